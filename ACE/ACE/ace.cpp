@@ -1,6 +1,14 @@
 #include <time.h>
 #include "libguardaimagen.h"
 #include "libACE.h"
+#include "libACEgeneral.h"
+#include "libcontenedor.h"
+#include "libmedidas.h"
+#include "libmotores.h"
+#include "libtrayectoria.h"
+#include "libminiatura.h"
+#include "libaditivas.h"
+#include "libcolumna.h"
 
 #pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
 
@@ -17,6 +25,11 @@
 #define MIN_CELDAS					2		// como mínimo 2 celdas en el ACE
 #define MAX_CELDAS					10000	// como máximo 10000 celdas en el ACE
 
+#define MAX_PASOS_MINIATURA			1000000000	// como máximo 10^9 pasos de evolución con miniatura
+#define MAX_CELDAS_MINIATURA		100000000	// como máximo 10^8 celdas en el ACE con miniatura
+#define MAX_LADO_MINIATURA			16384	// como máximo 16384 píxeles de anchura y de altura en la miniatura
+#define MAX_CELDAS_SALTO			50000000	// como máximo 5·10^7 celdas en total (instantes X celdas) con instantes
+
 /*
  * Nombre: ACE (Autómata Celular Elemental)
  * Autor: Ismael Flores Campoy
@@ -26,19 +39,67 @@
  * Opción					| Valores (separados por comas)		| Valor por defecto
  * -------------------------------------------------------------------------------------------------------
  * inicializacion			| aleatoria, semilla				| semilla
+ * semilla					| entero >= 0						| (instante actual)
  * reglas					| [0, 255], todas					| REGLA (54)
  * pasos					| [1, 5000]							| PASOS (500)
  * celdas					| [2, 10000]						| CELDAS (1000)
+ * radio					| [1, 3]							| 1
+ * estados					| [2, 4]							| 2
+ * totalista				| si, no							| no
+ * contenedor				| nombre de fichero					| (ficheros independientes)
+ * informe					| nombre de fichero					| (sin informe)
+ * progreso					| segundos							| 0 (sin progreso)
+ * ciclos					| si, no							| si
+ * motor					| referencia, empaquetado, tabla,	| referencia
+ *							| auto								|
+ * calibracion				| nombre de fichero					| motores.cal
+ * trayectoria				| si, no							| no
+ * miniatura				| <anchura>x<altura>				| (sin miniatura)
+ * teselas					| si, no							| no
+ * instantes				| enteros >= 0 (1e12, 2^40)			| (evolución completa)
+ * columna					| si, no							| no
  *
  * Argumento					| Significado
  * ------------------------------------------------------------------------------------------------------------
  * inicializacion:aleatoria		| La primera fila del ACE contiene una sucesión aleatoria de '0' y '1'
  * inicializacion:semilla		| La primera fila del ACE contiene todo '0' menos un '1' en la posición central
+ * semilla:1234				| La inicialización aleatoria es siempre la misma para la misma semilla (resultados reproducibles)
  * reglas:todas					| Se calculan los ACEs (y se guardan en ficheros) de todas las reglas [0, 255]
  * reglas:4						| Se calcula el ACE (y se guarda en ficheros) de la regla 4
  * reglas:4,90,126				| Se calcula el ACE (y se guarda en ficheros) de laS reglas 4, 90 y 126
  * pasos:300					| Se calculan 300 pasos de la evolución del ACE
  * celdas:700					| El ACE lo conforman 700 posiciones
+ * radio:2						| La vecindad de cada celda es de radio 2 (5 celdas). Con radio mayor que 1, más de 2 estados
+ *								| o reglas totalistas, las reglas se dan por su código de Wolfram (decimal, o hexadecimal con 0x
+ *								| para 2 estados: reglas:0x6a5c33f1) y los ficheros se nombran R<código>_RADIO<radio>_E<estados>
+ * estados:3					| Cada celda tiene 3 estados (0, 1 y 2)
+ * totalista:si					| La cifra i del código de la regla es el nuevo estado cuando la vecindad suma i
+ * contenedor:R.acec			| Todas las salidas se guardan en el fichero contenedor R.acec (se extraen con EXTRAER)
+ * informe:R.json				| Al terminar se guarda en R.json el informe de rendimiento (tiempo de cada fase, contadores, memoria)
+ * progreso:60					| Cada 60 segundos se muestra el porcentaje realizado y el tiempo estimado que falta
+ * ciclos:no					| Se simulan todos los pasos aunque la evolución entre en un ciclo (sin copiar el ciclo detectado)
+ * motor:empaquetado			| La evolución se calcula con el motor empaquetado (ver libmotores), tras comprobar que da lo mismo
+ *								| que generarACE; si no, se usa generarACE (referencia)
+ * motor:auto					| Para cada regla y tamaño se usa el motor más rápido de los que dan lo mismo que generarACE
+ *								| (se miden con una simulación corta y la elección se guarda en el fichero de calibración)
+ * calibracion:maquina.cal		| Con motor:auto, las elecciones de cada máquina se leen y guardan en maquina.cal
+ * trayectoria:si				| Además de la imagen, se guarda la evolución comprimida en un fichero de trayectoria (.tra)
+ * miniatura:1024x768			| En lugar de la imagen completa se guarda una imagen de 1024 X 768 píxeles en la que cada píxel
+ *								| es la densidad de celdas a 1 de un bloque de celdas y pasos (MINIATURA_R..._C..._P..._<inicializacion>.pgm).
+ *								| La evolución no se guarda: se simula empaquetada y cada fila se reduce al recibirla, por lo que
+ *								| la memoria es proporcional a la imagen y se admiten hasta 10^8 celdas y 10^9 pasos.
+ *								| Sólo para reglas de 2 estados (de cualquier radio) y sin trayectoria
+ * teselas:si					| Con miniatura, se guarda también la pirámide de resoluciones en teselas de 256 X 256 píxeles
+ *								| (MINIATURA_..._Z<nivel>_X<columna>_Y<fila>.pgm, el nivel 0 cabe en una tesela)
+ * instantes:0,1000,1e12		| Con reglas aditivas (0, 60, 90, 102, 150, 170, 204 y 240) sólo se calculan las filas de esos
+ *								| instantes, saltando en el tiempo con O(celdas · log t) operaciones (ver libaditivas), y se guardan
+ *								| en SALTO_R..._C..._<inicializacion>.pgm, una fila por instante (hasta 5·10^7 celdas en total).
+ *								| El resto de reglas no se calcula
+ * columna:si					| Con inicializacion:semilla sólo se calcula la columna central ACE[t][celdas / 2 + 1], t = 0..pasos,
+ *								| y se guarda como fichero binario de pasos + 1 bits (COLUMNA_R..._C..._P....bin, 8 bits por byte
+ *								| empezando por el más significativo). No se guarda ninguna fila: en cada paso sólo se calculan las
+ *								| celdas del cono de luz de la celda central del último paso (ver libcolumna), por lo que se admiten
+ *								| hasta 10^9 pasos
  * 
  * Ejemplos:
  *
@@ -46,6 +107,9 @@
  * ACE inicializacion:aleatoria
  * ACE reglas:todas celdas:1000 pasos:500
  * ACE reglas:4,126 pasos:200 celdas:200
+ * ACE reglas:30,110 celdas:1000000 pasos:1000000 miniatura:2048x2048 teselas:si inicializacion:aleatoria
+ * ACE reglas:90,150 celdas:1024 instantes:1000,2^40,1e12 inicializacion:aleatoria
+ * ACE reglas:30 celdas:10000000 pasos:1000000 columna:si
  *
  */
 int main(int argc, char** argv)
@@ -58,12 +122,36 @@ int main(int argc, char** argv)
 	int reglas[MAX_REGLAS];							// Guardamos las reglas a aplicar
 	int nreglas;									// Guardamos el número de reglas a aplicar
 	char nombreFichero[256];						// Guardaremos los nombres de los ficheros a crear
+	char nombreContenedor[256];						// Fichero contenedor en el que guardar todas las salidas (vacío: ficheros independientes)
+	Contenedor* contenedor = NULL;					// Contenedor abierto (si se usa)
+	char nombreInforme[256];						// Fichero en el que guardar el informe de rendimiento (vacío: sin informe)
+	double intervaloProgreso = 0.0;					// Segundos entre líneas de progreso (0: sin progreso)
+	bool ciclos = true;								// Detección de ciclos en las simulaciones (por defecto activada)
+	int motor = MOTOR_REFERENCIA;					// Motor de evolución (ver libmotores, por defecto generarACE)
+	char ficheroCalibracion[256];					// Fichero de calibración de motor:auto
+	int radio = 1;									// Radio de la vecindad (por defecto 1, ACE elemental)
+	int estadosCelda = 2;							// Estados de cada celda (por defecto 2)
+	bool totalista = false;							// Reglas totalistas
+	const char* textoReglas = NULL;					// Texto del parámetro 'reglas:' (se interpreta al final si las reglas son generales)
+	ReglaGeneral* reglasGenerales = NULL;			// Reglas generales (NULL: reglas elementales en 'reglas')
+	char nombreRegla[96];							// Identificación de la regla general en ficheros y mensajes
+	unsigned long long semilla = (unsigned long long)time(NULL);	// Semilla de los números aleatorios (por defecto el instante actual)
+	bool trayectoria = false;						// Guardar también la evolución en un fichero de trayectoria
+	int anchuraMiniatura = 0;						// Píxeles de la miniatura (0: se guarda la imagen completa)
+	int alturaMiniatura = 0;
+	bool teselas = false;							// Guardar también la pirámide de teselas de la miniatura
+	Miniatura miniatura;							// Miniatura de la evolución (ver libminiatura)
+	unsigned long long instantes[ADITIVAS_MAX_INSTANTES];	// Instantes de las filas a calcular con reglas aditivas
+	int ninstantes = 0;								// Número de instantes (0: se guarda la evolución completa)
+	int** muestras = NULL;							// Filas de los instantes pedidos
+	bool columna = false;							// Guardar sólo la columna central (inicialización por semilla)
 
 	// Inicializamos el texto de la inicialización del ACE como "semilla" (se usará para el nombre del fichero PGM en el que se guardan los resultados)
 	strcpy(strInicializacion, "semilla");
+	nombreContenedor[0] = 0;
+	nombreInforme[0] = 0;
+	strcpy(ficheroCalibracion, MOTOR_FICHERO_CALIBRACION);
 
-	// Inicializamos la semilla de los números aleatorios
-	srand((unsigned int)time(NULL));
 
 	// Por defecto aplicaremos la regla 'REGLA' si como argumento no indicamos otra cosa
 	reglas[0] = REGLA;
@@ -82,49 +170,283 @@ int main(int argc, char** argv)
 				inicializacion = INICIALIZACION_SEMILLA;
 			}
 		}
+		else if (strstr(argv[a], "semilla:") == argv[a]) {
+			// Si encontramos un argumento 'semilla:' la inicialización aleatoria será reproducible
+			semilla = strtoull(argv[a] + strlen("semilla:"), NULL, 10);
+		}
 		else if (strstr(argv[a], "reglas:") == argv[a]) {
 			// Si encontramos un argumento 'regla:' analizamos que valor tiene.
 			if (strstr(argv[a], ":todas") != NULL)
 				nreglas = obtenerValores(reglas, MAX_REGLAS, "0-255");
 			else
 				nreglas = obtenerValores(reglas, MAX_REGLAS, argv[a] + strlen("reglas:"));
+			textoReglas = argv[a] + strlen("reglas:");
+		}
+		else if (strstr(argv[a], "radio:") == argv[a]) {
+			// Si encontramos un argumento 'radio:' analizamos que valor tiene.
+			radio = atoi(argv[a] + strlen("radio:"));
+			if (radio < RADIO_MIN || radio > RADIO_MAX) {
+				radio = 1;
+				printf("Parámetro incorrecto, se esperaba un radio entre %d y %d... Se asume radio %d\n", RADIO_MIN, RADIO_MAX, radio);
+			}
+		}
+		else if (strstr(argv[a], "estados:") == argv[a]) {
+			// Si encontramos un argumento 'estados:' analizamos que valor tiene.
+			estadosCelda = atoi(argv[a] + strlen("estados:"));
+			if (estadosCelda < ESTADOS_MIN || estadosCelda > ESTADOS_MAX) {
+				estadosCelda = 2;
+				printf("Parámetro incorrecto, se esperaba un número de estados entre %d y %d... Se asumen %d estados\n", ESTADOS_MIN, ESTADOS_MAX, estadosCelda);
+			}
+		}
+		else if (strstr(argv[a], "totalista:") == argv[a]) {
+			// Si encontramos un argumento 'totalista:' analizamos que valor tiene.
+			totalista = (strstr(argv[a], ":si") != NULL);
 		}
 		else if (strstr(argv[a], "celdas:") == argv[a]) {
 			// Si encontramos un argumento 'celdas:' analizamos que valor tiene.
+			// (el máximo sin miniatura se comprueba al final, cuando se sabe si se pide)
 			celdas = atoi(argv[a] + strlen("celdas:"));
-			if (celdas < MIN_CELDAS || celdas > MAX_CELDAS || errno != 0) {
+			if (celdas < MIN_CELDAS || celdas > MAX_CELDAS_MINIATURA || errno != 0) {
 				celdas = CELDAS;
-				printf("Parámetro incorrecto, se esperaba un número de celdas entre %d y %d... Se asumen %d celdas\n", MIN_CELDAS, MAX_CELDAS, celdas);
+				printf("Parámetro incorrecto, se esperaba un número de celdas entre %d y %d... Se asumen %d celdas\n", MIN_CELDAS, MAX_CELDAS_MINIATURA, celdas);
 			}
 		}
 		else if (strstr(argv[a], "pasos:") == argv[a]) {
 			// Si encontramos un argumento 'pasos:' analizamos que valor tiene.
 			pasos = atoi(argv[a] + strlen("pasos:"));
-			if (pasos < MIN_PASOS || pasos > MAX_PASOS || errno != 0) {
+			if (pasos < MIN_PASOS || pasos > MAX_PASOS_MINIATURA || errno != 0) {
 				pasos = PASOS;
-				printf("Parámetro incorrecto, se esperaba un número de pasos entre %d y %d... Se asumen %d pasos\n", MIN_PASOS, MAX_PASOS, pasos);
+				printf("Parámetro incorrecto, se esperaba un número de pasos entre %d y %d... Se asumen %d pasos\n", MIN_PASOS, MAX_PASOS_MINIATURA, pasos);
+			}
+		}
+		else if (strstr(argv[a], "trayectoria:") == argv[a]) {
+			// Si encontramos un argumento 'trayectoria:' analizamos que valor tiene.
+			trayectoria = (strstr(argv[a], ":si") != NULL);
+		}
+		else if (strstr(argv[a], "miniatura:") == argv[a]) {
+			// Si encontramos un argumento 'miniatura:' analizamos el tamaño de la imagen (<anchura>x<altura>)
+			if (sscanf(argv[a] + strlen("miniatura:"), "%dx%d", &anchuraMiniatura, &alturaMiniatura) != 2 ||
+				anchuraMiniatura < 1 || anchuraMiniatura > MAX_LADO_MINIATURA || alturaMiniatura < 1 || alturaMiniatura > MAX_LADO_MINIATURA) {
+				anchuraMiniatura = alturaMiniatura = 0;
+				printf("Parámetro incorrecto, se esperaba el tamaño de la miniatura como <anchura>x<altura> (entre 1 y %d)... Se guarda la imagen completa\n", MAX_LADO_MINIATURA);
+			}
+		}
+		else if (strstr(argv[a], "teselas:") == argv[a]) {
+			// Si encontramos un argumento 'teselas:' analizamos que valor tiene.
+			teselas = (strstr(argv[a], ":si") != NULL);
+		}
+		else if (strstr(argv[a], "instantes:") == argv[a]) {
+			// Si encontramos un argumento 'instantes:' sólo se calculan las filas de esos instantes (reglas aditivas)
+			ninstantes = obtenerInstantes(instantes, ADITIVAS_MAX_INSTANTES, argv[a] + strlen("instantes:"));
+			if (ninstantes == 0)
+				printf("Parámetro incorrecto, se esperaba una lista de instantes (enteros, 1e12, 2^40)... Se guarda la evolución completa\n");
+		}
+		else if (strstr(argv[a], "columna:") == argv[a]) {
+			// Si encontramos un argumento 'columna:' analizamos que valor tiene.
+			columna = (strstr(argv[a], ":si") != NULL);
+		}
+		else if (strstr(argv[a], "contenedor:") == argv[a]) {
+			// Si encontramos un argumento 'contenedor:' todas las salidas se guardarán en dicho fichero
+			strncpy(nombreContenedor, argv[a] + strlen("contenedor:"), sizeof(nombreContenedor) - 1);
+			nombreContenedor[sizeof(nombreContenedor) - 1] = 0;
+		}
+		else if (strstr(argv[a], "informe:") == argv[a]) {
+			// Si encontramos un argumento 'informe:' al terminar se guardará en dicho fichero el informe de rendimiento
+			strncpy(nombreInforme, argv[a] + strlen("informe:"), sizeof(nombreInforme) - 1);
+			nombreInforme[sizeof(nombreInforme) - 1] = 0;
+		}
+		else if (strstr(argv[a], "progreso:") == argv[a]) {
+			// Si encontramos un argumento 'progreso:' analizamos que valor tiene.
+			intervaloProgreso = atof(argv[a] + strlen("progreso:"));
+		}
+		else if (strstr(argv[a], "motor:") == argv[a]) {
+			// Si encontramos un argumento 'motor:' analizamos que valor tiene.
+			motor = obtenerMotor(argv[a] + strlen("motor:"));
+			if (motor < MOTOR_AUTOMATICO) {
+				motor = MOTOR_REFERENCIA;
+				printf("Parámetro incorrecto, se esperaba un motor (referencia, empaquetado, tabla o auto)... Se usa generarACE (referencia)\n");
 			}
 		}
+		else if (strstr(argv[a], "calibracion:") == argv[a]) {
+			// Si encontramos un argumento 'calibracion:' las elecciones de motor:auto se leen y guardan en dicho fichero
+			strncpy(ficheroCalibracion, argv[a] + strlen("calibracion:"), sizeof(ficheroCalibracion) - 1);
+			ficheroCalibracion[sizeof(ficheroCalibracion) - 1] = 0;
+		}
+		else if (strstr(argv[a], "ciclos:") == argv[a]) {
+			// Si encontramos un argumento 'ciclos:' analizamos que valor tiene.
+			ciclos = (strstr(argv[a], ":no") == NULL);
+		}
+	}
+
+	// El salto en el tiempo sólo existe para las reglas elementales aditivas
+	if (ninstantes > 0 && (radio != 1 || estadosCelda != 2 || totalista)) {
+		printf("Los instantes sólo se calculan para reglas elementales aditivas... Se guarda la evolución completa\n");
+		ninstantes = 0;
+	}
+	if (ninstantes > 0 && anchuraMiniatura > 0) {
+		printf("Con instantes no se guarda la miniatura\n");
+		anchuraMiniatura = alturaMiniatura = 0;
+	}
+	if (ninstantes > 0 && (long long)ninstantes * celdas > MAX_CELDAS_SALTO) {
+		printf("Parámetro incorrecto, como mucho se calculan %d celdas en total (instantes X celdas)... Se guarda la evolución completa\n", MAX_CELDAS_SALTO);
+		ninstantes = 0;
+	}
+
+	// La columna central se calcula por su cono de luz desde la semilla, sólo para reglas elementales
+	if (columna && (radio != 1 || estadosCelda != 2 || totalista || inicializacion != INICIALIZACION_SEMILLA)) {
+		printf("La columna central sólo se calcula para reglas elementales con inicializacion:semilla... Se guarda la evolución completa\n");
+		columna = false;
+	}
+	if (columna && (anchuraMiniatura > 0 || ninstantes > 0)) {
+		printf("Con columna no se guardan la miniatura ni los instantes\n");
+		anchuraMiniatura = alturaMiniatura = 0;
+		ninstantes = 0;
+	}
+
+	// La miniatura es la densidad de celdas a 1: sólo para reglas de 2 estados
+	if (anchuraMiniatura > 0 && estadosCelda != 2) {
+		printf("La miniatura sólo se guarda para reglas de 2 estados... Se guarda la imagen completa\n");
+		anchuraMiniatura = alturaMiniatura = 0;
+	}
+
+	// Sin miniatura, instantes ni columna la evolución completa se guarda en memoria
+	if (anchuraMiniatura == 0 && ninstantes == 0 && !columna && celdas > MAX_CELDAS) {
+		celdas = CELDAS;
+		printf("Parámetro incorrecto, se esperaba un número de celdas entre %d y %d... Se asumen %d celdas\n", MIN_CELDAS, MAX_CELDAS, celdas);
+	}
+	if (anchuraMiniatura == 0 && ninstantes == 0 && !columna && pasos > MAX_PASOS) {
+		pasos = PASOS;
+		printf("Parámetro incorrecto, se esperaba un número de pasos entre %d y %d... Se asumen %d pasos\n", MIN_PASOS, MAX_PASOS, pasos);
+	}
+
+	// Con radio mayor que 1, más de 2 estados o reglas totalistas se usa el motor general (libACEgeneral)
+	if (radio != 1 || estadosCelda != 2 || totalista) {
+		char reglaDefecto[16];
+		sprintf(reglaDefecto, "%d", REGLA);
+		reglasGenerales = new ReglaGeneral [MAX_REGLAS];
+		nreglas = obtenerReglasGenerales(reglasGenerales, MAX_REGLAS, textoReglas != NULL ? textoReglas : reglaDefecto, radio, estadosCelda, totalista);
+		if (nreglas == 0) {
+			printf("No hay ninguna regla válida para radio %d y %d estados\n", radio, estadosCelda);
+			delete[] reglasGenerales;
+			return 1;
+		}
 	}
 
-	// Asignamos la memoria necesaria dinámicamente
-	asignarMemoriaACE(&ACE, pasos, celdas);
+	// Inicializamos el generador de números aleatorios (se muestra la semilla para poder repetir la ejecución)
+	establecerSemilla(semilla);
+	if (inicializacion == INICIALIZACION_ALEATORIA)
+		printf("Semilla de los números aleatorios: %llu\n", semilla);
 
-	// Definimos la condición inicial de nuestro ACE 
+	// Medidas de rendimiento (progreso e informe)
+	iniciarMedidas("ACE", argc, argv, intervaloProgreso);
+
+	// Detección de ciclos en las simulaciones
+	usarDeteccionCiclos(ciclos);
+
+	// Motor de evolución de las reglas elementales (ver libmotores)
+	usarMotor(motor, ficheroCalibracion);
+
+	// Si se ha indicado un contenedor, todas las salidas se guardan en él
+	if (nombreContenedor[0] != 0) {
+		contenedor = crearContenedor(nombreContenedor);
+		if (contenedor == NULL)
+			printf("No se pudo crear el contenedor %s... Se guardan ficheros independientes\n", nombreContenedor);
+		usarContenedor(contenedor);
+	}
+
+	// Asignamos la memoria necesaria dinámicamente (con miniatura, instantes o columna sólo la primera fila, la evolución no se guarda)
+	int filasMemoria = (anchuraMiniatura > 0 || ninstantes > 0 || columna) ? 0 : pasos;
+	asignarMemoriaACE(&ACE, filasMemoria, celdas);
+	if (ninstantes > 0)
+		asignarMemoriaACE(&muestras, ninstantes - 1, celdas);
+	iniciarMiniatura(miniatura);
+
+	// Definimos la condición inicial de nuestro ACE (con más de 2 estados, la aleatoria usa todos los estados)
 	inicializarACE(ACE, celdas, inicializacion);
+	if (reglasGenerales != NULL && inicializacion == INICIALIZACION_ALEATORIA && estadosCelda > 2)
+		aleatorizarFilaGeneral(ACE[0], celdas, estadosCelda, generadorHilo());
+
+	// Las trayectorias guardan reglas elementales
+	if (reglasGenerales != NULL && trayectoria) {
+		printf("Las trayectorias sólo se guardan para reglas de radio 1 y 2 estados... No se guardan\n");
+		trayectoria = false;
+	}
+
+	// La trayectoria necesita la evolución completa
+	if ((anchuraMiniatura > 0 || ninstantes > 0 || columna) && trayectoria) {
+		printf("Las trayectorias no se guardan con miniatura, instantes ni columna... No se guardan\n");
+		trayectoria = false;
+	}
 
 	// Para cada regla generamos la evolución del ACE y lo guardamos
 	for (int nr = 0; nr < nreglas; nr++) { 
 
-		// Generamos nuestro ACE 
-		generarACE(ACE, reglas[nr], pasos, celdas);
+		// Generamos nuestro ACE y lo guardamos (el color de cada celda va del blanco, estado 0, al negro)
+		if (columna) {
+			// Columna central: sólo las celdas del cono de luz, escritas bit a bit (tras comprobarla con generarACE)
+			if (verificarColumnaCentral(reglas[nr])) {
+				sprintf(nombreFichero, "COLUMNA_R%03d_C%05d_P%05d.bin", reglas[nr], celdas, pasos);
+				if (!generarColumnaCentral(nombreFichero, reglas[nr], celdas, pasos))
+					printf("No se pudo crear el fichero %s\n", nombreFichero);
+			}
+		}
+		else if (ninstantes > 0) {
+			// Instantes: cada fila se obtiene saltando en el tiempo (sólo reglas aditivas, tras comprobar el salto)
+			if (!reglaAditiva(reglas[nr]))
+				printf("La regla %d no es aditiva, no se puede saltar en el tiempo... No se calcula\n", reglas[nr]);
+			else if (verificarSalto(reglas[nr])) {
+				generarMuestrasAditivas(ACE[0], muestras, reglas[nr], celdas, instantes, ninstantes);
+				sprintf(nombreFichero, "SALTO_R%03d_C%05d_%s.pgm", reglas[nr], celdas, strInicializacion);
+				guardaPGMiACE(nombreFichero, ninstantes - 1, celdas, muestras, 1, 0);
+			}
+		}
+		else if (anchuraMiniatura > 0) {
+			// Miniatura: cada fila se reduce a medida que se simula
+			ReglaGeneral reglaElemental;
+			if (reglasGenerales == NULL) {
+				char codigo[16];
+				sprintf(codigo, "%d", reglas[nr]);
+				leerReglaGeneral(reglaElemental, 1, 2, false, codigo);
+			}
+			empezarMiniatura(miniatura, anchuraMiniatura, alturaMiniatura, celdas, pasos);
+			generarMiniatura(miniatura, reglasGenerales != NULL ? reglasGenerales[nr] : reglaElemental, pasos, celdas, ACE[0]);
+			if (reglasGenerales != NULL)
+				sprintf(nombreFichero, "MINIATURA_%s_C%05d_P%05d_%s.pgm", nombreReglaGeneral(reglasGenerales[nr], nombreRegla), celdas, pasos, strInicializacion);
+			else
+				sprintf(nombreFichero, "MINIATURA_R%03d_C%05d_P%05d_%s.pgm", reglas[nr], celdas, pasos, strInicializacion);
+			guardarMiniatura(miniatura, nombreFichero);
+			if (teselas)
+				guardarTeselasMiniatura(miniatura, nombreFichero);
+		}
+		else if (reglasGenerales != NULL) {
+			delete[] generarACEGeneral(ACE, reglasGenerales[nr], pasos, celdas);
+			sprintf(nombreFichero, "ACE_%s_C%05d_P%05d_%s.pgm", nombreReglaGeneral(reglasGenerales[nr], nombreRegla), celdas, pasos, strInicializacion);
+			guardaPGMiACE(nombreFichero, pasos, celdas, ACE, estadosCelda - 1, 0);
+		}
+		else {
+			delete[] generarACEMotor(ACE, reglas[nr], pasos, celdas);
+			sprintf(nombreFichero, "ACE_R%03d_C%05d_P%05d_%s.pgm", reglas[nr], celdas, pasos, strInicializacion);
+			guardaPGMiACE(nombreFichero, pasos, celdas, ACE, 1, 0);
+		}
 
-		// Guardamos nuestro ACE 
-		sprintf(nombreFichero, "ACE_R%03d_C%05d_P%05d_%s.pgm", reglas[nr], celdas, pasos, strInicializacion);
-		guardaPGMiACE(nombreFichero, pasos, celdas, ACE, 1, 0);
+		// Guardamos la trayectoria (permite volver a analizar el ACE sin simularlo)
+		if (trayectoria)
+			guardarTrayectoria(cambiarExtension(nombreFichero, "tra"), ACE, reglas[nr], pasos, celdas, inicializacion);
 
+		MEDIR_PROGRESO(nr + 1, nreglas);
 	}
 
 	// Liberamos la memoria
-	liberarMemoriaACE(ACE, pasos);
+	liberarMemoriaACE(ACE, filasMemoria);
+	if (muestras != NULL)
+		liberarMemoriaACE(muestras, ninstantes - 1);
+	liberarMiniatura(miniatura);
+	delete[] reglasGenerales;
+
+	// Cerramos el contenedor (escribe el índice de las salidas guardadas)
+	cerrarContenedor(contenedor);
+
+	// Guardamos el informe de rendimiento
+	if (nombreInforme[0] != 0 && !guardarInformeMedidas(nombreInforme))
+		printf("No se pudo crear el informe %s\n", nombreInforme);
 }
@@ -1,48 +1,288 @@
 #include "libACE.h"
+#include "libmedidas.h"
+#include "libtablas.h"
+#include <errno.h>
+#include <limits.h>
 
 #pragma warning ( disable: 4996 )
 
+static thread_local GeneradorAleatorio generadorPropio = { mezclarBits(mezclarBits(PASO_GENERADOR)), 0 };	// Generador de cada hilo
+
+void iniciarGenerador(GeneradorAleatorio& generador, unsigned long long semilla, unsigned long long flujo)
+{
+	generador.clave = mezclarBits(semilla ^ mezclarBits(flujo + PASO_GENERADOR));
+	generador.contador = 0;
+}
+
+GeneradorAleatorio& generadorHilo()
+{
+	return generadorPropio;
+}
+
+void establecerSemilla(unsigned long long semilla, unsigned long long flujo)
+{
+	iniciarGenerador(generadorPropio, semilla, flujo);
+}
+
 int aleatorio(int a, int b)
 {
 	double denominador = b - a + 1;		// Número de posibles valores a devolver
-	double numerador = RAND_MAX + 1;	// Número de posibles valores de la función 'rand'
 	double resultado;					// Guardamos el índice del valor a devolver que toca [0 .. b - a]
-	
-	// Calculamos el índice del valor a devolver dentro del rango [a .. b]
-	resultado = ((double)rand() * denominador) / numerador;
+
+	// Calculamos el índice del valor a devolver dentro del rango [a .. b] a partir de 53 bits aleatorios (en [0, 1))
+	resultado = (double)(siguienteAleatorio(generadorPropio) >> 11) * (1.0 / 9007199254740992.0) * denominador;
 
 	// Desplazamos el índice para integrarnos en el rango [a .. b]
 	return a + (int)resultado;
 }
 
-long* generarACE(int** ACE, int regla, int pasos, int celdas)
+static bool deteccionCiclos = false;	// Detección de ciclos en generarACE (ver usarDeteccionCiclos)
+
+void usarDeteccionCiclos(bool detectar)
+{
+	deteccionCiclos = detectar;
+}
+
+/*
+	Compara las filas 'a' y 'b' de una simulación: por su código de estado si el ACE tiene menos de 32 celdas
+	('codigo0' es el de la fila 0, el resto están en 'estados') y celda a celda si no.
+*/
+static inline bool filasIguales(int** ACE, const long* estados, long codigo0, int celdas, int a, int b)
+{
+	if (celdas < 32)
+		return (a == 0 ? codigo0 : estados[a - 1]) == (b == 0 ? codigo0 : estados[b - 1]);
+	return memcmp(ACE[a] + 1, ACE[b] + 1, celdas * sizeof(int)) == 0;
+}
+
+#define BLOQUE_ACTIVIDAD		64		// Celdas de cada bloque en el seguimiento de actividad de generarACE
+#define PERIODO_ACTIVIDAD		4		// Pasos hacia atrás con los que se compara cada bloque
+#define BLOQUE_ACTIVO			-1		// Bloque que no repite ninguna fila anterior (hay que calcularlo)
+#define BLOQUE_PENDIENTE		-2		// Bloque calculado en este paso y aún sin clasificar
+#define PAUSA_ACTIVIDAD_MIN		8		// Pasos sin seguimiento de actividad cuando apenas se ahorra (se duplica cada vez)
+#define PAUSA_ACTIVIDAD_MAX		256		// Máximo de pasos sin seguimiento de actividad
+
+/*
+	Calcula las celdas [desde, hasta] de la fila 'i' a partir de la fila anterior y acumula su código en 'estado'
+	(si el ACE tiene menos de 32 celdas).
+*/
+static inline void calcularCeldas(int** ACE, int i, int regla, int desde, int hasta, int celdas, long& estado)
 {
 	int vecindad;	// Guardamos la vecindad de la celda a calcular [0-7]
-	long* estados;	// Vamos calculando los estados por los que pasa en cada uno de los pasos
 
-	estados = new long [pasos];
-	for (int i = 1; i < pasos + 1; i++)
+	for (int j = desde; j < hasta + 1; j++)
 	{
-		estados[i - 1] = 0; // Inicializamos el valor del estado para el paso 'i'
+		// La vencidad de la celda (i, j) la componen {(i-1, j-1), (i-1, j), (i-1, j+1)}
+		vecindad = (ACE[i - 1][j + 1] | ACE[i - 1][j] << 1 | ACE[i - 1][j - 1] << 2);
+
+		// Comprovamos que valor [0-1] corresponde a dicha vencidad según la regla
+		ACE[i][j] = (regla >> vecindad) & 1;
 
+		// Actualizamos el valor del estado si el número de celdas del ACE es menor que 32
+		if (celdas < 32)
+			estado += (ACE[i][j] * (long)pow(2.0, celdas - j));
+	}
+}
+
+static inline bool celdasIguales(const int* a, const int* b, int n)
+{
+	for (int k = 0; k < n; k++)
+		if (a[k] != b[k])
+			return false;
+	return true;
+}
+
+/*
+	Clasifica el bloque de celdas [a, a + n) de la fila 'i': si coincide con el de la fila i - p desplazado t celdas
+	(p en [1, PERIODO_ACTIVIDAD], t en {-1, 0, 1}) devuelve 3 p + t + 1 y si no BLOQUE_ACTIVO.
+	Constante es p = 1, t = 0; un desplazamiento rígido, p = 1, t = +-1; un fondo periódico, p > 1.
+*/
+static inline int tipoBloque(int** ACE, int i, int a, int n)
+{
+	for (int p = 1; p <= PERIODO_ACTIVIDAD && p <= i; p++)
+		for (int t = -1; t <= 1; t++)
+			if (celdasIguales(ACE[i] + a, ACE[i - p] + a - t, n))
+				return 3 * p + t + 1;
+	return BLOQUE_ACTIVO;
+}
+
+long* generarACE(int** ACE, int regla, int pasos, int celdas, long* estados, CicloACE* ciclo, bool rellenarFilas)
+{
+	int simuladas = pasos;	// Filas simuladas (menos si se detecta un ciclo)
+	int periodo = 0;		// Periodo del ciclo detectado (0: ninguno)
+	int tortuga = 0;		// Algoritmo de Brent: fila con la que se comparan las siguientes
+	int potencia = 1;		// Algoritmo de Brent: filas a comparar con 'tortuga' antes de moverla
+	int distancia = 0;		// Algoritmo de Brent: distancia de la fila actual a 'tortuga'
+	long codigo0 = 0;		// Código de estado de la fila 0
+	bool cono = ((regla & 1) == 0);	// La vecindad 000 da 0: las celdas fuera del cono de luz de los '1' siguen a 0
+	int izquierda = 1;		// Cono de luz: primera celda distinta de 0 de la fila anterior
+	int derecha = 0;		// Cono de luz: última celda distinta de 0 de la fila anterior (< izquierda si son todas 0)
+	unsigned long long actualizadas = 0;	// Celdas calculadas
+	int bloques = (celdas + BLOQUE_ACTIVIDAD - 1) / BLOQUE_ACTIVIDAD;	// Bloques del seguimiento de actividad
+	int* tipos = NULL;		// Seguimiento de actividad: tipo de cada bloque de la fila anterior (ver 'tipoBloque')
+	int* tiposNuevos = NULL;	// Seguimiento de actividad: tipo de cada bloque de la fila actual
+	bool tiposValidos = false;	// Cierto si 'tipos' corresponde a la fila anterior
+	int pausa = PAUSA_ACTIVIDAD_MIN;	// Pasos que se suspende el seguimiento la próxima vez que no compense
+	int espera = 0;				// Pasos que quedan sin seguimiento de actividad
+
+	MEDIR_INICIO(FASE_SIMULACION);
+
+	// El seguimiento de actividad necesita al menos 3 bloques (cada bloque depende de sus dos vecinos)
+	if (bloques >= 3) {
+		tipos = new int [bloques];
+		tiposNuevos = new int [bloques];
+	}
+
+	if (deteccionCiclos && celdas < 32)
 		for (int j = 1; j < celdas + 1; j++)
-		{
-			// La vencidad de la celda (i, j) la componen {(i-1, j-1), (i-1, j), (i-1, j+1)}
-			vecindad = (ACE[i - 1][j + 1] | ACE[i - 1][j] << 1 | ACE[i - 1][j - 1] << 2);
+			codigo0 += ((long)ACE[0][j] << (celdas - j));
+
+	// Intervalo inicial del cono de luz
+	if (cono) {
+		for (int j = 1; j < celdas + 1; j++)
+			if (ACE[0][j] != 0) {
+				if (derecha < izquierda)
+					izquierda = j;
+				derecha = j;
+			}
+	}
+
+	// Vamos calculando los estados por los que pasa en cada uno de los pasos
+	if (estados == NULL)
+		estados = new long [pasos];
+	for (int i = 1; i < pasos + 1; i++)
+	{
+		estados[i - 1] = 0; // Inicializamos el valor del estado para el paso 'i'
 
-			// Comprovamos que valor [0-1] corresponde a dicha vencidad según la regla
-			ACE[i][j] = (regla >> vecindad) & 1;
+		// Mientras el cono de luz no llegue a los extremos de la fila sólo se calculan sus celdas (una más a cada lado
+		// que en la fila anterior) y el resto se ponen a 0. Cuando llega, el contorno periódico lo hace dar la vuelta
+		// y se vuelve a calcular la fila completa
+		int desde = 1, hasta = celdas;
+		if (cono && derecha < izquierda) {
+			desde = 1;
+			hasta = 0;
+		}
+		else if (cono && izquierda - 1 > 1 && derecha + 1 < celdas) {
+			desde = izquierda - 1;
+			hasta = derecha + 1;
+		}
+		else
+			cono = false;
+		if (cono) {
+			memset(ACE[i], 0, desde * sizeof(int));
+			memset(ACE[i] + hasta + 1, 0, (celdas + 1 - hasta) * sizeof(int));
+		}
 
-			// Actualizamos el valor del estado si el número de celdas del ACE es menor que 32
-			if (celdas < 32)
-				estados[i - 1] += (ACE[i][j] * (long)pow(2.0, celdas - j));
+		// Seguimiento de actividad: si un bloque y sus dos vecinos repitieron en la fila anterior la fila i - 1 - p
+		// desplazada t celdas, las entradas del bloque son las de hace p pasos desplazadas y el bloque es una copia
+		// del de la fila i - p desplazado. Sólo se calculan los bloques en los que hubo cambios a su alrededor
+		bool porBloques = (!cono && tiposValidos);
+		int copiados = 0;
+		if (porBloques) {
+			for (int b = 0; b < bloques; b++) {
+				int a = 1 + b * BLOQUE_ACTIVIDAD;
+				int n = (celdas + 1 - a < BLOQUE_ACTIVIDAD) ? celdas + 1 - a : BLOQUE_ACTIVIDAD;
+				int tipo = tipos[b];
+				if (tipo != BLOQUE_ACTIVO && tipo == tipos[b == 0 ? bloques - 1 : b - 1] && tipo == tipos[b == bloques - 1 ? 0 : b + 1]) {
+					memcpy(ACE[i] + a, ACE[i - tipo / 3] + a - (tipo % 3 - 1), n * sizeof(int));
+					tiposNuevos[b] = tipo;
+					copiados++;
+				}
+				else {
+					calcularCeldas(ACE, i, regla, a, a + n - 1, celdas, estados[i - 1]);
+					actualizadas += n;
+					tiposNuevos[b] = BLOQUE_PENDIENTE;
+				}
+			}
+		}
+		else {
+			calcularCeldas(ACE, i, regla, desde, hasta, celdas, estados[i - 1]);
+			actualizadas += (hasta >= desde) ? hasta - desde + 1 : 0;
 		}
 
 		// actualizamos las condiciones periódicas de contorno
 		ACE[i][0] = ACE[i][celdas];
 		ACE[i][celdas + 1] = ACE[i][1];
+
+		// Si casi no se ha copiado ningún bloque (actividad en toda la fila) el seguimiento cuesta más de lo que ahorra:
+		// se suspende unos pasos, cada vez más si sigue sin compensar
+		if (porBloques && copiados < bloques / 8) {
+			tiposValidos = false;
+			espera = pausa;
+			pausa = (2 * pausa < PAUSA_ACTIVIDAD_MAX) ? 2 * pausa : PAUSA_ACTIVIDAD_MAX;
+		}
+		else if (porBloques)
+			pausa = PAUSA_ACTIVIDAD_MIN;
+
+		// Clasificamos los bloques calculados de la fila completa (con el cono de luz no hace falta)
+		if (espera > 0)
+			espera--;
+		else if (tipos != NULL && !cono) {
+			for (int b = 0; b < bloques; b++) {
+				if (!porBloques || tiposNuevos[b] == BLOQUE_PENDIENTE) {
+					int a = 1 + b * BLOQUE_ACTIVIDAD;
+					tiposNuevos[b] = tipoBloque(ACE, i, a, (celdas + 1 - a < BLOQUE_ACTIVIDAD) ? celdas + 1 - a : BLOQUE_ACTIVIDAD);
+				}
+			}
+			int* t = tipos;
+			tipos = tiposNuevos;
+			tiposNuevos = t;
+			tiposValidos = true;
+		}
+
+		// Ajustamos el cono de luz a las celdas distintas de 0 de la nueva fila
+		if (cono) {
+			izquierda = 1;
+			derecha = 0;
+			for (int j = desde; j < hasta + 1; j++)
+				if (ACE[i][j] != 0) {
+					if (derecha < izquierda)
+						izquierda = j;
+					derecha = j;
+				}
+		}
+
+		// Algoritmo de Brent: si la fila coincide con la de la tortuga, el periodo es la distancia entre ambas;
+		// si no, cada vez que la distancia llega a una potencia de 2 la tortuga pasa a la fila actual
+		if (deteccionCiclos) {
+			distancia++;
+			if (filasIguales(ACE, estados, codigo0, celdas, i, tortuga)) {
+				periodo = distancia;
+				simuladas = i;
+				break;
+			}
+			if (distancia == potencia) {
+				tortuga = i;
+				potencia *= 2;
+				distancia = 0;
+			}
+		}
+	}
+
+	// Con el ciclo detectado, el resto de la evolución es una copia de la fila 'periodo' pasos anterior
+	if (periodo > 0) {
+		for (int i = simuladas + 1; i < pasos + 1; i++) {
+			if (rellenarFilas || celdas >= 32)
+				memcpy(ACE[i], ACE[i - periodo], (celdas + 2) * sizeof(int));
+			estados[i - 1] = (celdas >= 32) ? 0 : (i - periodo == 0 ? codigo0 : estados[i - periodo - 1]);
+		}
+		MEDIR_CONTAR(CONTADOR_FILAS_PERIODICAS, (unsigned long long)(pasos - simuladas));
 	}
 
+	// El transitorio es la primera fila que se repite 'periodo' pasos después
+	if (ciclo != NULL) {
+		ciclo->transitorio = 0;
+		ciclo->periodo = periodo;
+		if (periodo > 0)
+			while (!filasIguales(ACE, estados, codigo0, celdas, ciclo->transitorio, ciclo->transitorio + periodo))
+				ciclo->transitorio++;
+	}
+
+	delete[] tipos;
+	delete[] tiposNuevos;
+
+	MEDIR_CONTAR(CONTADOR_ACTUALIZACIONES, actualizadas);
+	MEDIR_FIN();
+
 	return estados;
 }
 
@@ -69,7 +309,7 @@ void liberarMemoriaACE(int** ACE, int pasos)
 	delete[] ACE;
 }
 
-void inicializarACE(int** ACE, int celdas, int inicializacion, const int* base)
+void inicializarACE(int** ACE, int celdas, int inicializacion, const int* base, GeneradorAleatorio* generador)
 {
 	// Ponemos todos los valores a 0 como inicialización
 	memset(ACE[0], 0, (celdas + 2) * sizeof(int));
@@ -79,12 +319,12 @@ void inicializarACE(int** ACE, int celdas, int inicializacion, const int* base)
 		ACE[0][celdas / 2 + 1] = 1;
 	// Inicializamos la primera fila con una distribución aleatoria de 0 y 1
 	else if (inicializacion == INICIALIZACION_ALEATORIA) {
-		for (int c = 1; c < celdas + 1; c++)
-			ACE[0][c] = aleatorio(0, 1);
-
-		// actualizamos las condiciones periódicas de contorno de la primera fila
-		ACE[0][0] = ACE[0][celdas];
-		ACE[0][celdas + 1] = ACE[0][1];
+		// Generamos la fila empaquetada (64 celdas por cada valor aleatorio) y la desempaquetamos,
+		// lo que además actualiza las condiciones periódicas de contorno de la primera fila
+		unsigned long long* palabras = new unsigned long long [palabrasFila(celdas)];
+		aleatorizarFila(palabras, celdas, generador != NULL ? *generador : generadorPropio);
+		desempaquetarFila(palabras, ACE[0], celdas);
+		delete[] palabras;
 	}
 	// Inicializamos la primera fila con una copia del vector 'base' cambiando el valor
 	// de la celda central. Se supone que base tiene la dimensión adecuada y las condiciones
@@ -104,8 +344,36 @@ void inicializarACE(int** ACE, int celdas, int inicializacion, const int* base)
 	}
 }
 
-int obtenerValores(int* valores, int maxvalores, const char* valorestxt, int minvalor, int maxvalor)
+/*
+	Convierte el texto 'texto' (un número entero y nada más) en 'valor'. Devuelve falso si no es un número o no cabe en un int.
+*/
+static bool convertirValor(const char* texto, int& valor)
+{
+	char* fin;
+
+	errno = 0;
+	long nv = strtol(texto, &fin, 10);
+	if (fin == texto || *fin != 0 || errno != 0 || nv < INT_MIN || nv > INT_MAX)
+		return false;
+	valor = (int)nv;
+	return true;
+}
+
+/*
+	Copia en 'valortxt' (de 32 caracteres) los 'longitud' primeros caracteres de 'texto'. Devuelve falso si no caben.
+*/
+static bool copiarValor(char* valortxt, const char* texto, size_t longitud)
+{
+	if (longitud >= 32)
+		return false;
+	strncpy(valortxt, texto, longitud);
+	valortxt[longitud] = 0;
+	return true;
+}
+
+int obtenerValores(int* valores, int maxvalores, const char* valorestxt, int minvalor, int maxvalor, int* descartados)
 {
+	int ndescartados = 0;	// Valores descartados (no son números o están fuera de rango)
 	int nv;					// Almacenamos cada nuevo valor encontrado
 	char nvalortxt[32];		// Almacenamos cada cadena separada por comas encontrada
 	int nvalores;			// Guardamos los valores encontrados en la cadena de texto 'reglastxt'
@@ -113,20 +381,17 @@ int obtenerValores(int* valores, int maxvalores, const char* valorestxt, int min
 	// Mientras se encuentren comas (',') se va analizando la cadena 'reglastxt'
 	nvalores = 0;
 	while (strstr(valorestxt, ",") != NULL && nvalores < maxvalores) {
-		// En 'nreglatxt' almacenamos el primer texto antes de la primera coma.
-		strncpy(nvalortxt, valorestxt, strstr(valorestxt, ",") - valorestxt);
-		nvalortxt[strstr(valorestxt, ",") - valorestxt] = 0;
-
-		// Se analiza intenta convertir la cadena a un entero 
-		nv = (strlen(nvalortxt) > 0) ? atoi(nvalortxt) : -1;
-
+		// En 'nreglatxt' almacenamos el primer texto antes de la primera coma y se intenta convertir a un entero.
 		// Si no es una regla válida se descarta, si es válida se añade a la lista
-		if (nv >= minvalor || nv <= maxvalor || errno == 0) {
+		if (copiarValor(nvalortxt, valorestxt, strstr(valorestxt, ",") - valorestxt) && convertirValor(nvalortxt, nv)
+			&& nv >= minvalor && nv <= maxvalor) {
 			valores[nvalores] = nv;
 			nvalores++;
 		}
-		else
+		else {
 			printf("Parámetro incorrecto, se esperaba un valor entre %d y %d... Se descarta\n", minvalor, maxvalor);
+			ndescartados++;
+		}
 
 		// Avanzamos a la siguiente regla, tras la siguiente coma.
 		valorestxt = strstr(valorestxt, ",") + 1;
@@ -134,82 +399,80 @@ int obtenerValores(int* valores, int maxvalores, const char* valorestxt, int min
 
 	if (nvalores < maxvalores) {
 		if (strstr(valorestxt, "-") != NULL) {
-			// Se analiza el rango de reglas. Primero el valor inicial
-			strncpy(nvalortxt, valorestxt, strstr(valorestxt, "-") - valorestxt);
-			nvalortxt[strstr(valorestxt, "-") - valorestxt] = 0;
-			int desde = atoi(nvalortxt);
-
-			// Después el valor final
-			valorestxt = strstr(valorestxt, "-") + 1;
-			int hasta = atoi(valorestxt);
-			for (int i = desde; i <= hasta && nvalores < maxvalores; i++) {
-				if (i >= minvalor || i <= maxvalor) {
-					valores[nvalores] = i;
+			// Se analiza el rango de reglas: el valor inicial y después el valor final (los dos han de ser números)
+			int desde, hasta;
+			if (!copiarValor(nvalortxt, valorestxt, strstr(valorestxt, "-") - valorestxt) || !convertirValor(nvalortxt, desde)
+				|| !convertirValor(strstr(valorestxt, "-") + 1, hasta)) {
+				printf("Parámetro incorrecto, se esperaba un rango de valores entre %d y %d... Se descarta\n", minvalor, maxvalor);
+				ndescartados++;
+			}
+
+			// Los valores del rango fuera de [minvalor, maxvalor] se descartan todos a la vez
+			else {
+				if (desde < minvalor || hasta > maxvalor) {
+					printf("Parámetro incorrecto, se esperaba un valor entre %d y %d... Se descartan los valores fuera de rango\n", minvalor, maxvalor);
+					ndescartados++;
+					desde = (desde < minvalor) ? minvalor : desde;
+					hasta = (hasta > maxvalor) ? maxvalor : hasta;
+				}
+				for (long long i = desde; i <= hasta && nvalores < maxvalores; i++) {
+					valores[nvalores] = (int)i;
 					nvalores++;
 				}
-				else
-					printf("Parámetro incorrecto, se esperaba un valor entre %d y %d... Se descarta\n", minvalor, maxvalor);
 			}
 		}
 		else {
 			// Se analiza la última cadena sin comas
-			nv = (strlen(valorestxt) > 0) ? atoi(valorestxt) : -1;
-
 			// Si no es una regla válida se descarta, si es válida se añade a la lista
-			if (nv >= minvalor || nv <= maxvalor || errno == 0) {
+			if (convertirValor(valorestxt, nv) && nv >= minvalor && nv <= maxvalor) {
 				valores[nvalores] = nv;
 				nvalores++;
 			}
-			else
+			else {
 				printf("Parámetro incorrecto, se esperaba un valor entre %d y %d... Se descarta\n", minvalor, maxvalor);
+				ndescartados++;
+			}
 		}
 	}
 
+	if (descartados != NULL)
+		*descartados = ndescartados;
 	return nvalores;
 }
 
-bool regresion(const double* puntosx, const double* puntosy, int npuntos, double& my, double& y0, double& r)
+void iniciarRegresion(AcumuladorRegresion& acumulador)
+{
+	memset(&acumulador, 0, sizeof(acumulador));
+}
+
+bool resultadoRegresion(const AcumuladorRegresion& acumulador, double& my, double& y0, double& r)
 {
 	double mx = 0.0;		// Necesario para calcular 'r'
-	double sumx = 0.0;		// Sumatorio de los valores de 'puntosx'
-	double sumy = 0.0;		// Sumatorio de los valores de 'puntosy'
-	double sumxy = 0.0;		// Sumatorio de los valores de 'puntosx'*'puntosy'
-	double sumx2 = 0.0;		// Sumatorio de los valores de 'puntosx'^2
-	double sumy2 = 0.0;		// Sumatorio de los valores de 'puntosy'^2
 	double denominadormx;	// Guardaremos el denominador para 'mx'
 	double denominadormy;	// Guardaremos el denominador para 'my'
 	double numeradorm;		// Guardaremos el numerador tanto para 'mx' como para 'my'
-	double N = npuntos;		// Guardamos el número de puntos como un double
+	double N = acumulador.npuntos;	// Guardamos el número de puntos como un double
 
-	if (npuntos <= 0)
+	if (acumulador.npuntos <= 0)
 		return false;
 
-	// Calculamos los sumatorios
-	for (int i = 0; i < npuntos; i++) {
-		sumx += puntosx[i];
-		sumy += puntosy[i];
-		sumxy += (puntosx[i] * puntosy[i]);
-		sumx2 += (puntosx[i] * puntosx[i]);
-		sumy2 += (puntosy[i] * puntosy[i]);
-	}
-
 	// Calculamos el numerador
-	numeradorm = N * sumxy - sumx * sumy;
+	numeradorm = N * acumulador.sumxy - acumulador.sumx * acumulador.sumy;
 
 	// Calculamos el denominador para 'my' (si es cero devolvemos error)
-	denominadormy = N * sumx2 - sumx * sumx;
+	denominadormy = N * acumulador.sumx2 - acumulador.sumx * acumulador.sumx;
 	if (denominadormy == 0.0 && numeradorm != 0.0)
 		return false;
 
 	// Calculamos el denominador para 'mx' (si es cero devolvemos error)
-	denominadormx = N * sumy2 - sumy * sumy;
+	denominadormx = N * acumulador.sumy2 - acumulador.sumy * acumulador.sumy;
 	if (denominadormx == 0.0 && numeradorm != 0.0)
 		return false;
 
 	// Calculamos 'mx', 'my' y 'y0'
 	my = (numeradorm == 0.0) ? 0.0 : numeradorm / denominadormy;
 	mx = (numeradorm == 0.0) ? 0.0 : numeradorm / denominadormx;
-	y0 = (sumy - my * sumx) / N;
+	y0 = (acumulador.sumy - my * acumulador.sumx) / N;
 
 	// Si no podemos calcular 'r' devolvemos error
 	if (mx * my < 0.0)
@@ -221,6 +484,18 @@ bool regresion(const double* puntosx, const double* puntosy, int npuntos, double
 	return true;
 }
 
+bool regresion(const double* puntosx, const double* puntosy, int npuntos, double& my, double& y0, double& r)
+{
+	AcumuladorRegresion acumulador;		// Sumatorios de los puntos
+
+	// Calculamos los sumatorios
+	iniciarRegresion(acumulador);
+	for (int i = 0; i < npuntos; i++)
+		acumularRegresion(acumulador, puntosx[i], puntosy[i]);
+
+	return resultadoRegresion(acumulador, my, y0, r);
+}
+
 bool exponenteHamming(const int* distanciasHamming, int pasos, double& eh)
 {
 	double y0;								// Ordenada de la recta de regresión (x = 0)
@@ -228,6 +503,8 @@ bool exponenteHamming(const int* distanciasHamming, int pasos, double& eh)
 	double* puntosx = new double [pasos];	// Coordenadas X de los puntos a partir de los que se calculará la regresión
 	double* puntosy = new double [pasos];	// Coordenadas Y de los puntos a partir de los que se calculará la regresión
 
+	MEDIR_INICIO(FASE_ANALISIS);
+
 	// Inicializamos los puntos a partir de las distancias de Hamming aplicando logaritmos
 	for (int i = 0; i < pasos; i++) {
 
@@ -236,6 +513,7 @@ bool exponenteHamming(const int* distanciasHamming, int pasos, double& eh)
 		if (distanciasHamming[i] == 0) {
 			delete[] puntosx;
 			delete[] puntosy;
+			MEDIR_FIN();
 			return false;
 		}
 
@@ -254,22 +532,47 @@ bool exponenteHamming(const int* distanciasHamming, int pasos, double& eh)
 	delete[] puntosx;
 	delete[] puntosy;
 
+	MEDIR_FIN();
+
 	return resultado;
 }
 
-int* generarHamming(int** ACE, int regla, int pasos, int celdas)
+int* generarHamming(int** ACE, int regla, int pasos, int celdas, int** ACE1, const CicloACE* cicloACE)
 {
-	int** ACE1;		// Nueva simulación
+	bool asignado = (ACE1 == NULL);		// Cierto si la memoria de la nueva simulación se asigna aquí
 	int* hamming;	// Distancias de Hamming de cada estado (fila) entre las evoluciones de los ACE
-	
+	CicloACE ciclo1;					// Ciclo de la nueva simulación
+	int calculadas = pasos + 1;			// Distancias a calcular (el resto se repiten)
+	int periodoHamming = 0;				// Periodo con el que se repiten las distancias (0: no se repiten)
+
+	MEDIR_INICIO(FASE_HAMMING);
+
 	// Inicializamos el ACE1, esto es, asignamos memoria y inicializamos la primera
 	// fila (estado inicial) con el estado inicial de ACE sustituyendo la celda central
 	// por la inversa de tal manera que dicho estado inicial sólo difiere en un valor, el del centro.
-	asignarMemoriaACE(&ACE1, pasos, celdas);
+	if (asignado)
+		asignarMemoriaACE(&ACE1, pasos, celdas);
 	inicializarACE(ACE1, celdas, INICIALIZACION_SIMILAR, ACE[0]);
 
 	// Simulamos el nuevo ACE1 con la regla dada
-	generarACE(ACE1, regla, pasos, celdas);
+	delete[] generarACE(ACE1, regla, pasos, celdas, NULL, &ciclo1);
+
+	// Si las dos simulaciones son periódicas, a partir del final de ambos transitorios las distancias se repiten
+	// con el mínimo común múltiplo de los dos periodos
+	if (cicloACE != NULL && cicloACE->periodo > 0 && ciclo1.periodo > 0) {
+		long long a = cicloACE->periodo, b = ciclo1.periodo;
+		while (b != 0) {
+			long long r = a % b;
+			a = b;
+			b = r;
+		}
+		long long periodo = (long long)cicloACE->periodo / a * ciclo1.periodo;
+		long long inicio = cicloACE->transitorio > ciclo1.transitorio ? cicloACE->transitorio : ciclo1.transitorio;
+		if (inicio + periodo < calculadas) {
+			periodoHamming = (int)periodo;
+			calculadas = (int)(inicio + periodo);
+		}
+	}
 
 	// Asignamos memoria para generar las distancias de Hamming entre ambos ACEs
 	hamming = new int [pasos + 1];
@@ -280,7 +583,7 @@ int* generarHamming(int** ACE, int regla, int pasos, int celdas)
 	// La distancia de Hamming entre los estados iniciales sabemos que es 1 (el valor central de la primera fila)
 	hamming[0] = 1;
 
-	for (int i = 1; i < pasos + 1; i++) 
+	for (int i = 1; i < calculadas; i++) 
 	{
 		// Calculamos la distancia de Hamming para el paso 'i' (número de diferencias)
 		for (int j = 1; j < celdas + 1; j++)
@@ -289,45 +592,53 @@ int* generarHamming(int** ACE, int regla, int pasos, int celdas)
 		}
 	}
 
+	// Extensión periódica del resto de distancias
+	if (periodoHamming > 0) {
+		for (int i = calculadas; i < pasos + 1; i++)
+			hamming[i] = hamming[i - periodoHamming];
+	}
+
 	// Liberamos el espacio asignado dinámicamente a ACE1
-	liberarMemoriaACE(ACE1, pasos);
+	if (asignado)
+		liberarMemoriaACE(ACE1, pasos);
+
+	MEDIR_FIN();
 
 	return hamming;
 }
 
-void inicializarAtractores(int*** probabilidades, int** visitados, int** estados, int pasos, int estadosPosibles)
+void inicializarAtractores(Histograma** probabilidades, int** visitados, int** estados, int pasos, int estadosPosibles)
 {
-	// Memoria para almacenar las visitas a cada estado en cada paso
-	*probabilidades = new int* [pasos + 1];
+	// Histogramas para almacenar las visitas a cada estado en cada paso
+	*probabilidades = new Histograma [pasos + 1];
 	for (int p = 0; p < pasos + 1; p++)
 	{
-		(*probabilidades)[p] = new int [estadosPosibles];
-		memset((*probabilidades)[p], 0, estadosPosibles * sizeof(int));
+		iniciarHistograma((*probabilidades)[p]);
+		vaciarHistograma((*probabilidades)[p], estadosPosibles);
 	}
 
 	// Memoria para almacenar el número de estados diferentes visitados en cada paso
 	*visitados = new int [pasos + 1];
 	memset(*visitados, 0, (pasos + 1) * sizeof(int));
 
-	// Memoria para almacenar el número de visitas a cada estado en algún paso
-	*estados = new int [estadosPosibles];
-	memset(*estados, 0, estadosPosibles * sizeof(int));
+	// Memoria para almacenar el número de visitas a cada estado en algún paso (tabla grande, ver libtablas)
+	*estados = (int*)reservarTabla((size_t)estadosPosibles * sizeof(int));
 }
 
-void liberarAtractores(int** probabilidades, int* visitados, int* estados, int pasos)
+void liberarAtractores(Histograma* probabilidades, int* visitados, int* estados, int pasos)
 {
-	// Liberamos cada paso que consta de un vector con las veces en que se visitó cada estado
+	// Liberamos cada paso que consta de un histograma con las veces en que se visitó cada estado
 	for (int i = 0; i < pasos + 1; i++)
-		delete[] probabilidades[i];
+		liberarHistograma(probabilidades[i]);
 
-	// Liberamos el vector de punteros
+	// Liberamos el vector de histogramas
 	delete[] probabilidades;
 
 	// Liberamos el vector de porcentaje de estados visitados para cada paso
 	delete[] visitados;
 
 	// Liberamos el vector de porcentaje de visitas a cada estado 
-	delete[] estados;
+	liberarTabla(estados);
 }
 
 void generarEstadoInicial(int* base, int estado, int celdas)
@@ -347,6 +658,8 @@ double entropia(int* probabilidades, int celdas)
 	double suma = 0.0;								// Iremos guardando la suma
 	double pe;										// Guardaremos la probabilidad de visitar un estado concreto
 
+	MEDIR_INICIO(FASE_ENTROPIA);
+
 	// La fórmula de la entropía consiste en realizar el sumatorio de
 	for (long e = 0; e < estadosPosibles; e++) {
 		if (probabilidades[e] == 0)
@@ -357,6 +670,125 @@ double entropia(int* probabilidades, int celdas)
 		suma += ((pe * log(pe)) / log(2.0));
 	}
 
+	MEDIR_FIN();
+
 	// Finalmente devolvemos el sumatorio calculado multiplicado por -1/celdas
 	return -suma / (double)celdas;
 }
+
+double entropia(const Histograma& probabilidades, int celdas)
+{
+	if (probabilidades.denso != NULL)
+		return entropia(probabilidades.denso, celdas);
+
+	long estadosPosibles = (long)pow(2.0, celdas);	// Todos los estados posibles
+	double suma = 0.0;								// Iremos guardando la suma
+	double pe;										// Guardaremos la probabilidad de visitar un estado concreto
+
+	// Las visitas de los estados visitados, en el mismo orden que en el vector denso
+	int* cuentas = new int [(size_t)probabilidades.distintos + 1];
+	long long n = entradasHistograma(probabilidades, NULL, cuentas);
+
+	MEDIR_INICIO(FASE_ENTROPIA);
+
+	for (long long i = 0; i < n; i++) {
+		pe = (double)cuentas[i] / (double)estadosPosibles;
+		suma += ((pe * log(pe)) / log(2.0));
+	}
+
+	MEDIR_FIN();
+
+	delete[] cuentas;
+	return -suma / (double)celdas;
+}
+
+/*
+	Término c·log2(c) de un estado con 'visitas' visitas, en coma fija con ENTROPIA_BITS_FRACCION bits fraccionarios.
+*/
+static unsigned long long terminoEntropia(long long visitas)
+{
+	if (visitas <= 1)
+		return 0;
+	return (unsigned long long)llround(ldexp((double)visitas * log2((double)visitas), ENTROPIA_BITS_FRACCION));
+}
+
+/*
+	Incrementos de c·log2(c) precalculados hasta ENTROPIA_TABLA visitas (se construye la primera vez que se usa).
+*/
+struct TablaEntropia {
+	unsigned long long incremento[ENTROPIA_TABLA + 1];
+
+	TablaEntropia()
+	{
+		incremento[0] = 0;
+		for (int c = 1; c <= ENTROPIA_TABLA; c++)
+			incremento[c] = terminoEntropia(c) - terminoEntropia(c - 1);
+	}
+};
+
+unsigned long long incrementoEntropia(int visitas)
+{
+	static const TablaEntropia tabla;
+
+	if (visitas <= ENTROPIA_TABLA)
+		return tabla.incremento[visitas];
+	return terminoEntropia(visitas) - terminoEntropia(visitas - 1);
+}
+
+unsigned long long sumaEntropia(const Histograma& probabilidades)
+{
+	unsigned long long suma = 0;
+
+	if (probabilidades.denso != NULL) {
+		for (long long e = 0; e < probabilidades.estadosPosibles; e++)
+			suma += terminoEntropia(probabilidades.denso[e]);
+		return suma;
+	}
+
+	int* cuentas = new int [(size_t)probabilidades.distintos + 1];
+	long long n = entradasHistograma(probabilidades, NULL, cuentas);
+	for (long long i = 0; i < n; i++)
+		suma += terminoEntropia(cuentas[i]);
+	delete[] cuentas;
+	return suma;
+}
+
+double entropiaSuma(unsigned long long suma, int celdas)
+{
+	// Escrito como -(...) / celdas para dar el mismo signo que 'entropia' cuando la entropía es 0
+	double media = ldexp((double)suma, -(ENTROPIA_BITS_FRACCION + celdas));
+	return -(media - (double)celdas) / (double)celdas;
+}
+
+void empaquetarFila(const int* fila, unsigned long long* palabras, int celdas)
+{
+	// Cada palabra se forma en un registro y se escribe una sola vez
+	for (int w = 0, inicio = 1; inicio < celdas + 1; w++, inicio += 64) {
+		int n = celdas + 1 - inicio < 64 ? celdas + 1 - inicio : 64;
+		unsigned long long palabra = 0;
+		for (int b = 0; b < n; b++)
+			palabra |= ((unsigned long long)(fila[inicio + b] & 1)) << b;
+		palabras[w] = palabra;
+	}
+}
+
+void desempaquetarFila(const unsigned long long* palabras, int* fila, int celdas)
+{
+	for (int j = 1; j < celdas + 1; j++)
+		fila[j] = (int)((palabras[(j - 1) >> 6] >> ((j - 1) & 63)) & 1);
+
+	// Actualizamos las condiciones periódicas de contorno
+	fila[0] = fila[celdas];
+	fila[celdas + 1] = fila[1];
+}
+
+void aleatorizarFila(unsigned long long* palabras, int celdas, GeneradorAleatorio& generador)
+{
+	int n = palabrasFila(celdas);
+	for (int w = 0; w < n; w++)
+		palabras[w] = siguienteAleatorio(generador);
+
+	// Los bits que sobran en la última palabra quedan a 0
+	if (celdas % 64 != 0)
+		palabras[n - 1] &= (1ULL << (celdas % 64)) - 1;
+}
@@ -3,24 +3,96 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 #include <memory.h>
 #include <stdlib.h>
 #include <math.h>
+#include "libhistograma.h"
 
 #define INICIALIZACION_SEMILLA		0		// Se inicializa con un '1' en la primera fila, en la columna central
 #define INICIALIZACION_ALEATORIA	1		// Se inicializa con una distribución aleatoria de '0' y '1' en la primera fila
 #define INICIALIZACION_SIMILAR		2		// Se inicializa con la primera fila similar a otra pero cambiado sólo el valor central negado
 #define INICIALIZACION_FIJA			3		// Se inicializa con la primera fila proporcionada
 
+#define ENTROPIA_BITS_FRACCION		28		// Bits fraccionarios de las sumas de c·log2(c) (caben hasta 30 celdas en 64 bits)
+#define ENTROPIA_TABLA				65536	// Visitas hasta las que los incrementos de c·log2(c) están precalculados
+
+/*
+ * Generador de números aleatorios basado en contador (SplitMix64). El valor n-ésimo de un flujo es una mezcla de bits
+ * de (clave + n * PASO_GENERADOR), siendo la clave función de la semilla y del número de flujo: no hay estado compartido,
+ * cada hilo o cada miembro de un conjunto de simulaciones puede usar su propio flujo independiente y, con la misma semilla
+ * y el mismo flujo, la secuencia es siempre la misma en cualquier plataforma.
+ */
+#define PASO_GENERADOR				0x9E3779B97F4A7C15ULL	// Incremento de SplitMix64 (parte fraccionaria de la razón áurea)
+
+struct GeneradorAleatorio {
+	unsigned long long clave;		// Derivada de la semilla y del flujo
+	unsigned long long contador;	// Valores generados hasta ahora
+};
+
+/*
+ * Nombre: mezclarBits
+ *
+ * Descripción: Función de mezcla de SplitMix64 (biyectiva, cada bit de la entrada afecta a todos los de la salida).
+ *
+ */
+inline unsigned long long mezclarBits(unsigned long long z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/*
+ * Nombre: iniciarGenerador
+ *
+ * Descripción: Prepara un generador para producir la secuencia correspondiente a una semilla y un flujo.
+ *
+ * generador: Generador a iniciar.
+ * semilla: Semilla (la misma semilla y flujo dan siempre la misma secuencia).
+ * flujo: Número de flujo (hilo, miembro del conjunto, ...). Flujos distintos dan secuencias independientes.
+ *
+ */
+void iniciarGenerador(GeneradorAleatorio& generador, unsigned long long semilla, unsigned long long flujo = 0);
+
+/*
+ * Nombre: siguienteAleatorio
+ *
+ * Descripción: Devuelve los siguientes 64 bits aleatorios del generador.
+ *
+ */
+inline unsigned long long siguienteAleatorio(GeneradorAleatorio& generador)
+{
+	return mezclarBits(generador.clave + (++generador.contador) * PASO_GENERADOR);
+}
+
+/*
+ * Nombre: generadorHilo
+ *
+ * Descripción: Devuelve el generador propio del hilo que llama (semilla 0 y flujo 0 mientras no se use 'establecerSemilla').
+ *              Es el que usan 'aleatorio' e 'inicializarACE' cuando no se les indica otro.
+ *
+ */
+GeneradorAleatorio& generadorHilo();
+
+/*
+ * Nombre: establecerSemilla
+ *
+ * Descripción: Reinicia el generador del hilo que llama con la semilla y el flujo indicados.
+ *
+ */
+void establecerSemilla(unsigned long long semilla, unsigned long long flujo = 0);
+
 /*
  * Nombre: aleatorio
  *
  * Descripción: Devuelve un entero aleatorio entre 'a' y 'b' (ambos incluidos y de forma equiprobable)
+ *				usando el generador del hilo que llama.
  *
  * a: Valor inicial
  * b: Valor final
  *
- * La función presupone que (a < b) y (RAND_MAX > 0)
+ * La función presupone que (a < b)
  *
  */
 int aleatorio(int a, int b);
@@ -65,12 +137,34 @@ void liberarMemoriaACE(int** ACE, int pasos);
  * base: Si la inicialización es INICIALIZACION_SIMILAR, se inicializa la primera fila con este vector
  *       modificando únicamente el valor central negándolo (0 <-> 1). Se supone que el vector tiene la misma dimensión
  *       que el ACE ('celdas' + 2). Si la inicialización es INICIALIZACION_SIMILAR, se inicializa la primera fila con este vector.
+ * generador: Si la inicialización es INICIALIZACION_ALEATORIA, generador del que se obtienen los valores
+ *            (si es NULL se usa el del hilo, ver 'generadorHilo'). Se consumen palabrasFila(celdas) valores de 64 bits.
  *
  * El ACE debe tener 'celdas' + 2 columnas (las dos extras son para establecer las condiciones de contorno) y 
  * almenos una fila (paso 0).
  *
  */
-void inicializarACE(int** ACE, int celdas, int inicializacion = INICIALIZACION_SEMILLA, const int* base = NULL);
+void inicializarACE(int** ACE, int celdas, int inicializacion = INICIALIZACION_SEMILLA, const int* base = NULL, GeneradorAleatorio* generador = NULL);
+
+/*
+ * Ciclo en la evolución de un ACE: a partir de la fila 'transitorio' las filas se repiten cada 'periodo' pasos.
+ */
+struct CicloACE {
+	int transitorio;					// Primera fila del ciclo
+	int periodo;						// Longitud del ciclo (0: no se ha detectado ciclo)
+};
+
+/*
+ * Nombre: usarDeteccionCiclos
+ *
+ * Descripción: Activa o desactiva (por defecto desactivada) la detección de ciclos en 'generarACE'. Con ella activada,
+ *              mientras se simula se busca un ciclo con el algoritmo de Brent (comparando los códigos de estado si el ACE
+ *              tiene menos de 32 celdas y las filas completas si no) y, en cuanto se encuentra, el resto de filas y estados
+ *              se copian del ciclo en lugar de simularlos. El resultado es idéntico al de la simulación completa.
+ *              Se debe llamar antes de lanzar hilos de trabajo.
+ *
+ */
+void usarDeteccionCiclos(bool detectar);
 
 /*
  * Nombre: generarACE
@@ -83,15 +177,25 @@ void inicializarACE(int** ACE, int celdas, int inicializacion = INICIALIZACION_S
  * regla: Entero con la regla que se aplicará para hacer evolucionar el ACE de entrada.
  * pasos: Número de pasos de que consta la evolución del ACE.
  * celdas: Número de celdas que tiene el ACE.
+ * estados: Vector de al menos 'pasos' posiciones en el que devolver los estados (si es NULL se asigna memoria para él).
+ *          Permite reutilizar el mismo vector en simulaciones sucesivas.
  *
  * Devuelve en la variable ACE la evolución del autómata a partir de su estado inicial
  * aplicando la regla indicada. Se supone que la variable ACE está incializada correctamente, es decir,
  * que las dimensiones son correctas y su estado incial (primera fila) también.
  * Devueve un puntero al vector de estados que ha visitado a cada paso, sólo para tamaños de ACE menores que 32 celdas y
- * sin contar el estado inicial
+ * sin contar el estado inicial ('estados' si se proporcionó, si no se libera con delete[])
+ *
+ * ciclo: Si no es NULL, devuelve el ciclo detectado (ver 'usarDeteccionCiclos'); periodo 0 si no se detectó.
+ * rellenarFilas: Si es falso y el ACE tiene menos de 32 celdas, tras detectar un ciclo sólo se completan los estados
+ *                y no las filas (para quien sólo necesita los estados).
+ *
+ * Con 3 o más bloques de 64 celdas sólo se calculan los bloques con actividad: un bloque que, como sus dos vecinos,
+ * repitió en el paso anterior una fila reciente (constante, desplazada una celda o con periodo de hasta 4 pasos)
+ * se copia de esa fila. El resultado es el mismo que calculando todas las celdas.
  *
  */
-long* generarACE(int** ACE, int regla, int pasos, int celdas);
+long* generarACE(int** ACE, int regla, int pasos, int celdas, long* estados = NULL, CicloACE* ciclo = NULL, bool rellenarFilas = true);
 
 /*
  * Nombre: obtenerValores
@@ -102,13 +206,15 @@ long* generarACE(int** ACE, int regla, int pasos, int celdas);
  * valores: Vector de enteros en la que guardaremos los valores obtenidos.
  * maxvalores: Entero que contiene el número máximo de valores que pueden almacenar 'valores'.
  * valorestxt: Texto en el que buscamos los valores. Puede contener uno o más números enteros separados por comas.
+ * descartados: Si no es NULL, número de valores descartados (no son números o están fuera de rango; un rango
+ *              que se sale de [minvalor, maxvalor] cuenta como un descarte).
  *
  * Devuelve en el vector 'valores' los enteros entre 'minvalor' y 'maxvalor' encontrados en 'valorestxt' y 
  * devuelve el número de dichos valores encontrados. Si no se encuentra ningún valor se devuelve 0.
  * Como máximo se aceptan 'maxvalores' valores.
  *
  */
-int obtenerValores(int* valores, int maxvalores, const char* valorestxt, int minvalor = 0, int maxvalor = 255);
+int obtenerValores(int* valores, int maxvalores, const char* valorestxt, int minvalor = 0, int maxvalor = 255, int* descartados = NULL);
 
 /*
  * Nombre: regresion
@@ -130,6 +236,50 @@ int obtenerValores(int* valores, int maxvalores, const char* valorestxt, int min
  */
 bool regresion(const double* puntosx, const double* puntosy, int npuntos, double& my, double& y0, double& r);
 
+/*
+ * Sumatorios de los puntos de una recta de regresión, para acumularlos a medida que se obtienen los puntos
+ * (sin guardarlos) y calcular la recta al final con 'resultadoRegresion'.
+ */
+struct AcumuladorRegresion {
+	int npuntos;						// Número de puntos acumulados
+	double sumx, sumy;					// Sumatorios de las coordenadas X e Y
+	double sumxy;						// Sumatorio de X * Y
+	double sumx2, sumy2;				// Sumatorios de X^2 e Y^2
+};
+
+/*
+ * Nombre: iniciarRegresion
+ *
+ * Descripción: Deja el acumulador sin puntos.
+ *
+ */
+void iniciarRegresion(AcumuladorRegresion& acumulador);
+
+/*
+ * Nombre: acumularRegresion
+ *
+ * Descripción: Añade el punto (x, y) a los sumatorios del acumulador.
+ *
+ */
+inline void acumularRegresion(AcumuladorRegresion& acumulador, double x, double y)
+{
+	acumulador.npuntos++;
+	acumulador.sumx += x;
+	acumulador.sumy += y;
+	acumulador.sumxy += (x * y);
+	acumulador.sumx2 += (x * x);
+	acumulador.sumy2 += (y * y);
+}
+
+/*
+ * Nombre: resultadoRegresion
+ *
+ * Descripción: Calcula la recta de regresión de los puntos acumulados, como 'regresion' (que acumula los puntos
+ *              en el mismo orden y obtiene así exactamente el mismo resultado).
+ *
+ */
+bool resultadoRegresion(const AcumuladorRegresion& acumulador, double& my, double& y0, double& r);
+
 /*
  * Nombre: exponenteHamming
  *
@@ -160,29 +310,34 @@ bool exponenteHamming(const int* distanciasHamming, int pasos, double& eh);
  *		  hacer evolucionar el nuevo ACE en el tiempo.
  * pasos: Número de pasos de que consta el ACE de entrada y que tendrá la simulación del nuevo ACE.
  * celdas: Número de celdas que tiene el ACE y con que constará el nuevo ACE.
+ * ACE1: Memoria para la simulación del nuevo ACE, de al menos las dimensiones de ACE (si es NULL se asigna y se libera
+ *       dentro de la función). Permite reutilizar la misma memoria en cálculos sucesivos.
+ * cicloACE: Ciclo de la simulación de ACE devuelto por 'generarACE' (si se conoce). Si ambos ACEs tienen ciclo,
+ *           las distancias se repiten con el mínimo común múltiplo de los periodos y no se calculan más allá.
  *
  * Devuelve una lista de enteros con la evolución de las distancias de Hamming entre el ACE proporcionado 
  * y el ACE que evoluciona desde un estado inicial casi idéntico.
  *
  */
-int* generarHamming(int** ACE, int regla, int pasos, int celdas);
+int* generarHamming(int** ACE, int regla, int pasos, int celdas, int** ACE1 = NULL, const CicloACE* cicloACE = NULL);
 
 /*
  * Nombre: inicializarAtractores
  *
- * Descripción: Asigna la memoria necesaria para guardar el número de visitas a cada estado en cada paso ('probabilidades')
+ * Descripción: Prepara los histogramas para guardar el número de visitas a cada estado en cada paso ('probabilidades')
  *				a partir de las simulaciones partiendo de una serie de estados iniciales que abarca todo el espacio de fases.
  *				También asigna memoria para guardar el porcentaje de estados diferentes visitados en cada paso a partir de la misma simulación,
  *				es decir, en cada paso contará el número de estados diferentes visitados, dividirá por el número de estados posibles.
  *
- * probabilidades: Para cada paso, guardará cuantas veces se visitó cada estado posible en dicho paso.
+ * probabilidades: Para cada paso, guardará cuantas veces se visitó cada estado posible en dicho paso (un histograma
+ *                 por paso, disperso mientras se visiten pocos estados, ver libhistograma).
  * visitados: Para cada paso, guardaremos el número de estados diferentes visitados.
  * estados: Para cada estado guardaremos las veces que ha sido visitado en cualquier paso de la simulación.
  * pasos: Número de pasos de que constará las evoluciones de los ACEs.
  * estadosPosibles: Número de estados posibles de los ACEs (2^celdas).
  *
  */
-void inicializarAtractores(int*** probabilidades, int** visitados, int** estados, int pasos, int estadosPosibles);
+void inicializarAtractores(Histograma** probabilidades, int** visitados, int** estados, int pasos, int estadosPosibles);
 
 /*
  * Nombre: liberarAtractores
@@ -197,7 +352,7 @@ void inicializarAtractores(int*** probabilidades, int** visitados, int** estados
  * pasos: Número de pasos de que constan las simulaciones.
  *
  */
-void liberarAtractores(int** probabilidades, int* visitados, int* estados, int pasos);
+void liberarAtractores(Histograma* probabilidades, int* visitados, int* estados, int pasos);
 
 /*
  * Nombre: generarEstadoInicial
@@ -230,4 +385,113 @@ void generarEstadoInicial(int* base, int estado, int celdas);
  */
 double entropia(int* probabilidades, int celdas);
 
+/*
+ * Nombre: entropia
+ *
+ * Descripción: Como la anterior con las visitas en un histograma (denso o disperso). El resultado es idéntico
+ *              al del vector denso: los estados se suman en el mismo orden.
+ *
+ */
+double entropia(const Histograma& probabilidades, int celdas);
+
+/*
+ * Nombre: incrementoEntropia
+ *
+ * Descripción: Devuelve lo que aumenta la suma de c·log2(c) de un paso (ver 'entropiaSuma') cuando uno de sus estados
+ *              pasa de 'visitas' - 1 a 'visitas' visitas. Las sumas se llevan en coma fija con ENTROPIA_BITS_FRACCION
+ *              bits fraccionarios y cada término c·log2(c) se redondea por separado, de modo que la suma de los
+ *              incrementos de un estado es exactamente su término final y el resultado no depende del orden de las visitas.
+ *              Hasta ENTROPIA_TABLA visitas el incremento se toma de una tabla precalculada.
+ *
+ */
+unsigned long long incrementoEntropia(int visitas);
+
+/*
+ * Nombre: sumaEntropia
+ *
+ * Descripción: Calcula de una vez la suma de c·log2(c) de un histograma, igual a la que se obtiene acumulando
+ *              'incrementoEntropia' visita a visita (para retomar la suma al reanudar desde un punto de control).
+ *
+ */
+unsigned long long sumaEntropia(const Histograma& probabilidades);
+
+/*
+ * Nombre: entropiaSuma
+ *
+ * Descripción: Calcula la entropía de un paso de un ACE de 'celdas' celdas en el que se han simulado todos los
+ *              estados posibles (las visitas suman 2^celdas) a partir de la suma de c·log2(c) de sus visitas:
+ *              -sum(pe·log2(pe)) / celdas con pe = c / 2^celdas es (celdas - suma / 2^celdas) / celdas.
+ *              Permite tener la entropía de cada paso al acabar el recorrido de los estados sin volver a recorrer los histogramas.
+ *
+ */
+double entropiaSuma(unsigned long long suma, int celdas);
+
+/*
+ * Nombre: contarUnos
+ *
+ * Descripción: Devuelve el número de bits a 1 de 'x' (popcount).
+ *
+ */
+inline int contarUnos(unsigned long long x)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountll(x);
+#else
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/*
+ * Nombre: palabrasFila
+ *
+ * Descripción: Devuelve el número de palabras de 64 bits necesarias para guardar empaquetada una fila de 'celdas' celdas.
+ *
+ */
+inline int palabrasFila(int celdas)
+{
+	return (celdas + 63) / 64;
+}
+
+/*
+ * Nombre: empaquetarFila
+ *
+ * Descripción: Empaqueta una fila de un ACE (un entero por celda) en palabras de 64 bits (un bit por celda).
+ *
+ * fila: Fila del ACE con 'celdas' + 2 posiciones (las dos extras son las condiciones de contorno, que se ignoran).
+ * palabras: Vector de palabrasFila(celdas) palabras en el que se guarda la fila empaquetada.
+ *           La celda j [1, celdas] se guarda en el bit (j - 1) % 64 de la palabra (j - 1) / 64. 
+ *           Los bits sobrantes de la última palabra quedan a 0.
+ * celdas: Número de celdas de la fila.
+ *
+ */
+void empaquetarFila(const int* fila, unsigned long long* palabras, int celdas);
+
+/*
+ * Nombre: desempaquetarFila
+ *
+ * Descripción: Operación inversa de 'empaquetarFila'. Se actualizan también las condiciones periódicas de contorno.
+ *
+ * palabras: Fila empaquetada (palabrasFila(celdas) palabras).
+ * fila: Fila del ACE con 'celdas' + 2 posiciones en la que se guarda el resultado.
+ * celdas: Número de celdas de la fila.
+ *
+ */
+void desempaquetarFila(const unsigned long long* palabras, int* fila, int celdas);
+
+/*
+ * Nombre: aleatorizarFila
+ *
+ * Descripción: Llena una fila empaquetada con valores aleatorios, 64 celdas por cada valor del generador
+ *              (los bits de relleno de la última palabra quedan a 0).
+ *
+ * palabras: Fila empaquetada (palabrasFila(celdas) palabras).
+ * celdas: Número de celdas.
+ * generador: Generador del que se obtienen los valores.
+ *
+ */
+void aleatorizarFila(unsigned long long* palabras, int celdas, GeneradorAleatorio& generador);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include "libACEgeneral.h"
+#include "libmedidas.h"
+
+#pragma warning ( disable: 4996 )
+
+bool leerReglaGeneral(ReglaGeneral& regla, int radio, int estados, bool totalista, const char* texto)
+{
+	unsigned char cifras[MAX_CONFIGURACIONES];	// Cifras del código (base 'estados'), de menos a más significativa
+	int vecinos = 2 * radio + 1;
+
+	if (radio < RADIO_MIN || radio > RADIO_MAX || estados < ESTADOS_MIN || estados > ESTADOS_MAX)
+		return false;
+
+	regla.radio = radio;
+	regla.estados = estados;
+	regla.totalista = totalista;
+	regla.configuraciones = 1;
+	for (int v = 0; v < vecinos; v++)
+		regla.configuraciones *= estados;
+	int entradas = totalista ? vecinos * (estados - 1) + 1 : regla.configuraciones;
+	memset(cifras, 0, sizeof(cifras));
+
+	if (texto[0] == '0' && (texto[1] == 'x' || texto[1] == 'X')) {
+		// Código hexadecimal: sólo para 2 estados, cada bit es una cifra
+		int digitos = (int)strlen(texto + 2);
+		if (estados != 2 || digitos == 0 || 4 * digitos > entradas + 3)
+			return false;
+		for (int d = 0; d < digitos; d++) {
+			char c = texto[2 + digitos - 1 - d];
+			int valor = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+			if (valor < 0)
+				return false;
+			for (int b = 0; b < 4; b++) {
+				if (((valor >> b) & 1) && 4 * d + b >= entradas)
+					return false;
+				if (4 * d + b < entradas)
+					cifras[4 * d + b] = (unsigned char)((valor >> b) & 1);
+			}
+		}
+	}
+	else {
+		// Código decimal: se descompone en base 'estados'
+		char* fin;
+		errno = 0;
+		if (texto[0] < '0' || texto[0] > '9')
+			return false;
+		unsigned long long codigo = strtoull(texto, &fin, 10);
+		if (*fin != 0 || errno != 0)
+			return false;
+		for (int e = 0; e < entradas && codigo > 0; e++) {
+			cifras[e] = (unsigned char)(codigo % estados);
+			codigo /= estados;
+		}
+		if (codigo > 0)
+			return false;
+	}
+
+	// Expandimos a la tabla de configuraciones (en las totalistas, la cifra de la suma de la vecindad)
+	for (int c = 0; c < regla.configuraciones; c++) {
+		int entrada = c;
+		if (totalista) {
+			entrada = 0;
+			for (int resto = c; resto > 0; resto /= estados)
+				entrada += resto % estados;
+		}
+		regla.tabla[c] = cifras[entrada];
+	}
+
+	strncpy(regla.texto, texto, sizeof(regla.texto) - 1);
+	regla.texto[sizeof(regla.texto) - 1] = 0;
+	return true;
+}
+
+int obtenerReglasGenerales(ReglaGeneral* reglas, int maxreglas, const char* texto, int radio, int estados, bool totalista)
+{
+	char codigo[64];		// Cada código separado por comas
+	int nreglas = 0;
+
+	while (*texto != 0 && nreglas < maxreglas) {
+		const char* coma = strchr(texto, ',');
+		size_t longitud = (coma != NULL) ? (size_t)(coma - texto) : strlen(texto);
+		if (longitud >= sizeof(codigo))
+			longitud = sizeof(codigo) - 1;
+		strncpy(codigo, texto, longitud);
+		codigo[longitud] = 0;
+
+		char* guion = strchr(codigo, '-');
+		if (guion != NULL && !(codigo[0] == '0' && (codigo[1] == 'x' || codigo[1] == 'X'))) {
+			// Rango de códigos decimales
+			*guion = 0;
+			unsigned long long desde = strtoull(codigo, NULL, 10);
+			unsigned long long hasta = strtoull(guion + 1, NULL, 10);
+			for (unsigned long long c = desde; c <= hasta && nreglas < maxreglas; c++) {
+				char numero[32];
+				sprintf(numero, "%llu", c);
+				if (leerReglaGeneral(reglas[nreglas], radio, estados, totalista, numero))
+					nreglas++;
+				else {
+					printf("Parámetro incorrecto, la regla %s no es válida para radio %d y %d estados... Se descarta\n", numero, radio, estados);
+					break;
+				}
+			}
+		}
+		else if (leerReglaGeneral(reglas[nreglas], radio, estados, totalista, codigo))
+			nreglas++;
+		else
+			printf("Parámetro incorrecto, la regla %s no es válida para radio %d y %d estados... Se descarta\n", codigo, radio, estados);
+
+		texto = (coma != NULL) ? coma + 1 : texto + strlen(texto);
+	}
+
+	return nreglas;
+}
+
+char* nombreReglaGeneral(const ReglaGeneral& regla, char* nombre)
+{
+	sprintf(nombre, "R%s_RADIO%d_E%d%s", regla.texto, regla.radio, regla.estados, regla.totalista ? "_T" : "");
+	return nombre;
+}
+
+int maxCeldasEstado(int estados)
+{
+	// Los códigos van de 0 a estados ^ celdas - 1: caben en 31 bits mientras estados ^ celdas <= 2^31
+	int celdas = 0;
+	for (long long potencia = estados; potencia <= (1LL << 31); potencia *= estados)
+		celdas++;
+	return celdas;
+}
+
+void aleatorizarFilaGeneral(int* fila, int celdas, int estados, GeneradorAleatorio& generador)
+{
+	if (estados == 2) {
+		unsigned long long* palabras = new unsigned long long [palabrasFila(celdas)];
+		aleatorizarFila(palabras, celdas, generador);
+		desempaquetarFila(palabras, fila, celdas);
+		delete[] palabras;
+		return;
+	}
+
+	for (int j = 1; j < celdas + 1; j++)
+		fila[j] = (int)(siguienteAleatorio(generador) % (unsigned long long)estados);
+	fila[0] = fila[celdas];
+	fila[celdas + 1] = fila[1];
+}
+
+/*
+	Evolución con el motor MotorACE<R, K>: se empaqueta la fila 0, se aplica el motor paso a paso y
+	cada fila nueva se desempaqueta en 'ACE' junto con su código de estado.
+*/
+template <int R, int K>
+static void generarMotor(int** ACE, const ReglaGeneral& regla, int pasos, int celdas, long* estados)
+{
+	typedef MotorACE<R, K> Motor;
+	int n = Motor::palabras(celdas);
+	unsigned long long* actual = new unsigned long long [n];
+	unsigned long long* siguiente = new unsigned long long [n];
+	unsigned long long* auxiliar = new unsigned long long [Motor::palabrasAuxiliar(celdas) + 1];
+	bool codigos = (celdas <= maxCeldasEstado(K));
+	const int bits = (K == 2) ? 1 : 4;
+	const int porPalabra = 64 / bits;
+
+	memset(actual, 0, n * sizeof(unsigned long long));
+	for (int j = 1; j < celdas + 1; j++)
+		actual[(j - 1) / porPalabra] |= (unsigned long long)ACE[0][j] << (((j - 1) % porPalabra) * bits);
+
+	for (int i = 1; i < pasos + 1; i++) {
+		Motor::paso(actual, siguiente, celdas, regla.tabla, auxiliar);
+
+		long codigo = 0;
+		for (int j = 1; j < celdas + 1; j++) {
+			ACE[i][j] = (int)((siguiente[(j - 1) / porPalabra] >> (((j - 1) % porPalabra) * bits)) & ((1 << bits) - 1));
+			if (codigos)
+				codigo = codigo * K + ACE[i][j];
+		}
+		ACE[i][0] = ACE[i][celdas];
+		ACE[i][celdas + 1] = ACE[i][1];
+		estados[i - 1] = codigo;
+
+		unsigned long long* t = actual;
+		actual = siguiente;
+		siguiente = t;
+	}
+
+	delete[] actual;
+	delete[] siguiente;
+	delete[] auxiliar;
+}
+
+long* generarACEGeneral(int** ACE, const ReglaGeneral& regla, int pasos, int celdas, long* estados)
+{
+	MEDIR_INICIO(FASE_SIMULACION);
+
+	if (estados == NULL)
+		estados = new long [pasos];
+
+	// Una instancia del motor por cada radio y número de estados admitidos
+	switch (regla.radio * 10 + regla.estados) {
+	case 12: generarMotor<1, 2>(ACE, regla, pasos, celdas, estados); break;
+	case 13: generarMotor<1, 3>(ACE, regla, pasos, celdas, estados); break;
+	case 14: generarMotor<1, 4>(ACE, regla, pasos, celdas, estados); break;
+	case 22: generarMotor<2, 2>(ACE, regla, pasos, celdas, estados); break;
+	case 23: generarMotor<2, 3>(ACE, regla, pasos, celdas, estados); break;
+	case 24: generarMotor<2, 4>(ACE, regla, pasos, celdas, estados); break;
+	case 32: generarMotor<3, 2>(ACE, regla, pasos, celdas, estados); break;
+	case 33: generarMotor<3, 3>(ACE, regla, pasos, celdas, estados); break;
+	case 34: generarMotor<3, 4>(ACE, regla, pasos, celdas, estados); break;
+	}
+
+	MEDIR_CONTAR(CONTADOR_ACTUALIZACIONES, (unsigned long long)pasos * celdas);
+	MEDIR_FIN();
+
+	return estados;
+}
+
+int* generarHammingGeneral(int** ACE, const ReglaGeneral& regla, int pasos, int celdas, int** ACE1)
+{
+	bool asignado = (ACE1 == NULL);		// Cierto si la memoria de la nueva simulación se asigna aquí
+
+	MEDIR_INICIO(FASE_HAMMING);
+
+	// El nuevo ACE sólo difiere en la celda central del estado inicial
+	if (asignado)
+		asignarMemoriaACE(&ACE1, pasos, celdas);
+	inicializarACE(ACE1, celdas, INICIALIZACION_SIMILAR, ACE[0]);
+	delete[] generarACEGeneral(ACE1, regla, pasos, celdas);
+
+	// Distancia de Hamming (número de celdas diferentes) en cada paso
+	int* hamming = new int [pasos + 1];
+	memset(hamming, 0, (pasos + 1) * sizeof(int));
+	hamming[0] = 1;
+	for (int i = 1; i < pasos + 1; i++)
+		for (int j = 1; j < celdas + 1; j++)
+			hamming[i] += (ACE[i][j] == ACE1[i][j] ? 0 : 1);
+
+	if (asignado)
+		liberarMemoriaACE(ACE1, pasos);
+
+	MEDIR_FIN();
+
+	return hamming;
+}
@@ -0,0 +1,219 @@
+#ifndef _LIBACEGENERAL_H_
+#define _LIBACEGENERAL_H_
+
+#include "libACE.h"
+
+#define RADIO_MIN					1		// Radio mínimo de la vecindad (ACE elemental)
+#define RADIO_MAX					3		// Radio máximo de la vecindad
+#define ESTADOS_MIN					2		// Número mínimo de estados por celda
+#define ESTADOS_MAX					4		// Número máximo de estados por celda
+#define MAX_CONFIGURACIONES			16384	// ESTADOS_MAX ^ (2 * RADIO_MAX + 1) configuraciones de la vecindad como máximo
+
+/*
+ * Regla de un autómata celular de radio 'radio' (la vecindad son las 2 * radio + 1 celdas centradas en cada celda)
+ * y 'estados' estados por celda. Se guarda expandida como tabla: para cada configuración de la vecindad, el nuevo
+ * estado de la celda central. La configuración se numera en base 'estados' con la celda de más a la izquierda como
+ * cifra más significativa, como 'vecindad' en 'generarACE' (para radio 1 y 2 estados la tabla son los bits de la regla).
+ */
+struct ReglaGeneral {
+	int radio;								// Radio de la vecindad [RADIO_MIN, RADIO_MAX]
+	int estados;							// Estados por celda [ESTADOS_MIN, ESTADOS_MAX]
+	bool totalista;							// Cierto si el nuevo estado sólo depende de la suma de la vecindad
+	int configuraciones;					// Configuraciones posibles de la vecindad (estados ^ (2 * radio + 1))
+	unsigned char tabla[MAX_CONFIGURACIONES];	// Nuevo estado para cada configuración
+	char texto[64];							// Código de la regla tal como se indicó (para los nombres de fichero)
+};
+
+/*
+ * Nombre: leerReglaGeneral
+ *
+ * Descripción: Construye la tabla de una regla a partir de su código de Wolfram: la cifra 'i' (en base 'estados')
+ *              del código es el nuevo estado para la configuración 'i' o, si la regla es totalista, para la suma 'i'.
+ *              El código se da en decimal o, para reglas de 2 estados, en hexadecimal precedido de 0x
+ *              (las reglas de radio 3 tienen 128 bits y no caben en un entero).
+ *
+ * Devuelve cierto si el radio, los estados y el código son válidos.
+ *
+ */
+bool leerReglaGeneral(ReglaGeneral& regla, int radio, int estados, bool totalista, const char* texto);
+
+/*
+ * Nombre: obtenerReglasGenerales
+ *
+ * Descripción: Como 'obtenerValores' para reglas generales: lista de códigos separados por comas,
+ *              o rangos de códigos decimales (desde-hasta). Los códigos incorrectos se descartan con un mensaje.
+ *
+ * Devuelve el número de reglas obtenidas.
+ *
+ */
+int obtenerReglasGenerales(ReglaGeneral* reglas, int maxreglas, const char* texto, int radio, int estados, bool totalista);
+
+/*
+ * Nombre: nombreReglaGeneral
+ *
+ * Descripción: Escribe en 'nombre' la identificación de la regla para los nombres de fichero y los mensajes:
+ *              R<código>_RADIO<radio>_E<estados>, terminada en _T si la regla es totalista. Devuelve 'nombre'.
+ *
+ */
+char* nombreReglaGeneral(const ReglaGeneral& regla, char* nombre);
+
+/*
+ * Nombre: maxCeldasEstado
+ *
+ * Descripción: Devuelve el número máximo de celdas para el que se calculan los códigos de estado
+ *              (los códigos, menores que estados ^ celdas, caben en 31 bits; 31 celdas para 2 estados, como en
+ *              'generarACE').
+ *
+ */
+int maxCeldasEstado(int estados);
+
+/*
+ * Nombre: aleatorizarFilaGeneral
+ *
+ * Descripción: Inicializa la fila 'fila' (con sus condiciones periódicas de contorno) con estados aleatorios
+ *              en [0, estados). Para 2 estados el resultado es el mismo que el de 'inicializarACE'.
+ *
+ */
+void aleatorizarFilaGeneral(int* fila, int celdas, int estados, GeneradorAleatorio& generador);
+
+/*
+ * Nombre: generarACEGeneral
+ *
+ * Descripción: Como 'generarACE' para una regla general. Internamente la fila se evoluciona empaquetada
+ *              (1 bit por celda para 2 estados, 4 bits por celda para más) con el motor especializado para
+ *              el radio y el número de estados de la regla, y cada paso se desempaqueta en 'ACE' para que
+ *              las funciones de análisis (generarHamming, atractores, entropía...) se usen igual que con 'generarACE'.
+ *
+ * Devuelve el vector de estados (base 'estados') si el ACE no tiene más de maxCeldasEstado(estados) celdas.
+ *
+ */
+long* generarACEGeneral(int** ACE, const ReglaGeneral& regla, int pasos, int celdas, long* estados = NULL);
+
+/*
+ * Nombre: generarHammingGeneral
+ *
+ * Descripción: Como 'generarHamming' para una regla general.
+ *
+ */
+int* generarHammingGeneral(int** ACE, const ReglaGeneral& regla, int pasos, int celdas, int** ACE1 = NULL);
+
+/*
+ * Motor de evolución especializado en tiempo de compilación para radio R y K estados por celda.
+ * La fila se guarda empaquetada, con la celda j (1..celdas) en la posición j - 1 y las posiciones
+ * sobrantes de la última palabra a 0:
+ *
+ * - K > 2: 4 bits por celda (16 celdas por palabra). Cada celda se calcula con una consulta a la tabla;
+ *   el índice de la vecindad se desplaza de una celda a la siguiente añadiendo la celda que entra por la derecha.
+ * - K = 2: 1 bit por celda (64 celdas por palabra, especialización más abajo). Las celdas de una palabra se
+ *   calculan a la vez evaluando la tabla como un árbol de selectores de bits.
+ */
+template <int R, int K>
+struct MotorACE {
+	static const int VECINOS = 2 * R + 1;
+	static const int BITS = 4;											// Bits por celda
+	static const int CELDAS_PALABRA = 64 / BITS;						// Celdas por palabra
+
+	static int palabras(int celdas) { return (celdas + CELDAS_PALABRA - 1) / CELDAS_PALABRA; }
+	static int palabrasAuxiliar(int /*celdas*/) { return 0; }
+
+	static inline int celda(const unsigned long long* fila, int j)
+	{
+		return (int)((fila[j / CELDAS_PALABRA] >> ((j % CELDAS_PALABRA) * BITS)) & ((1 << BITS) - 1));
+	}
+
+	static void paso(const unsigned long long* origen, unsigned long long* destino, int celdas, const unsigned char* tabla, unsigned long long* /*auxiliar*/)
+	{
+		// K ^ (VECINOS - 1): al desplazar la vecindad se descarta la cifra más significativa
+		int potencia = 1;
+		for (int v = 0; v < VECINOS - 1; v++)
+			potencia *= K;
+
+		// Vecindad de la primera celda (índices de celda desde 0, con contorno periódico)
+		int indice = 0;
+		for (int d = -R; d <= R; d++)
+			indice = indice * K + celda(origen, ((d % celdas) + celdas) % celdas);
+
+		int entrada = R + 1;	// Celda que entra por la derecha al pasar a la siguiente
+		while (entrada >= celdas)
+			entrada -= celdas;
+
+		unsigned long long palabra = 0;
+		for (int j = 0; j < celdas; j++) {
+			palabra |= (unsigned long long)tabla[indice] << ((j % CELDAS_PALABRA) * BITS);
+			if (j % CELDAS_PALABRA == CELDAS_PALABRA - 1) {
+				destino[j / CELDAS_PALABRA] = palabra;
+				palabra = 0;
+			}
+
+			indice = (indice % potencia) * K + celda(origen, entrada);
+			if (++entrada == celdas)
+				entrada = 0;
+		}
+		if (celdas % CELDAS_PALABRA != 0)
+			destino[celdas / CELDAS_PALABRA] = palabra;
+	}
+};
+
+template <int R>
+struct MotorACE<R, 2> {
+	static const int VECINOS = 2 * R + 1;
+	static const int CONFIGURACIONES = 1 << VECINOS;
+
+	static int palabras(int celdas) { return (celdas + 63) / 64; }
+
+	// La fila repetida las veces necesarias para leer 64 celdas seguidas a partir de cualquier vecina (ver 'paso')
+	static int repeticionInicial(int celdas) { return celdas * ((R + celdas - 1) / celdas); }
+	static int palabrasAuxiliar(int celdas) { return (repeticionInicial(celdas) + palabras(celdas) * 64 + R + 64) / 64 + 2; }
+
+	static inline unsigned long long leer(const unsigned long long* bits, long long posicion)
+	{
+		int desplazamiento = (int)(posicion & 63);
+		const unsigned long long* p = bits + (posicion >> 6);
+		return desplazamiento == 0 ? p[0] : (p[0] >> desplazamiento) | (p[1] << (64 - desplazamiento));
+	}
+
+	static void paso(const unsigned long long* origen, unsigned long long* destino, int celdas, const unsigned char* tabla, unsigned long long* auxiliar)
+	{
+		int n = palabras(celdas);
+		int longitud = palabrasAuxiliar(celdas);
+		int inicio = repeticionInicial(celdas);
+		unsigned long long ultima = (celdas % 64 == 0) ? ~0ULL : ((1ULL << (celdas % 64)) - 1);
+
+		// 'auxiliar' contiene la fila repetida: el bit q es la celda q % celdas. Las vecinas a distancia d de las celdas
+		// de la palabra w empiezan en el bit inicio + 64 w + d, que nunca es negativo (inicio >= R es múltiplo de celdas)
+		memset(auxiliar, 0, longitud * sizeof(unsigned long long));
+		for (long long q = 0; q < (long long)(longitud - 1) * 64; q += celdas) {
+			int desplazamiento = (int)(q & 63);
+			unsigned long long* p = auxiliar + (q >> 6);
+			for (int w = 0; w < n && (q >> 6) + w < longitud; w++) {
+				unsigned long long v = (w == n - 1) ? (origen[w] & ultima) : origen[w];
+				p[w] |= v << desplazamiento;
+				if (desplazamiento != 0 && (q >> 6) + w + 1 < longitud)
+					p[w + 1] |= v >> (64 - desplazamiento);
+			}
+		}
+
+		// Hojas del árbol: para cada configuración, todas las celdas a 0 o a 1 según la regla
+		unsigned long long hojas[CONFIGURACIONES];
+		for (int c = 0; c < CONFIGURACIONES; c++)
+			hojas[c] = tabla[c] ? ~0ULL : 0ULL;
+
+		for (int w = 0; w < n; w++) {
+			unsigned long long nodos[CONFIGURACIONES];
+			memcpy(nodos, hojas, sizeof(nodos));
+
+			// Nivel l del árbol: la cifra l de la configuración es la vecina a distancia R - l
+			int anchura = CONFIGURACIONES;
+			for (int l = 0; l < VECINOS; l++) {
+				unsigned long long x = leer(auxiliar, (long long)inicio + 64LL * w + R - l);
+				anchura >>= 1;
+				for (int i = 0; i < anchura; i++)
+					nodos[i] = (x & nodos[2 * i + 1]) | (~x & nodos[2 * i]);
+			}
+			destino[w] = nodos[0];
+		}
+		destino[n - 1] &= ultima;
+	}
+};
+
+#endif
@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libACE.h"
+#include "libmedidas.h"
+#include "libaditivas.h"
+
+#pragma warning ( disable: 4996 )
+
+#define SEMILLA_VERIFICACION		0x5A17ADULL	// Semilla de las filas aleatorias de 'verificarSalto'
+
+bool reglaAditiva(int regla)
+{
+	// Coeficientes de la vecina izquierda, la celda y la vecina derecha (configuraciones 100, 010 y 001)
+	int a = (regla >> 4) & 1, b = (regla >> 2) & 1, c = (regla >> 1) & 1;
+
+	for (int v = 0; v < 8; v++)
+		if (((regla >> v) & 1) != ((a & (v >> 2)) ^ (b & (v >> 1) & 1) ^ (c & v & 1)))
+			return false;
+	return true;
+}
+
+/*
+	64 bits de 'bits' a partir del bit 'posicion'.
+*/
+static inline unsigned long long leer(const unsigned long long* bits, long long posicion)
+{
+	int desplazamiento = (int)(posicion & 63);
+	const unsigned long long* p = bits + (posicion >> 6);
+	return desplazamiento == 0 ? p[0] : (p[0] >> desplazamiento) | (p[1] << (64 - desplazamiento));
+}
+
+void saltarFila(int regla, unsigned long long* fila, int celdas, unsigned long long pasos, unsigned long long* auxiliar)
+{
+	int n = palabrasFila(celdas);
+	int a = (regla >> 4) & 1, b = (regla >> 2) & 1, c = (regla >> 1) & 1;
+	unsigned long long ultima = (celdas % 64 == 0) ? ~0ULL : ((1ULL << (celdas % 64)) - 1);
+	unsigned long long* doble = auxiliar;				// La fila dos veces seguida (2 · celdas bits)
+	unsigned long long* siguiente = auxiliar + 2 * n + 2;
+	long long desplazamiento = 1;						// 2^k mod celdas
+
+	for (; pasos != 0; pasos >>= 1) {
+		if (pasos & 1) {
+			// T^(2^k): la celda i recibe a x[i - 2^k] + b x[i] + c x[i + 2^k]. En la fila doble, la celda i - 2^k
+			// está en el bit celdas - 2^k + i y la celda i + 2^k en el bit 2^k + i
+			memset(doble, 0, (2 * n + 2) * sizeof(unsigned long long));
+			for (int copia = 0; copia < 2; copia++) {
+				long long q = (long long)copia * celdas;
+				int d = (int)(q & 63);
+				unsigned long long* p = doble + (q >> 6);
+				for (int w = 0; w < n; w++) {
+					p[w] |= fila[w] << d;
+					if (d != 0)
+						p[w + 1] |= fila[w] >> (64 - d);
+				}
+			}
+
+			long long izquierda = celdas - desplazamiento, derecha = desplazamiento;
+			for (int w = 0; w < n; w++) {
+				unsigned long long v = 0;
+				if (a)
+					v ^= leer(doble, izquierda + 64LL * w);
+				if (b)
+					v ^= fila[w];
+				if (c)
+					v ^= leer(doble, derecha + 64LL * w);
+				siguiente[w] = v;
+			}
+			siguiente[n - 1] &= ultima;
+			memcpy(fila, siguiente, n * sizeof(unsigned long long));
+		}
+		desplazamiento = (desplazamiento * 2) % celdas;
+	}
+}
+
+void generarMuestrasAditivas(const int* inicial, int** filas, int regla, int celdas, const unsigned long long* instantes, int ninstantes)
+{
+	int n = palabrasFila(celdas);
+	unsigned long long* fila = new unsigned long long [n];
+	unsigned long long* auxiliar = new unsigned long long [palabrasAuxiliarSalto(celdas)];
+	unsigned long long actual = 0;
+
+	MEDIR_INICIO(FASE_SIMULACION);
+
+	empaquetarFila(inicial, fila, celdas);
+	for (int i = 0; i < ninstantes; i++) {
+		if (instantes[i] < actual) {
+			empaquetarFila(inicial, fila, celdas);
+			actual = 0;
+		}
+		saltarFila(regla, fila, celdas, instantes[i] - actual, auxiliar);
+		actual = instantes[i];
+		desempaquetarFila(fila, filas[i], celdas);
+		MEDIR_CONTAR(CONTADOR_ESTADOS, 1);
+	}
+
+	delete[] fila;
+	delete[] auxiliar;
+
+	MEDIR_FIN();
+}
+
+int* generarHammingAditiva(int regla, int celdas, const unsigned long long* instantes, int ninstantes)
+{
+	int n = palabrasFila(celdas);
+	unsigned long long* diferencia = new unsigned long long [n];
+	unsigned long long* auxiliar = new unsigned long long [palabrasAuxiliarSalto(celdas)];
+	int* hamming = new int [ninstantes];
+	unsigned long long actual = 0;
+
+	MEDIR_INICIO(FASE_HAMMING);
+
+	// La diferencia inicial es la celda central (la celda celdas / 2 + 1, en el bit celdas / 2)
+	memset(diferencia, 0, n * sizeof(unsigned long long));
+	diferencia[(celdas / 2) >> 6] = 1ULL << ((celdas / 2) & 63);
+	for (int i = 0; i < ninstantes; i++) {
+		if (instantes[i] < actual) {
+			memset(diferencia, 0, n * sizeof(unsigned long long));
+			diferencia[(celdas / 2) >> 6] = 1ULL << ((celdas / 2) & 63);
+			actual = 0;
+		}
+		saltarFila(regla, diferencia, celdas, instantes[i] - actual, auxiliar);
+		actual = instantes[i];
+
+		hamming[i] = 0;
+		for (int w = 0; w < n; w++)
+			hamming[i] += contarUnos(diferencia[w]);
+	}
+
+	delete[] diferencia;
+	delete[] auxiliar;
+
+	MEDIR_FIN();
+
+	return hamming;
+}
+
+bool verificarSalto(int regla)
+{
+	int** ACE;
+	GeneradorAleatorio generador;
+	int n = palabrasFila(ADITIVAS_N_VERIFICACION);
+	unsigned long long* inicial = new unsigned long long [n];
+	unsigned long long* fila = new unsigned long long [n];
+	unsigned long long* esperada = new unsigned long long [n];
+	unsigned long long* auxiliar = new unsigned long long [palabrasAuxiliarSalto(ADITIVAS_N_VERIFICACION)];
+	bool correcto = true;
+
+	// Filas aleatorias propias para no alterar la sucesión del generador del hilo
+	iniciarGenerador(generador, SEMILLA_VERIFICACION);
+	asignarMemoriaACE(&ACE, ADITIVAS_PASOS_VERIFICACION, ADITIVAS_N_VERIFICACION);
+
+	for (int N = 3; N <= ADITIVAS_N_VERIFICACION && correcto; N++) {
+		for (int prueba = 0; prueba < 2 && correcto; prueba++) {
+			inicializarACE(ACE, N, prueba == 0 ? INICIALIZACION_SEMILLA : INICIALIZACION_ALEATORIA, NULL, &generador);
+			delete[] generarACE(ACE, regla, ADITIVAS_PASOS_VERIFICACION, N);
+
+			// Cada instante se alcanza de un salto desde la fila inicial
+			empaquetarFila(ACE[0], inicial, N);
+			for (int t = 0; t <= ADITIVAS_PASOS_VERIFICACION && correcto; t++) {
+				memcpy(fila, inicial, palabrasFila(N) * sizeof(unsigned long long));
+				saltarFila(regla, fila, N, (unsigned long long)t, auxiliar);
+				empaquetarFila(ACE[t], esperada, N);
+				correcto = memcmp(fila, esperada, palabrasFila(N) * sizeof(unsigned long long)) == 0;
+				if (!correcto)
+					printf("El salto de la regla %d con %d celdas no coincide con generarACE en el paso %d\n", regla, N, t);
+			}
+		}
+	}
+
+	liberarMemoriaACE(ACE, ADITIVAS_PASOS_VERIFICACION);
+	delete[] inicial;
+	delete[] fila;
+	delete[] esperada;
+	delete[] auxiliar;
+
+	return correcto;
+}
+
+int obtenerInstantes(unsigned long long* instantes, int maxinstantes, const char* texto)
+{
+	int ninstantes = 0;
+	const char* p = texto;
+
+	while (*p != 0 && ninstantes < maxinstantes) {
+		char* fin;
+		if (*p < '0' || *p > '9')
+			return 0;
+		unsigned long long base = strtoull(p, &fin, 10);
+		unsigned long long valor = base;
+
+		// Potencia: 1e12 (de 10) o 2^40 (de la base)
+		if (*fin == 'e' || *fin == 'E' || *fin == '^') {
+			unsigned long long factor = (*fin == '^') ? base : 10;
+			valor = (*fin == '^') ? 1 : base;
+			p = fin + 1;
+			if (*p < '0' || *p > '9')
+				return 0;
+			int exponente = (int)strtol(p, &fin, 10);
+			for (int e = 0; e < exponente; e++) {
+				if (factor != 0 && valor > ~0ULL / factor)
+					return 0;
+				valor *= factor;
+			}
+		}
+		if (*fin != ',' && *fin != 0)
+			return 0;
+
+		instantes[ninstantes++] = valor;
+		p = (*fin == ',') ? fin + 1 : fin;
+	}
+	return ninstantes;
+}
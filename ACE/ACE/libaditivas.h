@@ -0,0 +1,94 @@
+#ifndef _LIBADITIVAS_H_
+#define _LIBADITIVAS_H_
+
+#include "libACE.h"
+
+#define ADITIVAS_MAX_INSTANTES		4096		// Instantes máximos de una lista de muestras
+#define ADITIVAS_N_VERIFICACION		130			// Celdas máximas con las que se comprueba el salto contra generarACE
+#define ADITIVAS_PASOS_VERIFICACION	200			// Pasos de cada simulación de comprobación
+
+/*
+ * Salto en el tiempo de las reglas aditivas (lineales sobre GF(2)): 0, 60, 90, 102, 150, 170, 204 y 240.
+ *
+ * En ellas el nuevo valor de la celda j es la suma módulo 2 de algunas de sus vecinas: x'[j] = a x[j-1] + b x[j] + c x[j+1].
+ * En un anillo de N celdas el paso es el operador T = a L + b I + c R, con L y R los desplazamientos de una celda.
+ * Como L y R conmutan y en GF(2) el cuadrado de una suma es la suma de los cuadrados, T^(2^k) = a L^(2^k) + b I + c R^(2^k):
+ * el estado en el instante t es el producto de los T^(2^k) de los bits k a 1 de t, y cada uno se aplica a la fila
+ * empaquetada con dos rotaciones (de 2^k mod N celdas) y dos XOR. El coste es O(N / 64 · log t) en lugar de O(N · t),
+ * de manera que se puede obtener cualquier fila (o unas pocas filas de muestra) en instantes como 10^12.
+ */
+
+/*
+ * Nombre: reglaAditiva
+ *
+ * Descripción: Devuelve cierto si la regla elemental es aditiva (lineal sobre GF(2), sin término constante).
+ *
+ */
+bool reglaAditiva(int regla);
+
+/*
+ * Nombre: palabrasAuxiliarSalto
+ *
+ * Descripción: Devuelve las palabras de 64 bits del vector auxiliar de 'saltarFila' para filas de 'celdas' celdas.
+ *
+ */
+inline int palabrasAuxiliarSalto(int celdas)
+{
+	return 3 * palabrasFila(celdas) + 2;
+}
+
+/*
+ * Nombre: saltarFila
+ *
+ * Descripción: Avanza 'pasos' pasos la fila empaquetada 'fila' (como 'empaquetarFila', con condiciones periódicas)
+ *              con la regla aditiva 'regla'. 'auxiliar' tiene palabrasAuxiliarSalto(celdas) palabras.
+ *
+ */
+void saltarFila(int regla, unsigned long long* fila, int celdas, unsigned long long pasos, unsigned long long* auxiliar);
+
+/*
+ * Nombre: generarMuestrasAditivas
+ *
+ * Descripción: Calcula con 'saltarFila' las filas de la evolución desde la fila 'inicial' (como la de un ACE:
+ *              'celdas' + 2 posiciones) en los 'ninstantes' instantes de 'instantes': la fila del instante i se guarda
+ *              en filas[i] (con sus condiciones de contorno). Cada muestra se obtiene saltando desde la anterior si su
+ *              instante es mayor o igual y desde la fila inicial si no.
+ *
+ */
+void generarMuestrasAditivas(const int* inicial, int** filas, int regla, int celdas, const unsigned long long* instantes, int ninstantes);
+
+/*
+ * Nombre: generarHammingAditiva
+ *
+ * Descripción: Distancias de Hamming, en los 'ninstantes' instantes de 'instantes', entre dos evoluciones que sólo
+ *              difieren en la celda central de la primera fila (como 'generarHamming'). Por ser la regla lineal, la
+ *              diferencia entre las dos evoluciones es la evolución de la diferencia inicial, que no depende de la fila.
+ *
+ * Devuelve las distancias (a liberar con delete[]).
+ *
+ */
+int* generarHammingAditiva(int regla, int celdas, const unsigned long long* instantes, int ninstantes);
+
+/*
+ * Nombre: verificarSalto
+ *
+ * Descripción: Comprueba 'saltarFila' contra 'generarACE' para anillos de 3 a ADITIVAS_N_VERIFICACION celdas, con la
+ *              fila semilla y una aleatoria, en todos los instantes hasta ADITIVAS_PASOS_VERIFICACION.
+ *
+ * Devuelve falso (indicando la primera diferencia por pantalla) si algún resultado no coincide.
+ *
+ */
+bool verificarSalto(int regla);
+
+/*
+ * Nombre: obtenerInstantes
+ *
+ * Descripción: Lee una lista de instantes separados por comas. Cada instante es un entero, una potencia de 10
+ *              (1e12 = 10^12) o una potencia cualquiera (2^40).
+ *
+ * Devuelve el número de instantes leídos (como mucho 'maxinstantes') o 0 si alguno no es válido o no cabe en 64 bits.
+ *
+ */
+int obtenerInstantes(unsigned long long* instantes, int maxinstantes, const char* texto);
+
+#endif
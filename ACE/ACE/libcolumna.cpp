@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <string.h>
+#include "libACE.h"
+#include "libACEgeneral.h"
+#include "libcontenedor.h"
+#include "libmedidas.h"
+#include "libcolumna.h"
+
+#pragma warning ( disable: 4996 )
+
+/*
+	Destino de los bits de la columna: un fichero o (para la verificación) un vector en memoria.
+*/
+struct SalidaColumna {
+	FILE* fichero;						// Fichero en el que se vuelcan los bloques (NULL: se copian en 'memoria')
+	unsigned char* memoria;				// Vector con capacidad para toda la columna
+	unsigned char* bloque;				// Bytes pendientes de volcar (COLUMNA_BYTES_BLOQUE)
+	size_t bytes;						// Bytes completos en el bloque
+	size_t volcados;					// Bytes ya volcados
+	int bit;							// Bits ocupados del byte en curso [0, 8)
+};
+
+static void volcarColumna(SalidaColumna& salida, size_t bytes)
+{
+	if (salida.fichero != NULL)
+		fwrite(salida.bloque, 1, bytes, salida.fichero);
+	else
+		memcpy(salida.memoria + salida.volcados, salida.bloque, bytes);
+	salida.volcados += bytes;
+	salida.bytes = 0;
+}
+
+static inline void escribirBit(SalidaColumna& salida, int valor)
+{
+	if (salida.bit == 0)
+		salida.bloque[salida.bytes] = 0;
+	salida.bloque[salida.bytes] |= (unsigned char)(valor << (7 - salida.bit));
+	if (++salida.bit == 8) {
+		salida.bit = 0;
+		if (++salida.bytes == COLUMNA_BYTES_BLOQUE)
+			volcarColumna(salida, COLUMNA_BYTES_BLOQUE);
+	}
+}
+
+/*
+	Nuevo valor de 64 celdas a partir de sus vecinas izquierdas, ellas mismas y sus vecinas derechas
+	(árbol de selectores: la vecina derecha es la cifra menos significativa de la configuración).
+*/
+static inline unsigned long long aplicarRegla(const unsigned long long hojas[8], unsigned long long izquierda, unsigned long long centro, unsigned long long derecha)
+{
+	unsigned long long nodos[4];
+
+	for (int i = 0; i < 4; i++)
+		nodos[i] = (derecha & hojas[2 * i + 1]) | (~derecha & hojas[2 * i]);
+	nodos[0] = (centro & nodos[1]) | (~centro & nodos[0]);
+	nodos[1] = (centro & nodos[3]) | (~centro & nodos[2]);
+	return (izquierda & nodos[1]) | (~izquierda & nodos[0]);
+}
+
+static inline void fijarBit(unsigned long long* bits, long long posicion, int valor)
+{
+	if (valor)
+		bits[posicion >> 6] |= 1ULL << (posicion & 63);
+	else
+		bits[posicion >> 6] &= ~(1ULL << (posicion & 63));
+}
+
+/*
+	Columna por el rombo del cono de luz (celdas >= pasos + 5). Las celdas se guardan por su distancia al centro:
+	la posición centro + d es la celda celdas / 2 + 1 + d, con una palabra de margen a cada lado.
+*/
+static void columnaRombo(SalidaColumna& salida, int regla, long long pasos)
+{
+	long long L = pasos / 2 + 2;						// Distancia máxima al centro que se usa
+	long long centro = L + 64;
+	long long palabras = (2 * L + 64) / 64 + 2;
+	unsigned long long* actual = new unsigned long long [palabras];
+	unsigned long long* siguiente = new unsigned long long [palabras];
+	unsigned long long hojas[8];
+	unsigned long long actualizadas = 0;
+	int fondo = 0;										// Valor de las celdas fuera del cono de luz de la semilla
+
+	for (int v = 0; v < 8; v++)
+		hojas[v] = ((regla >> v) & 1) ? ~0ULL : 0ULL;
+	memset(actual, 0, palabras * sizeof(unsigned long long));
+	memset(siguiente, 0, palabras * sizeof(unsigned long long));
+	fijarBit(actual, centro, 1);
+	escribirBit(salida, 1);
+
+	for (long long s = 0; s < pasos; s++) {
+		// Las celdas a distancia s + 1 y s + 2 aún no han recibido la semilla: valen lo que el fondo
+		if (s + 2 <= L) {
+			fijarBit(actual, centro - s - 1, fondo);
+			fijarBit(actual, centro + s + 1, fondo);
+			fijarBit(actual, centro - s - 2, fondo);
+			fijarBit(actual, centro + s + 2, fondo);
+		}
+
+		// En el paso s + 1 hacen falta las celdas a distancia min(s + 1, pasos - s - 1)
+		long long d = (s + 1 < pasos - s - 1) ? s + 1 : pasos - s - 1;
+		long long desde = (centro - d) >> 6, hasta = (centro + d) >> 6;
+		for (long long w = desde; w <= hasta; w++) {
+			unsigned long long x = actual[w];
+			siguiente[w] = aplicarRegla(hojas, (x << 1) | (actual[w - 1] >> 63), x, (x >> 1) | (actual[w + 1] << 63));
+		}
+		actualizadas += (unsigned long long)(hasta - desde + 1) * 64;
+		fondo = (regla >> (fondo ? 7 : 0)) & 1;
+
+		unsigned long long* t = actual;
+		actual = siguiente;
+		siguiente = t;
+		escribirBit(salida, (int)((actual[centro >> 6] >> (centro & 63)) & 1));
+	}
+
+	delete[] actual;
+	delete[] siguiente;
+
+	MEDIR_CONTAR(CONTADOR_ACTUALIZACIONES, actualizadas);
+}
+
+/*
+	Columna simulando el anillo completo empaquetado (el cono de luz da la vuelta al anillo).
+*/
+static void columnaAnillo(SalidaColumna& salida, int regla, int celdas, long long pasos)
+{
+	int n = palabrasFila(celdas);
+	unsigned long long* actual = new unsigned long long [n];
+	unsigned long long* siguiente = new unsigned long long [n];
+	unsigned long long* auxiliar = new unsigned long long [MotorACE<1, 2>::palabrasAuxiliar(celdas) + 1];
+	unsigned char tabla[8];
+	int centro = celdas / 2;							// Bit de la celda celdas / 2 + 1
+
+	for (int v = 0; v < 8; v++)
+		tabla[v] = (unsigned char)((regla >> v) & 1);
+	memset(actual, 0, n * sizeof(unsigned long long));
+	fijarBit(actual, centro, 1);
+	escribirBit(salida, 1);
+
+	for (long long s = 0; s < pasos; s++) {
+		MotorACE<1, 2>::paso(actual, siguiente, celdas, tabla, auxiliar);
+
+		unsigned long long* t = actual;
+		actual = siguiente;
+		siguiente = t;
+		escribirBit(salida, (int)((actual[centro >> 6] >> (centro & 63)) & 1));
+	}
+
+	delete[] actual;
+	delete[] siguiente;
+	delete[] auxiliar;
+
+	MEDIR_CONTAR(CONTADOR_ACTUALIZACIONES, (unsigned long long)pasos * celdas);
+}
+
+/*
+	Calcula la columna por el rombo o por el anillo según el tamaño del anillo y la escribe en 'salida'.
+*/
+static void calcularColumna(SalidaColumna& salida, int regla, int celdas, long long pasos)
+{
+	salida.bloque = new unsigned char [COLUMNA_BYTES_BLOQUE];
+	salida.bytes = 0;
+	salida.volcados = 0;
+	salida.bit = 0;
+
+	MEDIR_INICIO(FASE_SIMULACION);
+
+	if (celdas >= pasos + 5)
+		columnaRombo(salida, regla, pasos);
+	else
+		columnaAnillo(salida, regla, celdas, pasos);
+
+	MEDIR_FIN();
+
+	volcarColumna(salida, salida.bytes + (salida.bit != 0 ? 1 : 0));
+	delete[] salida.bloque;
+}
+
+bool generarColumnaCentral(const char* nombre, int regla, int celdas, long long pasos)
+{
+	SalidaColumna salida;
+
+	salida.fichero = abrirSalida(nombre);
+	if (salida.fichero == NULL)
+		return false;
+	salida.memoria = NULL;
+	calcularColumna(salida, regla, celdas, pasos);
+	cerrarSalida(salida.fichero);
+	return true;
+}
+
+bool verificarColumnaCentral(int regla)
+{
+	int** ACE;
+	unsigned char columna[(COLUMNA_PASOS_VERIFICACION + 8) / 8];
+	bool correcto = true;
+
+	asignarMemoriaACE(&ACE, COLUMNA_PASOS_VERIFICACION, COLUMNA_N_VERIFICACION);
+
+	for (int N = 3; N <= COLUMNA_N_VERIFICACION && correcto; N++) {
+		for (int pasos = 1; pasos <= COLUMNA_PASOS_VERIFICACION && correcto; pasos++) {
+			SalidaColumna salida;
+			salida.fichero = NULL;
+			salida.memoria = columna;
+			calcularColumna(salida, regla, N, pasos);
+
+			inicializarACE(ACE, N, INICIALIZACION_SEMILLA);
+			delete[] generarACE(ACE, regla, pasos, N);
+			for (int t = 0; t <= pasos && correcto; t++) {
+				correcto = ((columna[t >> 3] >> (7 - (t & 7))) & 1) == ACE[t][N / 2 + 1];
+				if (!correcto)
+					printf("La columna central de la regla %d con %d celdas y %d pasos no coincide con generarACE en el paso %d\n", regla, N, pasos, t);
+			}
+		}
+	}
+
+	liberarMemoriaACE(ACE, COLUMNA_PASOS_VERIFICACION);
+
+	return correcto;
+}
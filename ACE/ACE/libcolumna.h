@@ -0,0 +1,46 @@
+#ifndef _LIBCOLUMNA_H_
+#define _LIBCOLUMNA_H_
+
+#define COLUMNA_BYTES_BLOQUE		(1 << 20)	// Bytes de la columna que se acumulan antes de escribirlos (1 MB)
+#define COLUMNA_N_VERIFICACION		100			// Celdas máximas con las que se comprueba la columna contra generarACE
+#define COLUMNA_PASOS_VERIFICACION	40			// Pasos máximos de cada simulación de comprobación
+
+/*
+ * Columna central de la evolución desde la inicialización por semilla: los valores ACE[t][celdas / 2 + 1] para
+ * t = 0, ..., pasos, sin guardar ninguna fila (es la sucesión de bits que se usa como fuente aleatoria con la regla 30).
+ *
+ * La celda central del paso T sólo depende de las celdas a distancia T - t del centro en el paso t (cono de luz hacia
+ * atrás) y, con la semilla, las celdas a más de t del centro valen lo mismo que el fondo (la evolución de la fila a 0).
+ * Por eso en el paso t sólo se calculan las celdas a distancia min(t, pasos - t) del centro: un rombo que crece hasta
+ * la mitad de la simulación y luego se estrecha, la mitad de celdas que el rectángulo pasos X pasos, empaquetadas
+ * 64 por palabra (la regla se evalúa como árbol de selectores de bits, como el motor empaquetado).
+ *
+ * Si el anillo es tan pequeño que el cono da la vuelta (celdas < pasos + 5) se simula el anillo completo empaquetado.
+ * En los dos casos el resultado es el de 'generarACE' con condiciones periódicas de contorno.
+ */
+
+/*
+ * Nombre: generarColumnaCentral
+ *
+ * Descripción: Calcula la columna central de la evolución de la regla 'regla' en un anillo de 'celdas' celdas desde
+ *              la semilla durante 'pasos' pasos y la guarda en el fichero 'nombre' (se abre con 'abrirSalida'):
+ *              pasos + 1 bits, 8 por byte empezando por el más significativo (el bit t es ACE[t][celdas / 2 + 1]);
+ *              los bits sobrantes del último byte quedan a 0.
+ *
+ * Devuelve falso si no se pudo crear el fichero.
+ *
+ */
+bool generarColumnaCentral(const char* nombre, int regla, int celdas, long long pasos);
+
+/*
+ * Nombre: verificarColumnaCentral
+ *
+ * Descripción: Comprueba la columna central (por el rombo y por el anillo completo) contra 'generarACE' para anillos
+ *              de 3 a COLUMNA_N_VERIFICACION celdas y de 1 a COLUMNA_PASOS_VERIFICACION pasos.
+ *
+ * Devuelve falso (indicando la primera diferencia por pantalla) si algún resultado no coincide.
+ *
+ */
+bool verificarColumnaCentral(int regla);
+
+#endif
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <string.h>
+#include "libconexion.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef SOCKET Socket;
+#define cerrarSocket closesocket
+#define SOCKET_INVALIDO INVALID_SOCKET
+#else
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+typedef int Socket;
+#define cerrarSocket close
+#define SOCKET_INVALIDO (-1)
+#endif
+
+#pragma warning ( disable: 4996 )
+
+/*
+	Dirección del socket 'ruta'. Devuelve falso si la ruta no cabe en la dirección.
+*/
+static bool direccionSocket(struct sockaddr_un& direccion, const char* ruta)
+{
+	memset(&direccion, 0, sizeof(direccion));
+	direccion.sun_family = AF_UNIX;
+	if (strlen(ruta) >= sizeof(direccion.sun_path))
+		return false;
+	strcpy(direccion.sun_path, ruta);
+	return true;
+}
+
+static inline long long aConexion(Socket s)
+{
+	return (s == SOCKET_INVALIDO) ? CONEXION_INVALIDA : (long long)s;
+}
+
+bool iniciarConexiones()
+{
+#ifdef _WIN32
+	WSADATA datos;
+	return WSAStartup(MAKEWORD(2, 2), &datos) == 0;
+#else
+	signal(SIGPIPE, SIG_IGN);
+	return true;
+#endif
+}
+
+long long escucharConexiones(const char* ruta)
+{
+	struct sockaddr_un direccion;
+	if (!direccionSocket(direccion, ruta))
+		return CONEXION_INVALIDA;
+
+	Socket escucha = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (escucha == SOCKET_INVALIDO)
+		return CONEXION_INVALIDA;
+	remove(ruta);
+	if (bind(escucha, (struct sockaddr*)&direccion, sizeof(direccion)) != 0 || listen(escucha, SOMAXCONN) != 0) {
+		cerrarSocket(escucha);
+		return CONEXION_INVALIDA;
+	}
+	return aConexion(escucha);
+}
+
+long long aceptarConexion(long long escucha)
+{
+	return aConexion(accept((Socket)escucha, NULL, NULL));
+}
+
+void dejarDeEscuchar(long long escucha, const char* ruta)
+{
+	// En Linux close no despierta a un accept bloqueado en otro hilo, shutdown sí
+#ifdef _WIN32
+	shutdown((Socket)escucha, SD_BOTH);
+#else
+	shutdown((Socket)escucha, SHUT_RDWR);
+#endif
+	cerrarSocket((Socket)escucha);
+	remove(ruta);
+}
+
+long long conectar(const char* ruta)
+{
+	struct sockaddr_un direccion;
+	if (!direccionSocket(direccion, ruta))
+		return CONEXION_INVALIDA;
+
+	Socket conexion = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (conexion == SOCKET_INVALIDO)
+		return CONEXION_INVALIDA;
+	if (connect(conexion, (struct sockaddr*)&direccion, sizeof(direccion)) != 0) {
+		cerrarSocket(conexion);
+		return CONEXION_INVALIDA;
+	}
+	return aConexion(conexion);
+}
+
+void cerrarConexion(long long conexion)
+{
+	if (conexion != CONEXION_INVALIDA)
+		cerrarSocket((Socket)conexion);
+}
+
+/*
+	Envía o recibe exactamente 'bytes' bytes (send y recv pueden transferir menos de los pedidos).
+*/
+static bool enviarTodo(long long conexion, const char* datos, size_t bytes)
+{
+	while (bytes > 0) {
+		int trozo = (bytes > (1u << 20)) ? (1 << 20) : (int)bytes;
+		int enviados = (int)send((Socket)conexion, datos, trozo, 0);
+		if (enviados <= 0)
+			return false;
+		datos += enviados;
+		bytes -= enviados;
+	}
+	return true;
+}
+
+static bool recibirTodo(long long conexion, char* datos, size_t bytes)
+{
+	while (bytes > 0) {
+		int trozo = (bytes > (1u << 20)) ? (1 << 20) : (int)bytes;
+		int recibidos = (int)recv((Socket)conexion, datos, trozo, 0);
+		if (recibidos <= 0)
+			return false;
+		datos += recibidos;
+		bytes -= recibidos;
+	}
+	return true;
+}
+
+bool enviarMensaje(long long conexion, const void* datos, size_t bytes)
+{
+	unsigned char longitud[4];
+
+	if (bytes > CONEXION_MAX_MENSAJE)
+		return false;
+	for (int b = 0; b < 4; b++)
+		longitud[b] = (unsigned char)(bytes >> (24 - 8 * b));
+	return enviarTodo(conexion, (const char*)longitud, 4) && enviarTodo(conexion, (const char*)datos, bytes);
+}
+
+bool recibirMensaje(long long conexion, std::vector<char>& mensaje)
+{
+	unsigned char longitud[4];
+
+	if (!recibirTodo(conexion, (char*)longitud, 4))
+		return false;
+	size_t bytes = ((size_t)longitud[0] << 24) | ((size_t)longitud[1] << 16) | ((size_t)longitud[2] << 8) | longitud[3];
+	if (bytes > CONEXION_MAX_MENSAJE)
+		return false;
+	mensaje.resize(bytes + 1);
+	mensaje[bytes] = 0;
+	return recibirTodo(conexion, mensaje.data(), bytes);
+}
@@ -0,0 +1,94 @@
+#ifndef _LIBCONEXION_H_
+#define _LIBCONEXION_H_
+
+#include <stddef.h>
+#include <vector>
+
+#define CONEXION_MAX_MENSAJE		(1u << 30)	// Bytes máximos de un mensaje (1 GB)
+#define CONEXION_INVALIDA			(-1)		// Valor de una conexión que no se pudo abrir
+
+/*
+ * Conexiones locales por un socket de dominio Unix (AF_UNIX, también en Windows 10 y posteriores) entre SERVIDOR
+ * y CLIENTE. Cada mensaje va precedido de su longitud en 4 bytes (entero sin signo, el byte más significativo primero),
+ * de forma que se pueden enviar varios mensajes por la misma conexión y cada uno se recibe completo.
+ */
+
+/*
+ * Nombre: iniciarConexiones
+ *
+ * Descripción: Prepara el uso de sockets (WSAStartup en Windows; en Linux ignora SIGPIPE para que escribir en una
+ *              conexión cerrada por el otro extremo devuelva un error). Se llama una vez al principio del programa.
+ *
+ * Devuelve falso si no se pueden usar sockets.
+ *
+ */
+bool iniciarConexiones();
+
+/*
+ * Nombre: escucharConexiones
+ *
+ * Descripción: Crea el socket 'ruta' (borrando el que hubiera de una ejecución anterior) y empieza a escuchar en él.
+ *
+ * Devuelve el socket o CONEXION_INVALIDA si hubo un error.
+ *
+ */
+long long escucharConexiones(const char* ruta);
+
+/*
+ * Nombre: aceptarConexion
+ *
+ * Descripción: Espera a la siguiente conexión en un socket creado con 'escucharConexiones'.
+ *
+ * Devuelve la conexión o CONEXION_INVALIDA si el socket se ha cerrado (ver 'dejarDeEscuchar').
+ *
+ */
+long long aceptarConexion(long long escucha);
+
+/*
+ * Nombre: dejarDeEscuchar
+ *
+ * Descripción: Cierra el socket de escucha (despertando a 'aceptarConexion') y borra su fichero 'ruta'.
+ *
+ */
+void dejarDeEscuchar(long long escucha, const char* ruta);
+
+/*
+ * Nombre: conectar
+ *
+ * Descripción: Se conecta al socket 'ruta' de un SERVIDOR.
+ *
+ * Devuelve la conexión o CONEXION_INVALIDA si no se pudo conectar.
+ *
+ */
+long long conectar(const char* ruta);
+
+/*
+ * Nombre: cerrarConexion
+ *
+ * Descripción: Cierra una conexión abierta con 'aceptarConexion' o 'conectar'.
+ *
+ */
+void cerrarConexion(long long conexion);
+
+/*
+ * Nombre: enviarMensaje
+ *
+ * Descripción: Envía un mensaje de 'bytes' bytes (como mucho CONEXION_MAX_MENSAJE) precedido de su longitud.
+ *
+ * Devuelve falso si la conexión se ha cerrado o hubo un error.
+ *
+ */
+bool enviarMensaje(long long conexion, const void* datos, size_t bytes);
+
+/*
+ * Nombre: recibirMensaje
+ *
+ * Descripción: Recibe un mensaje completo en 'mensaje' (con un 0 añadido al final que no forma parte del mensaje,
+ *              para poder tratarlo como texto).
+ *
+ * Devuelve falso si la conexión se ha cerrado, hubo un error o el mensaje supera CONEXION_MAX_MENSAJE.
+ *
+ */
+bool recibirMensaje(long long conexion, std::vector<char>& mensaje);
+
+#endif
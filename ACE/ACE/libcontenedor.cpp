@@ -0,0 +1,276 @@
+#include <string.h>
+#include <stdlib.h>
+#include "libcontenedor.h"
+#include "libmedidas.h"
+
+#pragma warning ( disable: 4996 )
+
+// Posicionamiento en ficheros de más de 2 GB
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+#define TAM_COPIA		(1 << 20)	// Tamaño del bloque usado al extraer entradas
+
+// Prefijos de los nombres de fichero de cada tipo (ordenados de forma que los más largos se comprueban antes)
+static const struct {
+	const char* prefijo;
+	int tipo;
+} tiposSalida[] = {
+	{ "ATRACTOR_VISITADO_PASO", TIPO_VISITADO_PASO },
+	{ "ATRACTOR_ESTADO_VISITADO", TIPO_ESTADO_VISITADO },
+	{ "ATRACTOR", TIPO_ATRACTOR },
+	{ "HAMMING_SALTO", TIPO_HAMMING_SALTO },
+	{ "HAMMING", TIPO_HAMMING },
+	{ "ENTROPIA", TIPO_ENTROPIA },
+	{ "NOVISITADOS_EXACTO", TIPO_NOVISITADOS_EXACTO },
+	{ "NOVISITADOS", TIPO_NOVISITADOS },
+	{ "DENSIDAD", TIPO_DENSIDAD },
+	{ "ESTADOS", TIPO_ESTADOS },
+	{ "ESPECTRO", TIPO_ESPECTRO },
+	{ "CORRELACION", TIPO_CORRELACION },
+	{ "MINIATURA", TIPO_MINIATURA },
+	{ "PREIMAGENES", TIPO_PREIMAGENES },
+	{ "SALTO", TIPO_SALTO },
+	{ "COLUMNA", TIPO_COLUMNA },
+	{ "ACE", TIPO_ACE }
+};
+
+static Contenedor* contenedorActivo = NULL;		// Contenedor en el que se guardan las salidas (NULL: ficheros independientes)
+static thread_local SalidasHilo* salidasHilo = NULL;	// Salidas del hilo (NULL: en el directorio actual)
+
+Contenedor* crearContenedor(const char* nombre)
+{
+	FILE* fichero = fopen(nombre, "wb");
+	if (fichero == NULL)
+		return NULL;
+
+	Contenedor* contenedor = new Contenedor;
+	contenedor->fichero = fichero;
+	contenedor->escritura = true;
+	memset(&contenedor->cabecera, 0, sizeof(CabeceraContenedor));
+	memcpy(contenedor->cabecera.magia, CONTENEDOR_MAGIA, sizeof(CONTENEDOR_MAGIA));
+	contenedor->cabecera.version = CONTENEDOR_VERSION;
+	contenedor->cabecera.alineacion = CONTENEDOR_ALINEACION;
+	contenedor->capacidad = 256;
+	contenedor->indice = new EntradaContenedor [contenedor->capacidad];
+
+	// Escribimos una cabecera provisional, se completa al cerrar el contenedor
+	fwrite(&contenedor->cabecera, sizeof(CabeceraContenedor), 1, fichero);
+
+	return contenedor;
+}
+
+/*
+	Comprueba el nombre de una entrada leída de un contenedor, que 'extraerEntradaContenedor' usa como nombre del fichero
+	a crear: ha de terminar dentro de su campo y ser un nombre de fichero sin directorios (ni '/', ni '\', ni "..",
+	ni la unidad de Windows), como los que generan las herramientas.
+*/
+static bool nombreEntradaValido(EntradaContenedor& entrada)
+{
+	entrada.nombre[CONTENEDOR_MAX_NOMBRE - 1] = 0;
+	return entrada.nombre[0] != 0 && strpbrk(entrada.nombre, "/\\:") == NULL && strstr(entrada.nombre, "..") == NULL;
+}
+
+Contenedor* abrirContenedor(const char* nombre)
+{
+	FILE* fichero = fopen(nombre, "rb");
+	if (fichero == NULL)
+		return NULL;
+
+	Contenedor* contenedor = new Contenedor;
+	contenedor->fichero = fichero;
+	contenedor->escritura = false;
+	contenedor->indice = NULL;
+	contenedor->capacidad = 0;
+
+	// Comprobamos la cabecera y leemos el índice
+	if (fread(&contenedor->cabecera, sizeof(CabeceraContenedor), 1, fichero) != 1 ||
+		memcmp(contenedor->cabecera.magia, CONTENEDOR_MAGIA, sizeof(CONTENEDOR_MAGIA)) != 0 ||
+		contenedor->cabecera.version != CONTENEDOR_VERSION ||
+		contenedor->cabecera.entradas < 0) {
+		fclose(fichero);
+		delete contenedor;
+		return NULL;
+	}
+	contenedor->capacidad = contenedor->cabecera.entradas;
+	contenedor->indice = new EntradaContenedor [contenedor->capacidad + 1];
+	fseek64(fichero, contenedor->cabecera.indice, SEEK_SET);
+	bool valido = (int)fread(contenedor->indice, sizeof(EntradaContenedor), contenedor->cabecera.entradas, fichero) == contenedor->cabecera.entradas;
+
+	// Un contenedor manipulado podría hacer que se escriba fuera del directorio actual al extraer sus entradas
+	for (int e = 0; e < contenedor->cabecera.entradas && valido; e++)
+		valido = nombreEntradaValido(contenedor->indice[e]);
+	if (!valido) {
+		fclose(fichero);
+		delete[] contenedor->indice;
+		delete contenedor;
+		return NULL;
+	}
+
+	return contenedor;
+}
+
+void cerrarContenedor(Contenedor* contenedor)
+{
+	if (contenedor == NULL)
+		return;
+
+	if (contenedor->escritura) {
+		// El índice va al final del fichero y la cabecera indica dónde empieza
+		fseek64(contenedor->fichero, 0, SEEK_END);
+		contenedor->cabecera.indice = ftell64(contenedor->fichero);
+		fwrite(contenedor->indice, sizeof(EntradaContenedor), contenedor->cabecera.entradas, contenedor->fichero);
+		fseek64(contenedor->fichero, 0, SEEK_SET);
+		fwrite(&contenedor->cabecera, sizeof(CabeceraContenedor), 1, contenedor->fichero);
+	}
+	if (contenedorActivo == contenedor)
+		contenedorActivo = NULL;
+
+	fclose(contenedor->fichero);
+	delete[] contenedor->indice;
+	delete contenedor;
+}
+
+FILE* abrirEntradaContenedor(Contenedor* contenedor, const char* nombre)
+{
+	static const char ceros[CONTENEDOR_ALINEACION] = { 0 };
+
+	// Ampliamos el índice si es necesario
+	if (contenedor->cabecera.entradas == contenedor->capacidad) {
+		EntradaContenedor* indice = new EntradaContenedor [2 * contenedor->capacidad];
+		memcpy(indice, contenedor->indice, contenedor->capacidad * sizeof(EntradaContenedor));
+		delete[] contenedor->indice;
+		contenedor->indice = indice;
+		contenedor->capacidad *= 2;
+	}
+
+	// Rellenamos con ceros hasta la siguiente posición alineada
+	fseek64(contenedor->fichero, 0, SEEK_END);
+	unsigned long long posicion = ftell64(contenedor->fichero);
+	unsigned long long resto = posicion % CONTENEDOR_ALINEACION;
+	if (resto != 0) {
+		fwrite(ceros, 1, (size_t)(CONTENEDOR_ALINEACION - resto), contenedor->fichero);
+		posicion += CONTENEDOR_ALINEACION - resto;
+	}
+
+	EntradaContenedor& entrada = contenedor->indice[contenedor->cabecera.entradas];
+	memset(&entrada, 0, sizeof(EntradaContenedor));
+	clasificarNombre(nombre, entrada.regla, entrada.tipo);
+	strncpy(entrada.nombre, nombre, CONTENEDOR_MAX_NOMBRE - 1);
+	entrada.desplazamiento = posicion;
+	entrada.longitud = 0;
+
+	return contenedor->fichero;
+}
+
+void cerrarEntradaContenedor(Contenedor* contenedor)
+{
+	EntradaContenedor& entrada = contenedor->indice[contenedor->cabecera.entradas];
+	fflush(contenedor->fichero);
+	entrada.longitud = ftell64(contenedor->fichero) - entrada.desplazamiento;
+	contenedor->cabecera.entradas++;
+}
+
+bool extraerEntradaContenedor(Contenedor* contenedor, int entrada, const char* destino)
+{
+	if (entrada < 0 || entrada >= contenedor->cabecera.entradas)
+		return false;
+
+	const EntradaContenedor& e = contenedor->indice[entrada];
+	FILE* fichero = fopen(destino != NULL ? destino : e.nombre, "wb");
+	if (fichero == NULL)
+		return false;
+
+	// Copiamos los datos por bloques
+	char* bloque = new char [TAM_COPIA];
+	unsigned long long pendientes = e.longitud;
+	bool correcto = true;
+	fseek64(contenedor->fichero, e.desplazamiento, SEEK_SET);
+	while (pendientes > 0 && correcto) {
+		size_t n = (pendientes > TAM_COPIA) ? TAM_COPIA : (size_t)pendientes;
+		correcto = (fread(bloque, 1, n, contenedor->fichero) == n) && (fwrite(bloque, 1, n, fichero) == n);
+		pendientes -= n;
+	}
+	delete[] bloque;
+	fclose(fichero);
+
+	return correcto;
+}
+
+void clasificarNombre(const char* nombre, int& regla, int& tipo)
+{
+	regla = -1;
+	tipo = TIPO_DESCONOCIDO;
+
+	// El tipo lo da el prefijo, siempre seguido de "_R" y la regla con tres cifras
+	for (int t = 0; t < (int)(sizeof(tiposSalida) / sizeof(tiposSalida[0])); t++) {
+		size_t longitud = strlen(tiposSalida[t].prefijo);
+		if (strncmp(nombre, tiposSalida[t].prefijo, longitud) == 0 && strncmp(nombre + longitud, "_R", 2) == 0) {
+			tipo = tiposSalida[t].tipo;
+			regla = atoi(nombre + longitud + 2);
+			return;
+		}
+	}
+}
+
+const char* nombreTipo(int tipo)
+{
+	for (int t = 0; t < (int)(sizeof(tiposSalida) / sizeof(tiposSalida[0])); t++)
+		if (tiposSalida[t].tipo == tipo)
+			return tiposSalida[t].prefijo;
+	return NULL;
+}
+
+void usarContenedor(Contenedor* contenedor)
+{
+	contenedorActivo = contenedor;
+}
+
+void usarSalidasHilo(SalidasHilo* salidas)
+{
+	salidasHilo = salidas;
+}
+
+FILE* abrirSalida(const char* nombre)
+{
+	FILE* salida;
+
+	MEDIR_INICIO(FASE_SALIDA);
+	if (contenedorActivo == NULL && salidasHilo != NULL) {
+		char ruta[sizeof(salidasHilo->directorio) + 256];
+		snprintf(ruta, sizeof(ruta), "%s/%s", salidasHilo->directorio, nombre);
+		salida = fopen(ruta, "wb");
+		if (salida != NULL) {
+			if (salidasHilo->nsalidas < SALIDAS_HILO_MAX && strlen(nombre) < CONTENEDOR_MAX_NOMBRE)
+				strcpy(salidasHilo->nombres[salidasHilo->nsalidas++], nombre);
+			else
+				salidasHilo->omitidas++;
+		}
+	}
+	else if (contenedorActivo == NULL)
+		salida = fopen(nombre, "wb");
+	else
+		salida = abrirEntradaContenedor(contenedorActivo, nombre);
+	if (salida == NULL)
+		MEDIR_FIN();
+	return salida;
+}
+
+void cerrarSalida(FILE* salida)
+{
+	if (contenedorActivo == NULL) {
+		fseek64(salida, 0, SEEK_END);
+		MEDIR_CONTAR(CONTADOR_BYTES, ftell64(salida));
+		fclose(salida);
+	}
+	else {
+		cerrarEntradaContenedor(contenedorActivo);
+		MEDIR_CONTAR(CONTADOR_BYTES, contenedorActivo->indice[contenedorActivo->cabecera.entradas - 1].longitud);
+	}
+	MEDIR_FIN();
+}
@@ -0,0 +1,212 @@
+#ifndef _LIBCONTENEDOR_H_
+#define _LIBCONTENEDOR_H_
+
+#include <stdio.h>
+
+#define CONTENEDOR_MAGIA			"ACECONT"	// Identificador al inicio de los ficheros contenedor
+#define CONTENEDOR_VERSION			1			// Versión del formato del fichero contenedor
+#define CONTENEDOR_ALINEACION		4096		// Los datos de cada entrada empiezan en un múltiplo de este valor (páginas para mmap)
+#define CONTENEDOR_MAX_NOMBRE		64			// Longitud máxima (incluyendo el 0 final) del nombre original de cada entrada
+#define SALIDAS_HILO_MAX			1024		// Salidas máximas que se anotan en unas salidas de hilo
+
+#define TIPO_DESCONOCIDO			-1		// Fichero cuyo nombre no corresponde a ninguna de las salidas conocidas
+#define TIPO_ACE					0		// ACE_R..._C..._P..._<inicializacion>.pgm
+#define TIPO_HAMMING				1		// HAMMING_R..._C..._P....dat
+#define TIPO_ATRACTOR				2		// ATRACTOR_R..._C..._P....dat
+#define TIPO_VISITADO_PASO			3		// ATRACTOR_VISITADO_PASO_R..._C..._P....dat
+#define TIPO_ESTADO_VISITADO		4		// ATRACTOR_ESTADO_VISITADO_R..._C..._P....dat
+#define TIPO_ENTROPIA				5		// ENTROPIA_R..._C..._P....dat y ENTROPIA_R..._P....dat
+#define TIPO_NOVISITADOS			6		// NOVISITADOS_R..._P....dat
+#define TIPO_DENSIDAD				7		// DENSIDAD_R..._C..._P....dat
+#define TIPO_ESTADOS				8		// ESTADOS_R..._C..._P....dat
+#define TIPO_ESPECTRO				9		// ESPECTRO_R..._C..._P....dat
+#define TIPO_CORRELACION			10		// CORRELACION_R..._C..._P....dat
+#define TIPO_MINIATURA				11		// MINIATURA_R..._C..._P..._<inicializacion>.pgm (y sus teselas)
+#define TIPO_NOVISITADOS_EXACTO		12		// NOVISITADOS_EXACTO_R....dat
+#define TIPO_PREIMAGENES			13		// PREIMAGENES_R..._C....dat
+#define TIPO_SALTO					14		// SALTO_R..._C..._<inicializacion>.pgm
+#define TIPO_HAMMING_SALTO			15		// HAMMING_SALTO_R..._C....dat
+#define TIPO_COLUMNA				16		// COLUMNA_R..._C..._P....bin
+
+/*
+ * Cabecera del fichero contenedor (32 bytes). Al final del fichero está el índice con 'entradas'
+ * registros EntradaContenedor que empieza en el byte 'indice'.
+ */
+struct CabeceraContenedor {
+	char magia[8];						// CONTENEDOR_MAGIA
+	int version;						// CONTENEDOR_VERSION
+	int alineacion;						// Alineación de los datos de cada entrada (CONTENEDOR_ALINEACION)
+	int entradas;						// Número de entradas en el índice
+	int reservado;						// Sin uso (0)
+	unsigned long long indice;			// Posición del índice en el fichero
+};
+
+/*
+ * Registro del índice del contenedor (88 bytes), uno por cada fichero guardado.
+ */
+struct EntradaContenedor {
+	int regla;							// Regla a la que corresponde el fichero (-1 si no se conoce)
+	int tipo;							// Tipo de fichero (TIPO_ACE, TIPO_HAMMING, ...)
+	unsigned long long desplazamiento;	// Posición de los datos en el contenedor (múltiplo de la alineación)
+	unsigned long long longitud;		// Número de bytes de los datos
+	char nombre[CONTENEDOR_MAX_NOMBRE];	// Nombre que tendría el fichero si se guardara por separado
+};
+
+/*
+ * Fichero contenedor abierto para escritura o lectura.
+ */
+struct Contenedor {
+	FILE* fichero;						// Fichero contenedor
+	bool escritura;						// Cierto si se abrió para escribir
+	CabeceraContenedor cabecera;		// Cabecera (en escritura se completa al cerrar)
+	EntradaContenedor* indice;			// Registros del índice
+	int capacidad;						// Registros para los que hay memoria asignada en 'indice'
+};
+
+/*
+ * Nombre: crearContenedor
+ *
+ * Descripción: Crea un fichero contenedor vacío en el que se irán guardando las salidas de una ejecución.
+ *
+ * nombre: Nombre del fichero contenedor.
+ *
+ * Devuelve el contenedor creado o NULL si no se pudo crear el fichero.
+ *
+ */
+Contenedor* crearContenedor(const char* nombre);
+
+/*
+ * Nombre: abrirContenedor
+ *
+ * Descripción: Abre para lectura un fichero contenedor creado con 'crearContenedor' y lee su índice.
+ *
+ * nombre: Nombre del fichero contenedor.
+ *
+ * Devuelve el contenedor o NULL si no se pudo abrir o no es un contenedor válido (también si el nombre de alguna
+ * entrada no es un nombre de fichero sin directorios).
+ *
+ */
+Contenedor* abrirContenedor(const char* nombre);
+
+/*
+ * Nombre: cerrarContenedor
+ *
+ * Descripción: Cierra el contenedor y libera su memoria. Si se abrió para escritura,
+ *              escribe el índice al final del fichero y completa la cabecera.
+ *
+ * contenedor: Contenedor a cerrar.
+ *
+ */
+void cerrarContenedor(Contenedor* contenedor);
+
+/*
+ * Nombre: abrirEntradaContenedor
+ *
+ * Descripción: Añade una nueva entrada al contenedor. Se deduce la regla y el tipo del nombre del fichero.
+ *
+ * contenedor: Contenedor abierto para escritura.
+ * nombre: Nombre que tendría el fichero si se guardara por separado.
+ *
+ * Devuelve el FILE* del contenedor posicionado al inicio (alineado) de los datos de la entrada.
+ * No se debe cerrar, la entrada se termina con 'cerrarEntradaContenedor'.
+ *
+ */
+FILE* abrirEntradaContenedor(Contenedor* contenedor, const char* nombre);
+
+/*
+ * Nombre: cerrarEntradaContenedor
+ *
+ * Descripción: Termina la última entrada abierta con 'abrirEntradaContenedor' anotando su longitud.
+ *
+ * contenedor: Contenedor abierto para escritura.
+ *
+ */
+void cerrarEntradaContenedor(Contenedor* contenedor);
+
+/*
+ * Nombre: extraerEntradaContenedor
+ *
+ * Descripción: Copia los datos de una entrada del contenedor a un fichero independiente,
+ *              idéntico al que se habría generado sin usar el contenedor.
+ *
+ * contenedor: Contenedor abierto para lectura.
+ * entrada: Índice de la entrada a extraer [0, entradas - 1].
+ * destino: Nombre del fichero a crear (si es NULL se usa el nombre original de la entrada).
+ *
+ * Devuelve cierto si se pudo extraer la entrada.
+ *
+ */
+bool extraerEntradaContenedor(Contenedor* contenedor, int entrada, const char* destino = NULL);
+
+/*
+ * Nombre: clasificarNombre
+ *
+ * Descripción: Obtiene la regla y el tipo de salida a partir del nombre de un fichero generado por las herramientas.
+ *
+ * nombre: Nombre del fichero (por ejemplo ATRACTOR_VISITADO_PASO_R054_C00010_P00020.dat).
+ * regla: Regla encontrada en el nombre (-1 si no se encuentra).
+ * tipo: Tipo de salida (TIPO_DESCONOCIDO si no se reconoce).
+ *
+ */
+void clasificarNombre(const char* nombre, int& regla, int& tipo);
+
+/*
+ * Nombre: nombreTipo
+ *
+ * Descripción: Devuelve el texto que identifica un tipo de salida (el prefijo de sus ficheros) o NULL si no existe.
+ *
+ */
+const char* nombreTipo(int tipo);
+
+/*
+ * Nombre: usarContenedor
+ *
+ * Descripción: Establece el contenedor en el que se guardarán todas las salidas que se abran con 'abrirSalida'.
+ *              Con NULL las salidas vuelven a guardarse en ficheros independientes.
+ *
+ */
+void usarContenedor(Contenedor* contenedor);
+
+/*
+ * Salidas de un hilo: si un hilo las establece (ver 'usarSalidasHilo'), las salidas que abre ese hilo con
+ * 'abrirSalida' se crean en el directorio indicado y sus nombres se anotan, de forma que un proceso que atiende
+ * varias peticiones a la vez (SERVIDOR) sabe qué ficheros ha generado cada una sin que se mezclen.
+ */
+struct SalidasHilo {
+	char directorio[256];								// Directorio en el que se crean las salidas
+	int nsalidas;										// Salidas anotadas
+	int omitidas;										// Salidas creadas que no caben en 'nombres'
+	char nombres[SALIDAS_HILO_MAX][CONTENEDOR_MAX_NOMBRE];	// Nombres de las salidas (sin el directorio)
+};
+
+/*
+ * Nombre: usarSalidasHilo
+ *
+ * Descripción: Establece las salidas del hilo que llama (NULL, por defecto: las salidas se crean con su nombre, o en
+ *              el contenedor si hay uno en uso, que tiene prioridad). No borra las salidas ya anotadas en 'salidas'.
+ *
+ */
+void usarSalidasHilo(SalidasHilo* salidas);
+
+/*
+ * Nombre: abrirSalida
+ *
+ * Descripción: Abre para escritura la salida de nombre dado. Si hay un contenedor en uso se añade
+ *              como entrada del mismo; si no, se crea el fichero con ese nombre (en el directorio de las salidas
+ *              del hilo, si las hay, ver 'usarSalidasHilo'). Hasta 'cerrarSalida'
+ *              el tiempo se cuenta en la fase FASE_SALIDA de libmedidas.
+ *
+ * Devuelve el FILE* en el que escribir o NULL si hubo un error.
+ *
+ */
+FILE* abrirSalida(const char* nombre);
+
+/*
+ * Nombre: cerrarSalida
+ *
+ * Descripción: Cierra la salida abierta con 'abrirSalida' y suma su tamaño al contador CONTADOR_BYTES.
+ *
+ */
+void cerrarSalida(FILE* salida);
+
+#endif
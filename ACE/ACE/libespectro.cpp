@@ -0,0 +1,359 @@
+#include <string.h>
+#include <math.h>
+#include "libespectro.h"
+#include "libmedidas.h"
+
+#ifndef M_PI
+#define M_PI						3.14159265358979323846
+#endif
+
+static inline Complejo producto(Complejo a, Complejo b)
+{
+	Complejo c = { a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re };
+	return c;
+}
+
+/*
+	Descompone n en factores: primero bases 4, después 2 y después los primos impares.
+	Devuelve el mayor factor encontrado.
+*/
+static int factorizar(int n, int* factores)
+{
+	int p = 4, mayor = 1, f = 0;
+	while (n > 1 && f < ESPECTRO_MAX_FACTORES) {
+		while (n % p != 0) {
+			if (p == 4)
+				p = 2;
+			else if (p == 2)
+				p = 3;
+			else
+				p += 2;
+			if ((long long)p * p > n)
+				p = n;
+		}
+		n /= p;
+		factores[2 * f] = p;
+		factores[2 * f + 1] = n;
+		if (p > mayor)
+			mayor = p;
+		f++;
+	}
+	return n > 1 ? n : mayor;
+}
+
+void crearPlanFFT(PlanFFT& plan, int n)
+{
+	memset(&plan, 0, sizeof(plan));
+	plan.n = n;
+
+	// Tabla de giros de la transformada directa
+	plan.giros = new Complejo [n];
+	for (int k = 0; k < n; k++) {
+		double angulo = -2.0 * M_PI * k / n;
+		plan.giros[k].re = cos(angulo);
+		plan.giros[k].im = sin(angulo);
+	}
+	plan.auxiliar = new Complejo [n];
+
+	if (factorizar(n, plan.factores) <= ESPECTRO_MAX_RADIX)
+		return;
+
+	// Bluestein: X(k) = chirp(k) * sum (x(j) chirp(j)) conj(chirp(k - j)), una convolución de longitud m >= 2n - 1
+	plan.m = 1;
+	while (plan.m < 2 * n - 1)
+		plan.m <<= 1;
+	plan.interno = new PlanFFT;
+	crearPlanFFT(*plan.interno, plan.m);
+	plan.chirp = new Complejo [n];
+	for (int k = 0; k < n; k++) {
+		// k² módulo 2n para no perder precisión con n grande
+		double angulo = -M_PI * (double)((long long)k * k % (2LL * n)) / n;
+		plan.chirp[k].re = cos(angulo);
+		plan.chirp[k].im = sin(angulo);
+	}
+	plan.filtro = new Complejo [plan.m];
+	memset(plan.filtro, 0, plan.m * sizeof(Complejo));
+	for (int k = 0; k < n; k++) {
+		Complejo c = { plan.chirp[k].re, -plan.chirp[k].im };
+		plan.filtro[k] = c;
+		if (k > 0)
+			plan.filtro[plan.m - k] = c;
+	}
+	transformarFFT(*plan.interno, plan.filtro);
+
+	// El auxiliar de Bluestein es la secuencia extendida (m posiciones)
+	delete[] plan.auxiliar;
+	plan.auxiliar = new Complejo [plan.m];
+}
+
+void liberarPlanFFT(PlanFFT& plan)
+{
+	delete[] plan.giros;
+	delete[] plan.auxiliar;
+	if (plan.interno != NULL) {
+		liberarPlanFFT(*plan.interno);
+		delete plan.interno;
+	}
+	delete[] plan.chirp;
+	delete[] plan.filtro;
+	memset(&plan, 0, sizeof(plan));
+}
+
+/*
+	Mariposas de una etapa: combina las p transformadas de m puntos que hay seguidas en 'salida' en una de p * m puntos.
+	'paso' es la separación en la tabla de giros (n / (p * m)).
+*/
+static void mariposas(const PlanFFT& plan, Complejo* salida, int paso, int p, int m)
+{
+	const Complejo* giros = plan.giros;
+
+	if (p == 2) {
+		for (int k = 0; k < m; k++) {
+			Complejo t = producto(salida[k + m], giros[k * paso]);
+			salida[k + m].re = salida[k].re - t.re;
+			salida[k + m].im = salida[k].im - t.im;
+			salida[k].re += t.re;
+			salida[k].im += t.im;
+		}
+	}
+	else if (p == 4) {
+		for (int k = 0; k < m; k++) {
+			Complejo s0 = producto(salida[k + m], giros[k * paso]);
+			Complejo s1 = producto(salida[k + 2 * m], giros[2 * k * paso]);
+			Complejo s2 = producto(salida[k + 3 * m], giros[3 * k * paso]);
+			Complejo s5 = { salida[k].re - s1.re, salida[k].im - s1.im };
+			Complejo a = { salida[k].re + s1.re, salida[k].im + s1.im };
+			Complejo s3 = { s0.re + s2.re, s0.im + s2.im };
+			Complejo s4 = { s0.re - s2.re, s0.im - s2.im };
+			salida[k + 2 * m].re = a.re - s3.re;
+			salida[k + 2 * m].im = a.im - s3.im;
+			salida[k].re = a.re + s3.re;
+			salida[k].im = a.im + s3.im;
+			salida[k + m].re = s5.re + s4.im;
+			salida[k + m].im = s5.im - s4.re;
+			salida[k + 3 * m].re = s5.re - s4.im;
+			salida[k + 3 * m].im = s5.im + s4.re;
+		}
+	}
+	else if (p == 3) {
+		double seno = giros[paso * m].im;		// Im(e^(-2*pi*i/3))
+		for (int k = 0; k < m; k++) {
+			Complejo s1 = producto(salida[k + m], giros[k * paso]);
+			Complejo s2 = producto(salida[k + 2 * m], giros[2 * k * paso]);
+			Complejo s3 = { s1.re + s2.re, s1.im + s2.im };
+			Complejo s0 = { (s1.re - s2.re) * seno, (s1.im - s2.im) * seno };
+			Complejo medio = { salida[k].re - 0.5 * s3.re, salida[k].im - 0.5 * s3.im };
+			salida[k].re += s3.re;
+			salida[k].im += s3.im;
+			salida[k + m].re = medio.re - s0.im;
+			salida[k + m].im = medio.im + s0.re;
+			salida[k + 2 * m].re = medio.re + s0.im;
+			salida[k + 2 * m].im = medio.im - s0.re;
+		}
+	}
+	else if (p == 5) {
+		Complejo ya = giros[paso * m];			// e^(-2*pi*i/5)
+		Complejo yb = giros[2 * paso * m];		// e^(-4*pi*i/5)
+		for (int k = 0; k < m; k++) {
+			Complejo s0 = salida[k];
+			Complejo s1 = producto(salida[k + m], giros[k * paso]);
+			Complejo s2 = producto(salida[k + 2 * m], giros[2 * k * paso]);
+			Complejo s3 = producto(salida[k + 3 * m], giros[3 * k * paso]);
+			Complejo s4 = producto(salida[k + 4 * m], giros[4 * k * paso]);
+			Complejo s7 = { s1.re + s4.re, s1.im + s4.im };
+			Complejo s10 = { s1.re - s4.re, s1.im - s4.im };
+			Complejo s8 = { s2.re + s3.re, s2.im + s3.im };
+			Complejo s9 = { s2.re - s3.re, s2.im - s3.im };
+			Complejo s5 = { s0.re + s7.re * ya.re + s8.re * yb.re, s0.im + s7.im * ya.re + s8.im * yb.re };
+			Complejo s6 = { s10.im * ya.im + s9.im * yb.im, -s10.re * ya.im - s9.re * yb.im };
+			Complejo s11 = { s0.re + s7.re * yb.re + s8.re * ya.re, s0.im + s7.im * yb.re + s8.im * ya.re };
+			Complejo s12 = { -s10.im * yb.im + s9.im * ya.im, s10.re * yb.im - s9.re * ya.im };
+			salida[k].re = s0.re + s7.re + s8.re;
+			salida[k].im = s0.im + s7.im + s8.im;
+			salida[k + m].re = s5.re - s6.re;
+			salida[k + m].im = s5.im - s6.im;
+			salida[k + 4 * m].re = s5.re + s6.re;
+			salida[k + 4 * m].im = s5.im + s6.im;
+			salida[k + 2 * m].re = s11.re + s12.re;
+			salida[k + 2 * m].im = s11.im + s12.im;
+			salida[k + 3 * m].re = s11.re - s12.re;
+			salida[k + 3 * m].im = s11.im - s12.im;
+		}
+	}
+	else {
+		// Base genérica: se aplican los giros de la etapa y después una DFT directa de p puntos (p <= ESPECTRO_MAX_RADIX)
+		// con las raíces p-ésimas de la unidad, que son giros[j * paso * m]
+		Complejo entrada[ESPECTRO_MAX_RADIX];
+		Complejo raices[ESPECTRO_MAX_RADIX];
+		for (int j = 0; j < p; j++)
+			raices[j] = giros[j * paso * m];
+		for (int u = 0; u < m; u++) {
+			entrada[0] = salida[u];
+			for (int q = 1; q < p; q++)
+				entrada[q] = producto(salida[u + q * m], giros[q * paso * u]);
+			for (int q1 = 0; q1 < p; q1++) {
+				Complejo suma = entrada[0];
+				int raiz = 0;
+				for (int q = 1; q < p; q++) {
+					raiz += q1;
+					if (raiz >= p)
+						raiz -= p;
+					Complejo t = producto(entrada[q], raices[raiz]);
+					suma.re += t.re;
+					suma.im += t.im;
+				}
+				salida[u + q1 * m] = suma;
+			}
+		}
+	}
+}
+
+/*
+	Transformada de base mixta fuera de sitio (decimación en el tiempo): la entrada se lee con separación 'separacion'.
+*/
+static void fftFactores(const PlanFFT& plan, Complejo* salida, const Complejo* entrada, int separacion, const int* factores)
+{
+	int p = factores[0], m = factores[1];
+	if (m == 1) {
+		for (int i = 0; i < p; i++)
+			salida[i] = entrada[i * separacion];
+	}
+	else {
+		for (int i = 0; i < p; i++)
+			fftFactores(plan, salida + i * m, entrada + i * separacion, separacion * p, factores + 2);
+	}
+	mariposas(plan, salida, separacion, p, m);
+}
+
+static void conjugar(Complejo* datos, int n)
+{
+	for (int k = 0; k < n; k++)
+		datos[k].im = -datos[k].im;
+}
+
+void transformarFFT(const PlanFFT& plan, Complejo* datos, bool inversa)
+{
+	int n = plan.n;
+
+	// La inversa es la conjugada de la directa de los datos conjugados
+	if (inversa)
+		conjugar(datos, n);
+
+	if (n == 1) {
+		// Nada que hacer
+	}
+	else if (plan.m == 0) {
+		fftFactores(plan, plan.auxiliar, datos, 1, plan.factores);
+		memcpy(datos, plan.auxiliar, n * sizeof(Complejo));
+	}
+	else {
+		// Bluestein: convolución de x(j) chirp(j) con el filtro mediante la FFT interna
+		Complejo* extendido = plan.auxiliar;
+		int m = plan.m;
+		for (int k = 0; k < n; k++)
+			extendido[k] = producto(datos[k], plan.chirp[k]);
+		memset(extendido + n, 0, (m - n) * sizeof(Complejo));
+		transformarFFT(*plan.interno, extendido);
+		for (int k = 0; k < m; k++)
+			extendido[k] = producto(extendido[k], plan.filtro[k]);
+		transformarFFT(*plan.interno, extendido, true);
+		double escala = 1.0 / m;
+		for (int k = 0; k < n; k++) {
+			Complejo c = producto(extendido[k], plan.chirp[k]);
+			datos[k].re = c.re * escala;
+			datos[k].im = c.im * escala;
+		}
+	}
+
+	if (inversa)
+		conjugar(datos, n);
+}
+
+void iniciarEspectro(Espectro& espectro)
+{
+	memset(&espectro, 0, sizeof(espectro));
+}
+
+void liberarEspectro(Espectro& espectro)
+{
+	liberarPlanFFT(espectro.plan);
+	delete[] espectro.datos;
+	delete[] espectro.potencia;
+	iniciarEspectro(espectro);
+}
+
+void empezarEspectro(Espectro& espectro, int n)
+{
+	if (espectro.plan.n != n) {
+		liberarEspectro(espectro);
+		crearPlanFFT(espectro.plan, n);
+		espectro.datos = new Complejo [n];
+		espectro.potencia = new double [n];
+	}
+	memset(espectro.potencia, 0, n * sizeof(double));
+	espectro.filas = 0;
+	espectro.pendiente = false;
+}
+
+/*
+	Transforma las filas pendientes (una o dos) y suma su potencia.
+*/
+static void transformarPendientes(Espectro& espectro)
+{
+	int n = espectro.plan.n;
+	Complejo* z = espectro.datos;
+	double escala = 0.5 / n;
+
+	MEDIR_INICIO(FASE_ANALISIS);
+	transformarFFT(espectro.plan, z);
+	for (int k = 0; k < n; k++) {
+		const Complejo& a = z[k];
+		const Complejo& b = z[k == 0 ? 0 : n - k];
+		espectro.potencia[k] += (a.re * a.re + a.im * a.im + b.re * b.re + b.im * b.im) * escala;
+	}
+	espectro.pendiente = false;
+	MEDIR_FIN();
+}
+
+void acumularFilaEspectro(Espectro& espectro, const int* fila)
+{
+	int n = espectro.plan.n;
+	Complejo* z = espectro.datos;
+
+	if (!espectro.pendiente) {
+		for (int j = 0; j < n; j++) {
+			z[j].re = fila[j + 1];
+			z[j].im = 0.0;
+		}
+		espectro.pendiente = true;
+	}
+	else {
+		for (int j = 0; j < n; j++)
+			z[j].im = fila[j + 1];
+		transformarPendientes(espectro);
+	}
+	espectro.filas++;
+}
+
+void resultadoEspectro(Espectro& espectro, double* potencias, double* correlacion)
+{
+	int n = espectro.plan.n;
+	Complejo* z = espectro.datos;
+
+	if (espectro.pendiente)
+		transformarPendientes(espectro);
+
+	// Espectro medio de las fluctuaciones (sin la componente k = 0, que sólo depende de la densidad)
+	double filas = espectro.filas > 0 ? espectro.filas : 1;
+	for (int k = 0; k < n; k++) {
+		z[k].re = (k == 0) ? 0.0 : espectro.potencia[k] / filas;
+		z[k].im = 0.0;
+	}
+	for (int k = 0; k <= n / 2; k++)
+		potencias[k] = z[k].re;
+
+	// C(r) = (1/n) sum P(k) e^(2*pi*i*k*r/n)
+	transformarFFT(espectro.plan, z, true);
+	for (int r = 0; r <= n / 2; r++)
+		correlacion[r] = z[r].re / n;
+}
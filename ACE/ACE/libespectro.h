@@ -0,0 +1,115 @@
+#ifndef _LIBESPECTRO_H_
+#define _LIBESPECTRO_H_
+
+#define ESPECTRO_MAX_RADIX			31		// Factor primo máximo de n para la transformada directa (si no, Bluestein)
+#define ESPECTRO_MAX_FACTORES		40		// Número máximo de factores de n
+
+/*
+ * Número complejo de la transformada de Fourier.
+ */
+struct Complejo {
+	double re, im;
+};
+
+/*
+ * Plan de la transformada rápida de Fourier (FFT) de 'n' puntos, sin bibliotecas externas. Si n sólo tiene factores
+ * primos hasta ESPECTRO_MAX_RADIX se descompone en transformadas de esos tamaños (Cooley-Tukey de base mixta, con
+ * mariposas específicas de base 2, 3, 4 y 5); si no, se calcula como una convolución con una FFT de potencia de 2 de al menos
+ * 2n - 1 puntos (algoritmo de Bluestein). En ambos casos el coste es O(n log n) y la transformada es la circular
+ * de exactamente n puntos, la adecuada para filas con condiciones periódicas de contorno.
+ */
+struct PlanFFT {
+	int n;								// Puntos de la transformada
+	int factores[2 * ESPECTRO_MAX_FACTORES];	// Parejas (p, m): cada etapa hace p transformadas de m puntos
+	Complejo* giros;					// e^(-2*pi*i*k/n), k = 0 ... n - 1
+	Complejo* auxiliar;					// n posiciones para la transformada fuera de sitio
+	int m;								// Puntos de la FFT interna de Bluestein (0 si no se usa)
+	PlanFFT* interno;					// Plan de la FFT interna de Bluestein
+	Complejo* chirp;					// e^(-pi*i*k²/n), k = 0 ... n - 1 (Bluestein)
+	Complejo* filtro;					// Transformada del filtro conj(chirp) extendido a m puntos (Bluestein)
+};
+
+/*
+ * Espectro de potencia medio de una serie de filas de n celdas (0 o 1). Las filas se transforman de dos en dos:
+ * una en la parte real y otra en la imaginaria de la misma FFT compleja, ya que para entradas reales
+ * |A(k)|² + |B(k)|² = (|Z(k)|² + |Z(n - k)|²) / 2 siendo Z = FFT(a + ib).
+ */
+struct Espectro {
+	PlanFFT plan;						// Plan de la FFT de n puntos
+	Complejo* datos;					// Filas pendientes de transformar (n posiciones)
+	double* potencia;					// Suma de |X(k)|² / n de las filas transformadas (n posiciones)
+	int filas;							// Filas acumuladas
+	bool pendiente;						// Cierto si hay una fila en la parte real esperando a su pareja
+};
+
+/*
+ * Nombre: crearPlanFFT
+ *
+ * Descripción: Prepara el plan de la FFT de 'n' puntos (n >= 1).
+ *
+ */
+void crearPlanFFT(PlanFFT& plan, int n);
+
+/*
+ * Nombre: liberarPlanFFT
+ *
+ * Descripción: Libera la memoria del plan y lo deja vacío.
+ *
+ */
+void liberarPlanFFT(PlanFFT& plan);
+
+/*
+ * Nombre: transformarFFT
+ *
+ * Descripción: Calcula en el sitio la transformada X(k) = sum x(j) e^(-2*pi*i*j*k/n) de 'datos' (n posiciones)
+ *              o, si 'inversa', la transformada inversa sin normalizar (con e^(+2*pi*i*j*k/n), sin dividir por n).
+ *
+ */
+void transformarFFT(const PlanFFT& plan, Complejo* datos, bool inversa = false);
+
+/*
+ * Nombre: iniciarEspectro
+ *
+ * Descripción: Deja el espectro vacío (sin memoria reservada).
+ *
+ */
+void iniciarEspectro(Espectro& espectro);
+
+/*
+ * Nombre: liberarEspectro
+ *
+ * Descripción: Libera la memoria del espectro y lo deja vacío.
+ *
+ */
+void liberarEspectro(Espectro& espectro);
+
+/*
+ * Nombre: empezarEspectro
+ *
+ * Descripción: Prepara el espectro para acumular filas de 'n' celdas. El plan sólo se vuelve a crear si cambia 'n'.
+ *
+ */
+void empezarEspectro(Espectro& espectro, int n);
+
+/*
+ * Nombre: acumularFilaEspectro
+ *
+ * Descripción: Añade una fila de un ACE ('n' + 2 posiciones, se usan las celdas 1 ... n) al espectro medio.
+ *
+ */
+void acumularFilaEspectro(Espectro& espectro, const int* fila);
+
+/*
+ * Nombre: resultadoEspectro
+ *
+ * Descripción: Calcula, para las fluctuaciones de las filas acumuladas respecto de su densidad, el espectro de potencia
+ *              medio P(k) = <|X(k)|²> / n y la función de correlación circular media C(r) = <(1/n) sum dx(j) dx(j + r)>,
+ *              obtenida como la transformada inversa de P(k) dividida por n (C(0) es la varianza de cada fila).
+ *
+ * potencias: Vector de n / 2 + 1 posiciones en el que devolver P(k) para k = 0 ... n / 2 (P(0) = 0).
+ * correlacion: Vector de n / 2 + 1 posiciones en el que devolver C(r) para r = 0 ... n / 2.
+ *
+ */
+void resultadoEspectro(Espectro& espectro, double* potencias, double* correlacion);
+
+#endif
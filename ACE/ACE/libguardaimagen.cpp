@@ -1,12 +1,124 @@
+#include <charconv>
+#include <stdlib.h>
+#include <string.h>
 #include "libguardaimagen.h"
+#include "libcontenedor.h"
 
 #pragma warning ( disable: 4996 )
 
+#define TAM_BUFFER_SALIDA	(1 << 20)	// Tamaño del buffer en el que se acumula la salida antes de escribirla en el fichero (1 MB)
+#define MAX_CARACTERES_NUMERO	352		// Máximo de caracteres que puede ocupar un número al convertirlo a texto (double con decimales)
+
+/*
+	Buffer de salida: se acumula el texto (o los datos binarios) a escribir y se vuelca al fichero 
+	únicamente cuando está lleno o al cerrarlo, evitando llamar a fprintf por cada valor.
+*/
+struct BufferSalida {
+	FILE* fichero;		// Fichero en el que se vuelcan los datos
+	char* datos;		// Memoria del buffer (TAM_BUFFER_SALIDA bytes)
+	size_t usados;		// Bytes ocupados en el buffer pendientes de volcar
+};
+
+static bool abrirBuffer(BufferSalida& buffer, char* nombre)
+{
+	buffer.fichero = abrirSalida(nombre);
+	if (buffer.fichero == NULL)
+		return false;
+	buffer.datos = new char [TAM_BUFFER_SALIDA];
+	buffer.usados = 0;
+	return true;
+}
+
+static void volcarBuffer(BufferSalida& buffer)
+{
+	fwrite(buffer.datos, 1, buffer.usados, buffer.fichero);
+	buffer.usados = 0;
+}
+
+static void cerrarBuffer(BufferSalida& buffer)
+{
+	volcarBuffer(buffer);
+	cerrarSalida(buffer.fichero);
+	delete[] buffer.datos;
+}
+
+// Nos aseguramos de que caben 'n' bytes más en el buffer (n <= TAM_BUFFER_SALIDA)
+static inline void reservarBuffer(BufferSalida& buffer, size_t n)
+{
+	if (buffer.usados + n > TAM_BUFFER_SALIDA)
+		volcarBuffer(buffer);
+}
+
+static inline void escribirCaracter(BufferSalida& buffer, char c)
+{
+	reservarBuffer(buffer, 1);
+	buffer.datos[buffer.usados++] = c;
+}
+
+static inline void escribirEntero(BufferSalida& buffer, int valor)
+{
+	reservarBuffer(buffer, MAX_CARACTERES_NUMERO);
+	char* inicio = buffer.datos + buffer.usados;
+	buffer.usados = std::to_chars(inicio, inicio + MAX_CARACTERES_NUMERO, valor).ptr - buffer.datos;
+}
+
+// Equivalente a "%.<decimales>f" de printf (mismo redondeo)
+static inline void escribirReal(BufferSalida& buffer, double valor, int decimales)
+{
+	reservarBuffer(buffer, MAX_CARACTERES_NUMERO);
+	char* inicio = buffer.datos + buffer.usados;
+	std::to_chars_result r = std::to_chars(inicio, inicio + MAX_CARACTERES_NUMERO, valor, std::chars_format::fixed, decimales);
+	if (r.ec == std::errc())
+		buffer.usados = r.ptr - buffer.datos;
+	else
+		buffer.usados += sprintf(inicio, "%.*f", decimales, valor);
+}
+
+static void escribirBinario(BufferSalida& buffer, const void* datos, size_t bytes)
+{
+	const char* origen = (const char*)datos;
+	while (bytes > 0) {
+		size_t n = TAM_BUFFER_SALIDA - buffer.usados;
+		if (n == 0) {
+			volcarBuffer(buffer);
+			continue;
+		}
+		if (n > bytes)
+			n = bytes;
+		memcpy(buffer.datos + buffer.usados, origen, n);
+		buffer.usados += n;
+		origen += n;
+		bytes -= n;
+	}
+}
+
+/*
+	Escribe la cabecera de un fichero NPY (versión 1.0) para una matriz de 'filas' X 'columnas' 
+	del tipo 'tipo' ('i4' o 'f8') almacenada por columnas. El tamaño total de la cabecera es 
+	múltiplo de 64 bytes para que los datos queden alineados al mapearlos en memoria.
+*/
+static void escribirCabeceraNPY(BufferSalida& buffer, const char* tipo, long filas, int columnas)
+{
+	unsigned int u = 1;
+	char orden = (*(unsigned char*)&u == 1) ? '<' : '>';	// Los datos se escriben en el orden de bytes de la máquina
+	char diccionario[256];
+	int longitud = sprintf(diccionario, "{'descr': '%c%s', 'fortran_order': True, 'shape': (%ld, %d), }", orden, tipo, filas, columnas);
+
+	// Rellenamos con espacios y terminamos con '\n' (10 bytes de prefijo: magic, versión y longitud)
+	while ((10 + longitud + 1) % 64 != 0)
+		diccionario[longitud++] = ' ';
+	diccionario[longitud++] = '\n';
+
+	unsigned char prefijo[10] = { 0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0, (unsigned char)(longitud & 0xFF), (unsigned char)(longitud >> 8) };
+	escribirBinario(buffer, prefijo, 10);
+	escribirBinario(buffer, diccionario, longitud);
+}
+
 void guardaPGMi(char* nombre, int anchura, int altura, int *pixels, int pixel_min, int pixel_max)
 {
 	int i, j, ij, p;
 	FILE* imagen;
-	imagen = fopen(nombre, "wb");
+	imagen = abrirSalida(nombre);
 	fprintf(imagen, "P2");
 	fprintf(imagen, "#guardaPGMi %s\n", nombre);
 	fprintf(imagen, "%d %d\n", anchura, altura);
@@ -24,14 +136,14 @@ void guardaPGMi(char* nombre, int anchura, int altura, int *pixels, int pixel_mi
 		}
 		fprintf (imagen, "\n");
 	}
-	fclose (imagen);
+	cerrarSalida(imagen);
 }
 
 void guardaPGMd (char* nombre, int anchura, int altura, double *pixels, double pixel_min, double pixel_max)
 {
 	int i, j, ij, p;
 	FILE* imagen;
-	imagen = fopen(nombre, "wb");
+	imagen = abrirSalida(nombre);
 	fprintf(imagen, "P2");
 	fprintf(imagen, "#guardaPGMi %s\n", nombre);
 	fprintf(imagen, "%d %d\n", anchura, altura);
@@ -49,7 +161,7 @@ void guardaPGMd (char* nombre, int anchura, int altura, double *pixels, double p
 		}
 		fprintf (imagen, "\n");
 	}
-	fclose (imagen);
+	cerrarSalida(imagen);
 }
 
 void guardaPGMiACE(char* nombre, int pasos, int celdas, int **pixels, int pixel_min, int pixel_max)
@@ -58,7 +170,7 @@ void guardaPGMiACE(char* nombre, int pasos, int celdas, int **pixels, int pixel_
 	int anchura = celdas + 2;
 	int i, j, p;
 	FILE* imagen;
-	imagen = fopen(nombre, "wb");
+	imagen = abrirSalida(nombre);
 	fprintf(imagen, "P2");
 	fprintf(imagen, "#guardaPGMi %s\n", nombre);
 	fprintf(imagen, "%d %d\n", anchura, altura);
@@ -76,40 +188,190 @@ void guardaPGMiACE(char* nombre, int pasos, int celdas, int **pixels, int pixel_
 		}
 		fprintf (imagen, "\n");
 	}
-	fclose (imagen);
+	cerrarSalida(imagen);
 }
 
 void guardaPLOT (char* nombre, const int *y, int valores, int xini)
 {
-	FILE* plot;
-	plot = fopen(nombre, "wb");
+	BufferSalida plot;
+	if (!abrirBuffer(plot, nombre))
+		return;
 	for (int i = 0; i < valores; i++) {
-		fprintf (plot, "%d %d\n", i + xini, y[i]);
+		escribirEntero(plot, i + xini);
+		escribirCaracter(plot, ' ');
+		escribirEntero(plot, y[i]);
+		escribirCaracter(plot, '\n');
 	}
-	fclose (plot);
+	cerrarBuffer(plot);
 }
 
 void guardaPLOT (char* nombre, const double *y, int valores, int xini, int decimales)
 {
-	char decs[32];
-	sprintf(decs, "%%d %%.%df\n", decimales);
-	FILE* plot;
-	plot = fopen(nombre, "wb");
+	BufferSalida plot;
+	if (!abrirBuffer(plot, nombre))
+		return;
+	for (int i = 0; i < valores; i++) {
+		escribirEntero(plot, i + xini);
+		escribirCaracter(plot, ' ');
+		escribirReal(plot, y[i], decimales);
+		escribirCaracter(plot, '\n');
+	}
+	cerrarBuffer(plot);
+}
+
+void guardaParesPLOT (char* nombre, const double *x, const double *y, int valores, int decimalesX, int decimales)
+{
+	BufferSalida plot;
+	if (!abrirBuffer(plot, nombre))
+		return;
 	for (int i = 0; i < valores; i++) {
-		fprintf (plot, decs, i + xini, y[i]);
+		escribirReal(plot, x[i], decimalesX);
+		escribirCaracter(plot, ' ');
+		escribirReal(plot, y[i], decimales);
+		escribirCaracter(plot, '\n');
 	}
-	fclose (plot);
+	cerrarBuffer(plot);
 }
 
-void guardarAtractorPLOT(char* nombreFichero, int** probabilidades, int pasos, int estados)
+/*
+	Vector con capacidad para los estados visitados en el paso con más estados visitados.
+*/
+static unsigned int* reservarEstadosAtractor(const Histograma* probabilidades, int pasos)
 {
-	FILE* plot;
-	plot = fopen(nombreFichero, "wb");
+	long long maximo = 0;
+	for (int p = 0; p <= pasos; p++)
+		if (probabilidades[p].distintos > maximo)
+			maximo = probabilidades[p].distintos;
+	return new unsigned int [(size_t)maximo + 1];
+}
+
+void guardarAtractorPLOT(char* nombreFichero, const Histograma* probabilidades, int pasos)
+{
+	BufferSalida plot;
+	if (!abrirBuffer(plot, nombreFichero))
+		return;
+	unsigned int* visitados = reservarEstadosAtractor(probabilidades, pasos);
 	for (int p = 0; p <= pasos; p++) {
-		for (int e = 0; e < estados; e++) {
-			if (probabilidades[p][e] != 0) 
-				fprintf(plot, "%d %d\n", e, p);
+		long long n = entradasHistograma(probabilidades[p], visitados, NULL);
+		for (long long i = 0; i < n; i++) {
+			escribirEntero(plot, (int)visitados[i]);
+			escribirCaracter(plot, ' ');
+			escribirEntero(plot, p);
+			escribirCaracter(plot, '\n');
 		}
 	}
-	fclose (plot);
+	delete[] visitados;
+	cerrarBuffer(plot);
+}
+
+void guardaNPY (char* nombre, const int *y, int valores, int xini)
+{
+	BufferSalida npy;
+	if (!abrirBuffer(npy, nombre))
+		return;
+	escribirCabeceraNPY(npy, "i4", valores, 2);
+	for (int i = 0; i < valores; i++) {
+		int x = i + xini;
+		escribirBinario(npy, &x, sizeof(int));
+	}
+	escribirBinario(npy, y, valores * sizeof(int));
+	cerrarBuffer(npy);
+}
+
+void guardaNPY (char* nombre, const double *y, int valores, int xini)
+{
+	BufferSalida npy;
+	if (!abrirBuffer(npy, nombre))
+		return;
+	escribirCabeceraNPY(npy, "f8", valores, 2);
+	for (int i = 0; i < valores; i++) {
+		double x = i + xini;
+		escribirBinario(npy, &x, sizeof(double));
+	}
+	escribirBinario(npy, y, valores * sizeof(double));
+	cerrarBuffer(npy);
+}
+
+void guardaParesNPY (char* nombre, const double *x, const double *y, int valores)
+{
+	BufferSalida npy;
+	if (!abrirBuffer(npy, nombre))
+		return;
+	escribirCabeceraNPY(npy, "f8", valores, 2);
+	escribirBinario(npy, x, valores * sizeof(double));
+	escribirBinario(npy, y, valores * sizeof(double));
+	cerrarBuffer(npy);
+}
+
+void guardarAtractorNPY(char* nombreFichero, const Histograma* probabilidades, int pasos)
+{
+	BufferSalida npy;
+	long puntos = 0;
+
+	// Primero contamos los puntos para poder escribir la cabecera
+	for (int p = 0; p <= pasos; p++)
+		puntos += (long)probabilidades[p].distintos;
+
+	if (!abrirBuffer(npy, nombreFichero))
+		return;
+	escribirCabeceraNPY(npy, "i4", puntos, 2);
+
+	// Primera columna: estados
+	unsigned int* visitados = reservarEstadosAtractor(probabilidades, pasos);
+	for (int p = 0; p <= pasos; p++) {
+		long long n = entradasHistograma(probabilidades[p], visitados, NULL);
+		escribirBinario(npy, visitados, (size_t)n * sizeof(unsigned int));
+	}
+	delete[] visitados;
+
+	// Segunda columna: pasos
+	for (int p = 0; p <= pasos; p++)
+		for (long long i = 0; i < probabilidades[p].distintos; i++)
+			escribirBinario(npy, &p, sizeof(int));
+
+	cerrarBuffer(npy);
+}
+
+void guardarHistogramaPLOT(char* nombreFichero, const Histograma& visitas)
+{
+	BufferSalida plot;
+	if (!abrirBuffer(plot, nombreFichero))
+		return;
+	unsigned int* estados = new unsigned int [(size_t)visitas.distintos + 1];
+	int* cuentas = new int [(size_t)visitas.distintos + 1];
+	long long n = entradasHistograma(visitas, estados, cuentas);
+	for (long long i = 0; i < n; i++) {
+		escribirEntero(plot, (int)estados[i]);
+		escribirCaracter(plot, ' ');
+		escribirEntero(plot, cuentas[i]);
+		escribirCaracter(plot, '\n');
+	}
+	delete[] estados;
+	delete[] cuentas;
+	cerrarBuffer(plot);
+}
+
+void guardarHistogramaNPY(char* nombreFichero, const Histograma& visitas)
+{
+	BufferSalida npy;
+	if (!abrirBuffer(npy, nombreFichero))
+		return;
+	unsigned int* estados = new unsigned int [(size_t)visitas.distintos + 1];
+	int* cuentas = new int [(size_t)visitas.distintos + 1];
+	long long n = entradasHistograma(visitas, estados, cuentas);
+	escribirCabeceraNPY(npy, "i4", (long)n, 2);
+	escribirBinario(npy, estados, (size_t)n * sizeof(unsigned int));
+	escribirBinario(npy, cuentas, (size_t)n * sizeof(int));
+	delete[] estados;
+	delete[] cuentas;
+	cerrarBuffer(npy);
+}
+
+char* cambiarExtension (char* nombre, const char* extension)
+{
+	char* punto = strrchr(nombre, '.');
+	if (punto == NULL)
+		punto = nombre + strlen(nombre);
+	sprintf(punto, ".%s", extension);
+	return nombre;
 }
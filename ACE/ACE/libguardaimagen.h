@@ -2,6 +2,11 @@
 #define _LIBGUARDAIMAGEN_H_
 
 #include <stdio.h>
+#include "libhistograma.h"
+
+#define FORMATO_TEXTO				1		// Las series se guardan en ficheros de texto (.dat) compatibles con gnuplot
+#define FORMATO_NPY					2		// Las series se guardan en ficheros binarios por columnas (.npy) compatibles con numpy
+#define FORMATO_AMBOS				3		// Las series se guardan en ambos formatos
 
 /* 
 	Guarda en el archivo de nombre dado una imagen PGM de dimensiones anchura X altura 
@@ -39,14 +44,69 @@ void guardaPLOT (char* nombre, const int *y, int valores, int xini = 1);
 */
 void guardaPLOT (char* nombre, const double *y, int valores, int xini = 1, int decimales = 3);
 
+/* 
+	Guarda en el archivo de nombre dado los puntos (x[i], y[i]) de una gráfica, para cuando los valores de x
+	no son consecutivos. En 'valores' tenemos el número de puntos. Cada valor de 'x' se guarda con 'decimalesX'
+	decimales (por defecto ninguno) y cada valor de 'y' con 'decimales' decimales (por defecto 3).
+*/
+void guardaParesPLOT (char* nombre, const double *x, const double *y, int valores, int decimalesX = 0, int decimales = 3);
+
 /* 
 	Guarda en el archivo de nombre dado los valores de las visitas a cada estado posible de un ACE en cada paso.
-	En 'probabilidades' tenemos la estructura (doble vector [paso][estado]) que almacena las visitas.	
-	En 'pasos' tenemos los pasos de la simulación. Por tanto la estructura tendra 'pasos + 1' vectores de estados.
-	En 'estados' tenemos el número de estados simulados.
+	En 'probabilidades' tenemos la estructura (un histograma por paso) que almacena las visitas.
+	En 'pasos' tenemos los pasos de la simulación. Por tanto la estructura tendra 'pasos + 1' histogramas.
 	El formato del fichero es compatible con el comando plot de gnuplot (dos columnas, la primera el valor X y la segunda el valor Y)
 	Para representarlo con el comando plot de gnuplot: plot [0:estados] [-1:pasos + 2] “nombreFichero” pt 7 ps 0.2.
 */
-void guardarAtractorPLOT(char* nombreFichero, int** probabilidades, int pasos, int estados);
+void guardarAtractorPLOT(char* nombreFichero, const Histograma* probabilidades, int pasos);
+
+/* 
+	Guarda en el archivo de nombre dado los puntos de una gráfica almacenados en 'y' en formato NPY (numpy).
+	En 'valores' tenemos el número de puntos que hay en 'y' (lista de enteros).
+	Los valores de la coordenada x se obtienen incrementalmente a partir de 'xini' (por defecto 1)
+	Se guarda una matriz de enteros de 32 bits de dimensiones 'valores' X 2 ordenada por columnas (fortran_order),
+	primero todos los valores X y después todos los valores Y, de manera que puede leerse con numpy.load(mmap_mode='r')
+*/
+void guardaNPY (char* nombre, const int *y, int valores, int xini = 1);
+
+/* 
+	Guarda en el archivo de nombre dado los puntos de una gráfica almacenados en 'y' en formato NPY (numpy).
+	En 'valores' tenemos el número de puntos que hay en 'y' (lista de reales)
+	Los valores de la coordenada x se obtienen incrementalmente a partir de 'xini' (por defecto 1).
+	Se guarda una matriz de reales de 64 bits de dimensiones 'valores' X 2 ordenada por columnas (fortran_order)
+*/
+void guardaNPY (char* nombre, const double *y, int valores, int xini = 1);
+
+/* 
+	Como guardaParesPLOT en formato NPY (numpy): una matriz de reales de 64 bits de dimensiones 'valores' X 2
+	ordenada por columnas (fortran_order), primero todos los valores X y después todos los valores Y.
+*/
+void guardaParesNPY (char* nombre, const double *x, const double *y, int valores);
+
+/* 
+	Guarda en el archivo de nombre dado los valores de las visitas a cada estado posible de un ACE en cada paso en formato NPY (numpy).
+	Contiene los mismos puntos (estado, paso) que guardarAtractorPLOT y en el mismo orden, 
+	como una matriz de enteros de 32 bits de dimensiones 'puntos' X 2 ordenada por columnas (fortran_order)
+*/
+void guardarAtractorNPY(char* nombreFichero, const Histograma* probabilidades, int pasos);
+
+/* 
+	Guarda en el archivo de nombre dado las visitas a cada estado de un histograma, sólo de los estados visitados
+	y en orden creciente de estado (dos columnas, la primera el estado y la segunda sus visitas).
+*/
+void guardarHistogramaPLOT(char* nombreFichero, const Histograma& visitas);
+
+/* 
+	Como guardarHistogramaPLOT en formato NPY (numpy): una matriz de enteros de 32 bits de dimensiones
+	'estados visitados' X 2 ordenada por columnas (fortran_order), primero los estados y después sus visitas.
+*/
+void guardarHistogramaNPY(char* nombreFichero, const Histograma& visitas);
+
+/* 
+	Sustituye la extensión del nombre de fichero dado por 'extension' (sin el punto).
+	Se supone que 'nombre' tiene espacio suficiente para la nueva extensión.
+	Devuelve el propio 'nombre' para poder usarlo directamente como parámetro.
+*/
+char* cambiarExtension (char* nombre, const char* extension);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include <string.h>
+#include <algorithm>
+#include "libhistograma.h"
+#include "libtablas.h"
+
+/*
+	Posición ideal del estado en la tabla dispersa (hash multiplicativo de Fibonacci).
+*/
+static inline long long posicionIdeal(const Histograma& h, unsigned int estado)
+{
+	return (long long)(((unsigned long long)estado * 0x9E3779B97F4A7C15ULL) >> (64 - h.bitsCapacidad));
+}
+
+/*
+	Reserva una tabla dispersa vacía de 2^bits posiciones (liberando la anterior).
+*/
+static void reservarDisperso(Histograma& h, int bits)
+{
+	liberarTabla(h.tabla);
+	h.bitsCapacidad = bits;
+	h.capacidad = 1LL << bits;
+	h.tabla = (EntradaHistograma*)reservarTabla((size_t)h.capacidad * sizeof(EntradaHistograma));
+}
+
+/*
+	Coloca en la tabla dispersa, a partir de la posición 'posicion' (a distancia 'distancia' de su posición ideal),
+	un estado que no está en ella: cuando encuentra un estado más cerca de la suya que el que se está colocando,
+	se lo cambia y sigue colocando el desplazado.
+*/
+static void colocarDisperso(Histograma& h, EntradaHistograma entrada, long long posicion, long long distancia)
+{
+	long long mascara = h.capacidad - 1;
+
+	while (h.tabla[posicion].cuenta != 0) {
+		long long suya = (posicion - posicionIdeal(h, h.tabla[posicion].estado)) & mascara;
+		if (suya < distancia) {
+			std::swap(entrada, h.tabla[posicion]);
+			distancia = suya;
+		}
+		posicion = (posicion + 1) & mascara;
+		distancia++;
+	}
+	h.tabla[posicion] = entrada;
+}
+
+/*
+	Busca el estado en la tabla dispersa. Devuelve su posición o -1 si no está; en ese caso deja en 'posicion'
+	y 'distancia' el punto desde el que hay que colocarlo (ver 'colocarDisperso').
+*/
+static long long buscarDisperso(const Histograma& h, unsigned int estado, long long& posicion, long long& distancia)
+{
+	long long mascara = h.capacidad - 1;
+
+	posicion = posicionIdeal(h, estado);
+	for (distancia = 0; h.tabla[posicion].cuenta != 0; distancia++) {
+		if (h.tabla[posicion].estado == estado)
+			return posicion;
+		if (((posicion - posicionIdeal(h, h.tabla[posicion].estado)) & mascara) < distancia)
+			return -1;
+		posicion = (posicion + 1) & mascara;
+	}
+	return -1;
+}
+
+/*
+	Pasa el histograma disperso a denso y libera la tabla dispersa.
+*/
+static void convertirDenso(Histograma& h)
+{
+	h.denso = (int*)reservarTabla((size_t)h.estadosPosibles * sizeof(int));
+	for (long long p = 0; p < h.capacidad; p++)
+		if (h.tabla[p].cuenta != 0)
+			h.denso[h.tabla[p].estado] = h.tabla[p].cuenta;
+
+	liberarTabla(h.tabla);
+	h.tabla = NULL;
+	h.capacidad = 0;
+	h.bitsCapacidad = 0;
+}
+
+/*
+	Duplica la capacidad de la tabla dispersa y vuelve a colocar sus estados.
+*/
+static void crecerDisperso(Histograma& h)
+{
+	EntradaHistograma* tabla = h.tabla;
+	long long capacidad = h.capacidad;
+
+	h.tabla = NULL;
+	reservarDisperso(h, h.bitsCapacidad + 1);
+	for (long long p = 0; p < capacidad; p++)
+		if (tabla[p].cuenta != 0)
+			colocarDisperso(h, tabla[p], posicionIdeal(h, tabla[p].estado), 0);
+
+	liberarTabla(tabla);
+}
+
+void iniciarHistograma(Histograma& h)
+{
+	memset(&h, 0, sizeof(h));
+}
+
+void vaciarHistograma(Histograma& h, long long estadosPosibles)
+{
+	h.distintos = 0;
+
+	// Los histogramas pequeños son siempre densos (se reutiliza el vector si tiene la misma longitud)
+	if (estadosPosibles <= HISTOGRAMA_DENSO_MAX) {
+		if (h.denso == NULL || h.estadosPosibles != estadosPosibles) {
+			liberarTabla(h.denso);
+			h.denso = (int*)reservarTabla((size_t)estadosPosibles * sizeof(int));
+		}
+		else
+			vaciarTabla(h.denso, (size_t)estadosPosibles * sizeof(int));
+		h.estadosPosibles = estadosPosibles;
+		return;
+	}
+
+	// Los demás empiezan dispersos con la capacidad inicial
+	liberarTabla(h.denso);
+	h.denso = NULL;
+	h.estadosPosibles = estadosPosibles;
+	if (h.capacidad != HISTOGRAMA_CAPACIDAD_INICIAL) {
+		int bits = 0;
+		while ((1LL << bits) < HISTOGRAMA_CAPACIDAD_INICIAL)
+			bits++;
+		reservarDisperso(h, bits);
+	}
+	else
+		vaciarTabla(h.tabla, (size_t)h.capacidad * sizeof(EntradaHistograma));
+}
+
+void liberarHistograma(Histograma& h)
+{
+	liberarTabla(h.denso);
+	liberarTabla(h.tabla);
+	iniciarHistograma(h);
+}
+
+int sumarHistograma(Histograma& h, unsigned int estado, int n)
+{
+	if (h.denso != NULL) {
+		int cuenta = (h.denso[estado] += n);
+		if (cuenta == n)
+			h.distintos++;
+		return cuenta;
+	}
+
+	long long posicion, distancia;
+	long long encontrado = buscarDisperso(h, estado, posicion, distancia);
+	if (encontrado >= 0)
+		return h.tabla[encontrado].cuenta += n;
+
+	EntradaHistograma entrada = { estado, n };
+	colocarDisperso(h, entrada, posicion, distancia);
+	h.distintos++;
+
+	// Con demasiados estados visitados el vector denso ocupa menos; si no, se mantiene la ocupación por debajo de 3/4
+	if (h.distintos * HISTOGRAMA_FRACCION_DENSO > h.estadosPosibles)
+		convertirDenso(h);
+	else if (h.distintos * 4 > h.capacidad * 3)
+		crecerDisperso(h);
+	return n;
+}
+
+int valorHistograma(const Histograma& h, unsigned int estado)
+{
+	if (h.denso != NULL)
+		return h.denso[estado];
+
+	long long posicion, distancia;
+	long long encontrado = buscarDisperso(h, estado, posicion, distancia);
+	return encontrado >= 0 ? h.tabla[encontrado].cuenta : 0;
+}
+
+long long entradasHistograma(const Histograma& h, unsigned int* estados, int* cuentas)
+{
+	long long n = 0;
+
+	if (h.denso != NULL) {
+		for (long long e = 0; e < h.estadosPosibles; e++) {
+			if (h.denso[e] != 0) {
+				if (estados != NULL)
+					estados[n] = (unsigned int)e;
+				if (cuentas != NULL)
+					cuentas[n] = h.denso[e];
+				n++;
+			}
+		}
+		return n;
+	}
+
+	// Ordenamos las parejas (estado, visitas) por estado empaquetadas en un entero de 64 bits
+	unsigned long long* parejas = new unsigned long long [(size_t)h.distintos + 1];
+	for (long long p = 0; p < h.capacidad; p++)
+		if (h.tabla[p].cuenta != 0)
+			parejas[n++] = ((unsigned long long)h.tabla[p].estado << 32) | (unsigned int)h.tabla[p].cuenta;
+	std::sort(parejas, parejas + n);
+	for (long long i = 0; i < n; i++) {
+		if (estados != NULL)
+			estados[i] = (unsigned int)(parejas[i] >> 32);
+		if (cuentas != NULL)
+			cuentas[i] = (int)(parejas[i] & 0xFFFFFFFFULL);
+	}
+	delete[] parejas;
+	return n;
+}
+
+const void* bloqueHistograma(const Histograma& h, unsigned long long& bytes, unsigned int*& copia)
+{
+	if (h.denso != NULL) {
+		copia = NULL;
+		bytes = (unsigned long long)h.estadosPosibles * sizeof(int);
+		return h.denso;
+	}
+
+	copia = new unsigned int [(size_t)(2 * h.distintos) + 1];
+	long long n = 0;
+	for (long long p = 0; p < h.capacidad; p++) {
+		if (h.tabla[p].cuenta != 0) {
+			copia[2 * n] = h.tabla[p].estado;
+			copia[2 * n + 1] = (unsigned int)h.tabla[p].cuenta;
+			n++;
+		}
+	}
+	bytes = (unsigned long long)n * 2 * sizeof(unsigned int);
+	return copia;
+}
+
+bool restaurarHistograma(Histograma& h, long long estadosPosibles, const void* datos, unsigned long long bytes)
+{
+	vaciarHistograma(h, estadosPosibles);
+
+	// Bloque denso en un histograma vacío: se copia el vector de visitas completo
+	if (bytes == (unsigned long long)estadosPosibles * sizeof(int)) {
+		if (h.denso == NULL)
+			h.denso = (int*)reservarTabla((size_t)estadosPosibles * sizeof(int));
+		memcpy(h.denso, datos, (size_t)bytes);
+		for (long long e = 0; e < estadosPosibles; e++)
+			if (h.denso[e] != 0)
+				h.distintos++;
+		return true;
+	}
+
+	if (!sumarBloqueHistograma(h, datos, bytes)) {
+		vaciarHistograma(h, estadosPosibles);
+		return false;
+	}
+	return true;
+}
+
+bool sumarBloqueHistograma(Histograma& h, const void* datos, unsigned long long bytes)
+{
+	// Bloque denso: el vector de visitas completo
+	if (bytes == (unsigned long long)h.estadosPosibles * sizeof(int)) {
+		const int* visitas = (const int*)datos;
+		for (long long e = 0; e < h.estadosPosibles; e++)
+			if (visitas[e] < 0)
+				return false;
+		for (long long e = 0; e < h.estadosPosibles; e++)
+			if (visitas[e] != 0)
+				sumarHistograma(h, (unsigned int)e, visitas[e]);
+		return true;
+	}
+
+	// Bloque disperso: parejas (estado, visitas)
+	if (bytes % (2 * sizeof(unsigned int)) != 0)
+		return false;
+	const unsigned int* parejas = (const unsigned int*)datos;
+	long long n = (long long)(bytes / (2 * sizeof(unsigned int)));
+	for (long long i = 0; i < n; i++)
+		if (parejas[2 * i] >= (unsigned long long)h.estadosPosibles || (int)parejas[2 * i + 1] <= 0)
+			return false;
+	for (long long i = 0; i < n; i++)
+		sumarHistograma(h, parejas[2 * i], (int)parejas[2 * i + 1]);
+	return true;
+}
@@ -0,0 +1,114 @@
+#ifndef _LIBHISTOGRAMA_H_
+#define _LIBHISTOGRAMA_H_
+
+#define HISTOGRAMA_CAPACIDAD_INICIAL	1024	// Posiciones iniciales de la tabla dispersa (potencia de 2)
+#define HISTOGRAMA_DENSO_MAX			65536	// Hasta este número de estados posibles el histograma es siempre denso
+#define HISTOGRAMA_FRACCION_DENSO		16		// Pasa a denso al visitar más de 1 / HISTOGRAMA_FRACCION_DENSO de los estados
+
+/*
+ * Posición de la tabla dispersa: estado y visitas juntos, para que cada consulta toque una sola línea de caché.
+ */
+struct EntradaHistograma {
+	unsigned int estado;				// Estado guardado en la posición
+	int cuenta;							// Visitas del estado (0: posición libre)
+};
+
+/*
+ * Histograma de visitas a los estados de un ACE (2^celdas estados posibles). Mientras se visitan pocos estados
+ * se guarda como tabla dispersa de direccionamiento abierto (robin hood: cada estado se guarda lo más cerca
+ * posible de su posición ideal y la búsqueda termina en cuanto se encuentra uno más cerca que el buscado),
+ * con memoria proporcional a los estados visitados. Al superar 1 / HISTOGRAMA_FRACCION_DENSO de los estados posibles
+ * pasa a ser un vector denso con una posición por estado, como los vectores de visitas de 'entropia'.
+ */
+struct Histograma {
+	long long estadosPosibles;			// Estados posibles (2^celdas)
+	long long distintos;				// Estados con alguna visita
+	int* denso;							// Visitas a cada estado (NULL mientras es disperso)
+	EntradaHistograma* tabla;			// Tabla dispersa (NULL mientras es denso)
+	long long capacidad;				// Posiciones de la tabla dispersa (potencia de 2)
+	int bitsCapacidad;					// log2(capacidad)
+};
+
+/*
+ * Nombre: iniciarHistograma
+ *
+ * Descripción: Deja un histograma vacío y sin memoria reservada (hay que prepararlo con 'vaciarHistograma').
+ *
+ */
+void iniciarHistograma(Histograma& h);
+
+/*
+ * Nombre: vaciarHistograma
+ *
+ * Descripción: Deja el histograma sin visitas para 'estadosPosibles' estados. Vuelve a ser disperso
+ *              (salvo que haya como mucho HISTOGRAMA_DENSO_MAX estados posibles) y reutiliza la tabla dispersa.
+ *
+ */
+void vaciarHistograma(Histograma& h, long long estadosPosibles);
+
+/*
+ * Nombre: liberarHistograma
+ *
+ * Descripción: Libera la memoria del histograma y lo deja vacío.
+ *
+ */
+void liberarHistograma(Histograma& h);
+
+/*
+ * Nombre: sumarHistograma
+ *
+ * Descripción: Suma 'n' visitas al estado 'estado'. Devuelve las visitas del estado tras sumarlas
+ *              (1 si es la primera visita con n = 1, para contar los estados diferentes visitados).
+ *
+ */
+int sumarHistograma(Histograma& h, unsigned int estado, int n = 1);
+
+/*
+ * Nombre: valorHistograma
+ *
+ * Descripción: Devuelve las visitas al estado 'estado'.
+ *
+ */
+int valorHistograma(const Histograma& h, unsigned int estado);
+
+/*
+ * Nombre: entradasHistograma
+ *
+ * Descripción: Escribe los estados visitados en orden creciente en 'estados' y sus visitas en 'cuentas'
+ *              (cualquiera de los dos puede ser NULL), con h.distintos posiciones. Devuelve el número de estados escritos.
+ *              Permite recorrer igual un histograma disperso que uno denso, en el orden del vector denso.
+ *
+ */
+long long entradasHistograma(const Histograma& h, unsigned int* estados, int* cuentas);
+
+/*
+ * Nombre: bloqueHistograma
+ *
+ * Descripción: Devuelve el histograma como bloque de datos para un punto de control y su longitud en 'bytes':
+ *              si es denso, el propio vector (estadosPosibles enteros); si es disperso, las parejas
+ *              (estado, visitas) de los estados visitados, en 'copia' (a liberar con delete[]; NULL si no hace falta).
+ *              Un bloque disperso nunca tiene la longitud de uno denso (tiene como mucho estadosPosibles / HISTOGRAMA_FRACCION_DENSO parejas).
+ *
+ */
+const void* bloqueHistograma(const Histograma& h, unsigned long long& bytes, unsigned int*& copia);
+
+/*
+ * Nombre: restaurarHistograma
+ *
+ * Descripción: Recupera en 'h' (vaciado para 'estadosPosibles' estados) un bloque obtenido con 'bloqueHistograma'.
+ *              Devuelve falso si la longitud del bloque no corresponde a ese número de estados.
+ *
+ */
+bool restaurarHistograma(Histograma& h, long long estadosPosibles, const void* datos, unsigned long long bytes);
+
+/*
+ * Nombre: sumarBloqueHistograma
+ *
+ * Descripción: Suma a 'h' (ya preparado con 'vaciarHistograma') las visitas de un bloque obtenido con 'bloqueHistograma'
+ *              para el mismo número de estados, por ejemplo para juntar los histogramas parciales de varios procesos.
+ *              Devuelve falso (sin sumar nada) si el bloque no corresponde a ese número de estados.
+ *
+ */
+bool sumarBloqueHistograma(Histograma& h, const void* datos, unsigned long long bytes);
+
+#endif
@@ -0,0 +1,209 @@
+#include <string.h>
+#include <mutex>
+#include "libmedidas.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
+
+static const char* nombresFases[NUM_FASES] = { "simulacion", "hamming", "histograma", "entropia", "analisis", "salida" };
+static const char* nombresContadores[NUM_CONTADORES] = { "actualizaciones", "estados", "bytes", "filas_periodicas", "bytes_tablas" };
+
+/*
+	Medidas globales: suma de las de los hilos que ya han terminado.
+*/
+static std::mutex cerrojoMedidas;
+static unsigned long long tiempoGlobal[NUM_FASES];
+static unsigned long long contadorGlobal[NUM_CONTADORES];
+
+/*
+	Calibración de los tics: al cargar el programa se anota el tic y el instante de steady_clock,
+	de manera que en cualquier momento se puede saber cuántos segundos dura un tic.
+*/
+static const unsigned long long ticsArranque = tics();
+static const std::chrono::steady_clock::time_point relojArranque = std::chrono::steady_clock::now();
+
+static char herramientaMedida[64] = "";
+static char argumentosMedida[1024] = "";
+static double intervaloProgreso = 0.0;
+static double siguienteProgreso = 0.0;
+
+std::atomic<unsigned long long> ticsProgreso(~0ULL);
+thread_local MedidasHilo medidasHilo;
+
+MedidasHilo::MedidasHilo()
+{
+	memset(tiempo, 0, sizeof(tiempo));
+	memset(contador, 0, sizeof(contador));
+	profundidad = 0;
+	inicio = 0;
+}
+
+MedidasHilo::~MedidasHilo()
+{
+	std::lock_guard<std::mutex> cerrojo(cerrojoMedidas);
+	for (int f = 0; f < NUM_FASES; f++)
+		tiempoGlobal[f] += tiempo[f];
+	for (int c = 0; c < NUM_CONTADORES; c++)
+		contadorGlobal[c] += contador[c];
+}
+
+static double segundosDesdeArranque()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - relojArranque).count();
+}
+
+/*
+	Segundos que dura un tic, según lo transcurrido desde el arranque del programa.
+*/
+static double segundosPorTic()
+{
+	double segundos = segundosDesdeArranque();
+	unsigned long long transcurridos = tics() - ticsArranque;
+	return transcurridos > 0 ? segundos / (double)transcurridos : 0.0;
+}
+
+static void formatearTiempo(char* texto, double segundos)
+{
+	long s = (long)(segundos + 0.5);
+	sprintf(texto, "%02ld:%02ld:%02ld", s / 3600, (s / 60) % 60, s % 60);
+}
+
+void iniciarMedidas(const char* herramienta, int argc, char** argv, double intervalo)
+{
+	strncpy(herramientaMedida, herramienta, sizeof(herramientaMedida) - 1);
+
+	// Guardamos los argumentos separados por espacios (sin comillas ni barras, que habría que escapar en el JSON)
+	argumentosMedida[0] = 0;
+	for (int a = 1; a < argc; a++) {
+		size_t usados = strlen(argumentosMedida);
+		for (const char* c = argv[a]; *c != 0 && usados < sizeof(argumentosMedida) - 2; c++)
+			if (*c != '"' && *c != '\\' && (unsigned char)*c >= ' ')
+				argumentosMedida[usados++] = *c;
+		if (a < argc - 1 && usados < sizeof(argumentosMedida) - 2)
+			argumentosMedida[usados++] = ' ';
+		argumentosMedida[usados] = 0;
+	}
+
+	intervaloProgreso = intervalo;
+	if (intervaloProgreso > 0.0) {
+		siguienteProgreso = segundosDesdeArranque() + intervaloProgreso;
+		ticsProgreso.store(0, std::memory_order_relaxed);
+	}
+	else
+		ticsProgreso.store(~0ULL, std::memory_order_relaxed);
+}
+
+void mostrarProgreso(long long hecho, long long total)
+{
+	static std::mutex cerrojoProgreso;
+	std::lock_guard<std::mutex> cerrojo(cerrojoProgreso);
+
+	double ahora = segundosDesdeArranque();
+	if (ahora >= siguienteProgreso && total > 0) {
+		char transcurrido[32], restante[32];
+		double fraccion = (double)hecho / (double)total;
+		formatearTiempo(transcurrido, ahora);
+		if (fraccion > 0.0)
+			formatearTiempo(restante, ahora * (1.0 - fraccion) / fraccion);
+		else
+			strcpy(restante, "--:--:--");
+		printf("[%s] %6.2f%% (%lld/%lld) transcurrido %s, quedan %s\n", herramientaMedida, 100.0 * fraccion, hecho, total, transcurrido, restante);
+		fflush(stdout);
+		siguienteProgreso = ahora + intervaloProgreso;
+	}
+
+	// Calculamos en tics cuándo hay que volver a comprobarlo (como mínimo dentro de 1 ms)
+	double spt = segundosPorTic();
+	double espera = siguienteProgreso - ahora;
+	if (espera < 0.001)
+		espera = 0.001;
+	ticsProgreso.store(spt > 0.0 ? tics() + (unsigned long long)(espera / spt) : 0, std::memory_order_relaxed);
+}
+
+unsigned long long memoriaPico()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return (unsigned long long)pmc.PeakWorkingSetSize;
+	return 0;
+#else
+	struct rusage uso;
+	if (getrusage(RUSAGE_SELF, &uso) != 0)
+		return 0;
+#if defined(__APPLE__)
+	return (unsigned long long)uso.ru_maxrss;				// En macOS ya viene en bytes
+#else
+	return (unsigned long long)uso.ru_maxrss * 1024ULL;		// En Linux viene en KB
+#endif
+#endif
+}
+
+bool guardarInformeMedidas(const char* nombre)
+{
+	unsigned long long tiempo[NUM_FASES];
+	unsigned long long contador[NUM_CONTADORES];
+
+	// Medidas globales más las del hilo actual (cerrando la fase que esté en curso hasta este momento)
+	MedidasHilo& m = medidasHilo;
+	unsigned long long ahora = tics();
+	if (m.profundidad > 0 && m.profundidad <= MAX_PROFUNDIDAD_FASES) {
+		m.tiempo[m.pila[m.profundidad - 1]] += ahora - m.inicio;
+		m.inicio = ahora;
+	}
+	{
+		std::lock_guard<std::mutex> cerrojo(cerrojoMedidas);
+		for (int f = 0; f < NUM_FASES; f++)
+			tiempo[f] = tiempoGlobal[f] + m.tiempo[f];
+		for (int c = 0; c < NUM_CONTADORES; c++)
+			contador[c] = contadorGlobal[c] + m.contador[c];
+	}
+
+	FILE* informe = (nombre != NULL) ? fopen(nombre, "w") : stdout;
+	if (informe == NULL)
+		return false;
+
+	double total = segundosDesdeArranque();
+	double spt = segundosPorTic();
+	double segundosFase[NUM_FASES];
+	double enFases = 0.0;
+	for (int f = 0; f < NUM_FASES; f++) {
+		segundosFase[f] = tiempo[f] * spt;
+		enFases += segundosFase[f];
+	}
+
+	fprintf(informe, "{\n");
+	fprintf(informe, "  \"herramienta\": \"%s\",\n", herramientaMedida);
+	fprintf(informe, "  \"argumentos\": \"%s\",\n", argumentosMedida);
+#ifndef ACE_SIN_MEDIDAS
+	fprintf(informe, "  \"medidas\": true,\n");
+#else
+	fprintf(informe, "  \"medidas\": false,\n");
+#endif
+	fprintf(informe, "  \"segundos_total\": %.6f,\n", total);
+	fprintf(informe, "  \"fases\": {");
+	for (int f = 0; f < NUM_FASES; f++)
+		fprintf(informe, "%s\n    \"%s\": %.6f", f == 0 ? "" : ",", nombresFases[f], segundosFase[f]);
+	fprintf(informe, ",\n    \"otros\": %.6f\n  },\n", total > enFases ? total - enFases : 0.0);
+	fprintf(informe, "  \"contadores\": {");
+	for (int c = 0; c < NUM_CONTADORES; c++)
+		fprintf(informe, "%s\n    \"%s\": %llu", c == 0 ? "" : ",", nombresContadores[c], contador[c]);
+	fprintf(informe, "\n  },\n");
+	fprintf(informe, "  \"actualizaciones_por_segundo\": %.6e,\n",
+		segundosFase[FASE_SIMULACION] > 0.0 ? contador[CONTADOR_ACTUALIZACIONES] / segundosFase[FASE_SIMULACION] : 0.0);
+	fprintf(informe, "  \"bytes_por_segundo\": %.6e,\n",
+		segundosFase[FASE_SALIDA] > 0.0 ? contador[CONTADOR_BYTES] / segundosFase[FASE_SALIDA] : 0.0);
+	fprintf(informe, "  \"memoria_pico_bytes\": %llu\n", memoriaPico());
+	fprintf(informe, "}\n");
+
+	if (informe != stdout)
+		fclose(informe);
+	return true;
+}
@@ -0,0 +1,195 @@
+#ifndef _LIBMEDIDAS_H_
+#define _LIBMEDIDAS_H_
+
+#include <stdio.h>
+#include <chrono>
+#include <atomic>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * Medidas de rendimiento de las herramientas: tiempo de cada fase, contadores de trabajo realizado,
+ * memoria máxima, líneas periódicas de progreso y un informe final en JSON.
+ *
+ * Las funciones de libACE, libguardaimagen y libcontenedor marcan sus fases y contadores con las macros MEDIR_*.
+ * Compilando con ACE_SIN_MEDIDAS definido las macros desaparecen por completo (el informe sólo contiene
+ * el tiempo total y la memoria máxima).
+ *
+ * El tiempo de las fases es exclusivo: si una fase empieza dentro de otra (generarACE dentro de generarHamming),
+ * la exterior se detiene hasta que termina la interior, de manera que la suma de todas las fases nunca supera
+ * el tiempo total. Cada hilo lleva sus propias medidas, que se acumulan a las globales cuando el hilo termina.
+ */
+
+#define FASE_SIMULACION				0		// generarACE
+#define FASE_HAMMING				1		// generarHamming (sin la simulación del segundo ACE)
+#define FASE_HISTOGRAMA				2		// Actualización de las visitas a cada estado
+#define FASE_ENTROPIA				3		// entropia
+#define FASE_ANALISIS				4		// exponenteHamming y regresion
+#define FASE_SALIDA					5		// Desde abrirSalida hasta cerrarSalida (formateo y escritura de ficheros)
+#define NUM_FASES					6
+
+#define CONTADOR_ACTUALIZACIONES	0		// Celdas actualizadas (celdas calculadas en las simulaciones)
+#define CONTADOR_ESTADOS			1		// Estados iniciales enumerados
+#define CONTADOR_BYTES				2		// Bytes escritos en los ficheros de salida
+#define CONTADOR_FILAS_PERIODICAS	3		// Filas copiadas del ciclo detectado en lugar de simularlas
+#define CONTADOR_BYTES_TABLAS		4		// Bytes de las tablas grandes proyectadas con libtablas
+#define NUM_CONTADORES				5
+
+#define MAX_PROFUNDIDAD_FASES		8		// Número máximo de fases anidadas
+
+/*
+ * Medidas de un hilo. Los tiempos se guardan en tics de 'tics()', que se convierten a segundos al hacer el informe.
+ */
+struct MedidasHilo {
+	unsigned long long tiempo[NUM_FASES];			// Tics acumulados en cada fase
+	unsigned long long contador[NUM_CONTADORES];	// Valor de cada contador
+	int pila[MAX_PROFUNDIDAD_FASES];				// Fases en curso (la última es la que está corriendo)
+	int profundidad;								// Número de fases en curso
+	unsigned long long inicio;						// Tic en el que empezó a correr la fase actual
+
+	MedidasHilo();
+	~MedidasHilo();									// Acumula las medidas del hilo a las globales
+};
+
+extern thread_local MedidasHilo medidasHilo;
+
+/*
+ * Nombre: tics
+ *
+ * Descripción: Reloj de muy bajo coste para medir las fases (contador de ciclos del procesador si existe,
+ *              si no nanosegundos de steady_clock). Los tics se convierten a segundos calibrándolos contra steady_clock.
+ *
+ */
+inline unsigned long long tics()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*
+ * Nombre: iniciarFase
+ *
+ * Descripción: Empieza a contar el tiempo de una fase (se detiene la que estuviera en curso).
+ *
+ */
+inline void iniciarFase(int fase)
+{
+	MedidasHilo& m = medidasHilo;
+	unsigned long long ahora = tics();
+	if (m.profundidad > 0)
+		m.tiempo[m.pila[m.profundidad - 1]] += ahora - m.inicio;
+	if (m.profundidad < MAX_PROFUNDIDAD_FASES)
+		m.pila[m.profundidad] = fase;
+	m.profundidad++;
+	m.inicio = ahora;
+}
+
+/*
+ * Nombre: terminarFase
+ *
+ * Descripción: Termina la última fase iniciada y continúa la anterior (si la hay).
+ *
+ */
+inline void terminarFase()
+{
+	MedidasHilo& m = medidasHilo;
+	unsigned long long ahora = tics();
+	if (m.profundidad <= 0)
+		return;
+	m.profundidad--;
+	if (m.profundidad < MAX_PROFUNDIDAD_FASES)
+		m.tiempo[m.pila[m.profundidad]] += ahora - m.inicio;
+	m.inicio = ahora;
+}
+
+/*
+ * Nombre: sumarContador
+ *
+ * Descripción: Suma 'n' al contador indicado (CONTADOR_ACTUALIZACIONES, ...).
+ *
+ */
+inline void sumarContador(int contador, unsigned long long n)
+{
+	medidasHilo.contador[contador] += n;
+}
+
+/*
+ * Nombre: mostrarProgreso
+ *
+ * Descripción: Muestra una línea con el porcentaje realizado, el tiempo transcurrido y el tiempo estimado hasta terminar.
+ *              Se llama a través de 'progresoMedidas', que sólo la llama cuando ha pasado el intervalo de progreso.
+ *
+ */
+void mostrarProgreso(long long hecho, long long total);
+
+extern std::atomic<unsigned long long> ticsProgreso;		// Tic a partir del cual toca mostrar la siguiente línea de progreso
+
+/*
+ * Nombre: progresoMedidas
+ *
+ * Descripción: Informa del trabajo realizado hasta ahora. Se puede llamar con mucha frecuencia: sólo muestra
+ *              una línea de progreso cada 'intervalo' segundos (ver 'iniciarMedidas').
+ *
+ * hecho: Unidades de trabajo terminadas.
+ * total: Unidades de trabajo totales.
+ *
+ */
+inline void progresoMedidas(long long hecho, long long total)
+{
+	if (tics() >= ticsProgreso.load(std::memory_order_relaxed))
+		mostrarProgreso(hecho, total);
+}
+
+#ifndef ACE_SIN_MEDIDAS
+#define MEDIR_INICIO(fase)				iniciarFase(fase)
+#define MEDIR_FIN()						terminarFase()
+#define MEDIR_CONTAR(contador, n)		sumarContador(contador, (unsigned long long)(n))
+#define MEDIR_PROGRESO(hecho, total)	progresoMedidas(hecho, total)
+#else
+#define MEDIR_INICIO(fase)				((void)0)
+#define MEDIR_FIN()						((void)0)
+#define MEDIR_CONTAR(contador, n)		((void)0)
+#define MEDIR_PROGRESO(hecho, total)	((void)0)
+#endif
+
+/*
+ * Nombre: iniciarMedidas
+ *
+ * Descripción: Indica la herramienta que se está midiendo y activa las líneas de progreso.
+ *
+ * herramienta: Nombre de la herramienta (aparece en el progreso y en el informe).
+ * argc, argv: Argumentos de la herramienta (se copian en el informe).
+ * intervalo: Segundos entre líneas de progreso (0: no se muestra el progreso).
+ *
+ */
+void iniciarMedidas(const char* herramienta, int argc, char** argv, double intervalo);
+
+/*
+ * Nombre: memoriaPico
+ *
+ * Descripción: Devuelve la memoria máxima (en bytes) que ha ocupado el proceso hasta el momento (0 si no se puede obtener).
+ *
+ */
+unsigned long long memoriaPico();
+
+/*
+ * Nombre: guardarInformeMedidas
+ *
+ * Descripción: Escribe en formato JSON el informe de la ejecución: tiempo total y de cada fase, contadores,
+ *              velocidades (actualizaciones por segundo y bytes por segundo) y memoria máxima.
+ *              Incluye las medidas de los hilos que ya han terminado y las del hilo que llama.
+ *
+ * nombre: Nombre del fichero del informe (si es NULL se escribe en la consola).
+ *
+ * Devuelve cierto si se pudo escribir el informe.
+ *
+ */
+bool guardarInformeMedidas(const char* nombre);
+
+#endif
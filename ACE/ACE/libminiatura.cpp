@@ -0,0 +1,205 @@
+#include <string.h>
+#include "libminiatura.h"
+#include "libguardaimagen.h"
+#include "libmedidas.h"
+
+#pragma warning ( disable: 4996 )
+
+void iniciarMiniatura(Miniatura& miniatura)
+{
+	memset(&miniatura, 0, sizeof(miniatura));
+}
+
+void liberarMiniatura(Miniatura& miniatura)
+{
+	delete[] miniatura.limites;
+	delete[] miniatura.unos;
+	delete[] miniatura.densidad;
+	iniciarMiniatura(miniatura);
+}
+
+void empezarMiniatura(Miniatura& miniatura, int anchura, int altura, int celdas, long long pasos)
+{
+	if (anchura > celdas)
+		anchura = celdas;
+	if (altura > pasos + 1)
+		altura = (int)(pasos + 1);
+
+	if (anchura > miniatura.capacidadAnchura) {
+		delete[] miniatura.limites;
+		delete[] miniatura.unos;
+		miniatura.limites = new int [anchura + 1];
+		miniatura.unos = new long long [anchura];
+		miniatura.capacidadAnchura = anchura;
+	}
+	if ((long long)anchura * altura > miniatura.capacidadPixels) {
+		delete[] miniatura.densidad;
+		miniatura.densidad = new double [(size_t)anchura * altura];
+		miniatura.capacidadPixels = (long long)anchura * altura;
+	}
+
+	miniatura.anchura = anchura;
+	miniatura.altura = altura;
+	miniatura.celdas = celdas;
+	miniatura.filas = pasos + 1;
+	for (int x = 0; x <= anchura; x++)
+		miniatura.limites[x] = (int)((long long)x * celdas / anchura);
+	memset(miniatura.unos, 0, anchura * sizeof(long long));
+	miniatura.banda = 0;
+	miniatura.fila = 0;
+	miniatura.inicioBanda = 0;
+	miniatura.finBanda = miniatura.filas / altura;
+}
+
+/*
+	Celdas a 1 en los bits [a, b) de la fila empaquetada (a < b).
+*/
+static inline long long contarUnosRango(const unsigned long long* palabras, int a, int b)
+{
+	int wa = a >> 6, wb = (b - 1) >> 6;
+	unsigned long long mascaraA = ~0ULL << (a & 63);
+	unsigned long long mascaraB = ~0ULL >> (63 - ((b - 1) & 63));
+
+	if (wa == wb)
+		return contarUnos(palabras[wa] & mascaraA & mascaraB);
+
+	long long n = contarUnos(palabras[wa] & mascaraA);
+	for (int w = wa + 1; w < wb; w++)
+		n += contarUnos(palabras[w]);
+	return n + contarUnos(palabras[wb] & mascaraB);
+}
+
+void acumularFilaMiniatura(Miniatura& miniatura, const unsigned long long* palabras)
+{
+	MEDIR_INICIO(FASE_ANALISIS);
+
+	for (int x = 0; x < miniatura.anchura; x++)
+		miniatura.unos[x] += contarUnosRango(palabras, miniatura.limites[x], miniatura.limites[x + 1]);
+
+	// Al completar la banda se calcula la densidad de sus píxeles y se empieza la siguiente
+	if (++miniatura.fila == miniatura.finBanda) {
+		double filasBanda = (double)(miniatura.finBanda - miniatura.inicioBanda);
+		double* densidad = miniatura.densidad + (size_t)miniatura.banda * miniatura.anchura;
+		for (int x = 0; x < miniatura.anchura; x++) {
+			densidad[x] = miniatura.unos[x] / ((miniatura.limites[x + 1] - miniatura.limites[x]) * filasBanda);
+			miniatura.unos[x] = 0;
+		}
+		miniatura.banda++;
+		miniatura.inicioBanda = miniatura.finBanda;
+		miniatura.finBanda = (miniatura.banda + 1) * miniatura.filas / miniatura.altura;
+	}
+
+	MEDIR_FIN();
+}
+
+/*
+	Evolución con el motor MotorACE<R, 2>: sólo se guardan la fila actual y la siguiente.
+*/
+template <int R>
+static void generarMotorMiniatura(Miniatura& miniatura, const ReglaGeneral& regla, int pasos, int celdas, const int* fila0)
+{
+	typedef MotorACE<R, 2> Motor;
+	int n = Motor::palabras(celdas);
+	unsigned long long* actual = new unsigned long long [n];
+	unsigned long long* siguiente = new unsigned long long [n];
+	unsigned long long* auxiliar = new unsigned long long [Motor::palabrasAuxiliar(celdas) + 1];
+
+	empaquetarFila(fila0, actual, celdas);
+	acumularFilaMiniatura(miniatura, actual);
+
+	for (int i = 1; i < pasos + 1; i++) {
+		Motor::paso(actual, siguiente, celdas, regla.tabla, auxiliar);
+		acumularFilaMiniatura(miniatura, siguiente);
+
+		unsigned long long* t = actual;
+		actual = siguiente;
+		siguiente = t;
+	}
+
+	delete[] actual;
+	delete[] siguiente;
+	delete[] auxiliar;
+}
+
+void generarMiniatura(Miniatura& miniatura, const ReglaGeneral& regla, int pasos, int celdas, const int* fila0)
+{
+	MEDIR_INICIO(FASE_SIMULACION);
+
+	// Una instancia del motor por cada radio (las miniaturas son de reglas de 2 estados)
+	switch (regla.radio) {
+	case 1: generarMotorMiniatura<1>(miniatura, regla, pasos, celdas, fila0); break;
+	case 2: generarMotorMiniatura<2>(miniatura, regla, pasos, celdas, fila0); break;
+	case 3: generarMotorMiniatura<3>(miniatura, regla, pasos, celdas, fila0); break;
+	}
+
+	MEDIR_CONTAR(CONTADOR_ACTUALIZACIONES, (unsigned long long)pasos * celdas);
+	MEDIR_FIN();
+}
+
+void guardarMiniatura(const Miniatura& miniatura, char* nombre)
+{
+	guardaPGMd(nombre, miniatura.anchura, miniatura.altura, miniatura.densidad, 1.0, 0.0);
+}
+
+int guardarTeselasMiniatura(const Miniatura& miniatura, const char* nombre)
+{
+	char base[256];
+	char nombreTesela[320];
+	int anchura = miniatura.anchura;
+	int altura = miniatura.altura;
+
+	// Nombre sin extensión
+	strncpy(base, nombre, sizeof(base) - 1);
+	base[sizeof(base) - 1] = 0;
+	char* punto = strrchr(base, '.');
+	if (punto != NULL)
+		*punto = 0;
+
+	// Niveles necesarios hasta que la imagen cabe en una tesela
+	int niveles = 1;
+	for (int w = anchura, h = altura; w > MINIATURA_TESELA || h > MINIATURA_TESELA; niveles++) {
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+	}
+
+	double* nivel = new double [(size_t)anchura * altura];
+	double* tesela = new double [MINIATURA_TESELA * MINIATURA_TESELA];
+	memcpy(nivel, miniatura.densidad, (size_t)anchura * altura * sizeof(double));
+
+	for (int z = niveles - 1; z >= 0; z--) {
+		// Teselas del nivel z
+		for (int ty = 0; ty * MINIATURA_TESELA < altura; ty++) {
+			for (int tx = 0; tx * MINIATURA_TESELA < anchura; tx++) {
+				int x0 = tx * MINIATURA_TESELA, y0 = ty * MINIATURA_TESELA;
+				int w = anchura - x0 < MINIATURA_TESELA ? anchura - x0 : MINIATURA_TESELA;
+				int h = altura - y0 < MINIATURA_TESELA ? altura - y0 : MINIATURA_TESELA;
+				for (int y = 0; y < h; y++)
+					memcpy(tesela + y * w, nivel + (size_t)(y0 + y) * anchura + x0, w * sizeof(double));
+				sprintf(nombreTesela, "%s_Z%02d_X%04d_Y%04d.pgm", base, z, tx, ty);
+				guardaPGMd(nombreTesela, w, h, tesela, 1.0, 0.0);
+			}
+		}
+
+		// Nivel z - 1: media de cada bloque de 2 X 2 píxeles (de 1 o 2 en los bordes si el lado es impar)
+		if (z > 0) {
+			int anchuraInferior = (anchura + 1) / 2, alturaInferior = (altura + 1) / 2;
+			for (int y = 0; y < alturaInferior; y++) {
+				for (int x = 0; x < anchuraInferior; x++) {
+					double suma = 0.0;
+					int n = 0;
+					for (int dy = 0; dy < 2 && 2 * y + dy < altura; dy++)
+						for (int dx = 0; dx < 2 && 2 * x + dx < anchura; dx++, n++)
+							suma += nivel[(size_t)(2 * y + dy) * anchura + 2 * x + dx];
+					// El nivel inferior se escribe sobre el superior, en posiciones que ya no se vuelven a leer
+					nivel[(size_t)y * anchuraInferior + x] = suma / n;
+				}
+			}
+			anchura = anchuraInferior;
+			altura = alturaInferior;
+		}
+	}
+
+	delete[] nivel;
+	delete[] tesela;
+	return niveles;
+}
@@ -0,0 +1,95 @@
+#ifndef _LIBMINIATURA_H_
+#define _LIBMINIATURA_H_
+
+#include "libACEgeneral.h"
+
+#define MINIATURA_TESELA			256		// Lado (en píxeles) de las teselas de la pirámide de resoluciones
+
+/*
+ * Imagen reducida de la evolución de un ACE de 2 estados, para evoluciones demasiado grandes para guardarlas enteras
+ * (guardaPGMiACE necesita un píxel por celda y paso). La imagen tiene un tamaño fijo anchura X altura: la columna x
+ * representa las celdas [x * celdas / anchura, (x + 1) * celdas / anchura) y la fila y los pasos de la banda
+ * [y * filas / altura, (y + 1) * filas / altura), y cada píxel es la densidad de celdas a 1 del bloque.
+ * Las filas de la evolución se reciben empaquetadas (como 'empaquetarFila') a medida que se simulan y sólo se cuentan
+ * sus bits a 1 en cada columna (contarUnos), por lo que la memoria es proporcional a la imagen y no a la evolución.
+ */
+struct Miniatura {
+	int anchura, altura;				// Píxeles de la imagen
+	int celdas;							// Celdas del ACE
+	long long filas;					// Filas de la evolución (pasos + 1)
+	int* limites;						// Primera celda (desde 0) de cada columna de la imagen (anchura + 1 posiciones)
+	long long* unos;					// Celdas a 1 de cada columna en la banda actual
+	double* densidad;					// Densidad de cada píxel (anchura * altura, por filas)
+	int capacidadAnchura;				// Columnas reservadas para 'limites' y 'unos'
+	long long capacidadPixels;			// Píxeles reservados para 'densidad'
+	int banda;							// Fila de la imagen que se está acumulando
+	long long fila;						// Filas de la evolución recibidas
+	long long inicioBanda, finBanda;	// Filas de la evolución [inicioBanda, finBanda) de la banda actual
+};
+
+/*
+ * Nombre: iniciarMiniatura
+ *
+ * Descripción: Deja la miniatura vacía (sin memoria reservada).
+ *
+ */
+void iniciarMiniatura(Miniatura& miniatura);
+
+/*
+ * Nombre: liberarMiniatura
+ *
+ * Descripción: Libera la memoria de la miniatura y la deja vacía.
+ *
+ */
+void liberarMiniatura(Miniatura& miniatura);
+
+/*
+ * Nombre: empezarMiniatura
+ *
+ * Descripción: Prepara la miniatura de anchura X altura píxeles para una evolución de 'celdas' celdas y 'pasos' pasos.
+ *              La anchura y la altura se reducen a 'celdas' y 'pasos' + 1 si son mayores (un píxel por celda y paso).
+ *              Sólo reserva memoria si la que ya tiene no basta, por lo que se puede reutilizar.
+ *
+ */
+void empezarMiniatura(Miniatura& miniatura, int anchura, int altura, int celdas, long long pasos);
+
+/*
+ * Nombre: acumularFilaMiniatura
+ *
+ * Descripción: Añade a la miniatura la siguiente fila de la evolución, empaquetada (la celda j en el bit j - 1).
+ *
+ */
+void acumularFilaMiniatura(Miniatura& miniatura, const unsigned long long* palabras);
+
+/*
+ * Nombre: generarMiniatura
+ *
+ * Descripción: Simula 'pasos' pasos de la regla de 2 estados 'regla' (de cualquier radio) a partir de la fila 'fila0'
+ *              ('celdas' + 2 posiciones, como la primera fila de 'inicializarACE') con el motor empaquetado de
+ *              libACEgeneral, entregando cada fila a la miniatura sin guardar la evolución.
+ *
+ */
+void generarMiniatura(Miniatura& miniatura, const ReglaGeneral& regla, int pasos, int celdas, const int* fila0);
+
+/*
+ * Nombre: guardarMiniatura
+ *
+ * Descripción: Guarda la miniatura como imagen PGM (con guardaPGMd: densidad 0 en blanco y 1 en negro, como ACE).
+ *
+ */
+void guardarMiniatura(const Miniatura& miniatura, char* nombre);
+
+/*
+ * Nombre: guardarTeselasMiniatura
+ *
+ * Descripción: Guarda la pirámide de resoluciones de la miniatura en teselas PGM de MINIATURA_TESELA X MINIATURA_TESELA
+ *              píxeles como máximo, <nombre sin extensión>_Z<nivel>_X<columna>_Y<fila>.pgm. El nivel más alto es la
+ *              miniatura a resolución completa y cada nivel inferior la mitad (cada píxel es la media de hasta 2 X 2
+ *              píxeles del nivel superior), hasta el nivel 0, que cabe en una sola tesela.
+ *
+ * Devuelve el número de niveles.
+ *
+ */
+int guardarTeselasMiniatura(const Miniatura& miniatura, const char* nombre);
+
+#endif
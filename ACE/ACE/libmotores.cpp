@@ -0,0 +1,408 @@
+#include <chrono>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "libmotores.h"
+#include "libACEgeneral.h"
+#include "libmedidas.h"
+
+#pragma warning ( disable: 4996 )
+
+typedef long* (*FuncionMotor)(int** ACE, int regla, int pasos, int celdas, long* estados, CicloACE* ciclo, bool rellenarFilas);
+
+/*
+	Elección guardada: motor para una regla y unos órdenes de magnitud de celdas y pasos.
+*/
+struct EleccionMotor {
+	int regla, claseCeldas, clasePasos;
+	int motor;
+};
+
+/*
+	Resultado de la verificación de un motor para una regla y un número de celdas.
+*/
+struct VerificacionMotor {
+	int motor, regla, celdas;
+	bool correcto;
+};
+
+static int motorFijado = MOTOR_REFERENCIA;		// Motor fijado con 'usarMotor'
+static char ficheroMotores[256] = "";			// Fichero de calibración (vacío: las elecciones no se guardan)
+static char equipo[256] = "";					// Identificación de la máquina en el fichero de calibración
+static EleccionMotor elecciones[MOTOR_MAX_ELECCIONES];
+static int nelecciones = 0;
+static VerificacionMotor verificaciones[MOTOR_MAX_VERIFICACIONES];
+static int nverificaciones = 0;
+static std::mutex cerrojoMotores;				// Protege las elecciones y verificaciones (hilos de trabajo)
+
+/*
+	Código de estado de una fila (la celda 1 es la cifra más significativa), como en 'generarACE'.
+*/
+static inline long codigoFila(const int* fila, int celdas)
+{
+	if (celdas >= 32)
+		return 0;
+	long codigo = 0;
+	for (int j = 1; j < celdas + 1; j++)
+		codigo = codigo * 2 + fila[j];
+	return codigo;
+}
+
+/*
+	Paso del motor de tabla: la vecindad de las celdas j + 1 ... j + 8 son los bits j ... j + 9 de la fila extendida
+	(bit 0 la celda 'celdas', bits 1 ... celdas las celdas y bit celdas + 1 la celda 1) y la tabla da las 8 celdas.
+*/
+static void pasoTabla(const unsigned long long* origen, unsigned long long* destino, int celdas, const unsigned char* tabla, unsigned long long* extendida)
+{
+	int n = palabrasFila(celdas);
+
+	for (int w = 0; w < n; w++)
+		extendida[w] = (origen[w] << 1) | (w > 0 ? origen[w - 1] >> 63 : 0);
+	extendida[n] = origen[n - 1] >> 63;
+	extendida[n + 1] = 0;
+	extendida[0] |= (origen[(celdas - 1) >> 6] >> ((celdas - 1) & 63)) & 1;
+	extendida[(celdas + 1) >> 6] |= (origen[0] & 1) << ((celdas + 1) & 63);
+
+	memset(destino, 0, n * sizeof(unsigned long long));
+	for (int j = 0; j < celdas; j += 8) {
+		int w = j >> 6, desplazamiento = j & 63;
+		unsigned long long vecindad = extendida[w] >> desplazamiento;
+		if (desplazamiento > 54)
+			vecindad |= extendida[w + 1] << (64 - desplazamiento);
+		destino[w] |= (unsigned long long)tabla[vecindad & 1023] << desplazamiento;
+	}
+	if (celdas % 64 != 0)
+		destino[n - 1] &= (1ULL << (celdas % 64)) - 1;
+}
+
+/*
+	Motores empaquetados: la fila se evoluciona empaquetada y cada paso se desempaqueta en 'ACE' con su código de estado.
+*/
+static long* generarEmpaquetado(int motor, int** ACE, int regla, int pasos, int celdas, long* estados, CicloACE* ciclo)
+{
+	int n = palabrasFila(celdas);
+	unsigned long long* actual = new unsigned long long [n];
+	unsigned long long* siguiente = new unsigned long long [n];
+	unsigned long long* auxiliar;
+	unsigned char tabla[1024];
+
+	MEDIR_INICIO(FASE_SIMULACION);
+
+	if (estados == NULL)
+		estados = new long [pasos];
+
+	if (motor == MOTOR_TABLA) {
+		// Para cada vecindad de 10 celdas (la primera en el bit 0), las 8 celdas centrales (la primera en el bit 0)
+		for (int v = 0; v < 1024; v++) {
+			tabla[v] = 0;
+			for (int k = 0; k < 8; k++) {
+				int vecindad = ((v >> k) & 1) << 2 | ((v >> (k + 1)) & 1) << 1 | ((v >> (k + 2)) & 1);
+				tabla[v] |= (unsigned char)(((regla >> vecindad) & 1) << k);
+			}
+		}
+		auxiliar = new unsigned long long [n + 2];
+	}
+	else {
+		for (int v = 0; v < 8; v++)
+			tabla[v] = (unsigned char)((regla >> v) & 1);
+		auxiliar = new unsigned long long [MotorACE<1, 2>::palabrasAuxiliar(celdas) + 1];
+	}
+
+	empaquetarFila(ACE[0], actual, celdas);
+	for (int i = 1; i < pasos + 1; i++) {
+		if (motor == MOTOR_TABLA)
+			pasoTabla(actual, siguiente, celdas, tabla, auxiliar);
+		else
+			MotorACE<1, 2>::paso(actual, siguiente, celdas, tabla, auxiliar);
+		desempaquetarFila(siguiente, ACE[i], celdas);
+		estados[i - 1] = codigoFila(ACE[i], celdas);
+
+		unsigned long long* t = actual;
+		actual = siguiente;
+		siguiente = t;
+	}
+
+	if (ciclo != NULL) {
+		ciclo->transitorio = 0;
+		ciclo->periodo = 0;
+	}
+
+	delete[] actual;
+	delete[] siguiente;
+	delete[] auxiliar;
+
+	MEDIR_CONTAR(CONTADOR_ACTUALIZACIONES, (unsigned long long)pasos * celdas);
+	MEDIR_FIN();
+
+	return estados;
+}
+
+static long* motorEmpaquetado(int** ACE, int regla, int pasos, int celdas, long* estados, CicloACE* ciclo, bool /*rellenarFilas*/)
+{
+	return generarEmpaquetado(MOTOR_EMPAQUETADO, ACE, regla, pasos, celdas, estados, ciclo);
+}
+
+static long* motorTabla(int** ACE, int regla, int pasos, int celdas, long* estados, CicloACE* ciclo, bool /*rellenarFilas*/)
+{
+	return generarEmpaquetado(MOTOR_TABLA, ACE, regla, pasos, celdas, estados, ciclo);
+}
+
+/*
+	Motores registrados (el índice es su identificador MOTOR_*)
+*/
+static const struct {
+	const char* nombre;
+	FuncionMotor generar;
+} motores[NUM_MOTORES] = {
+	{ "referencia", generarACE },
+	{ "empaquetado", motorEmpaquetado },
+	{ "tabla", motorTabla }
+};
+
+int obtenerMotor(const char* texto)
+{
+	if (strcmp(texto, "auto") == 0)
+		return MOTOR_AUTOMATICO;
+	for (int m = 0; m < NUM_MOTORES; m++)
+		if (strcmp(texto, motores[m].nombre) == 0)
+			return m;
+	return -2;
+}
+
+const char* nombreMotor(int motor)
+{
+	return (motor >= 0 && motor < NUM_MOTORES) ? motores[motor].nombre : "auto";
+}
+
+long* generarACEConMotor(int motor, int** ACE, int regla, int pasos, int celdas, long* estados, CicloACE* ciclo, bool rellenarFilas)
+{
+	return motores[motor].generar(ACE, regla, pasos, celdas, estados, ciclo, rellenarFilas);
+}
+
+/*
+	Orden de magnitud de un número de celdas o pasos (parte entera de log2).
+*/
+static int claseMotor(int n)
+{
+	int clase = 0;
+	while (n > 1) {
+		n >>= 1;
+		clase++;
+	}
+	return clase;
+}
+
+/*
+	Nombre del equipo y modelo del procesador, sin espacios.
+*/
+static void identificarEquipo(char* texto, size_t tam)
+{
+	char nombre[128] = "desconocido";
+	char procesador[128] = "desconocido";
+
+#ifdef _WIN32
+	if (getenv("COMPUTERNAME") != NULL)
+		strncpy(nombre, getenv("COMPUTERNAME"), sizeof(nombre) - 1);
+	if (getenv("PROCESSOR_IDENTIFIER") != NULL)
+		strncpy(procesador, getenv("PROCESSOR_IDENTIFIER"), sizeof(procesador) - 1);
+#else
+	gethostname(nombre, sizeof(nombre) - 1);
+	FILE* cpuinfo = fopen("/proc/cpuinfo", "r");
+	if (cpuinfo != NULL) {
+		char linea[256];
+		while (fgets(linea, sizeof(linea), cpuinfo) != NULL) {
+			char* dos = strchr(linea, ':');
+			if (strncmp(linea, "model name", strlen("model name")) == 0 && dos != NULL) {
+				strncpy(procesador, dos + 2, sizeof(procesador) - 1);
+				procesador[strcspn(procesador, "\r\n")] = 0;
+				break;
+			}
+		}
+		fclose(cpuinfo);
+	}
+#endif
+	nombre[sizeof(nombre) - 1] = 0;
+	procesador[sizeof(procesador) - 1] = 0;
+
+	snprintf(texto, tam, "%s|%s", nombre, procesador);
+	for (char* c = texto; *c != 0; c++)
+		if (*c == ' ' || *c == '\t')
+			*c = '_';
+}
+
+void usarMotor(int motor, const char* ficheroCalibracion)
+{
+	motorFijado = motor;
+	nelecciones = 0;
+	ficheroMotores[0] = 0;
+	if (motor != MOTOR_AUTOMATICO || ficheroCalibracion == NULL)
+		return;
+
+	strncpy(ficheroMotores, ficheroCalibracion, sizeof(ficheroMotores) - 1);
+	ficheroMotores[sizeof(ficheroMotores) - 1] = 0;
+	identificarEquipo(equipo, sizeof(equipo));
+
+	// Cargamos las elecciones guardadas para esta máquina
+	FILE* fichero = fopen(ficheroMotores, "r");
+	if (fichero == NULL)
+		return;
+	char linea[512], maquina[256], nombre[64];
+	EleccionMotor eleccion;
+	while (fgets(linea, sizeof(linea), fichero) != NULL && nelecciones < MOTOR_MAX_ELECCIONES) {
+		if (linea[0] == '#')
+			continue;
+		if (sscanf(linea, "%255s %d %d %d %63s", maquina, &eleccion.regla, &eleccion.claseCeldas, &eleccion.clasePasos, nombre) != 5)
+			continue;
+		eleccion.motor = obtenerMotor(nombre);
+		if (strcmp(maquina, equipo) == 0 && eleccion.motor >= 0)
+			elecciones[nelecciones++] = eleccion;
+	}
+	fclose(fichero);
+}
+
+/*
+	Fila inicial de la prueba 'prueba': la semilla y después filas aleatorias reproducibles.
+*/
+static void filaPrueba(int** ACE, int regla, int celdas, int prueba)
+{
+	GeneradorAleatorio generador;
+	iniciarGenerador(generador, (unsigned long long)regla * 1000003ULL + (unsigned long long)celdas, (unsigned long long)prueba);
+	inicializarACE(ACE, celdas, prueba == 0 ? INICIALIZACION_SEMILLA : INICIALIZACION_ALEATORIA, NULL, &generador);
+}
+
+static int pasosPrueba(int maximo, int celdas)
+{
+	int pasos = MOTOR_CELDAS_PRUEBA / celdas - 1;
+	if (pasos > maximo)
+		pasos = maximo;
+	return pasos < 1 ? 1 : pasos;
+}
+
+/*
+	Verificación diferencial (sin el cerrojo): las filas y los estados deben coincidir con los de 'generarACE'.
+*/
+static bool compararConReferencia(int motor, int regla, int celdas)
+{
+	int pasos = pasosPrueba(MOTOR_PASOS_VERIFICACION, celdas);
+	int** referencia;
+	int** ACE;
+	long* estadosReferencia = new long [pasos];
+	long* estados = new long [pasos];
+	bool correcto = true;
+
+	asignarMemoriaACE(&referencia, pasos, celdas);
+	asignarMemoriaACE(&ACE, pasos, celdas);
+	for (int prueba = 0; prueba < MOTOR_PRUEBAS_VERIFICACION && correcto; prueba++) {
+		filaPrueba(referencia, regla, celdas, prueba);
+		filaPrueba(ACE, regla, celdas, prueba);
+		generarACE(referencia, regla, pasos, celdas, estadosReferencia);
+		generarACEConMotor(motor, ACE, regla, pasos, celdas, estados);
+		for (int i = 0; i < pasos + 1 && correcto; i++)
+			correcto = (memcmp(referencia[i], ACE[i], (celdas + 2) * sizeof(int)) == 0) && (i == 0 || estadosReferencia[i - 1] == estados[i - 1]);
+	}
+	liberarMemoriaACE(referencia, pasos);
+	liberarMemoriaACE(ACE, pasos);
+	delete[] estadosReferencia;
+	delete[] estados;
+
+	if (!correcto)
+		printf("El motor %s no da el mismo resultado que generarACE (R%03d, %d celdas)... Se descarta\n", nombreMotor(motor), regla, celdas);
+	return correcto;
+}
+
+bool verificarMotor(int motor, int regla, int celdas)
+{
+	if (motor == MOTOR_REFERENCIA)
+		return true;
+
+	std::lock_guard<std::mutex> cerrojo(cerrojoMotores);
+	for (int v = 0; v < nverificaciones; v++)
+		if (verificaciones[v].motor == motor && verificaciones[v].regla == regla && verificaciones[v].celdas == celdas)
+			return verificaciones[v].correcto;
+
+	bool correcto = compararConReferencia(motor, regla, celdas);
+	if (nverificaciones < MOTOR_MAX_VERIFICACIONES) {
+		VerificacionMotor verificacion = { motor, regla, celdas, correcto };
+		verificaciones[nverificaciones++] = verificacion;
+	}
+	return correcto;
+}
+
+/*
+	Calibración: segundos de la más rápida de dos simulaciones cortas con el motor.
+*/
+static double medirMotor(int motor, int** ACE, int regla, int pasos, int celdas, long* estados)
+{
+	double mejor = 0.0;
+	for (int r = 0; r < 2; r++) {
+		filaPrueba(ACE, regla, celdas, 1);
+		std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+		generarACEConMotor(motor, ACE, regla, pasos, celdas, estados);
+		double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+		if (r == 0 || t < mejor)
+			mejor = t;
+	}
+	return mejor;
+}
+
+int elegirMotor(int regla, int celdas, int pasos)
+{
+	if (motorFijado != MOTOR_AUTOMATICO)
+		return verificarMotor(motorFijado, regla, celdas) ? motorFijado : MOTOR_REFERENCIA;
+
+	int claseCeldas = claseMotor(celdas), clasePasos = claseMotor(pasos);
+	int elegido = -1;
+	{
+		std::lock_guard<std::mutex> cerrojo(cerrojoMotores);
+		for (int e = 0; e < nelecciones && elegido < 0; e++)
+			if (elecciones[e].regla == regla && elecciones[e].claseCeldas == claseCeldas && elecciones[e].clasePasos == clasePasos)
+				elegido = elecciones[e].motor;
+	}
+	if (elegido >= 0)
+		return verificarMotor(elegido, regla, celdas) ? elegido : MOTOR_REFERENCIA;
+
+	// Calibración: se mide cada motor verificado con una simulación corta del mismo número de celdas
+	int pasosCalibracion = pasosPrueba(pasos < MOTOR_PASOS_CALIBRACION ? pasos : MOTOR_PASOS_CALIBRACION, celdas);
+	int** ACE;
+	long* estados = new long [pasosCalibracion];
+	double mejor = 0.0;
+	asignarMemoriaACE(&ACE, pasosCalibracion, celdas);
+	for (int m = 0; m < NUM_MOTORES; m++) {
+		if (!verificarMotor(m, regla, celdas))
+			continue;
+		double t = medirMotor(m, ACE, regla, pasosCalibracion, celdas, estados);
+		if (elegido < 0 || t < mejor) {
+			elegido = m;
+			mejor = t;
+		}
+	}
+	liberarMemoriaACE(ACE, pasosCalibracion);
+	delete[] estados;
+	printf("Motor elegido para R%03d (%d celdas, %d pasos): %s\n", regla, celdas, pasos, nombreMotor(elegido));
+
+	// Guardamos la elección (en memoria y, si hay fichero de calibración, para las próximas ejecuciones)
+	std::lock_guard<std::mutex> cerrojo(cerrojoMotores);
+	if (nelecciones < MOTOR_MAX_ELECCIONES) {
+		EleccionMotor eleccion = { regla, claseCeldas, clasePasos, elegido };
+		elecciones[nelecciones++] = eleccion;
+	}
+	if (ficheroMotores[0] != 0) {
+		FILE* fichero = fopen(ficheroMotores, "a");
+		if (fichero != NULL) {
+			fseek(fichero, 0, SEEK_END);
+			if (ftell(fichero) == 0)
+				fprintf(fichero, "# equipo regla log2(celdas) log2(pasos) motor\n");
+			fprintf(fichero, "%s %d %d %d %s\n", equipo, regla, claseCeldas, clasePasos, nombreMotor(elegido));
+			fclose(fichero);
+		}
+	}
+	return elegido;
+}
+
+long* generarACEMotor(int** ACE, int regla, int pasos, int celdas, long* estados, CicloACE* ciclo, bool rellenarFilas)
+{
+	return generarACEConMotor(elegirMotor(regla, celdas, pasos), ACE, regla, pasos, celdas, estados, ciclo, rellenarFilas);
+}
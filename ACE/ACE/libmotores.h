@@ -0,0 +1,98 @@
+#ifndef _LIBMOTORES_H_
+#define _LIBMOTORES_H_
+
+#include "libACE.h"
+
+#define MOTOR_AUTOMATICO			-1		// Se elige el motor más rápido calibrando (ver 'elegirMotor')
+#define MOTOR_REFERENCIA			0		// generarACE (con cono de luz, seguimiento de actividad y detección de ciclos)
+#define MOTOR_EMPAQUETADO			1		// 64 celdas por palabra evaluando la regla como árbol de selectores de bits
+#define MOTOR_TABLA					2		// 8 celdas por consulta a una tabla de 1024 entradas (vecindad de 10 celdas)
+#define NUM_MOTORES					3		// Motores registrados
+
+#define MOTOR_FICHERO_CALIBRACION	"motores.cal"	// Fichero de calibración por defecto
+
+#define MOTOR_PASOS_CALIBRACION		256		// Pasos máximos de cada simulación de calibración
+#define MOTOR_PASOS_VERIFICACION	64		// Pasos máximos de cada simulación de verificación
+#define MOTOR_PRUEBAS_VERIFICACION	4		// Filas iniciales (semilla y aleatorias) con las que se verifica cada motor
+#define MOTOR_CELDAS_PRUEBA			(1 << 22)	// Celdas máximas (filas X celdas) de las simulaciones de calibración y verificación
+#define MOTOR_MAX_ELECCIONES		4096	// Elecciones de motor recordadas (del fichero de calibración y de esta ejecución)
+#define MOTOR_MAX_VERIFICACIONES	1024	// Verificaciones (motor, regla, celdas) recordadas en esta ejecución
+
+/*
+ * Registro de motores de evolución de ACEs elementales. Todos calculan exactamente lo mismo que 'generarACE'
+ * (las filas, con sus condiciones periódicas de contorno, y los estados), pero su velocidad depende de la regla,
+ * del número de celdas y de pasos y de la máquina: 'generarACE' aprovecha el cono de luz, los bloques sin actividad
+ * y los ciclos, y los motores empaquetados calculan muchas celdas por operación aunque la evolución sea caótica.
+ *
+ * Antes de usar un motor distinto de la referencia para una regla y un número de celdas se comprueba que da lo mismo
+ * que 'generarACE' con varias filas iniciales (verificación diferencial); si no, se descarta y se usa la referencia.
+ * Con MOTOR_AUTOMATICO se mide cada motor verificado con una simulación corta y se usa el más rápido; la elección
+ * se guarda en el fichero de calibración para la máquina (nombre del equipo y procesador), la regla y el orden de
+ * magnitud (log2) de las celdas y de los pasos, de manera que en las ejecuciones siguientes no se vuelve a medir.
+ */
+
+/*
+ * Nombre: obtenerMotor
+ *
+ * Descripción: Interpreta el nombre de un motor (referencia, empaquetado, tabla o auto).
+ *
+ * Devuelve el motor (MOTOR_*) o -2 si el nombre no es válido.
+ *
+ */
+int obtenerMotor(const char* texto);
+
+/*
+ * Nombre: nombreMotor
+ *
+ * Descripción: Devuelve el nombre del motor ("auto" para MOTOR_AUTOMATICO).
+ *
+ */
+const char* nombreMotor(int motor);
+
+/*
+ * Nombre: usarMotor
+ *
+ * Descripción: Fija el motor de 'generarACEMotor' (por defecto MOTOR_REFERENCIA) y, con MOTOR_AUTOMATICO, el fichero
+ *              de calibración en el que se leen y guardan las elecciones (NULL: no se guardan entre ejecuciones).
+ *              Se debe llamar antes de lanzar hilos de trabajo.
+ *
+ */
+void usarMotor(int motor, const char* ficheroCalibracion = NULL);
+
+/*
+ * Nombre: verificarMotor
+ *
+ * Descripción: Comprueba que el motor da el mismo resultado que 'generarACE' para la regla y el número de celdas
+ *              con MOTOR_PRUEBAS_VERIFICACION filas iniciales. El resultado se recuerda durante la ejecución.
+ *
+ */
+bool verificarMotor(int motor, int regla, int celdas);
+
+/*
+ * Nombre: elegirMotor
+ *
+ * Descripción: Devuelve el motor a usar para una simulación: el fijado con 'usarMotor' si supera la verificación
+ *              o, con MOTOR_AUTOMATICO, el más rápido de los que la superan (calibrando si no hay una elección guardada).
+ *              Si ningún otro motor es válido, MOTOR_REFERENCIA.
+ *
+ */
+int elegirMotor(int regla, int celdas, int pasos);
+
+/*
+ * Nombre: generarACEConMotor
+ *
+ * Descripción: Como 'generarACE' con el motor indicado. Los motores distintos de la referencia simulan todos los pasos:
+ *              devuelven siempre periodo 0 en 'ciclo' e ignoran 'rellenarFilas'.
+ *
+ */
+long* generarACEConMotor(int motor, int** ACE, int regla, int pasos, int celdas, long* estados = NULL, CicloACE* ciclo = NULL, bool rellenarFilas = true);
+
+/*
+ * Nombre: generarACEMotor
+ *
+ * Descripción: Como 'generarACE' con el motor que devuelve 'elegirMotor'.
+ *
+ */
+long* generarACEMotor(int** ACE, int regla, int pasos, int celdas, long* estados = NULL, CicloACE* ciclo = NULL, bool rellenarFilas = true);
+
+#endif
@@ -0,0 +1,187 @@
+#include "libobservadores.h"
+#include "libguardaimagen.h"
+
+#pragma warning ( disable: 4996 )
+
+/*
+	Nombre de cada observador en la opción metricas: (en el orden de sus bits).
+*/
+static const struct {
+	const char* nombre;
+	int observador;
+} nombresObservadores[] = {
+	{ "imagen", OBSERVADOR_IMAGEN },
+	{ "hamming", OBSERVADOR_HAMMING },
+	{ "densidad", OBSERVADOR_DENSIDAD },
+	{ "estados", OBSERVADOR_ESTADOS },
+	{ "regresion", OBSERVADOR_REGRESION },
+	{ "espectro", OBSERVADOR_ESPECTRO },
+	{ "todos", OBSERVADOR_TODOS }
+};
+
+int obtenerObservadores(const char* texto)
+{
+	int activos = 0;
+
+	// Sin strtok: se usa mientras LOTES recorre las opciones de la línea con strtok
+	while (*texto != 0) {
+		const char* coma = strchr(texto, ',');
+		size_t longitud = (coma != NULL) ? (size_t)(coma - texto) : strlen(texto);
+		for (int o = 0; o < (int)(sizeof(nombresObservadores) / sizeof(nombresObservadores[0])); o++)
+			if (strlen(nombresObservadores[o].nombre) == longitud && strncmp(texto, nombresObservadores[o].nombre, longitud) == 0)
+				activos |= nombresObservadores[o].observador;
+		texto += longitud + (coma != NULL ? 1 : 0);
+	}
+	return activos;
+}
+
+void iniciarObservadores(Observadores& observadores)
+{
+	memset(&observadores, 0, sizeof(observadores));
+	iniciarHistograma(observadores.estados);
+	iniciarEspectro(observadores.espectro);
+}
+
+void liberarObservadores(Observadores& observadores)
+{
+	delete[] observadores.fila;
+	delete[] observadores.filaGemelo;
+	delete[] observadores.hamming;
+	delete[] observadores.densidad;
+	liberarHistograma(observadores.estados);
+	liberarEspectro(observadores.espectro);
+	iniciarObservadores(observadores);
+}
+
+void empezarObservadores(Observadores& observadores, int activos, int regla, int celdas, int pasos)
+{
+	if (celdas > OBSERVADOR_MAX_CELDAS_ESTADOS)
+		activos &= ~OBSERVADOR_ESTADOS;
+	observadores.activos = activos;
+	observadores.regla = regla;
+	observadores.celdas = celdas;
+	observadores.pasos = pasos;
+
+	// La memoria sólo crece: se reutiliza la de evoluciones anteriores si basta
+	if (observadores.fila == NULL || palabrasFila(celdas) > observadores.capacidadFila) {
+		delete[] observadores.fila;
+		delete[] observadores.filaGemelo;
+		observadores.capacidadFila = palabrasFila(celdas);
+		observadores.fila = new unsigned long long [observadores.capacidadFila];
+		observadores.filaGemelo = new unsigned long long [observadores.capacidadFila];
+	}
+	if (observadores.hamming == NULL || pasos + 1 > observadores.capacidadPasos) {
+		delete[] observadores.hamming;
+		delete[] observadores.densidad;
+		observadores.capacidadPasos = pasos + 1;
+		observadores.hamming = new int [observadores.capacidadPasos];
+		observadores.densidad = new double [observadores.capacidadPasos];
+	}
+
+	if (activos & OBSERVADOR_ESTADOS)
+		vaciarHistograma(observadores.estados, 1 << celdas);
+	iniciarRegresion(observadores.regresion);
+	observadores.convergido = false;
+	if (activos & OBSERVADOR_ESPECTRO)
+		empezarEspectro(observadores.espectro, celdas);
+}
+
+void observarFila(Observadores& observadores, int paso, const int* fila, const int* filaGemelo, long estado)
+{
+	int activos = observadores.activos;
+	int palabras = palabrasFila(observadores.celdas);
+
+	// Densidad: celdas a 1 de la fila empaquetada
+	if (activos & (OBSERVADOR_DENSIDAD | OBSERVADOR_HAMMING | OBSERVADOR_REGRESION))
+		empaquetarFila(fila, observadores.fila, observadores.celdas);
+	if (activos & OBSERVADOR_DENSIDAD) {
+		int unos = 0;
+		for (int w = 0; w < palabras; w++)
+			unos += contarUnos(observadores.fila[w]);
+		observadores.densidad[paso] = (double)unos / observadores.celdas;
+	}
+
+	// Distancia de Hamming: celdas distintas entre las dos filas empaquetadas
+	if (gemeloObservadores(activos)) {
+		empaquetarFila(filaGemelo, observadores.filaGemelo, observadores.celdas);
+		int distancia = 0;
+		for (int w = 0; w < palabras; w++)
+			distancia += contarUnos(observadores.fila[w] ^ observadores.filaGemelo[w]);
+		observadores.hamming[paso] = distancia;
+
+		// Como en 'exponenteHamming': puntos (log(paso + 1), log(distancia)) mientras no converjan
+		if (distancia == 0)
+			observadores.convergido = true;
+		else if (!observadores.convergido)
+			acumularRegresion(observadores.regresion, log((double)(paso + 1)), log((double)distancia));
+	}
+
+	if (activos & OBSERVADOR_ESTADOS)
+		sumarHistograma(observadores.estados, (unsigned int)estado);
+
+	if (activos & OBSERVADOR_ESPECTRO)
+		acumularFilaEspectro(observadores.espectro, fila);
+}
+
+void terminarObservadores(Observadores& observadores, int** ACE, int inicializacion, int formato)
+{
+	char nombreFichero[256];
+	int activos = observadores.activos;
+	int regla = observadores.regla, celdas = observadores.celdas, pasos = observadores.pasos;
+
+	if (activos & OBSERVADOR_IMAGEN) {
+		sprintf(nombreFichero, "ACE_R%03d_C%05d_P%05d_%s.pgm", regla, celdas, pasos, inicializacion == INICIALIZACION_ALEATORIA ? "aleatoria" : "semilla");
+		guardaPGMiACE(nombreFichero, pasos, celdas, ACE, 1, 0);
+	}
+
+	if (activos & OBSERVADOR_HAMMING) {
+		sprintf(nombreFichero, "HAMMING_R%03d_C%05d_P%05d.dat", regla, celdas, pasos);
+		if (formato & FORMATO_TEXTO)
+			guardaPLOT(nombreFichero, observadores.hamming, pasos + 1);
+		if (formato & FORMATO_NPY)
+			guardaNPY(cambiarExtension(nombreFichero, "npy"), observadores.hamming, pasos + 1);
+	}
+
+	if (activos & OBSERVADOR_DENSIDAD) {
+		sprintf(nombreFichero, "DENSIDAD_R%03d_C%05d_P%05d.dat", regla, celdas, pasos);
+		if (formato & FORMATO_TEXTO)
+			guardaPLOT(nombreFichero, observadores.densidad, pasos + 1, 0, 5);
+		if (formato & FORMATO_NPY)
+			guardaNPY(cambiarExtension(nombreFichero, "npy"), observadores.densidad, pasos + 1, 0);
+	}
+
+	if (activos & OBSERVADOR_ESTADOS) {
+		sprintf(nombreFichero, "ESTADOS_R%03d_C%05d_P%05d.dat", regla, celdas, pasos);
+		if (formato & FORMATO_TEXTO)
+			guardarHistogramaPLOT(nombreFichero, observadores.estados);
+		if (formato & FORMATO_NPY)
+			guardarHistogramaNPY(cambiarExtension(nombreFichero, "npy"), observadores.estados);
+	}
+
+	if (activos & OBSERVADOR_ESPECTRO) {
+		// Primera columna el número de onda k (o la distancia r), de 0 a celdas / 2
+		double* potencias = new double [celdas / 2 + 1];
+		double* correlacion = new double [celdas / 2 + 1];
+		resultadoEspectro(observadores.espectro, potencias, correlacion);
+		sprintf(nombreFichero, "ESPECTRO_R%03d_C%05d_P%05d.dat", regla, celdas, pasos);
+		if (formato & FORMATO_TEXTO)
+			guardaPLOT(nombreFichero, potencias, celdas / 2 + 1, 0, 6);
+		if (formato & FORMATO_NPY)
+			guardaNPY(cambiarExtension(nombreFichero, "npy"), potencias, celdas / 2 + 1, 0);
+		sprintf(nombreFichero, "CORRELACION_R%03d_C%05d_P%05d.dat", regla, celdas, pasos);
+		if (formato & FORMATO_TEXTO)
+			guardaPLOT(nombreFichero, correlacion, celdas / 2 + 1, 0, 6);
+		if (formato & FORMATO_NPY)
+			guardaNPY(cambiarExtension(nombreFichero, "npy"), correlacion, celdas / 2 + 1, 0);
+		delete[] potencias;
+		delete[] correlacion;
+	}
+
+	if (activos & OBSERVADOR_REGRESION) {
+		double eh, y0, r;
+		if (!observadores.convergido && resultadoRegresion(observadores.regresion, eh, y0, r))
+			printf("El exponente de hamming (R%03d,C%05d,P%05d) es %.5f\n", regla, celdas, pasos, eh);
+		else
+			printf("No se pudo calcular el exponente de hamming (R%03d,C%05d,P%05d)\n", regla, celdas, pasos);
+	}
+}
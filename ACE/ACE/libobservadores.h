@@ -0,0 +1,108 @@
+#ifndef _LIBOBSERVADORES_H_
+#define _LIBOBSERVADORES_H_
+
+#include "libACE.h"
+#include "libespectro.h"
+
+#define OBSERVADOR_IMAGEN			1		// Imagen PGM de la evolución (ACE_R..._C..._P..._<inicializacion>.pgm, como ACE)
+#define OBSERVADOR_HAMMING			2		// Distancia de Hamming con el ACE que difiere en la celda central (HAMMING_..., como HAMMING)
+#define OBSERVADOR_DENSIDAD			4		// Fracción de celdas a 1 en cada paso (DENSIDAD_R..._C..._P....dat)
+#define OBSERVADOR_ESTADOS			8		// Visitas a cada código de estado en toda la evolución (ESTADOS_R..._C..._P....dat)
+#define OBSERVADOR_REGRESION		16		// Exponente de Hamming, acumulando la regresión paso a paso
+#define OBSERVADOR_ESPECTRO			32		// Espectro de potencia y correlación espacial medios (ESPECTRO_... y CORRELACION_...)
+#define OBSERVADOR_TODOS			63		// Todos los observadores
+
+#define OBSERVADOR_MAX_CELDAS_ESTADOS	30	// Celdas máximas para el histograma de códigos de estado (2^30 estados)
+
+/*
+ * Análisis de una evolución en una sola pasada: cada fila de la simulación (y la del ACE gemelo, que difiere
+ * en la celda central, si algún observador la necesita) se entrega a todos los observadores activos a medida
+ * que se recorre, de manera que el ACE se simula una sola vez sea cual sea el número de medidas pedidas.
+ * Cada fila se empaqueta una vez (un bit por celda) y la densidad y la distancia de Hamming se obtienen
+ * contando bits (contarUnos) sobre las palabras empaquetadas.
+ */
+struct Observadores {
+	int activos;						// Observadores activos (OBSERVADOR_IMAGEN | OBSERVADOR_HAMMING | ...)
+	int regla, celdas, pasos;			// Parámetros de la evolución observada
+	unsigned long long* fila;			// Fila actual empaquetada
+	unsigned long long* filaGemelo;		// Fila actual del ACE gemelo empaquetada
+	int capacidadFila;					// Palabras reservadas para 'fila' y 'filaGemelo'
+	int* hamming;						// Distancia de Hamming en cada paso
+	double* densidad;					// Densidad de celdas a 1 en cada paso
+	int capacidadPasos;					// Pasos + 1 reservados para 'hamming' y 'densidad'
+	Histograma estados;					// Visitas a cada código de estado
+	AcumuladorRegresion regresion;		// Sumatorios de log(paso + 1) y log(distancia de Hamming)
+	bool convergido;					// Cierto si la distancia de Hamming llegó a 0 (no hay exponente)
+	Espectro espectro;					// Espectro de potencia medio de las filas (libespectro)
+};
+
+/*
+ * Nombre: obtenerObservadores
+ *
+ * Descripción: Interpreta una lista de observadores separados por comas (imagen, hamming, densidad, estados,
+ *              regresion, espectro o todos).
+ *
+ * Devuelve la combinación de OBSERVADOR_* correspondiente (0 si no hay ninguno válido).
+ *
+ */
+int obtenerObservadores(const char* texto);
+
+/*
+ * Nombre: gemeloObservadores
+ *
+ * Descripción: Devuelve cierto si alguno de los observadores indicados necesita la evolución del ACE gemelo.
+ *
+ */
+inline bool gemeloObservadores(int activos)
+{
+	return (activos & (OBSERVADOR_HAMMING | OBSERVADOR_REGRESION)) != 0;
+}
+
+/*
+ * Nombre: iniciarObservadores
+ *
+ * Descripción: Deja los observadores vacíos (sin memoria reservada).
+ *
+ */
+void iniciarObservadores(Observadores& observadores);
+
+/*
+ * Nombre: liberarObservadores
+ *
+ * Descripción: Libera la memoria de los observadores y los deja vacíos.
+ *
+ */
+void liberarObservadores(Observadores& observadores);
+
+/*
+ * Nombre: empezarObservadores
+ *
+ * Descripción: Prepara los observadores 'activos' para una nueva evolución. Sólo reserva memoria si la que ya
+ *              tienen no basta, por lo que se pueden reutilizar para evoluciones sucesivas.
+ *              OBSERVADOR_ESTADOS se ignora si el ACE tiene más de OBSERVADOR_MAX_CELDAS_ESTADOS celdas.
+ *
+ */
+void empezarObservadores(Observadores& observadores, int activos, int regla, int celdas, int pasos);
+
+/*
+ * Nombre: observarFila
+ *
+ * Descripción: Entrega a los observadores activos la fila 'paso' de la evolución.
+ *
+ * fila: Fila del ACE ('celdas' + 2 posiciones).
+ * filaGemelo: Fila del ACE gemelo en el mismo paso (sólo se usa si gemeloObservadores).
+ * estado: Código de estado de la fila (sólo se usa con OBSERVADOR_ESTADOS, ver 'generarACE').
+ *
+ */
+void observarFila(Observadores& observadores, int paso, const int* fila, const int* filaGemelo, long estado);
+
+/*
+ * Nombre: terminarObservadores
+ *
+ * Descripción: Guarda las salidas de los observadores activos una vez observadas todas las filas
+ *              (la imagen se guarda a partir de la evolución completa 'ACE') y muestra el exponente de Hamming.
+ *
+ */
+void terminarObservadores(Observadores& observadores, int** ACE, int inicializacion, int formato);
+
+#endif
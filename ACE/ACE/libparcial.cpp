@@ -0,0 +1,202 @@
+#include <string.h>
+#include "libparcial.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#pragma warning ( disable: 4996 )
+
+static void nombreParcial(char* nombre, size_t longitud, const char* base, int parte)
+{
+	snprintf(nombre, longitud, "%s.%d.par", base, parte);
+}
+
+bool obtenerParte(const char* texto, int& parte, int& partes)
+{
+	char resto;
+	if (sscanf(texto, "%d/%d%c", &parte, &partes, &resto) != 2)
+		return false;
+	return partes >= 1 && partes <= PARCIAL_MAX_PARTES && parte >= 0 && parte < partes;
+}
+
+void tramoParte(long long total, int parte, int partes, long long& desde, long long& hasta)
+{
+	// total < 2^39 (256 reglas de hasta 2^30 estados) y partes <= PARCIAL_MAX_PARTES, así que el producto cabe en 64 bits
+	desde = total * parte / partes;
+	hasta = total * (parte + 1) / partes;
+}
+
+bool crearParcial(Parcial& parcial, const char* base, int tipo, int celdas, int pasos, int formato, const int* reglas, int nreglas, int parte, int partes)
+{
+	char temporal[sizeof(parcial.nombre) + 8];
+
+	memset(&parcial, 0, sizeof(parcial));
+	nombreParcial(parcial.nombre, sizeof(parcial.nombre), base, parte);
+	sprintf(temporal, "%s.tmp", parcial.nombre);
+
+	CabeceraParcial& cabecera = parcial.cabecera;
+	memcpy(cabecera.magia, PARCIAL_MAGIA, sizeof(cabecera.magia));
+	cabecera.version = PARCIAL_VERSION;
+	cabecera.tipo = tipo;
+	cabecera.celdas = celdas;
+	cabecera.pasos = pasos;
+	cabecera.formato = formato;
+	cabecera.nreglas = nreglas < PARCIAL_MAX_REGLAS ? nreglas : PARCIAL_MAX_REGLAS;
+	cabecera.parte = parte;
+	cabecera.partes = partes;
+	memcpy(parcial.reglas, reglas, cabecera.nreglas * sizeof(int));
+
+	parcial.fichero = fopen(temporal, "wb");
+	if (parcial.fichero == NULL)
+		return false;
+	if (fwrite(&cabecera, sizeof(cabecera), 1, parcial.fichero) != 1 ||
+		fwrite(parcial.reglas, sizeof(int), cabecera.nreglas, parcial.fichero) != (size_t)cabecera.nreglas) {
+		fclose(parcial.fichero);
+		parcial.fichero = NULL;
+		remove(temporal);
+		return false;
+	}
+	return true;
+}
+
+bool guardarPiezaParcial(Parcial& parcial, const CabeceraPieza& pieza, const void* const* datos, const unsigned long long* bytes)
+{
+	if (parcial.fichero == NULL)
+		return false;
+
+	bool correcto = (fwrite(&pieza, sizeof(pieza), 1, parcial.fichero) == 1);
+	for (int b = 0; correcto && b < pieza.bloques; b++) {
+		correcto = fwrite(&bytes[b], sizeof(unsigned long long), 1, parcial.fichero) == 1;
+		correcto = correcto && fwrite(datos[b], 1, (size_t)bytes[b], parcial.fichero) == bytes[b];
+	}
+	if (correcto) {
+		parcial.cabecera.piezas++;
+		return true;
+	}
+
+	// Un fichero con una pieza a medias no sirve: se descarta y 'cerrarParcial' fallará
+	char temporal[sizeof(parcial.nombre) + 8];
+	sprintf(temporal, "%s.tmp", parcial.nombre);
+	fclose(parcial.fichero);
+	parcial.fichero = NULL;
+	remove(temporal);
+	return false;
+}
+
+bool cerrarParcial(Parcial& parcial)
+{
+	char temporal[sizeof(parcial.nombre) + 8];
+	sprintf(temporal, "%s.tmp", parcial.nombre);
+
+	if (parcial.fichero == NULL)
+		return false;
+
+	// La cabecera definitiva lleva el número de piezas escritas
+	bool correcto = fseek(parcial.fichero, 0, SEEK_SET) == 0 && fwrite(&parcial.cabecera, sizeof(parcial.cabecera), 1, parcial.fichero) == 1;
+
+	// Forzamos la escritura en disco antes de darle su nombre definitivo
+	correcto = correcto && fflush(parcial.fichero) == 0;
+#ifdef _WIN32
+	correcto = correcto && _commit(_fileno(parcial.fichero)) == 0;
+#else
+	correcto = correcto && fsync(fileno(parcial.fichero)) == 0;
+#endif
+	correcto = (fclose(parcial.fichero) == 0) && correcto;
+	parcial.fichero = NULL;
+
+#ifdef _WIN32
+	correcto = correcto && MoveFileExA(temporal, parcial.nombre, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	correcto = correcto && rename(temporal, parcial.nombre) == 0;
+#endif
+	if (!correcto)
+		remove(temporal);
+	return correcto;
+}
+
+bool abrirParcial(Parcial& parcial, const char* base, int parte)
+{
+	memset(&parcial, 0, sizeof(parcial));
+	nombreParcial(parcial.nombre, sizeof(parcial.nombre), base, parte);
+
+	parcial.fichero = fopen(parcial.nombre, "rb");
+	if (parcial.fichero == NULL)
+		return false;
+
+	CabeceraParcial& cabecera = parcial.cabecera;
+	if (fread(&cabecera, sizeof(cabecera), 1, parcial.fichero) != 1 || memcmp(cabecera.magia, PARCIAL_MAGIA, sizeof(cabecera.magia)) != 0 ||
+		cabecera.version != PARCIAL_VERSION || cabecera.nreglas < 0 || cabecera.nreglas > PARCIAL_MAX_REGLAS ||
+		cabecera.partes < 1 || cabecera.partes > PARCIAL_MAX_PARTES || cabecera.parte != parte || cabecera.piezas < 0 ||
+		fread(parcial.reglas, sizeof(int), cabecera.nreglas, parcial.fichero) != (size_t)cabecera.nreglas) {
+		liberarParcial(parcial);
+		return false;
+	}
+
+	// Dejamos leída la primera pieza
+	parcial.leidas = 0;
+	if (!siguientePiezaParcial(parcial)) {
+		liberarParcial(parcial);
+		return false;
+	}
+	return true;
+}
+
+bool siguientePiezaParcial(Parcial& parcial)
+{
+	parcial.hayPieza = false;
+	if (parcial.fichero == NULL || parcial.leidas >= parcial.cabecera.piezas)
+		return parcial.fichero != NULL;
+
+	CabeceraPieza& pieza = parcial.pieza;
+	if (fread(&pieza, sizeof(pieza), 1, parcial.fichero) != 1 || pieza.bloques < 0 || pieza.bloques > PARCIAL_MAX_BLOQUES)
+		return false;
+
+	// Leemos los bloques uno detrás de otro, ampliando el buffer si hace falta
+	unsigned long long p = 0;
+	for (int b = 0; b < pieza.bloques; b++) {
+		unsigned long long bytes;
+		if (fread(&bytes, sizeof(bytes), 1, parcial.fichero) != 1)
+			return false;
+		if (p + bytes > parcial.capacidad) {
+			unsigned long long capacidad = 2 * (p + bytes);
+			unsigned char* datos = new unsigned char [(size_t)capacidad];
+			if (p > 0)
+				memcpy(datos, parcial.datos, (size_t)p);
+			delete[] parcial.datos;
+			parcial.datos = datos;
+			parcial.capacidad = capacidad;
+		}
+		if (fread(parcial.datos + p, 1, (size_t)bytes, parcial.fichero) != bytes)
+			return false;
+		parcial.bytes[b] = bytes;
+		parcial.posicion[b] = p;
+		p += bytes;
+	}
+
+	parcial.leidas++;
+	parcial.hayPieza = true;
+	return true;
+}
+
+const void* bloquePiezaParcial(const Parcial& parcial, int bloque, unsigned long long& bytes)
+{
+	if (!parcial.hayPieza || bloque < 0 || bloque >= parcial.pieza.bloques)
+		return NULL;
+	bytes = parcial.bytes[bloque];
+	return parcial.datos + parcial.posicion[bloque];
+}
+
+void liberarParcial(Parcial& parcial)
+{
+	if (parcial.fichero != NULL)
+		fclose(parcial.fichero);
+	parcial.fichero = NULL;
+	delete[] parcial.datos;
+	parcial.datos = NULL;
+	parcial.capacidad = 0;
+	parcial.hayPieza = false;
+}
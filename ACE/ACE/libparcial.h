@@ -0,0 +1,158 @@
+#ifndef _LIBPARCIAL_H_
+#define _LIBPARCIAL_H_
+
+#include <stdio.h>
+
+#define PARCIAL_MAGIA				"ACEPARC"	// Identificador al inicio de los ficheros de resultados parciales
+#define PARCIAL_VERSION				1			// Versión del formato de los ficheros de resultados parciales
+#define PARCIAL_MAX_REGLAS			256			// Número máximo de reglas de la lista guardada
+#define PARCIAL_MAX_BLOQUES			5003		// Número máximo de bloques de datos de una pieza
+#define PARCIAL_MAX_PARTES			4096		// Número máximo de partes en que se puede dividir una ejecución
+
+/*
+ * Una ejecución de ATRACTOR o ENTROPIA se puede repartir entre 'partes' procesos independientes (opción parte:i/n).
+ * Cada regla se recorre estado a estado (ENTROPIA recorre los estados de ENTROPIA_N_MIN celdas, después los de
+ * ENTROPIA_N_MIN + 1, ...) y el recorrido de todas las reglas de la lista, una detrás de otra, se divide en 'partes'
+ * tramos consecutivos de la misma longitud: a cada proceso le tocan unas pocas reglas, o un trozo de una sola,
+ * siempre igual para los mismos parámetros. Cada proceso guarda sus resultados parciales en <base>.<parte>.par
+ * y FUSIONAR los suma para obtener las mismas salidas que la ejecución completa. Como los tramos van en el orden
+ * del recorrido, FUSIONAR puede leer los ficheros uno detrás de otro sin tener más de uno abierto.
+ *
+ * Formato de un fichero de resultados parciales:
+ *
+ * - Cabecera (CabeceraParcial).
+ * - 'nreglas' enteros con la lista de reglas de la ejecución.
+ * - 'piezas' piezas, cada una con su cabecera (CabeceraPieza) y sus 'bloques' bloques de datos,
+ *   cada bloque precedido de su longitud en bytes (unsigned long long).
+ *
+ * Las piezas van en el orden del recorrido (regla y número de celdas crecientes). El fichero se escribe con otro nombre
+ * (terminado en .tmp) y se renombra al terminar, de manera que sólo existe si la parte se completó.
+ */
+struct CabeceraParcial {
+	char magia[8];						// PARCIAL_MAGIA
+	int version;						// PARCIAL_VERSION
+	int tipo;							// Herramienta (TRABAJO_ATRACTOR o TRABAJO_ENTROPIA)
+	int celdas;							// Celdas del ACE (si la herramienta las usa)
+	int pasos;							// Pasos de evolución
+	int formato;						// Formato de las series (FORMATO_TEXTO, ...)
+	int nreglas;						// Número de reglas de la lista
+	int parte;							// Parte guardada en el fichero (de 0 a partes - 1)
+	int partes;							// Número de partes de la ejecución
+	int piezas;							// Número de piezas del fichero
+};
+
+/*
+ * Resultados de un tramo de estados de una regla (y de un número de celdas en ENTROPIA).
+ */
+struct CabeceraPieza {
+	int indiceRegla;					// Posición de la regla en la lista
+	int regla;							// Regla
+	int N;								// Número de celdas del ACE
+	int bloques;						// Número de bloques de datos
+	long long desde, hasta;				// Estados iniciales simulados: [desde, hasta)
+};
+
+/*
+ * Fichero de resultados parciales abierto para escribir o para leer pieza a pieza.
+ */
+struct Parcial {
+	char nombre[256];					// Fichero de resultados parciales
+	FILE* fichero;						// Fichero abierto (el temporal al escribir)
+	CabeceraParcial cabecera;			// Cabecera del fichero
+	int reglas[PARCIAL_MAX_REGLAS];		// Lista de reglas de la ejecución
+	int leidas;							// Piezas leídas hasta ahora
+	bool hayPieza;						// Cierto si 'pieza' contiene la siguiente pieza sin consumir
+	CabeceraPieza pieza;				// Última pieza leída
+	unsigned char* datos;				// Datos de la última pieza leída (todos los bloques seguidos)
+	unsigned long long capacidad;		// Bytes reservados para 'datos'
+	unsigned long long bytes[PARCIAL_MAX_BLOQUES];		// Longitud de cada bloque de la pieza
+	unsigned long long posicion[PARCIAL_MAX_BLOQUES];	// Posición de cada bloque de la pieza dentro de 'datos'
+};
+
+/*
+ * Nombre: obtenerParte
+ *
+ * Descripción: Interpreta el valor de la opción parte:i/n (parte 'i' de 'n', con 0 <= i < n <= PARCIAL_MAX_PARTES).
+ *
+ * Devuelve falso si el texto no tiene ese formato.
+ *
+ */
+bool obtenerParte(const char* texto, int& parte, int& partes);
+
+/*
+ * Nombre: tramoParte
+ *
+ * Descripción: Devuelve en [desde, hasta) el tramo que le corresponde a la parte 'parte' de 'partes' de un recorrido
+ *              de 'total' posiciones. Los tramos son consecutivos, no se solapan y cubren todo el recorrido.
+ *
+ */
+void tramoParte(long long total, int parte, int partes, long long& desde, long long& hasta);
+
+/*
+ * Nombre: crearParcial
+ *
+ * Descripción: Crea el fichero de resultados parciales <base>.<parte>.par (primero como temporal) con la cabecera
+ *              de la ejecución. Las piezas se añaden con 'guardarPiezaParcial' y el fichero se completa con 'cerrarParcial'.
+ *
+ * Devuelve falso si no se pudo crear.
+ *
+ */
+bool crearParcial(Parcial& parcial, const char* base, int tipo, int celdas, int pasos, int formato, const int* reglas, int nreglas, int parte, int partes);
+
+/*
+ * Nombre: guardarPiezaParcial
+ *
+ * Descripción: Añade una pieza con los bloques de datos indicados al fichero de resultados parciales.
+ *
+ * Devuelve falso si no se pudo escribir (el fichero se descarta y 'cerrarParcial' también devolverá falso).
+ *
+ */
+bool guardarPiezaParcial(Parcial& parcial, const CabeceraPieza& pieza, const void* const* datos, const unsigned long long* bytes);
+
+/*
+ * Nombre: cerrarParcial
+ *
+ * Descripción: Completa la cabecera, fuerza la escritura en disco y da al fichero su nombre definitivo.
+ *
+ * Devuelve falso si no se pudo completar (en ese caso se borra el temporal).
+ *
+ */
+bool cerrarParcial(Parcial& parcial);
+
+/*
+ * Nombre: abrirParcial
+ *
+ * Descripción: Abre para leer el fichero de resultados parciales <base>.<parte>.par y lee su cabecera y la primera pieza.
+ *
+ * Devuelve falso si no existe o no es un fichero de resultados parciales válido.
+ *
+ */
+bool abrirParcial(Parcial& parcial, const char* base, int parte);
+
+/*
+ * Nombre: siguientePiezaParcial
+ *
+ * Descripción: Da por consumida la pieza actual y lee la siguiente (hayPieza queda falso al acabar las piezas).
+ *
+ * Devuelve falso si el fichero está incompleto o dañado.
+ *
+ */
+bool siguientePiezaParcial(Parcial& parcial);
+
+/*
+ * Nombre: bloquePiezaParcial
+ *
+ * Descripción: Devuelve el bloque 'bloque' de la pieza actual y su longitud en 'bytes' (NULL si no existe).
+ *
+ */
+const void* bloquePiezaParcial(const Parcial& parcial, int bloque, unsigned long long& bytes);
+
+/*
+ * Nombre: liberarParcial
+ *
+ * Descripción: Cierra el fichero de resultados parciales leído y libera sus datos.
+ *
+ */
+void liberarParcial(Parcial& parcial);
+
+#endif
@@ -0,0 +1,310 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "libACE.h"
+#include "libmedidas.h"
+#include "libsucesores.h"
+#include "libpreimagenes.h"
+
+#pragma warning ( disable: 4996 )
+
+#define DIAGONAL_BOOLEANA			0x8421		// Bits de la diagonal de una matriz booleana 4 X 4 (fila s en los bits 4s..4s+3)
+
+/*
+	Producto entero de las matrices de transferencia, con el peso (2^-celdas) y el número de los estados que llevan a él.
+*/
+struct ProductoPreimagenes {
+	double m[16];						// Matriz 4 X 4 por filas (fila: pareja inicial, columna: pareja actual)
+	double masa;						// Fracción de los estados (de las celdas añadidas hasta ahora) con este producto
+	unsigned long long cuenta;			// Número de esos estados
+};
+
+/*
+	Valor (0 o 1) que da la regla en la arista p = (a, b) -> q = (b, c) del grafo de de Bruijn (vecindad a, b, c).
+*/
+static inline int etiqueta(int regla, int p, int q)
+{
+	return (regla >> ((p << 1) | (q & 1))) & 1;
+}
+
+/*
+	Filas booleanas de las matrices de transferencia: parejas a las que se llega desde las parejas de 'fila'
+	(un bit por pareja) por una arista con etiqueta b.
+*/
+static void filasBooleanas(int regla, unsigned short siguiente[2][16])
+{
+	for (int b = 0; b < 2; b++) {
+		for (int fila = 0; fila < 16; fila++) {
+			siguiente[b][fila] = 0;
+			for (int p = 0; p < 4; p++) {
+				if (!(fila & (1 << p)))
+					continue;
+				for (int c = 0; c < 2; c++) {
+					int q = ((p & 1) << 1) | c;
+					if (etiqueta(regla, p, q) == b)
+						siguiente[b][fila] |= (unsigned short)(1 << q);
+				}
+			}
+		}
+	}
+}
+
+/*
+	Producto entero 'destino' = 'origen' · M(b).
+*/
+static inline void multiplicarTransferencia(int regla, const double* origen, int b, double* destino)
+{
+	for (int s = 0; s < 4; s++) {
+		for (int q = 0; q < 4; q++) {
+			// A la pareja q = (c, d) se llega desde las parejas (a, c)
+			double suma = 0.0;
+			for (int a = 0; a < 2; a++) {
+				int p = (a << 1) | (q >> 1);
+				if (etiqueta(regla, p, q) == b)
+					suma += origen[s * 4 + p];
+			}
+			destino[s * 4 + q] = suma;
+		}
+	}
+}
+
+double contarPreimagenes(int regla, const int* fila, int celdas)
+{
+	double producto[16], siguiente[16];
+
+	memset(producto, 0, sizeof(producto));
+	for (int s = 0; s < 4; s++)
+		producto[s * 4 + s] = 1.0;
+
+	for (int j = 1; j <= celdas; j++) {
+		multiplicarTransferencia(regla, producto, fila[j], siguiente);
+		memcpy(producto, siguiente, sizeof(producto));
+	}
+	return producto[0] + producto[5] + producto[10] + producto[15];
+}
+
+void fraccionJardinesEden(int regla, int NMin, int NMax, double* fraccion, unsigned long long* cuentas)
+{
+	unsigned short siguiente[2][16];
+	double* masa[2];
+	unsigned long long* cuenta[2];
+	unsigned short* lista[2];
+	int* marca = new int [65536];
+	int n = 1, actual = 0;
+
+	MEDIR_INICIO(FASE_ANALISIS);
+
+	filasBooleanas(regla, siguiente);
+	for (int k = 0; k < 2; k++) {
+		masa[k] = new double [65536];
+		cuenta[k] = new unsigned long long [65536];
+		lista[k] = new unsigned short [65536];
+		memset(masa[k], 0, 65536 * sizeof(double));
+		memset(cuenta[k], 0, 65536 * sizeof(unsigned long long));
+	}
+	memset(marca, 0, 65536 * sizeof(int));
+
+	// Sin celdas, el producto es la identidad
+	lista[0][0] = DIAGONAL_BOOLEANA;
+	masa[0][DIAGONAL_BOOLEANA] = 1.0;
+	cuenta[0][DIAGONAL_BOOLEANA] = 1;
+
+	for (int N = 1; N <= NMax; N++) {
+		int otro = 1 - actual, m = 0;
+
+		// Cada producto booleano se extiende con una celda a 0 y con una celda a 1
+		for (int i = 0; i < n; i++) {
+			unsigned short R = lista[actual][i];
+			for (int b = 0; b < 2; b++) {
+				unsigned short S = 0;
+				for (int s = 0; s < 4; s++)
+					S |= (unsigned short)(siguiente[b][(R >> (4 * s)) & 15] << (4 * s));
+				if (marca[S] != N) {
+					marca[S] = N;
+					lista[otro][m++] = S;
+				}
+				masa[otro][S] += 0.5 * masa[actual][R];
+				cuenta[otro][S] += cuenta[actual][R];
+			}
+			masa[actual][R] = 0.0;
+			cuenta[actual][R] = 0;
+		}
+		n = m;
+		actual = otro;
+
+		if (N >= NMin) {
+			double f = 0.0;
+			unsigned long long c = 0;
+			for (int i = 0; i < n; i++) {
+				unsigned short R = lista[actual][i];
+				if ((R & DIAGONAL_BOOLEANA) == 0) {
+					f += masa[actual][R];
+					c += cuenta[actual][R];
+				}
+			}
+			fraccion[N - NMin] = f;
+			if (cuentas != NULL)
+				cuentas[N - NMin] = N <= PREIMAGENES_CELDAS_EXACTAS ? c : 0;
+		}
+	}
+
+	for (int k = 0; k < 2; k++) {
+		delete[] masa[k];
+		delete[] cuenta[k];
+		delete[] lista[k];
+	}
+	delete[] marca;
+
+	MEDIR_FIN();
+}
+
+static bool menorProducto(const ProductoPreimagenes& a, const ProductoPreimagenes& b)
+{
+	return memcmp(a.m, b.m, sizeof(a.m)) < 0;
+}
+
+static bool menorTraza(const ProductoPreimagenes& a, const ProductoPreimagenes& b)
+{
+	return a.m[0] < b.m[0];
+}
+
+int distribucionPreimagenes(int regla, int celdas, double** preimagenes, double** fraccion, unsigned long long** cuentas)
+{
+	ProductoPreimagenes* productos = new ProductoPreimagenes [1];
+	int n = 1;
+	bool correcto = true;
+
+	MEDIR_INICIO(FASE_ANALISIS);
+
+	memset(productos, 0, sizeof(ProductoPreimagenes));
+	for (int s = 0; s < 4; s++)
+		productos[0].m[s * 4 + s] = 1.0;
+	productos[0].masa = 1.0;
+	productos[0].cuenta = 1;
+
+	for (int N = 1; N <= celdas && correcto; N++) {
+		// Cada producto se extiende con una celda a 0 y con una celda a 1
+		ProductoPreimagenes* siguientes = new ProductoPreimagenes [2 * (size_t)n];
+		for (int i = 0; i < n; i++) {
+			for (int b = 0; b < 2; b++) {
+				ProductoPreimagenes& p = siguientes[2 * i + b];
+				multiplicarTransferencia(regla, productos[i].m, b, p.m);
+				p.masa = 0.5 * productos[i].masa;
+				p.cuenta = productos[i].cuenta;
+			}
+		}
+		delete[] productos;
+
+		// Se juntan los productos iguales
+		std::sort(siguientes, siguientes + 2 * (size_t)n, menorProducto);
+		int m = 0;
+		for (int i = 0; i < 2 * n; i++) {
+			if (m > 0 && memcmp(siguientes[m - 1].m, siguientes[i].m, sizeof(siguientes[i].m)) == 0) {
+				siguientes[m - 1].masa += siguientes[i].masa;
+				siguientes[m - 1].cuenta += siguientes[i].cuenta;
+			}
+			else
+				siguientes[m++] = siguientes[i];
+		}
+		productos = siguientes;
+		n = m;
+		correcto = n <= PREIMAGENES_MAX_MATRICES;
+	}
+
+	int valores = -1;
+	if (correcto) {
+		// Se agrupan los estados por la traza de su producto (en m[0])
+		for (int i = 0; i < n; i++)
+			productos[i].m[0] += productos[i].m[5] + productos[i].m[10] + productos[i].m[15];
+		std::sort(productos, productos + n, menorTraza);
+
+		*preimagenes = new double [n];
+		*fraccion = new double [n];
+		if (cuentas != NULL)
+			*cuentas = new unsigned long long [n];
+		valores = 0;
+		for (int i = 0; i < n; i++) {
+			if (valores == 0 || (*preimagenes)[valores - 1] != productos[i].m[0]) {
+				(*preimagenes)[valores] = productos[i].m[0];
+				(*fraccion)[valores] = 0.0;
+				if (cuentas != NULL)
+					(*cuentas)[valores] = 0;
+				valores++;
+			}
+			(*fraccion)[valores - 1] += productos[i].masa;
+			if (cuentas != NULL)
+				(*cuentas)[valores - 1] += productos[i].cuenta;
+		}
+		if (cuentas != NULL && celdas > PREIMAGENES_CELDAS_EXACTAS)
+			memset(*cuentas, 0, valores * sizeof(unsigned long long));
+	}
+	delete[] productos;
+
+	MEDIR_FIN();
+
+	return valores;
+}
+
+bool verificarPreimagenes(int regla)
+{
+	int fila[PREIMAGENES_N_VERIFICACION + 2];
+	double fraccion[PREIMAGENES_N_VERIFICACION];
+	unsigned long long jardines[PREIMAGENES_N_VERIFICACION];
+
+	fraccionJardinesEden(regla, 3, PREIMAGENES_N_VERIFICACION, fraccion, jardines);
+
+	for (int N = 3; N <= PREIMAGENES_N_VERIFICACION; N++) {
+		unsigned int estadosPosibles = 1u << N;
+		unsigned int* sucesor = new unsigned int [estadosPosibles];
+		int* preimagenes = new int [estadosPosibles];
+		bool correcto = true;
+
+		// Enumeración: preimágenes de cada estado según la tabla de sucesores
+		calcularSucesores(sucesor, regla, N);
+		memset(preimagenes, 0, estadosPosibles * sizeof(int));
+		for (unsigned int e = 0; e < estadosPosibles; e++)
+			preimagenes[sucesor[e]]++;
+
+		unsigned long long sinPreimagenes = 0;
+		for (unsigned int e = 0; e < estadosPosibles; e++)
+			if (preimagenes[e] == 0)
+				sinPreimagenes++;
+		correcto = sinPreimagenes == jardines[N - 3] && fraccion[N - 3] == (double)sinPreimagenes / estadosPosibles;
+
+		// Distribución: cada número de preimágenes con el número de estados que lo tienen
+		double* valores;
+		double* fracciones;
+		unsigned long long* cuentas;
+		int n = distribucionPreimagenes(regla, N, &valores, &fracciones, &cuentas);
+		if (n >= 0) {
+			unsigned long long total = 0;
+			for (int i = 0; i < n && correcto; i++) {
+				unsigned long long c = 0;
+				for (unsigned int e = 0; e < estadosPosibles; e++)
+					if (preimagenes[e] == (int)valores[i])
+						c++;
+				correcto = c == cuentas[i] && fracciones[i] == (double)c / estadosPosibles;
+				total += c;
+			}
+			correcto = correcto && total == estadosPosibles;
+			delete[] valores;
+			delete[] fracciones;
+			delete[] cuentas;
+		}
+
+		// Traza del producto de cada estado (sólo hasta 10 celdas)
+		for (unsigned int e = 0; e < estadosPosibles && correcto && N <= 10; e++) {
+			generarEstadoInicial(fila, (int)e, N);
+			correcto = contarPreimagenes(regla, fila, N) == (double)preimagenes[e];
+		}
+
+		delete[] sucesor;
+		delete[] preimagenes;
+
+		if (!correcto) {
+			printf("Las preimágenes exactas de la regla %d con %d celdas no coinciden con la enumeración de los estados\n", regla, N);
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,70 @@
+#ifndef _LIBPREIMAGENES_H_
+#define _LIBPREIMAGENES_H_
+
+#define PREIMAGENES_MAX_CELDAS		100000		// Celdas máximas de los cálculos exactos
+#define PREIMAGENES_CELDAS_EXACTAS	63			// Hasta estas celdas las cuentas de estados caben en 64 bits
+#define PREIMAGENES_MAX_MATRICES	(1 << 18)	// Productos de matrices distintos máximos al calcular una distribución
+#define PREIMAGENES_N_VERIFICACION	16			// Celdas máximas con las que se comprueba contra la enumeración de estados
+
+/*
+ * Preimágenes de un paso de un ACE elemental en un anillo de N celdas, sin enumerar los 2^N estados.
+ *
+ * Las preimágenes de una fila y = (y1, ..., yN) son las filas x con f(x[i-1], x[i], x[i+1]) = y[i] en cada celda
+ * (con condiciones periódicas). Son los caminos cerrados de longitud N en el grafo de de Bruijn de parejas de celdas
+ * (x[i-1], x[i]) -> (x[i], x[i+1]) cuyas aristas tienen la etiqueta y[i], es decir, la traza del producto
+ * M(y1) · M(y2) · ... · M(yN) de las dos matrices de transferencia 4 X 4 (M(b) tiene un 1 en cada arista de etiqueta b).
+ *
+ * Un estado no tiene preimágenes (es un Jardín del Edén) si la diagonal del producto es 0, lo que sólo depende del
+ * producto booleano de las matrices. Los productos booleanos distintos son como mucho 2^16, de manera que se puede
+ * contar a la vez cuántos de los 2^N estados llevan a cada uno, añadiendo una celda cada vez: el coste es lineal en N.
+ * Con productos enteros se obtiene igual la distribución del número de preimágenes mientras los productos distintos
+ * no pasen de PREIMAGENES_MAX_MATRICES.
+ *
+ * Las fracciones se acumulan en reales (cada estado de N celdas pesa 2^-N): son exactas hasta 53 celdas y
+ * con precisión doble a partir de ahí. Las cuentas enteras sólo se dan hasta PREIMAGENES_CELDAS_EXACTAS celdas.
+ */
+
+/*
+ * Nombre: contarPreimagenes
+ *
+ * Descripción: Número de preimágenes de la fila 'fila' (como la de un ACE: 'celdas' + 2 posiciones, la celda j en
+ *              fila[j]) por la regla 'regla'. Exacto mientras no pase de 2^53.
+ *
+ */
+double contarPreimagenes(int regla, const int* fila, int celdas);
+
+/*
+ * Nombre: fraccionJardinesEden
+ *
+ * Descripción: Para anillos de NMin a NMax celdas, fracción de los estados sin preimágenes por la regla 'regla'
+ *              (los que no se alcanzan en un paso desde ningún estado) en 'fraccion' y, si no es NULL, su número
+ *              en 'cuentas' (0 a partir de PREIMAGENES_CELDAS_EXACTAS celdas). 1 <= NMin <= NMax.
+ *
+ */
+void fraccionJardinesEden(int regla, int NMin, int NMax, double* fraccion, unsigned long long* cuentas = NULL);
+
+/*
+ * Nombre: distribucionPreimagenes
+ *
+ * Descripción: Distribución del número de preimágenes de los estados de un anillo de 'celdas' celdas por la regla
+ *              'regla': en 'preimagenes' los números de preimágenes que aparecen, en orden creciente, en 'fraccion'
+ *              la fracción de los estados con cada uno y, si no es NULL, en 'cuentas' cuántos estados son (0 a partir
+ *              de PREIMAGENES_CELDAS_EXACTAS celdas). Los vectores se reservan aquí (a liberar con delete[]).
+ *
+ * Devuelve el número de valores distintos o -1 si los productos de matrices distintos superan PREIMAGENES_MAX_MATRICES.
+ *
+ */
+int distribucionPreimagenes(int regla, int celdas, double** preimagenes, double** fraccion, unsigned long long** cuentas = NULL);
+
+/*
+ * Nombre: verificarPreimagenes
+ *
+ * Descripción: Comprueba 'fraccionJardinesEden' y 'distribucionPreimagenes' contra la enumeración de todos los
+ *              estados con la tabla de sucesores, para anillos de 3 a PREIMAGENES_N_VERIFICACION celdas.
+ *
+ * Devuelve falso (indicando la primera diferencia por pantalla) si algún resultado no coincide.
+ *
+ */
+bool verificarPreimagenes(int regla);
+
+#endif
@@ -0,0 +1,193 @@
+#include <string.h>
+#include <chrono>
+#include "libACE.h"
+#include "libpuntocontrol.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#pragma warning ( disable: 4996 )
+
+// Posicionamiento en ficheros de más de 2 GB
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+static double segundosPuntoControl()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void iniciarPuntoControl(PuntoControl& control, const char* nombre, double intervalo, int tipo, int celdas, int pasos, int formato, const int* reglas, int nreglas)
+{
+	memset(&control.cabecera, 0, sizeof(control.cabecera));
+	memcpy(control.cabecera.magia, PUNTOCONTROL_MAGIA, sizeof(control.cabecera.magia));
+	control.cabecera.version = PUNTOCONTROL_VERSION;
+	control.cabecera.tipo = tipo;
+	control.cabecera.celdas = celdas;
+	control.cabecera.pasos = pasos;
+	control.cabecera.formato = formato;
+	control.cabecera.nreglas = nreglas < PUNTOCONTROL_MAX_REGLAS ? nreglas : PUNTOCONTROL_MAX_REGLAS;
+	memcpy(control.reglas, reglas, control.cabecera.nreglas * sizeof(int));
+
+	strncpy(control.nombre, nombre, sizeof(control.nombre) - 1);
+	control.nombre[sizeof(control.nombre) - 1] = 0;
+	control.intervalo = intervalo;
+	control.ultimo = segundosPuntoControl();
+	control.reanudar = false;
+	control.datos = NULL;
+}
+
+bool leerPuntoControl(PuntoControl& control, const char* nombre, double intervalo)
+{
+	FILE* fichero = fopen(nombre, "rb");
+	if (fichero == NULL)
+		return false;
+
+	control.datos = NULL;
+	CabeceraPuntoControl& cabecera = control.cabecera;
+	if (fread(&cabecera, sizeof(cabecera), 1, fichero) != 1 || memcmp(cabecera.magia, PUNTOCONTROL_MAGIA, sizeof(cabecera.magia)) != 0 ||
+		cabecera.version != PUNTOCONTROL_VERSION || cabecera.nreglas < 0 || cabecera.nreglas > PUNTOCONTROL_MAX_REGLAS ||
+		cabecera.bloques < 0 || cabecera.bloques > PUNTOCONTROL_MAX_BLOQUES ||
+		fread(control.reglas, sizeof(int), cabecera.nreglas, fichero) != (size_t)cabecera.nreglas) {
+		fclose(fichero);
+		return false;
+	}
+
+	// El resto del fichero son los bloques: lo leemos entero y anotamos dónde empieza cada uno
+	long long inicio = ftell64(fichero);
+	fseek64(fichero, 0, SEEK_END);
+	unsigned long long longitud = (unsigned long long)(ftell64(fichero) - inicio);
+	fseek64(fichero, inicio, SEEK_SET);
+	control.datos = new unsigned char [(size_t)(longitud > 0 ? longitud : 1)];
+	bool correcto = (fread(control.datos, 1, (size_t)longitud, fichero) == longitud);
+	fclose(fichero);
+
+	unsigned long long p = 0;
+	for (int b = 0; correcto && b < cabecera.bloques; b++) {
+		if (p + sizeof(unsigned long long) > longitud) {
+			correcto = false;
+			break;
+		}
+		memcpy(&control.bytes[b], control.datos + p, sizeof(unsigned long long));
+		p += sizeof(unsigned long long);
+		control.posicion[b] = p;
+		if (p + control.bytes[b] > longitud)
+			correcto = false;
+		p += control.bytes[b];
+	}
+	if (!correcto) {
+		delete[] control.datos;
+		control.datos = NULL;
+		return false;
+	}
+
+	// Restauramos el generador de números aleatorios del hilo
+	generadorHilo().clave = cabecera.claveGenerador;
+	generadorHilo().contador = cabecera.contadorGenerador;
+
+	strncpy(control.nombre, nombre, sizeof(control.nombre) - 1);
+	control.nombre[sizeof(control.nombre) - 1] = 0;
+	control.intervalo = intervalo;
+	control.ultimo = segundosPuntoControl();
+	control.reanudar = true;
+	return true;
+}
+
+bool bloquePuntoControl(PuntoControl& control, int bloque, void* destino, unsigned long long bytes)
+{
+	if (control.datos == NULL || bloque < 0 || bloque >= control.cabecera.bloques || control.bytes[bloque] != bytes)
+		return false;
+	memcpy(destino, control.datos + control.posicion[bloque], (size_t)bytes);
+	return true;
+}
+
+const void* datosBloquePuntoControl(PuntoControl& control, int bloque, unsigned long long& bytes)
+{
+	if (control.datos == NULL || bloque < 0 || bloque >= control.cabecera.bloques)
+		return NULL;
+	bytes = control.bytes[bloque];
+	return control.datos + control.posicion[bloque];
+}
+
+void restauradoPuntoControl(PuntoControl& control)
+{
+	delete[] control.datos;
+	control.datos = NULL;
+	control.reanudar = false;
+}
+
+bool tocaPuntoControl(PuntoControl* control)
+{
+	return control != NULL && segundosPuntoControl() - control->ultimo >= control->intervalo;
+}
+
+bool guardarPuntoControl(PuntoControl& control, const void* const* datos, const unsigned long long* bytes, int bloques)
+{
+	char temporal[sizeof(control.nombre) + 8];
+	sprintf(temporal, "%s.tmp", control.nombre);
+
+	FILE* fichero = fopen(temporal, "wb");
+	if (fichero == NULL)
+		return false;
+
+	control.cabecera.bloques = bloques;
+	control.cabecera.claveGenerador = generadorHilo().clave;
+	control.cabecera.contadorGenerador = generadorHilo().contador;
+
+	bool correcto = (fwrite(&control.cabecera, sizeof(control.cabecera), 1, fichero) == 1);
+	correcto = correcto && fwrite(control.reglas, sizeof(int), control.cabecera.nreglas, fichero) == (size_t)control.cabecera.nreglas;
+	for (int b = 0; correcto && b < bloques; b++) {
+		correcto = fwrite(&bytes[b], sizeof(unsigned long long), 1, fichero) == 1;
+		correcto = correcto && fwrite(datos[b], 1, (size_t)bytes[b], fichero) == bytes[b];
+	}
+
+	// Forzamos la escritura en disco antes de sustituir el punto de control anterior
+	correcto = correcto && fflush(fichero) == 0;
+#ifdef _WIN32
+	correcto = correcto && _commit(_fileno(fichero)) == 0;
+#else
+	correcto = correcto && fsync(fileno(fichero)) == 0;
+#endif
+	correcto = (fclose(fichero) == 0) && correcto;
+
+	// El renombrado sustituye el punto de control anterior de forma atómica
+#ifdef _WIN32
+	correcto = correcto && MoveFileExA(temporal, control.nombre, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	correcto = correcto && rename(temporal, control.nombre) == 0;
+#endif
+	if (!correcto)
+		remove(temporal);
+
+	control.ultimo = segundosPuntoControl();
+	return correcto;
+}
+
+void reglaPuntoControl(PuntoControl* control, int indiceRegla)
+{
+	if (control == NULL || control->reanudar)
+		return;
+
+	control->cabecera.indiceRegla = indiceRegla;
+	control->cabecera.N = 0;
+	control->cabecera.estado = 0;
+	if (tocaPuntoControl(control) && !guardarPuntoControl(*control, NULL, NULL, 0))
+		printf("No se pudo guardar el punto de control %s\n", control->nombre);
+}
+
+void borrarPuntoControl(PuntoControl& control)
+{
+	remove(control.nombre);
+	delete[] control.datos;
+	control.datos = NULL;
+	control.reanudar = false;
+}
@@ -0,0 +1,147 @@
+#ifndef _LIBPUNTOCONTROL_H_
+#define _LIBPUNTOCONTROL_H_
+
+#include <stdio.h>
+
+#define PUNTOCONTROL_MAGIA			"ACEPCTL"	// Identificador al inicio de los ficheros de punto de control
+#define PUNTOCONTROL_VERSION		2			// Versión del formato de los ficheros de punto de control (2: visitas como histogramas)
+#define PUNTOCONTROL_MAX_REGLAS		256			// Número máximo de reglas de la lista guardada
+#define PUNTOCONTROL_MAX_BLOQUES	5003		// Número máximo de bloques de datos (filas de 'probabilidades' y demás vectores)
+#define PUNTOCONTROL_INTERVALO		600.0		// Segundos entre puntos de control por defecto
+
+/*
+ * Formato de un fichero de punto de control:
+ *
+ * - Cabecera (CabeceraPuntoControl).
+ * - 'nreglas' enteros con la lista de reglas de la ejecución.
+ * - 'bloques' bloques de datos, cada uno precedido de su longitud en bytes (unsigned long long).
+ *
+ * El fichero se escribe primero con otro nombre (terminado en .tmp), se fuerza su escritura en disco
+ * y después se renombra, de manera que siempre hay un punto de control completo aunque el proceso muera a mitad.
+ */
+struct CabeceraPuntoControl {
+	char magia[8];						// PUNTOCONTROL_MAGIA
+	int version;						// PUNTOCONTROL_VERSION
+	int tipo;							// Herramienta (TRABAJO_ATRACTOR, TRABAJO_ENTROPIA, ...)
+	int celdas;							// Celdas del ACE (si la herramienta las usa)
+	int pasos;							// Pasos de evolución
+	int formato;						// Formato de las series (FORMATO_TEXTO, ...)
+	int nreglas;						// Número de reglas de la lista
+	int indiceRegla;					// Posición en la lista de la regla en curso
+	int N;								// Número de celdas en curso (ENTROPIA)
+	int estado;							// Siguiente estado inicial a simular
+	int bloques;						// Número de bloques de datos
+	unsigned long long claveGenerador;	// Estado del generador de números aleatorios del hilo (GeneradorAleatorio)
+	unsigned long long contadorGenerador;
+};
+
+/*
+ * Punto de control de una ejecución: dónde se guarda, cada cuánto, la posición actual y,
+ * al reanudar, los datos leídos del fichero hasta que se restauran.
+ */
+struct PuntoControl {
+	char nombre[256];					// Fichero de punto de control
+	double intervalo;					// Segundos entre puntos de control
+	double ultimo;						// Instante (segundos) del último punto de control guardado
+	CabeceraPuntoControl cabecera;		// Posición actual
+	int reglas[PUNTOCONTROL_MAX_REGLAS];// Lista de reglas de la ejecución
+	bool reanudar;						// Cierto si los datos leídos aún no se han restaurado
+	unsigned char* datos;				// Datos leídos (todos los bloques seguidos)
+	unsigned long long bytes[PUNTOCONTROL_MAX_BLOQUES];		// Longitud de cada bloque leído
+	unsigned long long posicion[PUNTOCONTROL_MAX_BLOQUES];	// Posición de cada bloque leído dentro de 'datos'
+};
+
+/*
+ * Nombre: iniciarPuntoControl
+ *
+ * Descripción: Prepara el punto de control de una ejecución nueva.
+ *
+ * control: Punto de control a preparar.
+ * nombre: Fichero en el que se guardará.
+ * intervalo: Segundos entre puntos de control.
+ * tipo, celdas, pasos, formato: Parámetros de la ejecución (se comprueban al reanudar).
+ * reglas, nreglas: Lista de reglas de la ejecución.
+ *
+ */
+void iniciarPuntoControl(PuntoControl& control, const char* nombre, double intervalo, int tipo, int celdas, int pasos, int formato, const int* reglas, int nreglas);
+
+/*
+ * Nombre: leerPuntoControl
+ *
+ * Descripción: Lee un fichero de punto de control para reanudar la ejecución. Los datos quedan en 'control'
+ *              hasta que se restauran ('bloquePuntoControl') y se liberan ('restauradoPuntoControl').
+ *
+ * Devuelve cierto si se pudo leer el fichero y es un punto de control válido.
+ *
+ */
+bool leerPuntoControl(PuntoControl& control, const char* nombre, double intervalo);
+
+/*
+ * Nombre: bloquePuntoControl
+ *
+ * Descripción: Copia en 'destino' el bloque de datos 'bloque' leído del punto de control.
+ *
+ * Devuelve cierto si el bloque existe y tiene exactamente 'bytes' bytes.
+ *
+ */
+bool bloquePuntoControl(PuntoControl& control, int bloque, void* destino, unsigned long long bytes);
+
+/*
+ * Nombre: datosBloquePuntoControl
+ *
+ * Descripción: Devuelve el bloque de datos 'bloque' leído del punto de control y su longitud en 'bytes',
+ *              para los bloques de longitud variable (histogramas). NULL si el bloque no existe.
+ *
+ */
+const void* datosBloquePuntoControl(PuntoControl& control, int bloque, unsigned long long& bytes);
+
+/*
+ * Nombre: restauradoPuntoControl
+ *
+ * Descripción: Libera los datos leídos una vez restaurados (a partir de aquí ya no se está reanudando).
+ *
+ */
+void restauradoPuntoControl(PuntoControl& control);
+
+/*
+ * Nombre: tocaPuntoControl
+ *
+ * Descripción: Devuelve cierto si desde el último punto de control ha pasado el intervalo indicado.
+ *
+ */
+bool tocaPuntoControl(PuntoControl* control);
+
+/*
+ * Nombre: reglaPuntoControl
+ *
+ * Descripción: Anota que se empieza la regla de la posición 'indiceRegla' de la lista y, si ha pasado el intervalo,
+ *              guarda un punto de control sin datos (las reglas anteriores ya están completas).
+ *              No hace nada si 'control' es NULL o si aún se está reanudando la regla guardada.
+ *
+ */
+void reglaPuntoControl(PuntoControl* control, int indiceRegla);
+
+/*
+ * Nombre: guardarPuntoControl
+ *
+ * Descripción: Guarda de forma atómica (fichero temporal y renombrado) la posición actual y los bloques de datos indicados.
+ *
+ * control: Punto de control (la posición está en 'control.cabecera').
+ * datos: Punteros a los bloques de datos.
+ * bytes: Longitud de cada bloque.
+ * bloques: Número de bloques.
+ *
+ * Devuelve cierto si se pudo guardar.
+ *
+ */
+bool guardarPuntoControl(PuntoControl& control, const void* const* datos, const unsigned long long* bytes, int bloques);
+
+/*
+ * Nombre: borrarPuntoControl
+ *
+ * Descripción: Borra el fichero de punto de control al terminar la ejecución y libera los datos leídos que queden.
+ *
+ */
+void borrarPuntoControl(PuntoControl& control);
+
+#endif
@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <list>
+#include "libmedidas.h"
+#include "libsucesores.h"
+#include "libtablas.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#include <windows.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#pragma warning ( disable: 4996 )
+
+static bool tablasSucesores = true;		// Uso de las tablas de sucesores (ver 'usarTablasSucesores')
+static char directorioCache[256] = "";	// Directorio de la caché de sucesores (vacío: sin caché)
+static std::atomic<int> temporales(0);	// Ficheros temporales creados (para que cada hilo use uno distinto)
+
+/*
+	Tabla retenida en memoria entre trabajos (ver 'retenerTablasSucesores').
+*/
+struct TablaRetenida {
+	TablaSucesores tabla;				// Tabla (memoria o proyección propiedad de la lista)
+	int usos;							// Hilos que la están usando
+};
+
+static std::mutex cerrojoRetenidas;						// Protege las variables siguientes
+static std::list<TablaRetenida> retenidas;				// Tablas retenidas, de la usada más recientemente a la que menos
+static unsigned long long bytesRetenidas = 0;			// Bytes de las tablas retenidas
+static unsigned long long maximoRetenidas = 0;			// Límite de bytes retenidos (0: no se retienen)
+
+void usarTablasSucesores(bool usar)
+{
+	tablasSucesores = usar;
+}
+
+void usarCacheSucesores(const char* directorio)
+{
+	if (directorio == NULL)
+		directorio = "";
+	strncpy(directorioCache, directorio, sizeof(directorioCache) - 1);
+	directorioCache[sizeof(directorioCache) - 1] = 0;
+}
+
+/*
+	Libera la memoria o la proyección de una tabla.
+*/
+static void soltarTablaSucesores(TablaSucesores& tabla)
+{
+	liberarTabla(tabla.memoria);
+	if (tabla.proyeccion != NULL) {
+#ifdef _WIN32
+		UnmapViewOfFile(tabla.proyeccion);
+#else
+		munmap(tabla.proyeccion, (size_t)tabla.bytesProyeccion);
+#endif
+	}
+	tabla.memoria = NULL;
+	tabla.proyeccion = NULL;
+	tabla.sucesor = NULL;
+}
+
+static unsigned long long bytesTablaSucesores(int celdas)
+{
+	return (1ULL << celdas) * sizeof(unsigned int);
+}
+
+/*
+	Libera las tablas retenidas menos usadas recientemente (que nadie esté usando) hasta no superar el límite.
+	Se llama con el cerrojo tomado.
+*/
+static void recortarRetenidas()
+{
+	std::list<TablaRetenida>::iterator t = retenidas.end();
+	while (bytesRetenidas > maximoRetenidas && t != retenidas.begin()) {
+		--t;
+		if (t->usos == 0) {
+			bytesRetenidas -= bytesTablaSucesores(t->tabla.celdas);
+			soltarTablaSucesores(t->tabla);
+			t = retenidas.erase(t);
+		}
+	}
+}
+
+void retenerTablasSucesores(unsigned long long bytesMaximos)
+{
+	std::lock_guard<std::mutex> cerrojo(cerrojoRetenidas);
+	maximoRetenidas = bytesMaximos;
+	recortarRetenidas();
+}
+
+/*
+	Busca la tabla entre las retenidas y, si está, la comparte en 'tabla' y la pasa a la más reciente.
+	Se llama con el cerrojo tomado.
+*/
+static bool buscarRetenida(TablaSucesores& tabla, int regla, int celdas)
+{
+	for (std::list<TablaRetenida>::iterator t = retenidas.begin(); t != retenidas.end(); ++t)
+		if (t->tabla.regla == regla && t->tabla.celdas == celdas) {
+			t->usos++;
+			retenidas.splice(retenidas.begin(), retenidas, t);
+			tabla = t->tabla;
+			tabla.retenida = true;
+			return true;
+		}
+	return false;
+}
+
+bool tablaSucesoresDisponible(int celdas)
+{
+	return tablasSucesores && celdas >= 2 && celdas <= SUCESORES_CELDAS_MAX;
+}
+
+void calcularSucesores(unsigned int* sucesor, int regla, int celdas)
+{
+	unsigned int mascara = (1u << celdas) - 1;
+	unsigned int estadosPosibles = 1u << celdas;
+	unsigned int h[8];		// Hojas del árbol: el bit 'v' de la regla extendido a toda la palabra
+
+	MEDIR_INICIO(FASE_SIMULACION);
+
+	for (int v = 0; v < 8; v++)
+		h[v] = ((regla >> v) & 1) ? ~0u : 0u;
+
+	for (unsigned int e = 0; e < estadosPosibles; e++) {
+		// La celda j es el bit celdas - j: su vecina derecha (j + 1) está un bit por debajo y la izquierda uno por encima
+		unsigned int derecha = ((e << 1) | (e >> (celdas - 1))) & mascara;
+		unsigned int izquierda = ((e >> 1) | (e << (celdas - 1))) & mascara;
+
+		// vecindad = izquierda << 2 | centro << 1 | derecha: se selecciona primero por la derecha, después por el centro
+		unsigned int n0 = (derecha & h[1]) | (~derecha & h[0]);
+		unsigned int n1 = (derecha & h[3]) | (~derecha & h[2]);
+		unsigned int n2 = (derecha & h[5]) | (~derecha & h[4]);
+		unsigned int n3 = (derecha & h[7]) | (~derecha & h[6]);
+		unsigned int m0 = (e & n1) | (~e & n0);
+		unsigned int m1 = (e & n3) | (~e & n2);
+		sucesor[e] = ((izquierda & m1) | (~izquierda & m0)) & mascara;
+	}
+
+	MEDIR_CONTAR(CONTADOR_ACTUALIZACIONES, (unsigned long long)estadosPosibles * celdas);
+	MEDIR_FIN();
+}
+
+/*
+	Proyecta en memoria el fichero de la caché 'nombre' si es la tabla de la regla 'regla' para 'celdas' celdas.
+*/
+static bool proyectarSucesores(TablaSucesores& tabla, const char* nombre, int regla, int celdas)
+{
+	unsigned long long bytes = sizeof(CabeceraSucesores) + (1ULL << celdas) * sizeof(unsigned int);
+	void* proyeccion = NULL;
+
+#ifdef _WIN32
+	HANDLE fichero = CreateFileA(nombre, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fichero == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER longitud;
+	if (GetFileSizeEx(fichero, &longitud) && (unsigned long long)longitud.QuadPart == bytes) {
+		HANDLE mapa = CreateFileMappingA(fichero, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapa != NULL) {
+			proyeccion = MapViewOfFile(mapa, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapa);
+		}
+	}
+	CloseHandle(fichero);
+#else
+	int fichero = open(nombre, O_RDONLY);
+	if (fichero < 0)
+		return false;
+	struct stat datos;
+	if (fstat(fichero, &datos) == 0 && (unsigned long long)datos.st_size == bytes) {
+		proyeccion = mmap(NULL, (size_t)bytes, PROT_READ, MAP_SHARED, fichero, 0);
+		if (proyeccion == MAP_FAILED)
+			proyeccion = NULL;
+	}
+	close(fichero);
+#endif
+	if (proyeccion == NULL)
+		return false;
+
+	// Comprobamos que la cabecera corresponde a esta tabla
+	const CabeceraSucesores* cabecera = (const CabeceraSucesores*)proyeccion;
+	tabla.proyeccion = proyeccion;
+	tabla.bytesProyeccion = bytes;
+	if (memcmp(cabecera->magia, SUCESORES_MAGIA, sizeof(cabecera->magia)) != 0 || cabecera->version != SUCESORES_VERSION ||
+		cabecera->regla != regla || cabecera->celdas != celdas || cabecera->bytesEntrada != (int)sizeof(unsigned int)) {
+		soltarTablaSucesores(tabla);
+		return false;
+	}
+	tabla.sucesor = (const unsigned int*)(cabecera + 1);
+	return true;
+}
+
+/*
+	Guarda la tabla calculada en el fichero de la caché 'nombre' (primero en un temporal propio del proceso y del hilo,
+	nombre.<proceso>.<n>.tmp, y después se renombra: varios hilos o procesos pueden guardar la misma tabla a la vez).
+*/
+static bool guardarSucesores(const TablaSucesores& tabla, const char* nombre)
+{
+	char temporal[sizeof(directorioCache) + 64];
+	sprintf(temporal, "%s.%d.%d.tmp", nombre, (int)getpid(), temporales.fetch_add(1));
+
+	FILE* fichero = fopen(temporal, "wb");
+	if (fichero == NULL)
+		return false;
+
+	CabeceraSucesores cabecera;
+	memset(&cabecera, 0, sizeof(cabecera));
+	memcpy(cabecera.magia, SUCESORES_MAGIA, sizeof(cabecera.magia));
+	cabecera.version = SUCESORES_VERSION;
+	cabecera.regla = tabla.regla;
+	cabecera.celdas = tabla.celdas;
+	cabecera.bytesEntrada = sizeof(unsigned int);
+
+	size_t entradas = (size_t)1 << tabla.celdas;
+	bool correcto = (fwrite(&cabecera, sizeof(cabecera), 1, fichero) == 1);
+	correcto = correcto && fwrite(tabla.sucesor, sizeof(unsigned int), entradas, fichero) == entradas;
+	correcto = correcto && fflush(fichero) == 0;
+#ifdef _WIN32
+	correcto = correcto && _commit(_fileno(fichero)) == 0;
+#else
+	correcto = correcto && fsync(fileno(fichero)) == 0;
+#endif
+	correcto = (fclose(fichero) == 0) && correcto;
+
+#ifdef _WIN32
+	correcto = correcto && MoveFileExA(temporal, nombre, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	correcto = correcto && rename(temporal, nombre) == 0;
+#endif
+	if (!correcto)
+		remove(temporal);
+	return correcto;
+}
+
+bool obtenerTablaSucesores(TablaSucesores& tabla, int regla, int celdas)
+{
+	char nombre[sizeof(directorioCache) + 32];
+
+	memset(&tabla, 0, sizeof(tabla));
+	if (!tablaSucesoresDisponible(celdas))
+		return false;
+	tabla.regla = regla;
+	tabla.celdas = celdas;
+
+	// Si la tabla está retenida en memoria se comparte
+	bool retener;
+	{
+		std::lock_guard<std::mutex> cerrojo(cerrojoRetenidas);
+		if (buscarRetenida(tabla, regla, celdas))
+			return true;
+		retener = bytesTablaSucesores(celdas) <= maximoRetenidas;
+	}
+
+	// Si la tabla está en la caché se proyecta en memoria; si no, se calcula y se guarda en la caché
+	bool proyectada = false;
+	if (directorioCache[0] != 0) {
+		sprintf(nombre, "%s/SUCESORES_R%03d_C%02d.suc", directorioCache, regla, celdas);
+		proyectada = proyectarSucesores(tabla, nombre, regla, celdas);
+	}
+	if (!proyectada) {
+		tabla.memoria = (unsigned int*)reservarTabla((size_t)bytesTablaSucesores(celdas));
+		calcularSucesores(tabla.memoria, regla, celdas);
+		tabla.sucesor = tabla.memoria;
+		if (directorioCache[0] != 0 && !guardarSucesores(tabla, nombre))
+			printf("No se pudo guardar la tabla de sucesores %s\n", nombre);
+	}
+
+	// La añadimos a las retenidas (si otro hilo la ha añadido mientras tanto, se usa la suya)
+	if (retener) {
+		std::lock_guard<std::mutex> cerrojo(cerrojoRetenidas);
+		TablaSucesores propia = tabla;
+		if (buscarRetenida(tabla, regla, celdas)) {
+			soltarTablaSucesores(propia);
+			return true;
+		}
+		TablaRetenida retenida;
+		retenida.tabla = tabla;
+		retenida.usos = 1;
+		retenidas.push_front(retenida);
+		bytesRetenidas += bytesTablaSucesores(celdas);
+		tabla.retenida = true;
+		recortarRetenidas();
+	}
+	return true;
+}
+
+void liberarTablaSucesores(TablaSucesores& tabla)
+{
+	if (tabla.retenida) {
+		std::lock_guard<std::mutex> cerrojo(cerrojoRetenidas);
+		for (std::list<TablaRetenida>::iterator t = retenidas.begin(); t != retenidas.end(); ++t)
+			if (t->tabla.regla == tabla.regla && t->tabla.celdas == tabla.celdas) {
+				t->usos--;
+				break;
+			}
+		recortarRetenidas();
+		tabla.memoria = NULL;
+		tabla.proyeccion = NULL;
+		tabla.sucesor = NULL;
+		tabla.retenida = false;
+		return;
+	}
+	soltarTablaSucesores(tabla);
+}
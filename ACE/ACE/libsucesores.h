@@ -0,0 +1,112 @@
+#ifndef _LIBSUCESORES_H_
+#define _LIBSUCESORES_H_
+
+#define SUCESORES_MAGIA				"ACESUCE"	// Identificador al inicio de los ficheros de la caché de sucesores
+#define SUCESORES_VERSION			1			// Versión del formato de los ficheros de la caché de sucesores
+#define SUCESORES_CELDAS_MAX		26			// Máximo de celdas con tabla de sucesores (2^26 entradas, 256 MB)
+
+/*
+ * Formato de un fichero de la caché de sucesores (SUCESORES_R<regla>_C<celdas>.suc):
+ *
+ * - Cabecera (CabeceraSucesores).
+ * - 2^celdas enteros sin signo de 32 bits: el sucesor de cada estado.
+ *
+ * El fichero se escribe con otro nombre (terminado en .tmp) y se renombra al terminar, por lo que
+ * nunca se proyecta un fichero a medio escribir. Si la cabecera o la longitud no coinciden se vuelve a calcular.
+ */
+struct CabeceraSucesores {
+	char magia[8];						// SUCESORES_MAGIA
+	int version;						// SUCESORES_VERSION
+	int regla;							// Regla del ACE
+	int celdas;							// Celdas del ACE
+	int bytesEntrada;					// Bytes de cada entrada de la tabla (sizeof(unsigned int))
+};
+
+/*
+ * Tabla de sucesores de una regla para un número de celdas: para cada estado (codificado como en 'generarACE',
+ * la celda j es el bit celdas - j) el estado al que pasa en un paso. Está calculada en memoria o proyectada
+ * desde la caché en disco.
+ */
+struct TablaSucesores {
+	int regla;							// Regla del ACE
+	int celdas;							// Celdas del ACE
+	const unsigned int* sucesor;		// Sucesor de cada estado (2^celdas entradas)
+	unsigned int* memoria;				// Tabla calculada en memoria (NULL si está proyectada)
+	void* proyeccion;					// Inicio del fichero proyectado en memoria (NULL si está calculada)
+	unsigned long long bytesProyeccion;	// Longitud de la proyección
+	bool retenida;						// Cierto si la tabla pertenece a las tablas retenidas (ver 'retenerTablasSucesores')
+};
+
+/*
+ * Nombre: usarTablasSucesores
+ *
+ * Descripción: Activa o desactiva el uso de las tablas de sucesores en ATRACTOR y ENTROPIA (por defecto activado).
+ *              Sin ellas cada estado inicial se simula con 'generarACE'.
+ *
+ */
+void usarTablasSucesores(bool usar);
+
+/*
+ * Nombre: usarCacheSucesores
+ *
+ * Descripción: Establece el directorio de la caché de tablas de sucesores. Las tablas calculadas se guardan en él
+ *              y en ejecuciones posteriores se proyectan en memoria en lugar de volver a calcularse.
+ *              Con NULL o "" (por defecto) las tablas sólo se calculan en memoria.
+ *
+ */
+void usarCacheSucesores(const char* directorio);
+
+/*
+ * Nombre: retenerTablasSucesores
+ *
+ * Descripción: Mantiene en memoria las tablas de sucesores entre trabajos, hasta 'bytesMaximos' bytes entre todas
+ *              (0, por defecto: cada tabla se libera al terminar el trabajo que la usa). Cuando se supera el límite se
+ *              liberan las tablas que lleven más tiempo sin usarse y que ningún hilo esté usando. Pensado para procesos
+ *              que atienden muchos trabajos seguidos con las mismas reglas (SERVIDOR). Se puede llamar en cualquier
+ *              momento; con un límite menor se liberan en ese momento las tablas sobrantes que no estén en uso.
+ *
+ */
+void retenerTablasSucesores(unsigned long long bytesMaximos);
+
+/*
+ * Nombre: tablaSucesoresDisponible
+ *
+ * Descripción: Devuelve cierto si las tablas de sucesores están activadas y hay tabla para 'celdas' celdas.
+ *
+ */
+bool tablaSucesoresDisponible(int celdas);
+
+/*
+ * Nombre: calcularSucesores
+ *
+ * Descripción: Calcula la tabla de sucesores de la regla 'regla' para 'celdas' celdas en 'sucesor' (2^celdas posiciones).
+ *              Cada estado se evoluciona entero de una vez: las vecinas izquierda y derecha de todas las celdas son
+ *              el estado rotado un bit, y la regla se evalúa sobre las tres palabras como un árbol de selectores de bits.
+ *              El bucle sobre los estados no tiene saltos, de forma que el compilador lo vectoriza (varios estados
+ *              por registro SIMD).
+ *
+ */
+void calcularSucesores(unsigned int* sucesor, int regla, int celdas);
+
+/*
+ * Nombre: obtenerTablaSucesores
+ *
+ * Descripción: Prepara en 'tabla' la tabla de sucesores de la regla 'regla' para 'celdas' celdas: si está retenida
+ *              en memoria se comparte; si no, la proyecta desde la caché si está en ella y, si no, la calcula y, si hay
+ *              caché, la guarda en ella. Se puede llamar desde varios hilos a la vez.
+ *
+ * Devuelve falso si no hay tabla para ese número de celdas (ver 'tablaSucesoresDisponible').
+ *
+ */
+bool obtenerTablaSucesores(TablaSucesores& tabla, int regla, int celdas);
+
+/*
+ * Nombre: liberarTablaSucesores
+ *
+ * Descripción: Libera la memoria o la proyección de una tabla obtenida con 'obtenerTablaSucesores'
+ *              (si está retenida sólo deja de usarla).
+ *
+ */
+void liberarTablaSucesores(TablaSucesores& tabla);
+
+#endif
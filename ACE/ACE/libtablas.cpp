@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include <new>
+#include "libmedidas.h"
+#include "libtablas.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+#pragma warning ( disable: 4996 )
+
+#define TABLAS_PAGINA				4096		// Bytes de una página normal (se toca una vez cada página al prefallar)
+
+/*
+	Cabecera que precede a cada tabla: de dónde viene su memoria para poder liberarla.
+*/
+struct CabeceraTabla {
+	void* base;							// Inicio de la memoria reservada (cabecera incluida)
+	size_t bytesBase;					// Bytes proyectados (0 si la tabla está en el montón)
+};
+
+/*
+	Procesadores del nodo NUMA de un hilo, a los que se fijan los hilos auxiliares.
+*/
+struct NodoTabla {
+#ifdef _WIN32
+	GROUP_AFFINITY afinidad;
+#else
+	cpu_set_t cpus;
+#endif
+	int procesadores;					// Procesadores del nodo
+};
+
+static bool paginasGrandes = true;		// Se piden páginas grandes (ver 'usarTablasGrandes')
+static int hilosAuxiliares = 0;			// Hilos que prefallan o vacían cada tabla (0: sin calcular todavía)
+
+void usarTablasGrandes(bool usar, int hilosTrabajo)
+{
+	int nucleos = (int)std::thread::hardware_concurrency();
+
+	paginasGrandes = usar;
+	if (hilosTrabajo < 1)
+		hilosTrabajo = 1;
+	hilosAuxiliares = nucleos / hilosTrabajo;
+	if (hilosAuxiliares < 1)
+		hilosAuxiliares = 1;
+	if (hilosAuxiliares > TABLAS_MAX_HILOS)
+		hilosAuxiliares = TABLAS_MAX_HILOS;
+}
+
+/*
+	Obtiene los procesadores del nodo NUMA en el que se ejecuta el hilo. Devuelve falso si no se puede saber
+	o si sólo hay un nodo (en ese caso no hace falta fijar los hilos auxiliares).
+*/
+static bool nodoActual(NodoTabla& nodo)
+{
+#ifdef _WIN32
+	PROCESSOR_NUMBER procesador;
+	USHORT numero;
+	ULONG mayor;
+
+	if (!GetNumaHighestNodeNumber(&mayor) || mayor == 0)
+		return false;
+	GetCurrentProcessorNumberEx(&procesador);
+	if (!GetNumaProcessorNodeEx(&procesador, &numero) || numero == 0xFFFF)
+		return false;
+	if (!GetNumaNodeProcessorMaskEx(numero, &nodo.afinidad))
+		return false;
+	nodo.procesadores = 0;
+	for (KAFFINITY m = nodo.afinidad.Mask; m != 0; m &= m - 1)
+		nodo.procesadores++;
+	return nodo.procesadores > 0;
+#else
+	char nombre[64];
+	char lista[4096];
+	int nodos = 0;
+	bool encontrado = false;
+	int cpu = sched_getcpu();
+
+	if (cpu < 0)
+		return false;
+
+	// Cada nodo tiene su lista de procesadores en /sys ("0-7,16-23")
+	for (int n = 0; n < TABLAS_MAX_NODOS; n++) {
+		sprintf(nombre, "/sys/devices/system/node/node%d/cpulist", n);
+		FILE* f = fopen(nombre, "r");
+		if (f == NULL)
+			continue;
+		bool leida = fgets(lista, sizeof(lista), f) != NULL;
+		fclose(f);
+		if (!leida)
+			continue;
+		nodos++;
+
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		for (char* p = lista; *p >= '0' && *p <= '9'; ) {
+			int desde = (int)strtol(p, &p, 10), hasta = desde;
+			if (*p == '-')
+				hasta = (int)strtol(p + 1, &p, 10);
+			for (int c = desde; c <= hasta && c < CPU_SETSIZE; c++)
+				CPU_SET(c, &cpus);
+			if (*p == ',')
+				p++;
+		}
+		if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &cpus)) {
+			nodo.cpus = cpus;
+			nodo.procesadores = CPU_COUNT(&cpus);
+			encontrado = true;
+		}
+	}
+	return encontrado && nodos > 1 && nodo.procesadores > 0;
+#endif
+}
+
+/*
+	Prefalla (toca una vez cada página) o vacía un trozo de tabla, desde un hilo fijado al nodo 'nodo' si no es NULL.
+*/
+static void recorrerTrozo(char* inicio, size_t bytes, bool vaciar, const NodoTabla* nodo)
+{
+	if (nodo != NULL) {
+#ifdef _WIN32
+		SetThreadGroupAffinity(GetCurrentThread(), &nodo->afinidad, NULL);
+#else
+		sched_setaffinity(0, sizeof(nodo->cpus), &nodo->cpus);
+#endif
+	}
+
+	if (vaciar)
+		memset(inicio, 0, bytes);
+	else
+		for (size_t i = 0; i < bytes; i += TABLAS_PAGINA)
+			inicio[i] = 0;
+}
+
+/*
+	Reparte el prefallo o el vaciado de una tabla grande entre el hilo que la reserva y los hilos auxiliares,
+	en trozos de páginas grandes completas, con todos los hilos en el nodo NUMA del primero.
+*/
+static void recorrerTabla(char* inicio, size_t bytes, bool vaciar)
+{
+	NodoTabla nodo;
+	std::thread auxiliares[TABLAS_MAX_HILOS];
+
+	if (hilosAuxiliares == 0)
+		usarTablasGrandes(paginasGrandes);
+
+	int hilos = hilosAuxiliares;
+	size_t paginas = (bytes + TABLAS_PAGINA_GRANDE - 1) / TABLAS_PAGINA_GRANDE;
+	if ((size_t)hilos > paginas)
+		hilos = (int)paginas;
+	bool fijar = hilos > 1 && nodoActual(nodo);
+	if (fijar && hilos > nodo.procesadores)
+		hilos = nodo.procesadores;
+
+	if (hilos <= 1) {
+		recorrerTrozo(inicio, bytes, vaciar, NULL);
+		return;
+	}
+
+	// El trozo 0 lo recorre este mismo hilo (que ya está en su nodo)
+	size_t trozo = (paginas + hilos - 1) / hilos * TABLAS_PAGINA_GRANDE;
+	for (int h = 1; h < hilos; h++) {
+		size_t desde = h * trozo;
+		if (desde >= bytes)
+			break;
+		size_t n = bytes - desde < trozo ? bytes - desde : trozo;
+		auxiliares[h] = std::thread(recorrerTrozo, inicio + desde, n, vaciar, fijar ? &nodo : NULL);
+	}
+	recorrerTrozo(inicio, bytes < trozo ? bytes : trozo, vaciar, NULL);
+	for (int h = 1; h < hilos; h++)
+		if (auxiliares[h].joinable())
+			auxiliares[h].join();
+}
+
+/*
+	Proyecta 'bytes' bytes (múltiplo de TABLAS_PAGINA_GRANDE) alineados a TABLAS_PAGINA_GRANDE, a cero.
+	'prefallar' indica si sus páginas aún no existen (con páginas grandes de Windows se reservan enteras al proyectarlas).
+*/
+static char* proyectarTabla(size_t bytes, bool& prefallar)
+{
+	prefallar = true;
+#ifdef _WIN32
+	SIZE_T grande = GetLargePageMinimum();
+	if (paginasGrandes && grande > 0 && bytes % grande == 0) {
+		void* p = VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (p != NULL) {
+			prefallar = false;
+			return (char*)p;
+		}
+	}
+	return (char*)VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+	// Se proyecta una página grande de más y se recortan los extremos para que el inicio quede alineado
+	char* mapa = (char*)mmap(NULL, bytes + TABLAS_PAGINA_GRANDE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapa == (char*)MAP_FAILED)
+		return NULL;
+	char* base = (char*)(((uintptr_t)mapa + TABLAS_PAGINA_GRANDE - 1) & ~(uintptr_t)(TABLAS_PAGINA_GRANDE - 1));
+	if (base > mapa)
+		munmap(mapa, base - mapa);
+	if (mapa + TABLAS_PAGINA_GRANDE > base)
+		munmap(base + bytes, mapa + TABLAS_PAGINA_GRANDE - base);
+#ifdef MADV_HUGEPAGE
+	if (paginasGrandes)
+		madvise(base, bytes, MADV_HUGEPAGE);
+#endif
+	return base;
+#endif
+}
+
+void* reservarTabla(size_t bytes)
+{
+	char* base;
+	size_t bytesBase = 0;
+
+	if (bytes + TABLAS_CABECERA < TABLAS_MINIMO_GRANDE) {
+		// Tabla pequeña: en el montón
+		base = (char*)calloc(1, bytes + TABLAS_CABECERA);
+		if (base == NULL)
+			throw std::bad_alloc();
+	}
+	else {
+		bool prefallar;
+		bytesBase = (bytes + TABLAS_CABECERA + TABLAS_PAGINA_GRANDE - 1) / TABLAS_PAGINA_GRANDE * TABLAS_PAGINA_GRANDE;
+		base = proyectarTabla(bytesBase, prefallar);
+		if (base == NULL)
+			throw std::bad_alloc();
+		if (prefallar)
+			recorrerTabla(base, bytesBase, false);
+		MEDIR_CONTAR(CONTADOR_BYTES_TABLAS, bytesBase);
+	}
+
+	CabeceraTabla* cabecera = (CabeceraTabla*)base;
+	cabecera->base = base;
+	cabecera->bytesBase = bytesBase;
+	return base + TABLAS_CABECERA;
+}
+
+void liberarTabla(void* tabla)
+{
+	if (tabla == NULL)
+		return;
+
+	CabeceraTabla* cabecera = (CabeceraTabla*)((char*)tabla - TABLAS_CABECERA);
+	if (cabecera->bytesBase == 0)
+		free(cabecera->base);
+	else {
+#ifdef _WIN32
+		VirtualFree(cabecera->base, 0, MEM_RELEASE);
+#else
+		munmap(cabecera->base, cabecera->bytesBase);
+#endif
+	}
+}
+
+void vaciarTabla(void* tabla, size_t bytes)
+{
+	if (bytes < TABLAS_MINIMO_GRANDE)
+		memset(tabla, 0, bytes);
+	else
+		recorrerTabla((char*)tabla, bytes, true);
+}
@@ -0,0 +1,63 @@
+#ifndef _LIBTABLAS_H_
+#define _LIBTABLAS_H_
+
+#include <stddef.h>
+
+#define TABLAS_PAGINA_GRANDE		(2 << 20)	// Bytes de una página grande (transparent huge pages en x86-64)
+#define TABLAS_MINIMO_GRANDE		(4 << 20)	// Tablas a partir de este tamaño: páginas grandes y prefallo en paralelo
+#define TABLAS_CABECERA				64			// Bytes de la cabecera antes de cada tabla (una línea de caché)
+#define TABLAS_MAX_HILOS			64			// Hilos máximos que prefallan o vacían una tabla
+#define TABLAS_MAX_NODOS			64			// Nodos NUMA máximos que se buscan
+
+/*
+ * Reserva de las tablas grandes de los análisis (los vectores de 2^celdas visitas de los histogramas densos de
+ * ATRACTOR y ENTROPIA, los estados visitados, las tablas de sucesores), que con 20 a 26 celdas ocupan de megas a gigas.
+ * Con 'new' y 'memset' cada página de 4 KB se falla la primera vez que se toca, de una en una y desde un solo hilo,
+ * y los recorridos aleatorios por la tabla fallan en la TLB casi en cada acceso.
+ *
+ * Las tablas de al menos TABLAS_MINIMO_GRANDE bytes se proyectan directamente (mmap / VirtualAlloc) alineadas a
+ * TABLAS_PAGINA_GRANDE y se piden con páginas grandes (madvise(MADV_HUGEPAGE) en Linux, MEM_LARGE_PAGES en Windows,
+ * que necesita el privilegio "Bloquear páginas en memoria"). Si el sistema no las da se usan páginas normales.
+ * Después se prefallan todas sus páginas en paralelo con hilos auxiliares fijados a los procesadores del nodo NUMA
+ * del hilo que reserva la tabla: como cada página se coloca en el nodo del primer hilo que la toca, la tabla queda
+ * en la memoria local del hilo de trabajo que la va a usar (en LOTES, cada hilo reserva sus propias tablas).
+ * Las tablas más pequeñas se reservan en el montón como siempre.
+ */
+
+/*
+ * Nombre: usarTablasGrandes
+ *
+ * Descripción: Indica si se piden páginas grandes y cuántos hilos de trabajo reservan tablas a la vez: los núcleos
+ *              del procesador se reparten entre ellos para prefallar y vaciar sus tablas (por defecto páginas grandes
+ *              y un solo hilo de trabajo, que usa todos los núcleos). Se debe llamar antes de lanzar hilos de trabajo.
+ *
+ */
+void usarTablasGrandes(bool paginasGrandes, int hilosTrabajo = 1);
+
+/*
+ * Nombre: reservarTabla
+ *
+ * Descripción: Reserva una tabla de 'bytes' bytes a cero, alineada a una línea de caché.
+ *
+ * Devuelve la tabla (a liberar con 'liberarTabla'). Si no hay memoria lanza std::bad_alloc, como 'new'.
+ *
+ */
+void* reservarTabla(size_t bytes);
+
+/*
+ * Nombre: liberarTabla
+ *
+ * Descripción: Libera una tabla reservada con 'reservarTabla' (no hace nada si es NULL).
+ *
+ */
+void liberarTabla(void* tabla);
+
+/*
+ * Nombre: vaciarTabla
+ *
+ * Descripción: Pone a cero los 'bytes' primeros bytes de una tabla (en paralelo, como el prefallo, si es grande).
+ *
+ */
+void vaciarTabla(void* tabla, size_t bytes);
+
+#endif
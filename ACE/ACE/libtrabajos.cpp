@@ -0,0 +1,961 @@
+#include <atomic>
+#include <stdarg.h>
+#include "libACE.h"
+#include "libguardaimagen.h"
+#include "libtrayectoria.h"
+#include "libmedidas.h"
+#include "libtrabajos.h"
+#include "libpuntocontrol.h"
+#include "libsucesores.h"
+#include "libparcial.h"
+#include "libmotores.h"
+#include "libtablas.h"
+#include "libpreimagenes.h"
+
+#pragma warning ( disable: 4996 )
+
+#define ESTADOS_PROGRESO			1024	// Estados simulados entre cada aviso de progreso en ATRACTOR y ENTROPIA
+
+#define MAX_VALORES					256		// Número máximo de valores de cada parámetro en una línea de trabajos
+#define MIN_PASOS					1		// como mínimo 1 paso de evolución
+#define MAX_PASOS					5000	// como máximo 5000 pasos de evolución
+#define MIN_CELDAS					2		// como mínimo 2 celdas en el ACE
+#define MAX_CELDAS					10000	// como máximo 10000 celdas en el ACE
+#define MAX_CELDAS_ATRACTOR			30		// como máximo 2^30 estados posibles en ATRACTOR
+
+static std::atomic<long long> trabajoHecho(0);	// Actualizaciones de celdas realizadas por todos los trabajos
+static long long trabajoTotal = 0;				// Actualizaciones de celdas totales
+
+static void avanzarTrabajo(long long actualizaciones)
+{
+	long long hecho = trabajoHecho.fetch_add(actualizaciones, std::memory_order_relaxed) + actualizaciones;
+	MEDIR_PROGRESO(hecho, trabajoTotal);
+	(void)hecho;
+}
+
+void iniciarProgresoTrabajos(long long total)
+{
+	trabajoHecho.store(0);
+	trabajoTotal = total;
+}
+
+long long costeTrabajo(int tipo, int celdas, int pasos)
+{
+	switch (tipo) {
+		case TRABAJO_ACE:
+			return (long long)celdas * pasos;
+		case TRABAJO_HAMMING:
+		case TRABAJO_ANALISIS:
+			return 2LL * celdas * pasos;
+		case TRABAJO_ATRACTOR:
+			return (1LL << celdas) * celdas * pasos;
+		case TRABAJO_ENTROPIA: {
+			long long coste = 0;
+			for (int N = ENTROPIA_N_MIN; N <= ENTROPIA_N_MAX; N++)
+				coste += (1LL << N) * N * pasos;
+			return coste;
+		}
+	}
+	return 0;
+}
+
+long long estadosTrabajo(int tipo, int celdas)
+{
+	if (tipo == TRABAJO_ENTROPIA)
+		return (1LL << (ENTROPIA_N_MAX + 1)) - (1LL << ENTROPIA_N_MIN);
+	return 1LL << celdas;
+}
+
+long long posicionTrabajo(int tipo, int celdas, int N, long long estado)
+{
+	if (tipo == TRABAJO_ENTROPIA) {
+		if (N < ENTROPIA_N_MIN || N > ENTROPIA_N_MAX || estado < 0 || estado > (1LL << N))
+			return -1;
+		// Antes que los de N celdas van los estados de ENTROPIA_N_MIN a N - 1 celdas: 2^N - 2^ENTROPIA_N_MIN
+		return (1LL << N) - (1LL << ENTROPIA_N_MIN) + estado;
+	}
+	if (N != celdas || estado < 0 || estado > (1LL << celdas))
+		return -1;
+	return estado;
+}
+
+bool tramoReglaTrabajo(int tipo, int celdas, int pasos, int nreglas, int indiceRegla, int parte, int partes, ParteTrabajo& tramo, long long& coste)
+{
+	long long porRegla = estadosTrabajo(tipo, celdas);
+	long long desde, hasta;
+	tramoParte(nreglas * porRegla, parte, partes, desde, hasta);
+
+	// Intersección del tramo de la parte con el recorrido de la regla
+	long long inicio = (long long)indiceRegla * porRegla;
+	tramo.indiceRegla = indiceRegla;
+	tramo.desde = desde > inicio ? desde - inicio : 0;
+	tramo.hasta = hasta < inicio + porRegla ? hasta - inicio : porRegla;
+	if (tramo.desde >= tramo.hasta)
+		return false;
+
+	// El coste de cada estado es el de simularlo (celdas * pasos)
+	coste = 0;
+	if (tipo == TRABAJO_ENTROPIA) {
+		for (int N = ENTROPIA_N_MIN; N <= ENTROPIA_N_MAX; N++) {
+			long long a = posicionTrabajo(tipo, celdas, N, 0), b = posicionTrabajo(tipo, celdas, N, 1LL << N);
+			a = a > tramo.desde ? a : tramo.desde;
+			b = b < tramo.hasta ? b : tramo.hasta;
+			if (a < b)
+				coste += (b - a) * N * pasos;
+		}
+	}
+	else
+		coste = (tramo.hasta - tramo.desde) * celdas * pasos;
+	return true;
+}
+
+void iniciarEspacioTrabajo(EspacioTrabajo& espacio)
+{
+	memset(&espacio, 0, sizeof(espacio));
+}
+
+void liberarEspacioTrabajo(EspacioTrabajo& espacio)
+{
+	if (espacio.ACE != NULL)
+		liberarMemoriaACE(espacio.ACE, espacio.pasosACE);
+	if (espacio.ACE1 != NULL)
+		liberarMemoriaACE(espacio.ACE1, espacio.pasosACE1);
+	if (espacio.probabilidades != NULL)
+		liberarAtractores(espacio.probabilidades, espacio.visitadosPaso, espacio.estadoVisitado, espacio.pasosAtractor);
+	delete[] espacio.estados;
+	delete[] espacio.base;
+	delete[] espacio.sumasEntropia;
+	liberarHistograma(espacio.visitas);
+	delete[] espacio.serie;
+	liberarObservadores(espacio.observadores);
+	iniciarEspacioTrabajo(espacio);
+}
+
+/*
+	Se asegura de que 'ACE' tiene memoria para al menos 'pasos' + 1 filas de 'celdas' + 2 posiciones.
+*/
+static int** reservarACE(int*** ACE, int& pasosReservados, int& celdasReservadas, int pasos, int celdas)
+{
+	if (*ACE == NULL || pasos > pasosReservados || celdas > celdasReservadas) {
+		if (*ACE != NULL)
+			liberarMemoriaACE(*ACE, pasosReservados);
+		if (pasos > pasosReservados)
+			pasosReservados = pasos;
+		if (celdas > celdasReservadas)
+			celdasReservadas = celdas;
+		asignarMemoriaACE(ACE, pasosReservados, celdasReservadas);
+	}
+	return *ACE;
+}
+
+/*
+	Se asegura de que el vector tiene al menos 'n' posiciones (sin conservar su contenido).
+*/
+template <typename T, typename C>
+static T* reservarVector(T*& vector, C& capacidad, C n)
+{
+	if (vector == NULL || n > capacidad) {
+		delete[] vector;
+		vector = new T [n];
+		capacidad = n;
+	}
+	return vector;
+}
+
+/*
+	Añade un aviso (una línea) al texto de avisos de 'interpretarLineaTrabajos'.
+*/
+static void anadirAviso(char* avisos, size_t tamAvisos, const char* formato, ...)
+{
+	size_t usados = strlen(avisos);
+	va_list argumentos;
+
+	if (usados + 1 >= tamAvisos)
+		return;
+	va_start(argumentos, formato);
+	int n = vsnprintf(avisos + usados, tamAvisos - usados - 1, formato, argumentos);
+	va_end(argumentos);
+	if (n < 0)
+		return;
+	usados += ((size_t)n < tamAvisos - usados - 1) ? (size_t)n : tamAvisos - usados - 2;
+	avisos[usados++] = '\n';
+	avisos[usados] = 0;
+}
+
+/*
+	Siguiente palabra de la línea a partir de '*cursor' (separadas por espacios o tabuladores). Como strtok,
+	termina la palabra con un 0, pero guarda la posición en 'cursor' y no en una variable global.
+*/
+static char* siguientePalabra(char** cursor)
+{
+	char* p = *cursor;
+	while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+		p++;
+	if (*p == 0)
+		return NULL;
+	char* palabra = p;
+	while (*p != 0 && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+		p++;
+	if (*p != 0)
+		*p++ = 0;
+	*cursor = p;
+	return palabra;
+}
+
+int interpretarLineaTrabajos(char* linea, unsigned long long semilla, std::vector<Trabajo>& trabajos, char* avisos, size_t tamAvisos)
+{
+	// Separamos la línea en palabras (herramienta y opciones), ignorando comentarios y líneas vacías
+	char* comentario = strchr(linea, '#');
+	if (comentario != NULL)
+		*comentario = 0;
+	char* cursor = linea;
+	char* herramienta = siguientePalabra(&cursor);
+	if (herramienta == NULL)
+		return 0;
+
+	Trabajo trabajo;
+	int reglas[MAX_VALORES], celdas[MAX_VALORES], pasos[MAX_VALORES];
+	int nreglas = 1, nceldas = 1, npasos = 1;
+	int maxCeldas = MAX_CELDAS;
+	reglas[0] = 54;
+	trabajo.inicializacion = INICIALIZACION_SEMILLA;
+	trabajo.semilla = semilla;
+	trabajo.trayectoria = false;
+	trabajo.formato = FORMATO_TEXTO;
+	trabajo.observadores = OBSERVADOR_TODOS;
+
+	// Herramienta y valores por defecto (los mismos que en cada herramienta)
+	if (strcmp(herramienta, "ACE") == 0) {
+		trabajo.tipo = TRABAJO_ACE;
+		celdas[0] = 1000;
+		pasos[0] = 500;
+	}
+	else if (strcmp(herramienta, "HAMMING") == 0) {
+		trabajo.tipo = TRABAJO_HAMMING;
+		celdas[0] = 1000;
+		pasos[0] = 500;
+	}
+	else if (strcmp(herramienta, "ATRACTOR") == 0) {
+		trabajo.tipo = TRABAJO_ATRACTOR;
+		celdas[0] = 10;
+		pasos[0] = 20;
+		maxCeldas = MAX_CELDAS_ATRACTOR;
+	}
+	else if (strcmp(herramienta, "ENTROPIA") == 0) {
+		trabajo.tipo = TRABAJO_ENTROPIA;
+		celdas[0] = 0;
+		pasos[0] = 20;
+	}
+	else if (strcmp(herramienta, "ANALIZAR") == 0) {
+		trabajo.tipo = TRABAJO_ANALISIS;
+		celdas[0] = 1000;
+		pasos[0] = 500;
+	}
+	else {
+		anadirAviso(avisos, tamAvisos, "herramienta desconocida (%s)... Se ignora la línea", herramienta);
+		return -1;
+	}
+
+	// Opciones de la línea, con la misma sintaxis que en la línea de comandos de cada herramienta
+	for (char* opcion = siguientePalabra(&cursor); opcion != NULL; opcion = siguientePalabra(&cursor)) {
+		int descartados = 0;	// Valores de reglas, celdas o pasos no válidos en esta opción
+		if (strstr(opcion, "reglas:") == opcion) {
+			if (strstr(opcion, ":todas") != NULL)
+				nreglas = obtenerValores(reglas, MAX_VALORES, "0-255");
+			else
+				nreglas = obtenerValores(reglas, MAX_VALORES, opcion + strlen("reglas:"), 0, 255, &descartados);
+		}
+		else if (strstr(opcion, "celdas:") == opcion && trabajo.tipo != TRABAJO_ENTROPIA)
+			nceldas = obtenerValores(celdas, MAX_VALORES, opcion + strlen("celdas:"), MIN_CELDAS, maxCeldas, &descartados);
+		else if (strstr(opcion, "pasos:") == opcion)
+			npasos = obtenerValores(pasos, MAX_VALORES, opcion + strlen("pasos:"), MIN_PASOS, MAX_PASOS, &descartados);
+		else if (strstr(opcion, "inicializacion:") == opcion) {
+			if (strstr(opcion, ":aleatoria") != NULL)
+				trabajo.inicializacion = INICIALIZACION_ALEATORIA;
+			else if (strstr(opcion, ":semilla") != NULL)
+				trabajo.inicializacion = INICIALIZACION_SEMILLA;
+		}
+		else if (strstr(opcion, "semilla:") == opcion)
+			trabajo.semilla = strtoull(opcion + strlen("semilla:"), NULL, 10);
+		else if (strstr(opcion, "trayectoria:") == opcion)
+			trabajo.trayectoria = (strstr(opcion, ":si") != NULL);
+		else if (strstr(opcion, "metricas:") == opcion && trabajo.tipo == TRABAJO_ANALISIS) {
+			trabajo.observadores = obtenerObservadores(opcion + strlen("metricas:"));
+			if (trabajo.observadores == 0) {
+				trabajo.observadores = OBSERVADOR_TODOS;
+				anadirAviso(avisos, tamAvisos, "métricas desconocidas (%s)... Se obtienen todas", opcion);
+			}
+		}
+		else if (strstr(opcion, "formato:") == opcion) {
+			if (strstr(opcion, ":texto") != NULL)
+				trabajo.formato = FORMATO_TEXTO;
+			else if (strstr(opcion, ":npy") != NULL)
+				trabajo.formato = FORMATO_NPY;
+			else if (strstr(opcion, ":ambos") != NULL)
+				trabajo.formato = FORMATO_AMBOS;
+		}
+		else
+			anadirAviso(avisos, tamAvisos, "opción desconocida (%s)... Se ignora", opcion);
+
+		// Un valor no válido no se descarta en silencio (la línea puede venir de SERVIDOR): invalida la línea
+		if (descartados > 0) {
+			anadirAviso(avisos, tamAvisos, "valores no válidos o fuera de rango (%s)... Se ignora la línea", opcion);
+			return -1;
+		}
+	}
+
+	if (nreglas == 0 || nceldas == 0 || npasos == 0) {
+		anadirAviso(avisos, tamAvisos, "no hay ninguna regla, número de celdas o de pasos válido... Se ignora la línea");
+		return -1;
+	}
+
+	// Un trabajo por cada combinación
+	for (int nr = 0; nr < nreglas; nr++)
+		for (int nc = 0; nc < nceldas; nc++)
+			for (int np = 0; np < npasos; np++) {
+				trabajo.regla = reglas[nr];
+				trabajo.celdas = celdas[nc];
+				trabajo.pasos = pasos[np];
+				trabajo.coste = costeTrabajo(trabajo.tipo, trabajo.celdas, trabajo.pasos);
+				trabajos.push_back(trabajo);
+			}
+	return nreglas * nceldas * npasos;
+}
+
+void ejecutarTrabajo(EspacioTrabajo& espacio, const Trabajo& trabajo)
+{
+	switch (trabajo.tipo) {
+		case TRABAJO_ACE:
+			trabajoACE(espacio, trabajo.regla, trabajo.celdas, trabajo.pasos, trabajo.inicializacion, trabajo.semilla, trabajo.trayectoria);
+			break;
+		case TRABAJO_HAMMING:
+			trabajoHamming(espacio, trabajo.regla, trabajo.celdas, trabajo.pasos, trabajo.inicializacion, trabajo.semilla, trabajo.formato);
+			break;
+		case TRABAJO_ATRACTOR:
+			trabajoAtractor(espacio, trabajo.regla, trabajo.celdas, trabajo.pasos, trabajo.formato);
+			break;
+		case TRABAJO_ENTROPIA:
+			trabajoEntropia(espacio, trabajo.regla, trabajo.pasos, trabajo.formato);
+			break;
+		case TRABAJO_ANALISIS:
+			trabajoAnalisis(espacio, trabajo.regla, trabajo.celdas, trabajo.pasos, trabajo.inicializacion, trabajo.semilla, trabajo.formato, trabajo.observadores);
+			break;
+	}
+}
+
+void trabajoACE(EspacioTrabajo& espacio, int regla, int celdas, int pasos, int inicializacion, unsigned long long semilla, bool trayectoria)
+{
+	char nombreFichero[256];
+	GeneradorAleatorio generador;
+	int** ACE = reservarACE(&espacio.ACE, espacio.pasosACE, espacio.celdasACE, pasos, celdas);
+
+	iniciarGenerador(generador, semilla);
+	inicializarACE(ACE, celdas, inicializacion, NULL, &generador);
+	generarACEMotor(ACE, regla, pasos, celdas, reservarVector(espacio.estados, espacio.capacidadEstados, pasos));
+
+	sprintf(nombreFichero, "ACE_R%03d_C%05d_P%05d_%s.pgm", regla, celdas, pasos, inicializacion == INICIALIZACION_ALEATORIA ? "aleatoria" : "semilla");
+	guardaPGMiACE(nombreFichero, pasos, celdas, ACE, 1, 0);
+	if (trayectoria)
+		guardarTrayectoria(cambiarExtension(nombreFichero, "tra"), ACE, regla, pasos, celdas, inicializacion);
+
+	avanzarTrabajo(costeTrabajo(TRABAJO_ACE, celdas, pasos));
+}
+
+void trabajoHamming(EspacioTrabajo& espacio, int regla, int celdas, int pasos, int inicializacion, unsigned long long semilla, int formato)
+{
+	char nombreFichero[256];
+	double eh;
+	GeneradorAleatorio generador;
+	int** ACE = reservarACE(&espacio.ACE, espacio.pasosACE, espacio.celdasACE, pasos, celdas);
+	int** ACE1 = reservarACE(&espacio.ACE1, espacio.pasosACE1, espacio.celdasACE1, pasos, celdas);
+
+	iniciarGenerador(generador, semilla);
+	inicializarACE(ACE, celdas, inicializacion, NULL, &generador);
+	CicloACE ciclo;
+	generarACEMotor(ACE, regla, pasos, celdas, reservarVector(espacio.estados, espacio.capacidadEstados, pasos), &ciclo);
+	int* distanciasHamming = generarHamming(ACE, regla, pasos, celdas, ACE1, &ciclo);
+
+	sprintf(nombreFichero, "HAMMING_R%03d_C%05d_P%05d.dat", regla, celdas, pasos);
+	if (formato & FORMATO_TEXTO)
+		guardaPLOT(nombreFichero, distanciasHamming, pasos + 1);
+	if (formato & FORMATO_NPY)
+		guardaNPY(cambiarExtension(nombreFichero, "npy"), distanciasHamming, pasos + 1);
+
+	if (exponenteHamming(distanciasHamming, pasos + 1, eh))
+		printf("El exponente de hamming (R%03d,C%05d,P%05d) es %.5f\n", regla, celdas, pasos, eh);
+	else
+		printf("No se pudo calcular el exponente de hamming (R%03d,C%05d,P%05d)\n", regla, celdas, pasos);
+
+	delete[] distanciasHamming;
+
+	avanzarTrabajo(costeTrabajo(TRABAJO_HAMMING, celdas, pasos));
+}
+
+void trabajoAnalisis(EspacioTrabajo& espacio, int regla, int celdas, int pasos, int inicializacion, unsigned long long semilla, int formato, int observadores)
+{
+	GeneradorAleatorio generador;
+	int** ACE = reservarACE(&espacio.ACE, espacio.pasosACE, espacio.celdasACE, pasos, celdas);
+	int** ACE1 = NULL;
+	long* estados = reservarVector(espacio.estados, espacio.capacidadEstados, pasos);
+
+	iniciarGenerador(generador, semilla);
+	inicializarACE(ACE, celdas, inicializacion, NULL, &generador);
+
+	// El gemelo sólo necesita la fila inicial: se simula primero para que 'estados' quede con los del ACE
+	if (gemeloObservadores(observadores)) {
+		ACE1 = reservarACE(&espacio.ACE1, espacio.pasosACE1, espacio.celdasACE1, pasos, celdas);
+		inicializarACE(ACE1, celdas, INICIALIZACION_SIMILAR, ACE[0]);
+		generarACEMotor(ACE1, regla, pasos, celdas, estados);
+	}
+	generarACEMotor(ACE, regla, pasos, celdas, estados);
+
+	// Una sola pasada por las filas para todos los observadores
+	Observadores& observacion = espacio.observadores;
+	empezarObservadores(observacion, observadores, regla, celdas, pasos);
+	MEDIR_INICIO(FASE_ANALISIS);
+	long codigo0 = 0;
+	if (celdas < 32)
+		for (int j = 1; j < celdas + 1; j++)
+			codigo0 += ((long)ACE[0][j] << (celdas - j));
+	for (int i = 0; i < pasos + 1; i++)
+		observarFila(observacion, i, ACE[i], ACE1 != NULL ? ACE1[i] : NULL, i == 0 ? codigo0 : estados[i - 1]);
+	MEDIR_FIN();
+
+	terminarObservadores(observacion, ACE, inicializacion, formato);
+
+	avanzarTrabajo(costeTrabajo(TRABAJO_ANALISIS, celdas, pasos));
+}
+
+/*
+	Devuelve en 'destino' el estado al que llega cada estado tras 'pasos' pasos, componiendo la tabla de sucesores
+	consigo misma por duplicación (log2(pasos) composiciones de la tabla entera en lugar de 'pasos' pasos por estado).
+*/
+static void potenciaSucesores(unsigned int* destino, const TablaSucesores& tabla, int pasos)
+{
+	unsigned int estadosPosibles = 1u << tabla.celdas;
+	unsigned int* potencia = (unsigned int*)reservarTabla((size_t)estadosPosibles * sizeof(unsigned int));	// Sucesores a 2^k pasos
+	unsigned int* auxiliar = (unsigned int*)reservarTabla((size_t)estadosPosibles * sizeof(unsigned int));
+
+	MEDIR_INICIO(FASE_SIMULACION);
+
+	memcpy(potencia, tabla.sucesor, estadosPosibles * sizeof(unsigned int));
+	for (unsigned int e = 0; e < estadosPosibles; e++)
+		destino[e] = e;
+	for (int resto = pasos; resto > 0; resto >>= 1) {
+		if (resto & 1)
+			for (unsigned int e = 0; e < estadosPosibles; e++)
+				destino[e] = potencia[destino[e]];
+		if (resto > 1) {
+			for (unsigned int e = 0; e < estadosPosibles; e++)
+				auxiliar[e] = potencia[potencia[e]];
+			unsigned int* t = potencia;
+			potencia = auxiliar;
+			auxiliar = t;
+		}
+	}
+
+	MEDIR_FIN();
+
+	liberarTabla(potencia);
+	liberarTabla(auxiliar);
+}
+
+/*
+	Guarda el punto de control de ATRACTOR: las visitas acumuladas hasta el estado 'estado' (sin incluirlo).
+*/
+static void guardarControlAtractor(PuntoControl* control, const Histograma* probabilidades, int* visitadosPaso, int* estadoVisitado, int pasos, int estadosPosibles, int estado)
+{
+	const void** datos = new const void* [pasos + 3];
+	unsigned long long* bytes = new unsigned long long [pasos + 3];
+	unsigned int** copias = new unsigned int* [pasos + 1];
+	for (int p = 0; p < pasos + 1; p++)
+		datos[p] = bloqueHistograma(probabilidades[p], bytes[p], copias[p]);
+	datos[pasos + 1] = visitadosPaso;
+	bytes[pasos + 1] = (unsigned long long)(pasos + 1) * sizeof(int);
+	datos[pasos + 2] = estadoVisitado;
+	bytes[pasos + 2] = (unsigned long long)estadosPosibles * sizeof(int);
+
+	control->cabecera.estado = estado;
+	if (!guardarPuntoControl(*control, datos, bytes, pasos + 3))
+		printf("No se pudo guardar el punto de control %s\n", control->nombre);
+
+	for (int p = 0; p < pasos + 1; p++)
+		delete[] copias[p];
+	delete[] copias;
+	delete[] datos;
+	delete[] bytes;
+}
+
+/*
+	Deja a cero en 'espacio' las visitas y las sumas de entropía de ATRACTOR para 'celdas' celdas y 'pasos' pasos.
+*/
+static void prepararAtractor(EspacioTrabajo& espacio, int celdas, int pasos)
+{
+	int estadosPosibles = 1 << celdas;
+
+	// Las estructuras de los atractores se reutilizan (a 0) si tienen las mismas dimensiones
+	if (espacio.probabilidades != NULL && espacio.pasosAtractor == pasos && espacio.estadosAtractor == estadosPosibles) {
+		for (int p = 0; p < pasos + 1; p++)
+			vaciarHistograma(espacio.probabilidades[p], estadosPosibles);
+		memset(espacio.visitadosPaso, 0, (pasos + 1) * sizeof(int));
+		vaciarTabla(espacio.estadoVisitado, (size_t)estadosPosibles * sizeof(int));
+	}
+	else {
+		if (espacio.probabilidades != NULL)
+			liberarAtractores(espacio.probabilidades, espacio.visitadosPaso, espacio.estadoVisitado, espacio.pasosAtractor);
+		inicializarAtractores(&espacio.probabilidades, &espacio.visitadosPaso, &espacio.estadoVisitado, pasos, estadosPosibles);
+		espacio.pasosAtractor = pasos;
+		espacio.estadosAtractor = estadosPosibles;
+	}
+
+	// La entropía de cada paso se acumula a medida que cambian las visitas
+	reservarVector(espacio.sumasEntropia, espacio.capacidadSumas, pasos + 1);
+	memset(espacio.sumasEntropia, 0, (pasos + 1) * sizeof(unsigned long long));
+}
+
+/*
+	Guarda las salidas de ATRACTOR a partir de las visitas y las sumas de entropía acumuladas en 'espacio'.
+*/
+static void guardarResultadosAtractor(EspacioTrabajo& espacio, int regla, int celdas, int pasos, int formato)
+{
+	char nombreFichero[256];
+	int estadosPosibles = 1 << celdas;
+	const Histograma* probabilidades = espacio.probabilidades;
+
+	sprintf(nombreFichero, "ATRACTOR_R%03d_C%05d_P%05d.dat", regla, celdas, pasos);
+	if (formato & FORMATO_TEXTO)
+		guardarAtractorPLOT(nombreFichero, probabilidades, pasos);
+	if (formato & FORMATO_NPY)
+		guardarAtractorNPY(cambiarExtension(nombreFichero, "npy"), probabilidades, pasos);
+
+	sprintf(nombreFichero, "ATRACTOR_VISITADO_PASO_R%03d_C%05d_P%05d.dat", regla, celdas, pasos);
+	if (formato & FORMATO_TEXTO)
+		guardaPLOT(nombreFichero, espacio.visitadosPaso, pasos + 1);
+	if (formato & FORMATO_NPY)
+		guardaNPY(cambiarExtension(nombreFichero, "npy"), espacio.visitadosPaso, pasos + 1);
+
+	sprintf(nombreFichero, "ATRACTOR_ESTADO_VISITADO_R%03d_C%05d_P%05d.dat", regla, celdas, pasos);
+	if (formato & FORMATO_TEXTO)
+		guardaPLOT(nombreFichero, espacio.estadoVisitado, estadosPosibles);
+	if (formato & FORMATO_NPY)
+		guardaNPY(cambiarExtension(nombreFichero, "npy"), espacio.estadoVisitado, estadosPosibles);
+
+	// Evolución de la entropia en el tiempo a partir de las sumas acumuladas durante el recorrido
+	double* entropias = reservarVector(espacio.serie, espacio.capacidadSerie, pasos + 1);
+	for (int p = 0; p < pasos + 1; p++)
+		entropias[p] = entropiaSuma(espacio.sumasEntropia[p], celdas);
+	sprintf(nombreFichero, "ENTROPIA_R%03d_C%05d_P%05d.dat", regla, celdas, pasos);
+	if (formato & FORMATO_TEXTO)
+		guardaPLOT(nombreFichero, entropias, pasos + 1);
+	if (formato & FORMATO_NPY)
+		guardaNPY(cambiarExtension(nombreFichero, "npy"), entropias, pasos + 1);
+}
+
+/*
+	Guarda en el fichero de resultados parciales la pieza de ATRACTOR del tramo 'parte':
+	los histogramas de cada paso y las visitas a cada estado.
+*/
+static void guardarPiezaAtractor(EspacioTrabajo& espacio, int regla, int celdas, int pasos, const ParteTrabajo* parte)
+{
+	CabeceraPieza pieza;
+	pieza.indiceRegla = parte->indiceRegla;
+	pieza.regla = regla;
+	pieza.N = celdas;
+	pieza.bloques = pasos + 2;
+	pieza.desde = parte->desde;
+	pieza.hasta = parte->hasta;
+
+	const void** datos = new const void* [pasos + 2];
+	unsigned long long* bytes = new unsigned long long [pasos + 2];
+	unsigned int** copias = new unsigned int* [pasos + 1];
+	for (int p = 0; p < pasos + 1; p++)
+		datos[p] = bloqueHistograma(espacio.probabilidades[p], bytes[p], copias[p]);
+	datos[pasos + 1] = espacio.estadoVisitado;
+	bytes[pasos + 1] = (unsigned long long)(1LL << celdas) * sizeof(int);
+
+	if (!guardarPiezaParcial(*parte->parcial, pieza, datos, bytes))
+		printf("No se pudieron guardar los resultados parciales en %s\n", parte->parcial->nombre);
+
+	for (int p = 0; p < pasos + 1; p++)
+		delete[] copias[p];
+	delete[] copias;
+	delete[] datos;
+	delete[] bytes;
+}
+
+void trabajoAtractor(EspacioTrabajo& espacio, int regla, int celdas, int pasos, int formato, PuntoControl* control, const ParteTrabajo* parte)
+{
+	int estadosPosibles = 1 << celdas;		// Todos los estados posibles según el número de celdas
+	int estadoInicial = 0;					// Primer estado a simular (distinto de 0 al reanudar o en un tramo)
+	int estadoLimite = estadosPosibles;		// Estado siguiente al último a simular (distinto de estadosPosibles en un tramo)
+	int** ACE = reservarACE(&espacio.ACE, espacio.pasosACE, espacio.celdasACE, pasos, celdas);
+	long* estados = reservarVector(espacio.estados, espacio.capacidadEstados, pasos);
+	int* base = reservarVector(espacio.base, espacio.capacidadBase, celdas + 2);
+
+	if (parte != NULL) {
+		estadoInicial = (int)parte->desde;
+		estadoLimite = (int)parte->hasta;
+	}
+
+	prepararAtractor(espacio, celdas, pasos);
+	Histograma* probabilidades = espacio.probabilidades;
+	int* visitadosPaso = espacio.visitadosPaso;
+	int* estadoVisitado = espacio.estadoVisitado;
+	unsigned long long* sumasEntropia = espacio.sumasEntropia;
+
+	// Si se reanuda desde un punto de control tomado a mitad de la regla, recuperamos las visitas acumuladas
+	if (control != NULL && control->reanudar) {
+		if (control->cabecera.bloques > 0) {
+			bool correcto = true;
+			for (int p = 0; p < pasos + 1 && correcto; p++) {
+				unsigned long long bytes;
+				const void* datos = datosBloquePuntoControl(*control, p, bytes);
+				correcto = datos != NULL && restaurarHistograma(probabilidades[p], estadosPosibles, datos, bytes);
+			}
+			correcto = correcto && bloquePuntoControl(*control, pasos + 1, visitadosPaso, (unsigned long long)(pasos + 1) * sizeof(int));
+			correcto = correcto && bloquePuntoControl(*control, pasos + 2, estadoVisitado, (unsigned long long)estadosPosibles * sizeof(int));
+			if (correcto) {
+				estadoInicial = control->cabecera.estado;
+				for (int p = 0; p < pasos + 1; p++)
+					sumasEntropia[p] = sumaEntropia(probabilidades[p]);
+			}
+			else {
+				printf("El punto de control %s no corresponde a esta ejecución... Se empieza la regla %d desde el principio\n", control->nombre, regla);
+				for (int p = 0; p < pasos + 1; p++)
+					vaciarHistograma(probabilidades[p], estadosPosibles);
+				memset(visitadosPaso, 0, (pasos + 1) * sizeof(int));
+				vaciarTabla(estadoVisitado, (size_t)estadosPosibles * sizeof(int));
+			}
+		}
+		restauradoPuntoControl(*control);
+	}
+
+	// Con la tabla de sucesores la lista de estados de cada simulación se obtiene sin simular el ACE
+	TablaSucesores tabla;
+	bool sucesores = obtenerTablaSucesores(tabla, regla, celdas);
+
+	// Recorremos todos los estados posibles (o los del tramo)
+	int avisado = estadoInicial;
+	for (int estado = estadoInicial; estado < estadoLimite; estado++) {
+		// Inicializamos los valores relativos al paso 0
+		sumarHistograma(probabilidades[0], estado);
+		visitadosPaso[0]++;
+		estadoVisitado[estado]++;
+
+		if (sucesores) {
+			MEDIR_INICIO(FASE_SIMULACION);
+			unsigned int e = (unsigned int)estado;
+			for (int p = 0; p < pasos; p++) {
+				e = tabla.sucesor[e];
+				estados[p] = (long)e;
+			}
+			MEDIR_FIN();
+		}
+		else {
+			// En 'base' ponemos el estado inicial del ACE correspondiente a 'estado'
+			generarEstadoInicial(base, estado, celdas);
+
+			// Inicializamos 'ACE' con el estado inicial 'base'
+			inicializarACE(ACE, celdas, INICIALIZACION_FIJA, base);
+
+			// Generamos la evolución del ACE y la lista de estados por la que ha pasado (sólo se usan los estados)
+			generarACE(ACE, regla, pasos, celdas, estados, NULL, false);
+		}
+
+		// probabilidades: Actualizamos las veces que cada estado es visitado en cada paso
+		// visitadosPaso: Actualizamos el número de estados diferentes visitados en cada paso
+		// estadoVisitado: Actualizamos el número de veces que un estado ha sido visitado
+		// sumasEntropia: Actualizamos la suma de c·log2(c) del paso (una primera visita no la cambia)
+		MEDIR_INICIO(FASE_HISTOGRAMA);
+		for (int p = 0; p < pasos; p++) {
+			int visitas = sumarHistograma(probabilidades[p + 1], (unsigned int)estados[p]);
+			if (visitas == 1)
+				visitadosPaso[p + 1]++;
+			else
+				sumasEntropia[p + 1] += incrementoEntropia(visitas);
+			estadoVisitado[estados[p]]++;
+		}
+		MEDIR_FIN();
+
+		if ((estado + 1) % ESTADOS_PROGRESO == 0) {
+			avanzarTrabajo((long long)(estado + 1 - avisado) * celdas * pasos);
+			avisado = estado + 1;
+			if (tocaPuntoControl(control))
+				guardarControlAtractor(control, probabilidades, visitadosPaso, estadoVisitado, pasos, estadosPosibles, estado + 1);
+		}
+	}
+	avanzarTrabajo((long long)(estadoLimite - avisado) * celdas * pasos);
+	liberarTablaSucesores(tabla);
+
+	MEDIR_CONTAR(CONTADOR_ESTADOS, estadoLimite - estadoInicial);
+
+	// Guardamos los resultados (los de un tramo, como pieza del fichero de resultados parciales)
+	if (parte != NULL)
+		guardarPiezaAtractor(espacio, regla, celdas, pasos, parte);
+	else
+		guardarResultadosAtractor(espacio, regla, celdas, pasos, formato);
+}
+
+/*
+	Guarda las salidas de ENTROPIA a partir de las series calculadas en 'espacio'.
+*/
+static void guardarResultadosEntropia(EspacioTrabajo& espacio, int regla, int pasos, int formato)
+{
+	char nombreFichero[256];
+	const int valores = ENTROPIA_N_MAX - ENTROPIA_N_MIN + 1;
+	double* noVisitados = espacio.serie;
+	double* entropias = espacio.serie + valores;
+
+	sprintf(nombreFichero, "NOVISITADOS_R%03d_P%05d.dat", regla, pasos);
+	if (formato & FORMATO_TEXTO)
+		guardaPLOT(nombreFichero, noVisitados, valores, ENTROPIA_N_MIN, 5);
+	if (formato & FORMATO_NPY)
+		guardaNPY(cambiarExtension(nombreFichero, "npy"), noVisitados, valores, ENTROPIA_N_MIN);
+
+	sprintf(nombreFichero, "ENTROPIA_R%03d_P%05d.dat", regla, pasos);
+	if (formato & FORMATO_TEXTO)
+		guardaPLOT(nombreFichero, entropias, valores, ENTROPIA_N_MIN);
+	if (formato & FORMATO_NPY)
+		guardaNPY(cambiarExtension(nombreFichero, "npy"), entropias, valores, ENTROPIA_N_MIN);
+}
+
+void trabajoEntropia(EspacioTrabajo& espacio, int regla, int pasos, int formato, PuntoControl* control, const ParteTrabajo* parte)
+{
+	int NInicial = ENTROPIA_N_MIN;			// Primer número de celdas a calcular (distinto de ENTROPIA_N_MIN al reanudar)
+	int estadoInicial = 0;					// Primer estado a simular para NInicial celdas
+	const int valores = ENTROPIA_N_MAX - ENTROPIA_N_MIN + 1;
+	double* series = reservarVector(espacio.serie, espacio.capacidadSerie, 2 * valores);
+	double* noVisitados = series;				// Porcentajes finales de estados no visitados
+	double* entropias = series + valores;		// Valores estacionarios de las entropías
+	long* estados = reservarVector(espacio.estados, espacio.capacidadEstados, pasos);
+	int visitadosPaso = 0;
+
+	// Si se reanuda desde un punto de control tomado a mitad de la regla, recuperamos la posición,
+	// las visitas acumuladas para ese número de celdas y los resultados de los anteriores
+	if (control != NULL && control->reanudar) {
+		int N = control->cabecera.N;
+		if (control->cabecera.bloques > 0 && N >= ENTROPIA_N_MIN && N <= ENTROPIA_N_MAX) {
+			unsigned long long bytes;
+			const void* datos = datosBloquePuntoControl(*control, 0, bytes);
+			if (datos != NULL && restaurarHistograma(espacio.visitas, 1LL << N, datos, bytes) &&
+				bloquePuntoControl(*control, 1, &visitadosPaso, sizeof(int)) &&
+				bloquePuntoControl(*control, 2, series, 2 * valores * sizeof(double))) {
+				NInicial = N;
+				estadoInicial = control->cabecera.estado;
+			}
+			else {
+				printf("El punto de control %s no corresponde a esta ejecución... Se empieza la regla %d desde el principio\n", control->nombre, regla);
+				visitadosPaso = 0;
+			}
+		}
+		restauradoPuntoControl(*control);
+	}
+
+	// Hacemos los cálculos para ACEs con números de celdas que van de ENTROPIA_N_MIN a ENTROPIA_N_MAX
+	for (int N = NInicial; N <= ENTROPIA_N_MAX; N++) {
+		long estadosPosibles = 1L << N;
+		Histograma& probabilidades = espacio.visitas;
+		int* base = reservarVector(espacio.base, espacio.capacidadBase, N + 2);
+		int** ACE = reservarACE(&espacio.ACE, espacio.pasosACE, espacio.celdasACE, pasos, N);
+		long primero = (N == NInicial) ? estadoInicial : 0;
+		long limite = estadosPosibles;
+
+		// En un tramo sólo se simulan sus estados de N celdas (si tiene alguno)
+		if (parte != NULL) {
+			long long inicio = posicionTrabajo(TRABAJO_ENTROPIA, 0, N, 0);
+			primero = (long)(parte->desde > inicio ? parte->desde - inicio : 0);
+			limite = (long)(parte->hasta < inicio + estadosPosibles ? parte->hasta - inicio : estadosPosibles);
+			if (primero >= limite)
+				continue;
+		}
+
+		if (primero == 0 || parte != NULL) {
+			visitadosPaso = 0;
+			vaciarHistograma(probabilidades, estadosPosibles);
+		}
+
+		// Con la tabla de sucesores se obtiene de una vez el estado final de todos los estados iniciales
+		TablaSucesores tabla;
+		unsigned int* finales = NULL;
+		if (obtenerTablaSucesores(tabla, regla, N)) {
+			finales = (unsigned int*)reservarTabla((size_t)estadosPosibles * sizeof(unsigned int));
+			potenciaSucesores(finales, tabla, pasos);
+			liberarTablaSucesores(tabla);
+		}
+
+		// Recorremos todos los estados posibles y anotamos el estado al que se llega en el último paso
+		long avisado = primero;
+		for (long estado = primero; estado < limite; estado++) {
+			long estadoFinal;
+			if (finales != NULL)
+				estadoFinal = (long)finales[estado];
+			else {
+				generarEstadoInicial(base, estado, N);
+				inicializarACE(ACE, N, INICIALIZACION_FIJA, base);
+				generarACE(ACE, regla, pasos, N, estados, NULL, false);
+				estadoFinal = estados[pasos - 1];
+			}
+
+			if (sumarHistograma(probabilidades, (unsigned int)estadoFinal) == 1)
+				visitadosPaso++;
+
+			if ((estado + 1) % ESTADOS_PROGRESO == 0) {
+				avanzarTrabajo((long long)(estado + 1 - avisado) * N * pasos);
+				avisado = estado + 1;
+				if (tocaPuntoControl(control)) {
+					unsigned int* copia;
+					unsigned long long bytes[3] = { 0, sizeof(int), 2 * valores * sizeof(double) };
+					const void* datos[3] = { bloqueHistograma(probabilidades, bytes[0], copia), &visitadosPaso, series };
+					control->cabecera.N = N;
+					control->cabecera.estado = (int)(estado + 1);
+					if (!guardarPuntoControl(*control, datos, bytes, 3))
+						printf("No se pudo guardar el punto de control %s\n", control->nombre);
+					delete[] copia;
+				}
+			}
+		}
+		avanzarTrabajo((long long)(limite - avisado) * N * pasos);
+		liberarTabla(finales);
+
+		MEDIR_CONTAR(CONTADOR_ESTADOS, limite - primero);
+
+		// Los resultados de un tramo se guardan como pieza del fichero de resultados parciales
+		if (parte != NULL) {
+			CabeceraPieza pieza;
+			pieza.indiceRegla = parte->indiceRegla;
+			pieza.regla = regla;
+			pieza.N = N;
+			pieza.bloques = 1;
+			pieza.desde = primero;
+			pieza.hasta = limite;
+			unsigned int* copia;
+			unsigned long long bytes;
+			const void* datos = bloqueHistograma(probabilidades, bytes, copia);
+			if (!guardarPiezaParcial(*parte->parcial, pieza, &datos, &bytes))
+				printf("No se pudieron guardar los resultados parciales en %s\n", parte->parcial->nombre);
+			delete[] copia;
+			continue;
+		}
+
+		noVisitados[N - ENTROPIA_N_MIN] = (double)(estadosPosibles - visitadosPaso) / (double)estadosPosibles;
+		entropias[N - ENTROPIA_N_MIN] = entropia(probabilidades, N);
+	}
+
+	if (parte == NULL)
+		guardarResultadosEntropia(espacio, regla, pasos, formato);
+}
+
+void trabajoPreimagenes(EspacioTrabajo& espacio, int regla, int NMax, const int* distribuciones, int ndistribuciones, int formato)
+{
+	char nombreFichero[256];
+
+	// Las matrices de transferencia se comprueban primero contra la tabla de sucesores
+	if (!verificarPreimagenes(regla)) {
+		printf("No se guardan las preimágenes exactas de la regla %d\n", regla);
+		return;
+	}
+
+	// Fracción de estados sin preimágenes para cada número de celdas
+	if (NMax >= ENTROPIA_N_MIN) {
+		const int valores = NMax - ENTROPIA_N_MIN + 1;
+		double* noVisitados = reservarVector(espacio.serie, espacio.capacidadSerie, valores);
+		fraccionJardinesEden(regla, ENTROPIA_N_MIN, NMax, noVisitados);
+
+		sprintf(nombreFichero, "NOVISITADOS_EXACTO_R%03d.dat", regla);
+		if (formato & FORMATO_TEXTO)
+			guardaPLOT(nombreFichero, noVisitados, valores, ENTROPIA_N_MIN, 10);
+		if (formato & FORMATO_NPY)
+			guardaNPY(cambiarExtension(nombreFichero, "npy"), noVisitados, valores, ENTROPIA_N_MIN);
+	}
+
+	// Distribución del número de preimágenes
+	for (int d = 0; d < ndistribuciones; d++) {
+		double* preimagenes;
+		double* fraccion;
+		int valores = distribucionPreimagenes(regla, distribuciones[d], &preimagenes, &fraccion);
+		if (valores < 0) {
+			printf("La distribución de preimágenes de la regla %d con %d celdas necesita más de %d productos de matrices distintos... No se guarda\n",
+				regla, distribuciones[d], PREIMAGENES_MAX_MATRICES);
+			continue;
+		}
+
+		sprintf(nombreFichero, "PREIMAGENES_R%03d_C%05d.dat", regla, distribuciones[d]);
+		if (formato & FORMATO_TEXTO)
+			guardaParesPLOT(nombreFichero, preimagenes, fraccion, valores, 0, 10);
+		if (formato & FORMATO_NPY)
+			guardaParesNPY(cambiarExtension(nombreFichero, "npy"), preimagenes, fraccion, valores);
+		delete[] preimagenes;
+		delete[] fraccion;
+	}
+}
+
+bool fusionarPiezaTrabajo(EspacioTrabajo& espacio, const Parcial& parcial)
+{
+	const CabeceraParcial& cabecera = parcial.cabecera;
+	const CabeceraPieza& pieza = parcial.pieza;
+	unsigned long long bytes;
+	const void* datos;
+
+	if (cabecera.tipo == TRABAJO_ATRACTOR) {
+		int pasos = cabecera.pasos;
+		long long estadosPosibles = 1LL << cabecera.celdas;
+		if (pieza.bloques != pasos + 2)
+			return false;
+
+		// La primera pieza de la regla deja las visitas a cero
+		if (pieza.desde == 0)
+			prepararAtractor(espacio, cabecera.celdas, pasos);
+
+		for (int p = 0; p < pasos + 1; p++) {
+			datos = bloquePiezaParcial(parcial, p, bytes);
+			if (datos == NULL || !sumarBloqueHistograma(espacio.probabilidades[p], datos, bytes))
+				return false;
+		}
+		const int* visitas = (const int*)bloquePiezaParcial(parcial, pasos + 1, bytes);
+		if (visitas == NULL || bytes != (unsigned long long)estadosPosibles * sizeof(int))
+			return false;
+		for (long long e = 0; e < estadosPosibles; e++)
+			espacio.estadoVisitado[e] += visitas[e];
+		return true;
+	}
+
+	if (cabecera.tipo == TRABAJO_ENTROPIA) {
+		const int valores = ENTROPIA_N_MAX - ENTROPIA_N_MIN + 1;
+		long long estadosPosibles = 1LL << pieza.N;
+		double* series = reservarVector(espacio.serie, espacio.capacidadSerie, 2 * valores);
+		Histograma& probabilidades = espacio.visitas;
+		if (pieza.bloques != 1)
+			return false;
+
+		// La primera pieza de cada número de celdas deja las visitas a cero
+		if (pieza.desde == 0)
+			vaciarHistograma(probabilidades, estadosPosibles);
+
+		datos = bloquePiezaParcial(parcial, 0, bytes);
+		if (datos == NULL || probabilidades.estadosPosibles != estadosPosibles || !sumarBloqueHistograma(probabilidades, datos, bytes))
+			return false;
+
+		// Con la última pieza de este número de celdas ya se pueden calcular sus valores de las series
+		if (pieza.hasta == estadosPosibles) {
+			series[pieza.N - ENTROPIA_N_MIN] = (double)(estadosPosibles - probabilidades.distintos) / (double)estadosPosibles;
+			series[valores + pieza.N - ENTROPIA_N_MIN] = entropia(probabilidades, pieza.N);
+		}
+		return true;
+	}
+
+	return false;
+}
+
+void guardarFusionTrabajo(EspacioTrabajo& espacio, const CabeceraParcial& cabecera, int regla)
+{
+	if (cabecera.tipo == TRABAJO_ATRACTOR) {
+		// Los estados diferentes visitados en cada paso y las sumas de entropía salen de los histogramas completos
+		for (int p = 0; p < cabecera.pasos + 1; p++) {
+			espacio.visitadosPaso[p] = (int)espacio.probabilidades[p].distintos;
+			espacio.sumasEntropia[p] = sumaEntropia(espacio.probabilidades[p]);
+		}
+		guardarResultadosAtractor(espacio, regla, cabecera.celdas, cabecera.pasos, cabecera.formato);
+	}
+	else if (cabecera.tipo == TRABAJO_ENTROPIA)
+		guardarResultadosEntropia(espacio, regla, cabecera.pasos, cabecera.formato);
+}
@@ -0,0 +1,263 @@
+#ifndef _LIBTRABAJOS_H_
+#define _LIBTRABAJOS_H_
+
+#define TRABAJO_ACE					0		// Simulación y guardado de la imagen (herramienta ACE)
+#define TRABAJO_HAMMING				1		// Distancias y exponente de Hamming (herramienta HAMMING)
+#define TRABAJO_ATRACTOR			2		// Visitas a cada estado en cada paso y entropía (herramienta ATRACTOR)
+#define TRABAJO_ENTROPIA			3		// Entropía y estados no visitados en función de las celdas (herramienta ENTROPIA)
+#define TRABAJO_ANALISIS			4		// Varias medidas de una misma simulación en una sola pasada (herramienta ANALIZAR)
+
+#define ENTROPIA_N_MIN				3		// En evoluciones por número de celdas, valor mínimo
+#define ENTROPIA_N_MAX				20		// En evoluciones por número de celdas, valor máximo
+
+#include <stddef.h>
+#include <vector>
+#include "libhistograma.h"
+#include "libobservadores.h"
+
+struct PuntoControl;
+struct Parcial;
+struct CabeceraParcial;
+
+/*
+ * Memoria de trabajo que se reutiliza entre cálculos sucesivos. Sólo crece: si un trabajo necesita
+ * dimensiones mayores que las reservadas se vuelve a asignar, si no se aprovecha la que ya hay.
+ * Cada hilo debe usar su propio espacio de trabajo.
+ */
+struct EspacioTrabajo {
+	int** ACE;							// Evolución del ACE
+	int pasosACE, celdasACE;			// Dimensiones reservadas para 'ACE'
+	int** ACE1;							// Evolución del segundo ACE (distancias de Hamming)
+	int pasosACE1, celdasACE1;			// Dimensiones reservadas para 'ACE1'
+	long* estados;						// Estados por los que pasa cada simulación
+	int capacidadEstados;				// Posiciones reservadas para 'estados'
+	int* base;							// Estado inicial del ACE
+	int capacidadBase;					// Posiciones reservadas para 'base'
+	Histograma* probabilidades;			// Visitas a cada estado en cada paso (ATRACTOR)
+	int* visitadosPaso;					// Estados diferentes visitados en cada paso (ATRACTOR)
+	int* estadoVisitado;				// Visitas a cada estado en cualquier paso (ATRACTOR)
+	int pasosAtractor, estadosAtractor;	// Dimensiones reservadas para los datos de los atractores
+	unsigned long long* sumasEntropia;	// Suma de c·log2(c) de las visitas de cada paso (ATRACTOR, ver 'incrementoEntropia')
+	int capacidadSumas;					// Posiciones reservadas para 'sumasEntropia'
+	Histograma visitas;					// Visitas a cada estado en el último paso (ENTROPIA)
+	double* serie;						// Series de resultados (entropías, ...)
+	int capacidadSerie;					// Posiciones reservadas para 'serie'
+	Observadores observadores;			// Observadores de las filas de la simulación (ANALIZAR)
+};
+
+/*
+ * Un trabajo: una regla de una herramienta con unas dimensiones concretas (una combinación de una línea de trabajos).
+ */
+struct Trabajo {
+	int tipo;							// TRABAJO_ACE, TRABAJO_HAMMING, ...
+	int regla;
+	int celdas;
+	int pasos;
+	int inicializacion;					// Sólo TRABAJO_ACE, TRABAJO_HAMMING y TRABAJO_ANALISIS
+	unsigned long long semilla;			// Semilla de la inicialización aleatoria (sólo TRABAJO_ACE, TRABAJO_HAMMING y TRABAJO_ANALISIS)
+	bool trayectoria;					// Sólo TRABAJO_ACE
+	int formato;						// Sólo TRABAJO_HAMMING, TRABAJO_ATRACTOR, TRABAJO_ENTROPIA y TRABAJO_ANALISIS
+	int observadores;					// Sólo TRABAJO_ANALISIS (OBSERVADOR_*)
+	long long coste;					// Actualizaciones de celdas (costeTrabajo)
+};
+
+/*
+ * Tramo de una regla que le toca a un proceso cuando la ejecución se reparte en partes (opción parte:i/n, libparcial).
+ * En lugar de guardar las salidas, los resultados del tramo se añaden como piezas al fichero de resultados parciales.
+ */
+struct ParteTrabajo {
+	Parcial* parcial;					// Fichero de resultados parciales de la parte
+	int indiceRegla;					// Posición de la regla en la lista
+	long long desde, hasta;				// Posiciones del recorrido de la regla a simular: [desde, hasta) (ver 'posicionTrabajo')
+};
+
+/*
+ * Nombre: iniciarEspacioTrabajo
+ *
+ * Descripción: Deja un espacio de trabajo vacío (sin memoria reservada).
+ *
+ */
+void iniciarEspacioTrabajo(EspacioTrabajo& espacio);
+
+/*
+ * Nombre: liberarEspacioTrabajo
+ *
+ * Descripción: Libera toda la memoria reservada en un espacio de trabajo y lo deja vacío.
+ *
+ */
+void liberarEspacioTrabajo(EspacioTrabajo& espacio);
+
+/*
+ * Nombre: iniciarProgresoTrabajos
+ *
+ * Descripción: Establece el trabajo total (en actualizaciones de celdas, ver 'costeTrabajo') del que informarán
+ *              las funciones trabajo* a medida que avanzan, para mostrar el progreso (libmedidas).
+ *              Es seguro llamar a las funciones trabajo* desde varios hilos a la vez.
+ *
+ */
+void iniciarProgresoTrabajos(long long total);
+
+/*
+ * Nombre: costeTrabajo
+ *
+ * Descripción: Devuelve el número de actualizaciones de celdas que realiza un trabajo (para el progreso y para ordenar trabajos).
+ *
+ */
+long long costeTrabajo(int tipo, int celdas, int pasos);
+
+/*
+ * Nombre: estadosTrabajo
+ *
+ * Descripción: Devuelve las posiciones del recorrido de una regla en ATRACTOR (los 2^celdas estados iniciales)
+ *              o en ENTROPIA (los estados de ENTROPIA_N_MIN celdas, después los de ENTROPIA_N_MIN + 1, ... hasta ENTROPIA_N_MAX).
+ *
+ */
+long long estadosTrabajo(int tipo, int celdas);
+
+/*
+ * Nombre: posicionTrabajo
+ *
+ * Descripción: Devuelve la posición en el recorrido de una regla (ver 'estadosTrabajo') del estado 'estado' de N celdas
+ *              (estado = 2^N es la posición siguiente al último). Devuelve -1 si no forma parte del recorrido.
+ *
+ */
+long long posicionTrabajo(int tipo, int celdas, int N, long long estado);
+
+/*
+ * Nombre: tramoReglaTrabajo
+ *
+ * Descripción: Calcula el tramo del recorrido de la regla de la posición 'indiceRegla' de una lista de 'nreglas' reglas
+ *              que le toca a la parte 'parte' de 'partes' (ver libparcial) y su coste (como en 'costeTrabajo').
+ *
+ * Devuelve falso si a esa parte no le toca nada de la regla.
+ *
+ */
+bool tramoReglaTrabajo(int tipo, int celdas, int pasos, int nreglas, int indiceRegla, int parte, int partes, ParteTrabajo& tramo, long long& coste);
+
+/*
+ * Nombre: interpretarLineaTrabajos
+ *
+ * Descripción: Interpreta una línea de trabajos (el nombre de la herramienta seguido de sus opciones, con la misma
+ *              sintaxis que en la línea de comandos, ver LOTES) y añade a 'trabajos' un trabajo por cada combinación
+ *              de regla, celdas y pasos. 'semilla' es la semilla si la línea no indica la suya. Lo que sigue a '#'
+ *              es un comentario. Se puede llamar desde varios hilos a la vez ('linea' se modifica).
+ *
+ * avisos: Texto en el que se añaden los avisos (opciones desconocidas, línea ignorada...), uno por línea.
+ * tamAvisos: Capacidad de 'avisos' (incluido el 0 final).
+ *
+ * Devuelve el número de trabajos añadidos (0 si la línea está vacía) o -1 si la línea no es válida (también si
+ * algún valor de reglas, celdas o pasos está fuera de rango).
+ *
+ */
+int interpretarLineaTrabajos(char* linea, unsigned long long semilla, std::vector<Trabajo>& trabajos, char* avisos, size_t tamAvisos);
+
+/*
+ * Nombre: ejecutarTrabajo
+ *
+ * Descripción: Ejecuta un trabajo con la función trabajo* de su herramienta (sin punto de control ni partes).
+ *
+ */
+void ejecutarTrabajo(EspacioTrabajo& espacio, const Trabajo& trabajo);
+
+/*
+ * Nombre: trabajoACE
+ *
+ * Descripción: Inicializa y simula un ACE y guarda su evolución en ACE_R..._C..._P..._<inicializacion>.pgm
+ *              (y en un fichero de trayectoria .tra si se pide).
+ *
+ * espacio: Espacio de trabajo del hilo.
+ * regla, celdas, pasos: Parámetros del ACE.
+ * inicializacion: INICIALIZACION_SEMILLA o INICIALIZACION_ALEATORIA.
+ * semilla: Semilla de la inicialización aleatoria. Cada trabajo usa su propio generador (flujo 0 de la semilla), por lo que
+ *          el resultado no depende del hilo que lo ejecute y es el mismo que el de la herramienta con la misma semilla.
+ * trayectoria: Cierto si también hay que guardar la trayectoria.
+ *
+ */
+void trabajoACE(EspacioTrabajo& espacio, int regla, int celdas, int pasos, int inicializacion, unsigned long long semilla, bool trayectoria);
+
+/*
+ * Nombre: trabajoHamming
+ *
+ * Descripción: Simula un ACE y el que difiere de él en la celda central, guarda la evolución de su distancia
+ *              de Hamming en HAMMING_R..._C..._P....dat (o .npy) y muestra el exponente de Hamming.
+ *              La inicialización y la semilla son como en 'trabajoACE'.
+ *
+ */
+void trabajoHamming(EspacioTrabajo& espacio, int regla, int celdas, int pasos, int inicializacion, unsigned long long semilla, int formato);
+
+/*
+ * Nombre: trabajoAnalisis
+ *
+ * Descripción: Inicializa y simula un ACE (y, si algún observador lo necesita, el que difiere de él en la celda central)
+ *              una sola vez y entrega cada fila de la evolución a los observadores indicados (libobservadores),
+ *              que guardan sus salidas al terminar. Las salidas de la imagen y de la distancia de Hamming son las mismas
+ *              que las de 'trabajoACE' y 'trabajoHamming'. La inicialización y la semilla son como en 'trabajoACE'.
+ *
+ * observadores: Combinación de OBSERVADOR_*.
+ *
+ */
+void trabajoAnalisis(EspacioTrabajo& espacio, int regla, int celdas, int pasos, int inicializacion, unsigned long long semilla, int formato, int observadores);
+
+/*
+ * Nombre: trabajoAtractor
+ *
+ * Descripción: Simula todos los estados iniciales posibles de un ACE de 'celdas' celdas y guarda las visitas
+ *              a cada estado en cada paso (ATRACTOR_...), los estados visitados en cada paso (ATRACTOR_VISITADO_PASO_...),
+ *              las visitas a cada estado (ATRACTOR_ESTADO_VISITADO_...) y la entropía en cada paso (ENTROPIA_R..._C..._P...).
+ *
+ * control: Si no es NULL, cada 'intervalo' segundos se guarda en él la posición y las visitas acumuladas (libpuntocontrol).
+ *          Si se está reanudando, se continúa desde el estado guardado con las visitas guardadas.
+ * parte: Si no es NULL, sólo se simulan los estados del tramo y sus visitas se guardan como una pieza
+ *        (histogramas de cada paso y visitas a cada estado) del fichero de resultados parciales, sin guardar las salidas.
+ *
+ */
+void trabajoAtractor(EspacioTrabajo& espacio, int regla, int celdas, int pasos, int formato, PuntoControl* control = NULL, const ParteTrabajo* parte = NULL);
+
+/*
+ * Nombre: trabajoEntropia
+ *
+ * Descripción: Para ACEs de ENTROPIA_N_MIN a ENTROPIA_N_MAX celdas, simula todos los estados iniciales posibles
+ *              y guarda el porcentaje de estados no visitados (NOVISITADOS_...) y la entropía (ENTROPIA_R..._P...)
+ *              tras 'pasos' pasos.
+ *
+ * control: Como en 'trabajoAtractor' (se guardan también el número de celdas en curso y los resultados de los anteriores).
+ * parte: Como en 'trabajoAtractor': se guarda una pieza (el histograma del último paso) por cada número de celdas del tramo.
+ *
+ */
+void trabajoEntropia(EspacioTrabajo& espacio, int regla, int pasos, int formato, PuntoControl* control = NULL, const ParteTrabajo* parte = NULL);
+
+/*
+ * Nombre: trabajoPreimagenes
+ *
+ * Descripción: Sin simular, calcula exactamente las preimágenes de un paso de la regla (ver libpreimagenes): guarda
+ *              la fracción de estados sin preimágenes (los que no se visitan en el primer paso, como NOVISITADOS_..._P00001)
+ *              para anillos de ENTROPIA_N_MIN a 'NMax' celdas (NOVISITADOS_EXACTO_R...) y la distribución del número
+ *              de preimágenes para cada uno de los 'ndistribuciones' números de celdas de 'distribuciones' (PREIMAGENES_R..._C...).
+ *              Antes se comprueban los resultados contra la enumeración de los estados con pocas celdas; si no coinciden
+ *              no se guarda nada.
+ *
+ */
+void trabajoPreimagenes(EspacioTrabajo& espacio, int regla, int NMax, const int* distribuciones, int ndistribuciones, int formato);
+
+/*
+ * Nombre: fusionarPiezaTrabajo
+ *
+ * Descripción: Suma a los resultados acumulados en 'espacio' los de la pieza actual de un fichero de resultados parciales
+ *              de ATRACTOR o ENTROPIA. Las piezas de cada regla se deben sumar en el orden del recorrido, empezando
+ *              por la que contiene su primera posición (que deja los resultados acumulados a cero).
+ *
+ * Devuelve falso si los datos de la pieza no corresponden a los parámetros del fichero.
+ *
+ */
+bool fusionarPiezaTrabajo(EspacioTrabajo& espacio, const Parcial& parcial);
+
+/*
+ * Nombre: guardarFusionTrabajo
+ *
+ * Descripción: Una vez sumadas todas las piezas de una regla, guarda las mismas salidas que 'trabajoAtractor'
+ *              o 'trabajoEntropia' sin partes.
+ *
+ */
+void guardarFusionTrabajo(EspacioTrabajo& espacio, const CabeceraParcial& cabecera, int regla);
+
+#endif
@@ -0,0 +1,402 @@
+#include <string.h>
+#include "libACE.h"
+#include "libcontenedor.h"
+#include "libtrayectoria.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#pragma warning ( disable: 4996 )
+
+// Posicionamiento en ficheros de más de 2 GB
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+#define RACHA_CEROS		0x80000000u		// Bit de la palabra de control que indica una racha de palabras a 0
+#define MAX_RACHA		0x7FFFFFFFu		// Longitud máxima de una racha
+
+/*
+	Comprime 'n' palabras por longitud de rachas de palabras a 0. Devuelve el número de bytes escritos en 'destino',
+	que debe tener espacio para al menos 12 * n + 4 bytes (caso peor).
+*/
+static size_t comprimirPalabras(const unsigned long long* palabras, size_t n, unsigned char* destino)
+{
+	size_t bytes = 0;
+	size_t i = 0;
+	while (i < n) {
+		size_t j = i;
+		unsigned int control;
+		if (palabras[i] == 0) {
+			// Racha de palabras a 0: sólo se guarda la palabra de control
+			while (j < n && palabras[j] == 0 && j - i < MAX_RACHA)
+				j++;
+			control = RACHA_CEROS | (unsigned int)(j - i);
+			memcpy(destino + bytes, &control, sizeof(control));
+			bytes += sizeof(control);
+		}
+		else {
+			// Racha de literales: palabra de control seguida de las palabras
+			while (j < n && palabras[j] != 0 && j - i < MAX_RACHA)
+				j++;
+			control = (unsigned int)(j - i);
+			memcpy(destino + bytes, &control, sizeof(control));
+			bytes += sizeof(control);
+			memcpy(destino + bytes, palabras + i, (j - i) * sizeof(unsigned long long));
+			bytes += (j - i) * sizeof(unsigned long long);
+		}
+		i = j;
+	}
+	return bytes;
+}
+
+/*
+	Descomprime en 'palabras' (n palabras) los 'bytes' bytes de 'origen'. Devuelve falso si los datos no son correctos.
+*/
+static bool descomprimirPalabras(const unsigned char* origen, size_t bytes, unsigned long long* palabras, size_t n)
+{
+	size_t i = 0;
+	size_t leidos = 0;
+	while (i < n) {
+		unsigned int control;
+		if (leidos + sizeof(control) > bytes)
+			return false;
+		memcpy(&control, origen + leidos, sizeof(control));
+		leidos += sizeof(control);
+
+		size_t racha = control & MAX_RACHA;
+		if (racha == 0 || i + racha > n)
+			return false;
+		if (control & RACHA_CEROS)
+			memset(palabras + i, 0, racha * sizeof(unsigned long long));
+		else {
+			if (leidos + racha * sizeof(unsigned long long) > bytes)
+				return false;
+			memcpy(palabras + i, origen + leidos, racha * sizeof(unsigned long long));
+			leidos += racha * sizeof(unsigned long long);
+		}
+		i += racha;
+	}
+	return true;
+}
+
+/*
+	Comprime y escribe el bloque de filas acumulado en la trayectoria (abierta para escritura).
+*/
+static void escribirBloque(Trayectoria* trayectoria)
+{
+	CabeceraTrayectoria& cabecera = trayectoria->cabecera;
+	int b = (trayectoria->filas - 1) / cabecera.filasBloque;
+	int filasEnBloque = trayectoria->filas - b * cabecera.filasBloque;
+
+	size_t bytes = comprimirPalabras(trayectoria->bloque, (size_t)filasEnBloque * cabecera.palabras, (unsigned char*)trayectoria->comprimido);
+	fwrite(trayectoria->comprimido, 1, bytes, trayectoria->fichero);
+	trayectoria->indice[b + 1] = trayectoria->indice[b] + bytes;
+}
+
+Trayectoria* crearTrayectoria(const char* nombre, int regla, int pasos, int celdas, int inicializacion, int filasBloque)
+{
+	FILE* fichero = abrirSalida(nombre);
+	if (fichero == NULL)
+		return NULL;
+
+	Trayectoria* trayectoria = new Trayectoria;
+	CabeceraTrayectoria& cabecera = trayectoria->cabecera;
+	memset(&cabecera, 0, sizeof(CabeceraTrayectoria));
+	memcpy(cabecera.magia, TRAYECTORIA_MAGIA, sizeof(TRAYECTORIA_MAGIA));
+	cabecera.version = TRAYECTORIA_VERSION;
+	cabecera.regla = regla;
+	cabecera.celdas = celdas;
+	cabecera.pasos = pasos;
+	cabecera.filasBloque = filasBloque;
+	cabecera.bloques = (pasos + filasBloque) / filasBloque;
+	cabecera.palabras = palabrasFila(celdas);
+	cabecera.inicializacion = inicializacion;
+
+	trayectoria->escritura = true;
+	trayectoria->fichero = fichero;
+	trayectoria->base = ftell64(fichero);
+	trayectoria->indice = new unsigned long long [cabecera.bloques + 1];
+	trayectoria->bloque = new unsigned long long [(size_t)filasBloque * cabecera.palabras];
+	trayectoria->anterior = new unsigned long long [cabecera.palabras];
+	trayectoria->comprimido = new unsigned long long [((size_t)filasBloque * cabecera.palabras * 12 + 4) / sizeof(unsigned long long) + 1];
+	trayectoria->filas = 0;
+	trayectoria->bloqueActual = -1;
+	trayectoria->datos = NULL;
+	trayectoria->longitud = 0;
+
+	// Los bloques empiezan tras la cabecera y el índice (que se reescriben al cerrar)
+	memset(trayectoria->indice, 0, (cabecera.bloques + 1) * sizeof(unsigned long long));
+	trayectoria->indice[0] = sizeof(CabeceraTrayectoria) + (cabecera.bloques + 1) * sizeof(unsigned long long);
+	fwrite(&cabecera, sizeof(CabeceraTrayectoria), 1, fichero);
+	fwrite(trayectoria->indice, sizeof(unsigned long long), cabecera.bloques + 1, fichero);
+
+	return trayectoria;
+}
+
+void anadirFilaTrayectoria(Trayectoria* trayectoria, const int* fila)
+{
+	CabeceraTrayectoria& cabecera = trayectoria->cabecera;
+	if (trayectoria->filas > cabecera.pasos)
+		return;
+
+	// Fila del bloque en la que se guarda
+	int f = trayectoria->filas % cabecera.filasBloque;
+	unsigned long long* destino = trayectoria->bloque + (size_t)f * cabecera.palabras;
+	empaquetarFila(fila, destino, cabecera.celdas);
+
+	// Salvo la primera fila del bloque, se guarda la diferencia con la fila anterior
+	for (int w = 0; w < cabecera.palabras; w++) {
+		unsigned long long palabra = destino[w];
+		if (f > 0)
+			destino[w] ^= trayectoria->anterior[w];
+		trayectoria->anterior[w] = palabra;
+	}
+
+	trayectoria->filas++;
+	if (f == cabecera.filasBloque - 1 || trayectoria->filas == cabecera.pasos + 1)
+		escribirBloque(trayectoria);
+}
+
+bool guardarTrayectoria(const char* nombre, int** ACE, int regla, int pasos, int celdas, int inicializacion)
+{
+	Trayectoria* trayectoria = crearTrayectoria(nombre, regla, pasos, celdas, inicializacion);
+	if (trayectoria == NULL)
+		return false;
+	for (int p = 0; p < pasos + 1; p++)
+		anadirFilaTrayectoria(trayectoria, ACE[p]);
+	cerrarTrayectoria(trayectoria);
+	return true;
+}
+
+Trayectoria* abrirTrayectoria(const char* nombre)
+{
+	const unsigned char* datos = NULL;
+	unsigned long long longitud = 0;
+
+	// Mapeamos el fichero completo en memoria (sólo lectura)
+#ifdef _WIN32
+	HANDLE fichero = CreateFileA(nombre, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fichero == INVALID_HANDLE_VALUE)
+		return NULL;
+	LARGE_INTEGER tam;
+	GetFileSizeEx(fichero, &tam);
+	longitud = (unsigned long long)tam.QuadPart;
+	HANDLE mapeo = (longitud > 0) ? CreateFileMappingA(fichero, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	if (mapeo != NULL) {
+		datos = (const unsigned char*)MapViewOfFile(mapeo, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapeo);
+	}
+	CloseHandle(fichero);
+#else
+	int fichero = open(nombre, O_RDONLY);
+	if (fichero < 0)
+		return NULL;
+	struct stat info;
+	if (fstat(fichero, &info) == 0 && info.st_size > 0) {
+		longitud = (unsigned long long)info.st_size;
+		void* mapeo = mmap(NULL, (size_t)longitud, PROT_READ, MAP_SHARED, fichero, 0);
+		if (mapeo != MAP_FAILED)
+			datos = (const unsigned char*)mapeo;
+	}
+	close(fichero);
+#endif
+	if (datos == NULL)
+		return NULL;
+
+	Trayectoria* trayectoria = new Trayectoria;
+	CabeceraTrayectoria& cabecera = trayectoria->cabecera;
+	trayectoria->escritura = false;
+	trayectoria->fichero = NULL;
+	trayectoria->base = 0;
+	trayectoria->datos = datos;
+	trayectoria->longitud = longitud;
+	trayectoria->indice = NULL;
+	trayectoria->bloque = NULL;
+	trayectoria->anterior = NULL;
+	trayectoria->comprimido = NULL;
+	trayectoria->filas = 0;
+	trayectoria->bloqueActual = -1;
+
+	// Comprobamos la cabecera
+	bool correcto = longitud >= sizeof(CabeceraTrayectoria);
+	if (correcto) {
+		memcpy(&cabecera, datos, sizeof(CabeceraTrayectoria));
+		correcto = memcmp(cabecera.magia, TRAYECTORIA_MAGIA, sizeof(TRAYECTORIA_MAGIA)) == 0 &&
+			cabecera.version == TRAYECTORIA_VERSION && cabecera.celdas > 0 && cabecera.pasos >= 0 && cabecera.filasBloque > 0 &&
+			cabecera.palabras == palabrasFila(cabecera.celdas) &&
+			cabecera.bloques == (cabecera.pasos + cabecera.filasBloque) / cabecera.filasBloque &&
+			longitud >= sizeof(CabeceraTrayectoria) + (cabecera.bloques + 1) * sizeof(unsigned long long);
+	}
+	if (!correcto) {
+		trayectoria->escritura = false;
+		cerrarTrayectoria(trayectoria);
+		return NULL;
+	}
+
+	trayectoria->indice = new unsigned long long [cabecera.bloques + 1];
+	memcpy(trayectoria->indice, datos + sizeof(CabeceraTrayectoria), (cabecera.bloques + 1) * sizeof(unsigned long long));
+	trayectoria->bloque = new unsigned long long [(size_t)cabecera.filasBloque * cabecera.palabras];
+
+	return trayectoria;
+}
+
+void cerrarTrayectoria(Trayectoria* trayectoria)
+{
+	if (trayectoria == NULL)
+		return;
+
+	if (trayectoria->escritura) {
+		// Si no se añadieron todas las filas, la trayectoria se queda con las que hay
+		CabeceraTrayectoria& cabecera = trayectoria->cabecera;
+		if (trayectoria->filas < cabecera.pasos + 1 && trayectoria->filas > 0) {
+			if (trayectoria->filas % cabecera.filasBloque != 0)
+				escribirBloque(trayectoria);
+			cabecera.pasos = trayectoria->filas - 1;
+			cabecera.bloques = (cabecera.pasos + cabecera.filasBloque) / cabecera.filasBloque;
+		}
+
+		// Reescribimos la cabecera y el índice (las posiciones son relativas al inicio de la trayectoria)
+		fseek64(trayectoria->fichero, trayectoria->base, SEEK_SET);
+		fwrite(&cabecera, sizeof(CabeceraTrayectoria), 1, trayectoria->fichero);
+		fwrite(trayectoria->indice, sizeof(unsigned long long), cabecera.bloques + 1, trayectoria->fichero);
+		fseek64(trayectoria->fichero, 0, SEEK_END);
+		cerrarSalida(trayectoria->fichero);
+	}
+
+	if (trayectoria->datos != NULL) {
+#ifdef _WIN32
+		UnmapViewOfFile(trayectoria->datos);
+#else
+		munmap((void*)trayectoria->datos, (size_t)trayectoria->longitud);
+#endif
+	}
+
+	delete[] trayectoria->indice;
+	delete[] trayectoria->bloque;
+	delete[] trayectoria->anterior;
+	delete[] trayectoria->comprimido;
+	delete trayectoria;
+}
+
+const unsigned long long* leerFilaEmpaquetadaTrayectoria(Trayectoria* trayectoria, int paso)
+{
+	CabeceraTrayectoria& cabecera = trayectoria->cabecera;
+	if (trayectoria->escritura || paso < 0 || paso > cabecera.pasos)
+		return NULL;
+
+	// Descomprimimos el bloque del paso si no es el que ya tenemos
+	int b = paso / cabecera.filasBloque;
+	if (b != trayectoria->bloqueActual) {
+		int filasEnBloque = cabecera.filasBloque;
+		if ((b + 1) * cabecera.filasBloque > cabecera.pasos + 1)
+			filasEnBloque = cabecera.pasos + 1 - b * cabecera.filasBloque;
+
+		unsigned long long inicio = trayectoria->indice[b];
+		unsigned long long fin = trayectoria->indice[b + 1];
+		if (fin < inicio || fin > trayectoria->longitud)
+			return NULL;
+		trayectoria->bloqueActual = -1;
+		if (!descomprimirPalabras(trayectoria->datos + inicio, (size_t)(fin - inicio), trayectoria->bloque, (size_t)filasEnBloque * cabecera.palabras))
+			return NULL;
+
+		// Deshacemos las diferencias entre filas consecutivas
+		for (int f = 1; f < filasEnBloque; f++) {
+			unsigned long long* fila = trayectoria->bloque + (size_t)f * cabecera.palabras;
+			const unsigned long long* anterior = fila - cabecera.palabras;
+			for (int w = 0; w < cabecera.palabras; w++)
+				fila[w] ^= anterior[w];
+		}
+		trayectoria->bloqueActual = b;
+		trayectoria->filas = filasEnBloque;
+	}
+
+	return trayectoria->bloque + (size_t)(paso - b * cabecera.filasBloque) * cabecera.palabras;
+}
+
+bool leerFilaTrayectoria(Trayectoria* trayectoria, int paso, int* fila)
+{
+	const unsigned long long* palabras = leerFilaEmpaquetadaTrayectoria(trayectoria, paso);
+	if (palabras == NULL)
+		return false;
+	desempaquetarFila(palabras, fila, trayectoria->cabecera.celdas);
+	return true;
+}
+
+bool leerPasosTrayectoria(Trayectoria* trayectoria, int** ACE, int desde, int hasta)
+{
+	for (int p = desde; p <= hasta; p++)
+		if (!leerFilaTrayectoria(trayectoria, p, ACE[p]))
+			return false;
+	return true;
+}
+
+bool cargarACETrayectoria(Trayectoria* trayectoria, int*** ACE)
+{
+	asignarMemoriaACE(ACE, trayectoria->cabecera.pasos, trayectoria->cabecera.celdas);
+	if (!leerPasosTrayectoria(trayectoria, *ACE, 0, trayectoria->cabecera.pasos)) {
+		liberarMemoriaACE(*ACE, trayectoria->cabecera.pasos);
+		*ACE = NULL;
+		return false;
+	}
+	return true;
+}
+
+long* estadosTrayectoria(Trayectoria* trayectoria)
+{
+	int celdas = trayectoria->cabecera.celdas;
+	int pasos = trayectoria->cabecera.pasos;
+	long* estados = new long [pasos];
+
+	for (int p = 1; p < pasos + 1; p++) {
+		const unsigned long long* palabras = leerFilaEmpaquetadaTrayectoria(trayectoria, p);
+		if (palabras == NULL) {
+			delete[] estados;
+			return NULL;
+		}
+
+		// Igual que en generarACE, la celda j aporta 2^(celdas - j)
+		estados[p - 1] = 0;
+		if (celdas < 32)
+			for (int j = 1; j < celdas + 1; j++)
+				estados[p - 1] |= (long)((palabras[0] >> (j - 1)) & 1) << (celdas - j);
+	}
+
+	return estados;
+}
+
+int* hammingTrayectorias(Trayectoria* trayectoria1, Trayectoria* trayectoria2)
+{
+	if (trayectoria1->cabecera.celdas != trayectoria2->cabecera.celdas || trayectoria1->cabecera.pasos != trayectoria2->cabecera.pasos)
+		return NULL;
+
+	int pasos = trayectoria1->cabecera.pasos;
+	int palabras = trayectoria1->cabecera.palabras;
+	int* hamming = new int [pasos + 1];
+
+	for (int p = 0; p < pasos + 1; p++) {
+		const unsigned long long* fila1 = leerFilaEmpaquetadaTrayectoria(trayectoria1, p);
+		const unsigned long long* fila2 = leerFilaEmpaquetadaTrayectoria(trayectoria2, p);
+		if (fila1 == NULL || fila2 == NULL) {
+			delete[] hamming;
+			return NULL;
+		}
+
+		// Número de celdas diferentes: bits a 1 de la diferencia (XOR)
+		hamming[p] = 0;
+		for (int w = 0; w < palabras; w++)
+			hamming[p] += contarUnos(fila1[w] ^ fila2[w]);
+	}
+
+	return hamming;
+}
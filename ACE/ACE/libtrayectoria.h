@@ -0,0 +1,200 @@
+#ifndef _LIBTRAYECTORIA_H_
+#define _LIBTRAYECTORIA_H_
+
+#include <stdio.h>
+
+#define TRAYECTORIA_MAGIA			"ACETRAY"	// Identificador al inicio de los ficheros de trayectoria
+#define TRAYECTORIA_VERSION			1			// Versión del formato de los ficheros de trayectoria
+#define FILAS_BLOQUE_TRAYECTORIA	64			// Filas (pasos) que se comprimen juntas en cada bloque por defecto
+
+/*
+ * Formato de un fichero de trayectoria (.tra):
+ *
+ * - Cabecera (CabeceraTrayectoria, 48 bytes).
+ * - Índice de pasos: 'bloques' + 1 posiciones (unsigned long long) de inicio de cada bloque en el fichero
+ *   (la última es el final del fichero). El bloque b contiene los pasos [b * filasBloque, (b + 1) * filasBloque - 1].
+ * - Bloques comprimidos. Cada fila se empaqueta con un bit por celda (palabrasFila(celdas) palabras de 64 bits).
+ *   La primera fila del bloque se guarda tal cual y cada una de las siguientes como diferencia (XOR) con la anterior,
+ *   de manera que las zonas que no cambian son palabras a 0. El resultado se codifica por longitud de rachas:
+ *   una palabra de control de 32 bits seguida, si su bit más alto es 0, de tantas palabras de 64 bits como indica
+ *   (literales) o, si su bit más alto es 1, de nada (ese número de palabras a 0).
+ *
+ * Para leer cualquier paso sólo hay que descomprimir su bloque, el fichero se lee mapeado en memoria.
+ */
+struct CabeceraTrayectoria {
+	char magia[8];						// TRAYECTORIA_MAGIA
+	int version;						// TRAYECTORIA_VERSION
+	int regla;							// Regla aplicada en la evolución
+	int celdas;							// Número de celdas del ACE
+	int pasos;							// Número de pasos de la evolución (hay 'pasos' + 1 filas)
+	int filasBloque;					// Filas por bloque
+	int bloques;						// Número de bloques
+	int palabras;						// Palabras de 64 bits por fila empaquetada
+	int inicializacion;					// Tipo de inicialización del ACE (INICIALIZACION_SEMILLA, ...)
+	int reservado[2];					// Sin uso (0)
+};
+
+/*
+ * Trayectoria abierta para escritura (se van añadiendo filas) o para lectura (fichero mapeado en memoria).
+ */
+struct Trayectoria {
+	CabeceraTrayectoria cabecera;		// Cabecera del fichero
+	bool escritura;						// Cierto si se abrió para escribir
+	FILE* fichero;						// Fichero (sólo en escritura)
+	long long base;						// Posición del inicio de la trayectoria en 'fichero' (puede estar dentro de un contenedor)
+	unsigned long long* indice;			// Posiciones de los bloques ('bloques' + 1)
+	unsigned long long* bloque;			// Filas del bloque actual (filasBloque X palabras), descomprimidas
+	unsigned long long* anterior;		// En escritura, última fila añadida (para calcular la diferencia)
+	unsigned long long* comprimido;		// En escritura, buffer para el bloque comprimido
+	int filas;							// En escritura, filas añadidas; en lectura, filas del bloque actual descomprimidas
+	int bloqueActual;					// En lectura, bloque que hay descomprimido en 'bloque' (-1 si ninguno)
+	const unsigned char* datos;			// En lectura, fichero mapeado en memoria
+	unsigned long long longitud;		// En lectura, longitud del fichero mapeado
+};
+
+/*
+ * Nombre: crearTrayectoria
+ *
+ * Descripción: Crea un fichero de trayectoria vacío al que se irán añadiendo las 'pasos' + 1 filas de un ACE.
+ *              Se abre con 'abrirSalida', por lo que puede guardarse dentro de un contenedor.
+ *
+ * nombre: Nombre del fichero.
+ * regla: Regla aplicada en la evolución.
+ * pasos: Número de pasos de la evolución.
+ * celdas: Número de celdas del ACE.
+ * inicializacion: Tipo de inicialización del ACE (sólo informativo).
+ * filasBloque: Filas por bloque comprimido (cuantas menos, más rápido el acceso a un paso y menor la compresión).
+ *
+ * Devuelve la trayectoria o NULL si no se pudo crear el fichero.
+ *
+ */
+Trayectoria* crearTrayectoria(const char* nombre, int regla, int pasos, int celdas, int inicializacion, int filasBloque = FILAS_BLOQUE_TRAYECTORIA);
+
+/*
+ * Nombre: anadirFilaTrayectoria
+ *
+ * Descripción: Añade la siguiente fila (paso) a una trayectoria abierta para escritura.
+ *
+ * trayectoria: Trayectoria creada con 'crearTrayectoria'.
+ * fila: Fila del ACE ('celdas' + 2 posiciones).
+ *
+ */
+void anadirFilaTrayectoria(Trayectoria* trayectoria, const int* fila);
+
+/*
+ * Nombre: guardarTrayectoria
+ *
+ * Descripción: Guarda en un fichero de trayectoria toda la evolución de un ACE.
+ *
+ * nombre: Nombre del fichero.
+ * ACE: Evolución del ACE ('pasos' + 1 filas de 'celdas' + 2 posiciones).
+ * regla: Regla aplicada en la evolución.
+ * pasos: Número de pasos de la evolución.
+ * celdas: Número de celdas del ACE.
+ * inicializacion: Tipo de inicialización del ACE.
+ *
+ * Devuelve cierto si se pudo guardar la trayectoria.
+ *
+ */
+bool guardarTrayectoria(const char* nombre, int** ACE, int regla, int pasos, int celdas, int inicializacion);
+
+/*
+ * Nombre: abrirTrayectoria
+ *
+ * Descripción: Abre para lectura un fichero de trayectoria mapeándolo en memoria.
+ *
+ * Devuelve la trayectoria o NULL si no se pudo abrir o no es un fichero de trayectoria válido.
+ *
+ */
+Trayectoria* abrirTrayectoria(const char* nombre);
+
+/*
+ * Nombre: cerrarTrayectoria
+ *
+ * Descripción: Cierra una trayectoria y libera su memoria. En escritura se completan la cabecera y el índice
+ *              (si faltan filas se guardan únicamente las añadidas).
+ *
+ */
+void cerrarTrayectoria(Trayectoria* trayectoria);
+
+/*
+ * Nombre: leerFilaEmpaquetadaTrayectoria
+ *
+ * Descripción: Obtiene la fila empaquetada (un bit por celda) de un paso concreto de la trayectoria.
+ *
+ * trayectoria: Trayectoria abierta para lectura.
+ * paso: Paso a leer [0, pasos].
+ *
+ * Devuelve un puntero a las palabrasFila(celdas) palabras de la fila (válido hasta la siguiente lectura)
+ * o NULL si el paso no existe o el fichero está dañado.
+ *
+ */
+const unsigned long long* leerFilaEmpaquetadaTrayectoria(Trayectoria* trayectoria, int paso);
+
+/*
+ * Nombre: leerFilaTrayectoria
+ *
+ * Descripción: Obtiene la fila (un entero por celda) de un paso concreto de la trayectoria.
+ *
+ * trayectoria: Trayectoria abierta para lectura.
+ * paso: Paso a leer [0, pasos].
+ * fila: Vector de 'celdas' + 2 posiciones en el que se devuelve la fila (con las condiciones de contorno).
+ *
+ * Devuelve cierto si se pudo leer el paso.
+ *
+ */
+bool leerFilaTrayectoria(Trayectoria* trayectoria, int paso, int* fila);
+
+/*
+ * Nombre: leerPasosTrayectoria
+ *
+ * Descripción: Obtiene las filas de los pasos [desde, hasta] de la trayectoria y las guarda en las mismas filas de 'ACE'.
+ *
+ * trayectoria: Trayectoria abierta para lectura.
+ * ACE: ACE con memoria asignada para al menos 'hasta' + 1 filas de 'celdas' + 2 posiciones.
+ * desde: Primer paso a leer.
+ * hasta: Último paso a leer.
+ *
+ * Devuelve cierto si se pudieron leer todos los pasos.
+ *
+ */
+bool leerPasosTrayectoria(Trayectoria* trayectoria, int** ACE, int desde, int hasta);
+
+/*
+ * Nombre: cargarACETrayectoria
+ *
+ * Descripción: Asigna memoria para un ACE (asignarMemoriaACE) y carga en él toda la trayectoria, de manera que se pueden
+ *              aplicar directamente las funciones de análisis de libACE (generarHamming, ...) sin volver a simular.
+ *
+ * trayectoria: Trayectoria abierta para lectura.
+ * ACE: ACE en el que se carga la trayectoria. Se libera con liberarMemoriaACE(*ACE, pasos).
+ *
+ * Devuelve cierto si se pudo cargar la trayectoria.
+ *
+ */
+bool cargarACETrayectoria(Trayectoria* trayectoria, int*** ACE);
+
+/*
+ * Nombre: estadosTrayectoria
+ *
+ * Descripción: Obtiene los estados por los que pasa la trayectoria, igual que los devuelve 'generarACE'
+ *              (uno por paso sin contar el estado inicial, sólo para ACEs de menos de 32 celdas).
+ *
+ * Devuelve el vector de 'pasos' estados (se libera con delete[]) o NULL si no se pudo leer la trayectoria.
+ *
+ */
+long* estadosTrayectoria(Trayectoria* trayectoria);
+
+/*
+ * Nombre: hammingTrayectorias
+ *
+ * Descripción: Calcula la evolución de la distancia de Hamming entre dos trayectorias con el mismo número de celdas,
+ *              paso a paso y sobre las filas empaquetadas (sin cargarlas completas en memoria).
+ *
+ * Devuelve el vector de pasos + 1 distancias (se libera con delete[]), igual que 'generarHamming',
+ * o NULL si las trayectorias no son compatibles.
+ *
+ */
+int* hammingTrayectorias(Trayectoria* trayectoria1, Trayectoria* trayectoria2);
+
+#endif
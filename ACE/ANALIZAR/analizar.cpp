@@ -0,0 +1,241 @@
+#include <time.h>
+#include "libguardaimagen.h"
+#include "libACE.h"
+#include "libcontenedor.h"
+#include "libmedidas.h"
+#include "libmotores.h"
+#include "libtrabajos.h"
+#include "libobservadores.h"
+
+#pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
+
+#define REGLA						54		// regla a aplicar por defecto
+#define CELDAS						1000	// número de celdas del ACE por defecto
+#define PASOS						500		// número de pasos de evolución por defecto
+
+#define MAX_REGLAS					256		// Número máximo de reglas a calcular
+
+#define MIN_PASOS					1		// como mínimo 1 paso de evolución
+#define MAX_PASOS					5000	// como máximo 5000 pasos de evolución
+
+#define MIN_CELDAS					2		// como mínimo 2 celdas en el ACE
+#define MAX_CELDAS					10000	// como máximo 10000 celdas en el ACE (se guardan todas las filas del ACE y de su gemelo)
+
+/*
+ * Nombre: ANALIZAR (Varias medidas de Autómatas Celulares Elementales en una sola simulación)
+ * Autor: Ismael Flores Campoy
+ * Descripción: Simula cada regla una sola vez y entrega cada fila de la evolución a todas las medidas pedidas
+ *              (observadores, ver libobservadores): la imagen de ACE, la distancia de Hamming de HAMMING,
+ *              la densidad de celdas a 1, el histograma de códigos de estado, el exponente de Hamming y el espectro
+ *              de potencia y la correlación espacial medios de las filas (por FFT, ver libespectro).
+ *              Obtener varias medidas cuesta una simulación (dos si se pide Hamming o su exponente),
+ *              en lugar de una por herramienta. Las salidas que coinciden con las de ACE y HAMMING son idénticas.
+ * Sintaxis: ANALIZAR <opcion1>:<valor1> <opcion2>:<valor2> ...
+ *
+ * Opción					| Valores (separados por comas)		| Valor por defecto
+ * -------------------------------------------------------------------------------------------------------
+ * metricas					| imagen, hamming, densidad,		| todos
+ *							| estados, regresion, espectro,		|
+ *							| todos								|
+ * inicializacion			| aleatoria, semilla				| semilla
+ * semilla					| entero >= 0						| (instante actual)
+ * reglas					| [0, 255], todas					| REGLA (54)
+ * pasos					| [1, 5000]							| PASOS (500)
+ * celdas					| [2, 10000]						| CELDAS (1000)
+ * formato					| texto, npy, ambos					| texto
+ * contenedor				| nombre de fichero					| (ficheros independientes)
+ * informe					| nombre de fichero					| (sin informe)
+ * progreso					| segundos							| 0 (sin progreso)
+ * ciclos					| si, no							| si
+ * motor					| referencia, empaquetado, tabla,	| referencia
+ *							| auto								|
+ * calibracion				| nombre de fichero					| motores.cal
+ *
+ * Argumento					| Significado
+ * ------------------------------------------------------------------------------------------------------------
+ * metricas:imagen				| Se guarda la imagen de la evolución (ACE_R..._C..._P..._<inicializacion>.pgm, como ACE)
+ * metricas:hamming				| Se guarda la distancia de Hamming con el ACE que difiere en la celda central (HAMMING_..., como HAMMING)
+ * metricas:densidad			| Se guarda la fracción de celdas a 1 en cada paso (DENSIDAD_R..._C..._P....dat, primera columna el paso)
+ * metricas:estados				| Se guardan las visitas a cada código de estado en toda la evolución (ESTADOS_R..._C..._P....dat,
+ *								| sólo con 30 celdas o menos)
+ * metricas:regresion			| Se muestra el exponente de Hamming (como HAMMING), acumulando la regresión paso a paso
+ * metricas:espectro			| Se guardan el espectro de potencia medio de las fluctuaciones de las filas (ESPECTRO_R..._C..._P....dat,
+ *								| primera columna el número de onda k) y la correlación espacial media (CORRELACION_..., primera
+ *								| columna la distancia r), de 0 a celdas / 2. Coste O(celdas log celdas) por fila
+ * metricas:densidad,estados	| Sólo la densidad y el histograma de estados (no hace falta simular el ACE gemelo)
+ * inicializacion:aleatoria		| La primera fila del ACE contiene una sucesión aleatoria de '0' y '1'
+ * inicializacion:semilla		| La primera fila del ACE contiene todo '0' menos un '1' en la posición central
+ * semilla:1234				| La inicialización aleatoria es siempre la misma para la misma semilla (resultados reproducibles)
+ * reglas:todas					| Se analizan todas las reglas [0, 255]
+ * reglas:4,90,126				| Se analizan las reglas 4, 90 y 126
+ * pasos:300					| Se calculan 300 pasos de la evolución del ACE
+ * celdas:700					| El ACE lo conforman 700 posiciones
+ * formato:npy					| Las series se guardan en formato binario NPY (numpy) en lugar de texto (.dat)
+ * contenedor:R.acec			| Todas las salidas se guardan en el fichero contenedor R.acec (se extraen con EXTRAER)
+ * informe:R.json				| Al terminar se guarda en R.json el informe de rendimiento (tiempo de cada fase, contadores, memoria)
+ * progreso:60					| Cada 60 segundos se muestra el porcentaje realizado y el tiempo estimado que falta
+ * ciclos:no					| Se simulan todos los pasos aunque la evolución entre en un ciclo (sin copiar el ciclo detectado)
+ * motor:empaquetado			| La evolución se calcula con el motor empaquetado (ver libmotores), tras comprobar que da lo mismo
+ *								| que generarACE; si no, se usa generarACE (referencia)
+ * motor:auto					| Para cada regla y tamaño se usa el motor más rápido de los que dan lo mismo que generarACE
+ *								| (se miden con una simulación corta y la elección se guarda en el fichero de calibración)
+ * calibracion:maquina.cal		| Con motor:auto, las elecciones de cada máquina se leen y guardan en maquina.cal
+ *
+ * Ejemplos:
+ *
+ * ANALIZAR reglas:30,90,110
+ * ANALIZAR reglas:todas metricas:hamming,densidad,regresion formato:npy
+ * ANALIZAR reglas:110 celdas:20 pasos:1000 metricas:estados,densidad
+ * ANALIZAR reglas:30,110 celdas:10000 pasos:100 metricas:espectro,densidad inicializacion:aleatoria
+ *
+ */
+int main(int argc, char** argv)
+{
+	int celdas = CELDAS;							// Celdas del ACE (por defecto CELDAS)
+	int pasos = PASOS;								// Pasos de evolución a simular (por defecto PASOS)
+	int inicializacion = INICIALIZACION_SEMILLA;	// Por defecto la inicialización es por semilla ACE[0][CELDAS /2 + 1]=1
+	int reglas[MAX_REGLAS];							// Guardamos las reglas a aplicar
+	int nreglas;									// Guardamos el número de reglas a aplicar
+	int observadores = OBSERVADOR_TODOS;			// Medidas a obtener de cada simulación (por defecto todas)
+	int formato = FORMATO_TEXTO;					// Formato de los ficheros de series (por defecto texto compatible con gnuplot)
+	char nombreContenedor[256];						// Fichero contenedor en el que guardar todas las salidas (vacío: ficheros independientes)
+	Contenedor* contenedor = NULL;					// Contenedor abierto (si se usa)
+	char nombreInforme[256];						// Fichero en el que guardar el informe de rendimiento (vacío: sin informe)
+	double intervaloProgreso = 0.0;					// Segundos entre líneas de progreso (0: sin progreso)
+	bool ciclos = true;								// Detección de ciclos en las simulaciones (por defecto activada)
+	int motor = MOTOR_REFERENCIA;					// Motor de evolución (ver libmotores, por defecto generarACE)
+	char ficheroCalibracion[256];					// Fichero de calibración de motor:auto
+	unsigned long long semilla = (unsigned long long)time(NULL);	// Semilla de los números aleatorios (por defecto el instante actual)
+
+	nombreContenedor[0] = 0;
+	nombreInforme[0] = 0;
+	strcpy(ficheroCalibracion, MOTOR_FICHERO_CALIBRACION);
+
+	// Por defecto aplicaremos la regla 'REGLA' si como argumento no indicamos otra cosa
+	reglas[0] = REGLA;
+	nreglas = 1;
+
+	// Procesado de los parámetros de entrada (si existen)
+	for (int a = 1; a < argc; a++) {
+		if (strstr(argv[a], "metricas:") == argv[a]) {
+			// Si encontramos un argumento 'metricas:' analizamos qué observadores se piden
+			observadores = obtenerObservadores(argv[a] + strlen("metricas:"));
+			if (observadores == 0) {
+				observadores = OBSERVADOR_TODOS;
+				printf("Parámetro incorrecto, se esperaba una lista de métricas (imagen, hamming, densidad, estados, regresion, espectro o todos)... Se obtienen todas\n");
+			}
+		}
+		else if (strstr(argv[a], "inicializacion:") == argv[a]) {
+			// Si encontramos un argumento 'inicialización:' analizamos que valor tiene.
+			if (strstr(argv[a], ":aleatoria") != NULL)
+				inicializacion = INICIALIZACION_ALEATORIA;
+			else if (strstr(argv[a], ":semilla") != NULL)
+				inicializacion = INICIALIZACION_SEMILLA;
+		}
+		else if (strstr(argv[a], "semilla:") == argv[a]) {
+			// Si encontramos un argumento 'semilla:' la inicialización aleatoria será reproducible
+			semilla = strtoull(argv[a] + strlen("semilla:"), NULL, 10);
+		}
+		else if (strstr(argv[a], "reglas:") == argv[a]) {
+			// Si encontramos un argumento 'regla:' analizamos que valor tiene.
+			if (strstr(argv[a], ":todas") != NULL)
+				nreglas = obtenerValores(reglas, MAX_REGLAS, "0-255");
+			else
+				nreglas = obtenerValores(reglas, MAX_REGLAS, argv[a] + strlen("reglas:"));
+		}
+		else if (strstr(argv[a], "celdas:") == argv[a]) {
+			// Si encontramos un argumento 'celdas:' analizamos que valor tiene.
+			celdas = atoi(argv[a] + strlen("celdas:"));
+			if (celdas < MIN_CELDAS || celdas > MAX_CELDAS || errno != 0) {
+				celdas = CELDAS;
+				printf("Parámetro incorrecto, se esperaba un número de celdas entre %d y %d... Se asumen %d celdas\n", MIN_CELDAS, MAX_CELDAS, celdas);
+			}
+		}
+		else if (strstr(argv[a], "pasos:") == argv[a]) {
+			// Si encontramos un argumento 'pasos:' analizamos que valor tiene.
+			pasos = atoi(argv[a] + strlen("pasos:"));
+			if (pasos < MIN_PASOS || pasos > MAX_PASOS || errno != 0) {
+				pasos = PASOS;
+				printf("Parámetro incorrecto, se esperaba un número de pasos entre %d y %d... Se asumen %d pasos\n", MIN_PASOS, MAX_PASOS, pasos);
+			}
+		}
+		else if (strstr(argv[a], "contenedor:") == argv[a]) {
+			// Si encontramos un argumento 'contenedor:' todas las salidas se guardarán en dicho fichero
+			strncpy(nombreContenedor, argv[a] + strlen("contenedor:"), sizeof(nombreContenedor) - 1);
+			nombreContenedor[sizeof(nombreContenedor) - 1] = 0;
+		}
+		else if (strstr(argv[a], "informe:") == argv[a]) {
+			// Si encontramos un argumento 'informe:' al terminar se guardará en dicho fichero el informe de rendimiento
+			strncpy(nombreInforme, argv[a] + strlen("informe:"), sizeof(nombreInforme) - 1);
+			nombreInforme[sizeof(nombreInforme) - 1] = 0;
+		}
+		else if (strstr(argv[a], "progreso:") == argv[a]) {
+			// Si encontramos un argumento 'progreso:' analizamos que valor tiene.
+			intervaloProgreso = atof(argv[a] + strlen("progreso:"));
+		}
+		else if (strstr(argv[a], "motor:") == argv[a]) {
+			// Si encontramos un argumento 'motor:' analizamos que valor tiene.
+			motor = obtenerMotor(argv[a] + strlen("motor:"));
+			if (motor < MOTOR_AUTOMATICO) {
+				motor = MOTOR_REFERENCIA;
+				printf("Parámetro incorrecto, se esperaba un motor (referencia, empaquetado, tabla o auto)... Se usa generarACE (referencia)\n");
+			}
+		}
+		else if (strstr(argv[a], "calibracion:") == argv[a]) {
+			// Si encontramos un argumento 'calibracion:' las elecciones de motor:auto se leen y guardan en dicho fichero
+			strncpy(ficheroCalibracion, argv[a] + strlen("calibracion:"), sizeof(ficheroCalibracion) - 1);
+			ficheroCalibracion[sizeof(ficheroCalibracion) - 1] = 0;
+		}
+		else if (strstr(argv[a], "ciclos:") == argv[a]) {
+			// Si encontramos un argumento 'ciclos:' analizamos que valor tiene.
+			ciclos = (strstr(argv[a], ":no") == NULL);
+		}
+		else if (strstr(argv[a], "formato:") == argv[a]) {
+			// Si encontramos un argumento 'formato:' analizamos que valor tiene.
+			if (strstr(argv[a], ":texto") != NULL)
+				formato = FORMATO_TEXTO;
+			else if (strstr(argv[a], ":npy") != NULL)
+				formato = FORMATO_NPY;
+			else if (strstr(argv[a], ":ambos") != NULL)
+				formato = FORMATO_AMBOS;
+		}
+	}
+
+	// Se muestra la semilla para poder repetir la ejecución
+	if (inicializacion == INICIALIZACION_ALEATORIA)
+		printf("Semilla de los números aleatorios: %llu\n", semilla);
+	if ((observadores & OBSERVADOR_ESTADOS) && celdas > OBSERVADOR_MAX_CELDAS_ESTADOS)
+		printf("El histograma de estados sólo se guarda con %d celdas o menos\n", OBSERVADOR_MAX_CELDAS_ESTADOS);
+
+	// Medidas de rendimiento (progreso e informe)
+	iniciarMedidas("ANALIZAR", argc, argv, intervaloProgreso);
+
+	// Detección de ciclos en las simulaciones
+	usarDeteccionCiclos(ciclos);
+
+	// Motor de evolución de las reglas elementales (ver libmotores)
+	usarMotor(motor, ficheroCalibracion);
+
+	// Si se ha indicado un contenedor, todas las salidas se guardan en él
+	if (nombreContenedor[0] != 0) {
+		contenedor = crearContenedor(nombreContenedor);
+		if (contenedor == NULL)
+			printf("No se pudo crear el contenedor %s... Se guardan ficheros independientes\n", nombreContenedor);
+		usarContenedor(contenedor);
+	}
+
+	// Cada regla se simula una vez y se reutiliza la memoria de trabajo de una a la siguiente
+	EspacioTrabajo espacio;
+	iniciarEspacioTrabajo(espacio);
+	iniciarProgresoTrabajos(nreglas * costeTrabajo(TRABAJO_ANALISIS, celdas, pasos));
+	for (int nr = 0; nr < nreglas; nr++)
+		trabajoAnalisis(espacio, reglas[nr], celdas, pasos, inicializacion, semilla, formato, observadores);
+	liberarEspacioTrabajo(espacio);
+
+	// Cerramos el contenedor (escribe el índice de las salidas guardadas)
+	cerrarContenedor(contenedor);
+
+	// Guardamos el informe de rendimiento
+	if (nombreInforme[0] != 0 && !guardarInformeMedidas(nombreInforme))
+		printf("No se pudo crear el informe %s\n", nombreInforme);
+}
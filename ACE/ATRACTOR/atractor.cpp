@@ -1,5 +1,12 @@
 #include "libguardaimagen.h"
 #include "libACE.h"
+#include "libcontenedor.h"
+#include "libmedidas.h"
+#include "libtrabajos.h"
+#include "libpuntocontrol.h"
+#include "libsucesores.h"
+#include "libtablas.h"
+#include "libparcial.h"
 
 #pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
 
@@ -33,6 +40,19 @@
  * reglas					| [0, 255], todas					| REGLA (54)
  * pasos					| [1, 5000]							| PASOS (500)
  * celdas					| [2, 10000]						| CELDAS (1000)
+ * formato					| texto, npy, ambos					| texto
+ * contenedor				| nombre de fichero					| (ficheros independientes)
+ * informe					| nombre de fichero					| (sin informe)
+ * progreso					| segundos							| 0 (sin progreso)
+ * ciclos					| si, no							| si
+ * sucesores				| si, no							| si
+ * cachesucesores			| directorio						| (sin caché)
+ * paginasgrandes			| si, no							| si
+ * puntocontrol				| nombre de fichero					| (sin puntos de control)
+ * intervalocontrol			| segundos							| PUNTOCONTROL_INTERVALO (600)
+ * reanudar					| nombre de fichero					| (ejecución nueva)
+ * parte (o shard)			| i/n (0 <= i < n)					| (ejecución completa)
+ * parciales				| nombre base de fichero			| PARCIAL_ATRACTOR
  *
  * Argumento					| Significado
  * ------------------------------------------------------------------------------------------------------------
@@ -41,28 +61,65 @@
  * reglas:4,90,126				| Se calcula el ACE (y se guarda en ficheros) de laS reglas 4, 90 y 126
  * pasos:300					| Se calculan 300 pasos de la evolución del ACE
  * celdas:700					| El ACE lo conforman 700 posiciones
+ * formato:npy					| Las series se guardan en formato binario NPY (numpy) en lugar de texto (.dat)
+ * formato:ambos				| Las series se guardan en formato texto (.dat) y en formato binario NPY (.npy)
+ * contenedor:R.acec			| Todas las salidas se guardan en el fichero contenedor R.acec (se extraen con EXTRAER)
+ * informe:R.json				| Al terminar se guarda en R.json el informe de rendimiento (tiempo de cada fase, contadores, memoria)
+ * progreso:60					| Cada 60 segundos se muestra el porcentaje realizado y el tiempo estimado que falta
+ * ciclos:no					| Se simulan todos los pasos aunque la evolución entre en un ciclo (sin copiar el ciclo detectado)
+ * sucesores:no					| Se simula cada estado inicial en lugar de seguir la tabla de sucesores (hasta 26 celdas)
+ * cachesucesores:cache			| Las tablas de sucesores se guardan en el directorio 'cache' y se reutilizan en otras ejecuciones
+ * paginasgrandes:no			| Las tablas grandes (visitas a cada estado, sucesores) se reservan con páginas normales
+ * puntocontrol:R.pc			| Cada 'intervalocontrol' segundos se guarda en R.pc la posición y los resultados parciales
+ * intervalocontrol:300			| Los puntos de control se guardan cada 300 segundos
+ * reanudar:R.pc				| Se continúa la ejecución guardada en R.pc (reglas, celdas, pasos y formato se toman de él)
+ * parte:3/16					| Se calcula sólo la parte 3 de 16 de la ejecución (las reglas y estados que le tocan) y sus resultados
+ *								| se guardan en PARCIAL_ATRACTOR.3.par, en lugar de las salidas (se juntan con FUSIONAR)
+ * parciales:compartido/R		| Los resultados parciales se guardan en compartido/R.<parte>.par
  * 
  * Ejemplos:
  *
  * ATRACTOR reglas:126,90
+ * ATRACTOR reglas:todas puntocontrol:R.pc
+ * ATRACTOR reanudar:R.pc
+ * ATRACTOR reglas:todas celdas:24 parte:3/16 parciales:compartido/R
  * ATRACTOR reglas:4 pasos:20 celdas:10
+ * ATRACTOR reglas:todas celdas:20 cachesucesores:cache
  *
  */
 int main(int argc, char** argv)
 {
 	int celdas = CELDAS;							// Celdas del ACE (por defecto CELDAS)
 	int pasos = PASOS;								// Pasos de evolución a simular (por defecto PASOS)
-	int** ACE;										// Donde guardamos el estado del autómata [PASOS + 1][CELDAS + 2]
 	int reglas[256];								// Guardamos las reglas a aplicar
 	int nreglas;									// Guardamos el número de reglas a aplicar
-	char nombreFichero[256];						// Guardamos los nombres de los ficheros a crear
-	int** probabilidades;							// Guardamos cuantas veces se visitó cada estado posible en cada paso.
-	int* visitadosPaso;								// Guardamos el número de estados diferentes visitados en cada paso.
-	int* estadoVisitado;							// Guardamos las veces que ha sido visitado cada estado en cualquier paso de la simulación.
-	int estadosPosibles;							// Número de estados diferentes posibles en un ACE (2^celdas)
+	int formato = FORMATO_TEXTO;					// Formato de los ficheros de series (por defecto texto compatible con gnuplot)
+	char nombreContenedor[256];						// Fichero contenedor en el que guardar todas las salidas (vacío: ficheros independientes)
+	Contenedor* contenedor = NULL;					// Contenedor abierto (si se usa)
+	char nombreInforme[256];						// Fichero en el que guardar el informe de rendimiento (vacío: sin informe)
+	double intervaloProgreso = 0.0;					// Segundos entre líneas de progreso (0: sin progreso)
+	bool ciclos = true;								// Detección de ciclos en las simulaciones (por defecto activada)
+	bool sucesores = true;							// Uso de las tablas de sucesores (por defecto activado)
+	char directorioSucesores[256];					// Directorio de la caché de tablas de sucesores (vacío: sin caché)
+	bool paginasGrandes = true;						// Páginas grandes para las tablas grandes (ver libtablas, por defecto activadas)
+	char nombreControl[256];						// Fichero de punto de control (vacío: sin puntos de control)
+	char nombreReanudar[256];						// Punto de control desde el que reanudar (vacío: ejecución nueva)
+	double intervaloControl = PUNTOCONTROL_INTERVALO;	// Segundos entre puntos de control
+	PuntoControl control;							// Punto de control de la ejecución
+	PuntoControl* pcontrol = NULL;					// Punto de control en uso (NULL: sin puntos de control)
+	int nrInicial = 0;								// Posición en la lista de la primera regla a calcular (al reanudar)
+	int parte = 0, partes = 0;						// Parte de la ejecución a calcular (partes = 0: ejecución completa)
+	char baseParciales[256];						// Nombre base de los ficheros de resultados parciales
+	Parcial parcial;								// Fichero de resultados parciales de la parte
 
 	// Por defecto aplicaremos la regla REGLA si como argumento no indicamos otra cosa
 	reglas[0] = REGLA;
+	nombreContenedor[0] = 0;
+	nombreInforme[0] = 0;
+	directorioSucesores[0] = 0;
+	nombreControl[0] = 0;
+	nombreReanudar[0] = 0;
+	strcpy(baseParciales, "PARCIAL_ATRACTOR");
 	nreglas = 1;
 
 	// Procesado de los parámetros de entrada (si existen)
@@ -90,88 +147,179 @@ int main(int argc, char** argv)
 				printf("Parámetro incorrecto, se esperaba un número de pasos entre %d y %d... Se asumen %d pasos\n", MIN_PASOS, MAX_PASOS, pasos);
 			}
 		}
+		else if (strstr(argv[a], "contenedor:") == argv[a]) {
+			// Si encontramos un argumento 'contenedor:' todas las salidas se guardarán en dicho fichero
+			strncpy(nombreContenedor, argv[a] + strlen("contenedor:"), sizeof(nombreContenedor) - 1);
+			nombreContenedor[sizeof(nombreContenedor) - 1] = 0;
+		}
+		else if (strstr(argv[a], "informe:") == argv[a]) {
+			// Si encontramos un argumento 'informe:' al terminar se guardará en dicho fichero el informe de rendimiento
+			strncpy(nombreInforme, argv[a] + strlen("informe:"), sizeof(nombreInforme) - 1);
+			nombreInforme[sizeof(nombreInforme) - 1] = 0;
+		}
+		else if (strstr(argv[a], "progreso:") == argv[a]) {
+			// Si encontramos un argumento 'progreso:' analizamos que valor tiene.
+			intervaloProgreso = atof(argv[a] + strlen("progreso:"));
+		}
+		else if (strstr(argv[a], "ciclos:") == argv[a]) {
+			// Si encontramos un argumento 'ciclos:' analizamos que valor tiene.
+			ciclos = (strstr(argv[a], ":no") == NULL);
+		}
+		else if (strstr(argv[a], "sucesores:") == argv[a]) {
+			// Si encontramos un argumento 'sucesores:' analizamos que valor tiene.
+			sucesores = (strstr(argv[a], ":no") == NULL);
+		}
+		else if (strstr(argv[a], "paginasgrandes:") == argv[a]) {
+			// Si encontramos un argumento 'paginasgrandes:' analizamos que valor tiene.
+			paginasGrandes = (strstr(argv[a], ":no") == NULL);
+		}
+		else if (strstr(argv[a], "cachesucesores:") == argv[a]) {
+			// Si encontramos un argumento 'cachesucesores:' las tablas de sucesores se guardarán en dicho directorio
+			strncpy(directorioSucesores, argv[a] + strlen("cachesucesores:"), sizeof(directorioSucesores) - 1);
+			directorioSucesores[sizeof(directorioSucesores) - 1] = 0;
+		}
+		else if (strstr(argv[a], "puntocontrol:") == argv[a]) {
+			// Si encontramos un argumento 'puntocontrol:' se guardarán puntos de control en dicho fichero
+			strncpy(nombreControl, argv[a] + strlen("puntocontrol:"), sizeof(nombreControl) - 1);
+			nombreControl[sizeof(nombreControl) - 1] = 0;
+		}
+		else if (strstr(argv[a], "intervalocontrol:") == argv[a]) {
+			// Si encontramos un argumento 'intervalocontrol:' analizamos que valor tiene.
+			intervaloControl = atof(argv[a] + strlen("intervalocontrol:"));
+		}
+		else if (strstr(argv[a], "reanudar:") == argv[a]) {
+			// Si encontramos un argumento 'reanudar:' se continuará la ejecución guardada en dicho fichero
+			strncpy(nombreReanudar, argv[a] + strlen("reanudar:"), sizeof(nombreReanudar) - 1);
+			nombreReanudar[sizeof(nombreReanudar) - 1] = 0;
+		}
+		else if (strstr(argv[a], "parte:") == argv[a] || strstr(argv[a], "shard:") == argv[a]) {
+			// Si encontramos un argumento 'parte:' sólo se calculará esa parte de la ejecución
+			if (!obtenerParte(strchr(argv[a], ':') + 1, parte, partes)) {
+				printf("Parámetro incorrecto, se esperaba la parte como i/n con 0 <= i < n <= %d\n", PARCIAL_MAX_PARTES);
+				return 1;
+			}
+		}
+		else if (strstr(argv[a], "parciales:") == argv[a]) {
+			// Si encontramos un argumento 'parciales:' los resultados parciales se guardarán con dicho nombre base
+			strncpy(baseParciales, argv[a] + strlen("parciales:"), sizeof(baseParciales) - 1);
+			baseParciales[sizeof(baseParciales) - 1] = 0;
+		}
+		else if (strstr(argv[a], "formato:") == argv[a]) {
+			// Si encontramos un argumento 'formato:' analizamos que valor tiene.
+			if (strstr(argv[a], ":texto") != NULL)
+				formato = FORMATO_TEXTO;
+			else if (strstr(argv[a], ":npy") != NULL)
+				formato = FORMATO_NPY;
+			else if (strstr(argv[a], ":ambos") != NULL)
+				formato = FORMATO_AMBOS;
+		}
 	}
 
-	// Asignamos la memoria necesaria para almacenar el ACE
-	asignarMemoriaACE(&ACE, pasos, celdas);
-
-	// Asignamos la memoria necesaria para almacenar un primer estado del ACE de 'celdas' celdas
-	int* base = new int [celdas + 2];
-
-	// Todos los estados posibles según el número de celdas
-	estadosPosibles = (int)pow(2.0, celdas);
-
-	// Para cada regla indicada, hacemos los cálculos
-	for (int nr = 0; nr < nreglas; nr++) {
-
-		// Asignamos memoria para las estructuras que necesitamos
-		inicializarAtractores(&probabilidades, &visitadosPaso, &estadoVisitado, pasos, estadosPosibles);
+	// Si se reanuda, los parámetros de la ejecución se toman del punto de control
+	if (nombreReanudar[0] != 0) {
+		if (!leerPuntoControl(control, nombreReanudar, intervaloControl) || control.cabecera.tipo != TRABAJO_ATRACTOR) {
+			printf("El fichero %s no es un punto de control de ATRACTOR\n", nombreReanudar);
+			return 1;
+		}
+		celdas = control.cabecera.celdas;
+		pasos = control.cabecera.pasos;
+		formato = control.cabecera.formato;
+		nreglas = control.cabecera.nreglas;
+		memcpy(reglas, control.reglas, nreglas * sizeof(int));
+		nrInicial = control.cabecera.indiceRegla;
+		printf("Se reanuda %s: regla %d (%d de %d), estado %d\n", nombreReanudar, reglas[nrInicial], nrInicial + 1, nreglas, control.cabecera.estado);
+		pcontrol = &control;
+	}
+	else if (nombreControl[0] != 0) {
+		iniciarPuntoControl(control, nombreControl, intervaloControl, TRABAJO_ATRACTOR, celdas, pasos, formato, reglas, nreglas);
+		pcontrol = &control;
+	}
 
-		// Recorremos todos los estados posibles
-		for (int estado = 0; estado < estadosPosibles; estado++) {
-			// En 'base' ponemos el estado inicial del ACE correspondiente a 'estado'
-			generarEstadoInicial(base, estado, celdas);
+	// El contenedor se escribe entero al cerrarlo, así que no se puede continuar desde un punto de control
+	if (pcontrol != NULL && nombreContenedor[0] != 0) {
+		printf("Los puntos de control no se pueden usar junto con un contenedor\n");
+		return 1;
+	}
 
-			// Inicializamos 'ACE' con el estado inicial 'base'
-			inicializarACE(ACE, celdas, INICIALIZACION_FIJA, base);
+	// Una parte no guarda salidas sino resultados parciales, que se completan de una vez al terminar
+	if (partes > 0 && (pcontrol != NULL || nombreContenedor[0] != 0)) {
+		printf("Una parte de la ejecución no se puede usar junto con puntos de control ni con un contenedor\n");
+		return 1;
+	}
+	if (partes > 0 && !crearParcial(parcial, baseParciales, TRABAJO_ATRACTOR, celdas, pasos, formato, reglas, nreglas, parte, partes)) {
+		printf("No se pudo crear el fichero de resultados parciales %s\n", parcial.nombre);
+		return 1;
+	}
 
-			// Inicializamos los valores relativos al paso 0
-			probabilidades[0][estado]++;
-			visitadosPaso[0]++;
-			estadoVisitado[estado]++;
+	// Medidas de rendimiento (progreso e informe)
+	iniciarMedidas("ATRACTOR", argc, argv, intervaloProgreso);
 
-			// Generamos la evolución del ACE que vamos a estudiar.
-			// Esta función devuelve la lista de estados por la que ha pasado
-			long* estados = generarACE(ACE, reglas[nr], pasos, celdas);
+	// Detección de ciclos en las simulaciones
+	usarDeteccionCiclos(ciclos);
 
-			// probabilidades: Actualizamos las veces que cada estado es visitado en cada paso
-			// visitadosPaso: Actualizamos el número de estados diferentes visitados en cada paso
-			// estadoVisitado: Actualizamos el número de veces que un estado ha sido visitado
-			//
-			// Si 'probabilidades' tiene un puntero válido se supone que tiene las dimensiones correctas: (pasos + 1)*(2^celdas)
-			// Si 'visitados' tiene un puntero válido se supone que tiene las dimensiones correctas (pasos + 1)
-			for (int p = 0; p < pasos; p++) {
-				// Actualizamos las probabilidades de caer en el 'estado' en el paso 'p'
-				probabilidades[p + 1][estados[p]]++;
+	// Tablas de sucesores (y su caché en disco)
+	usarTablasSucesores(sucesores);
+	usarCacheSucesores(directorioSucesores);
 
-				// Actualizamos el número de estados diferentes visitados en el paso 'p'
-				if (probabilidades[p + 1][estados[p]] == 1)
-					visitadosPaso[p + 1]++;
+	// Reserva de las tablas grandes (páginas grandes y prefallo en paralelo en el nodo NUMA de este hilo)
+	usarTablasGrandes(paginasGrandes);
 
-				// Actualizamos el número de visitas a dicho estado
-				estadoVisitado[estados[p]]++;
-			}
+	// Si se ha indicado un contenedor, todas las salidas se guardan en él
+	if (nombreContenedor[0] != 0) {
+		contenedor = crearContenedor(nombreContenedor);
+		if (contenedor == NULL)
+			printf("No se pudo crear el contenedor %s... Se guardan ficheros independientes\n", nombreContenedor);
+		usarContenedor(contenedor);
+	}
 
-			// Liberamos la memoria donde se guardó el estado de cada paso
-			delete[] estados;
+	// Memoria de trabajo que se reutiliza entre reglas
+	EspacioTrabajo espacio;
+	iniciarEspacioTrabajo(espacio);
 
-		}
+	// En una parte sólo se calculan los tramos de las reglas que le tocan
+	ParteTrabajo tramos[MAX_REGLAS];
+	bool calcular[MAX_REGLAS];
+	long long coste = 0;
+	for (int nr = nrInicial; nr < nreglas; nr++) {
+		long long costeRegla = costeTrabajo(TRABAJO_ATRACTOR, celdas, pasos);
+		calcular[nr] = (partes == 0) || tramoReglaTrabajo(TRABAJO_ATRACTOR, celdas, pasos, nreglas, nr, parte, partes, tramos[nr], costeRegla);
+		tramos[nr].parcial = &parcial;
+		if (calcular[nr])
+			coste += costeRegla;
+	}
+	iniciarProgresoTrabajos(coste);
 
-		// Guardamos los resultados
-		sprintf(nombreFichero, "ATRACTOR_R%03d_C%05d_P%05d.dat", reglas[nr], celdas, pasos);
-		guardarAtractorPLOT(nombreFichero, probabilidades, pasos, estadosPosibles);
+	// Para cada regla indicada, hacemos los cálculos y guardamos los resultados
+	for (int nr = nrInicial; nr < nreglas; nr++) {
+		if (!calcular[nr])
+			continue;
+		reglaPuntoControl(pcontrol, nr);
+		trabajoAtractor(espacio, reglas[nr], celdas, pasos, formato, pcontrol, partes > 0 ? &tramos[nr] : NULL);
+	}
 
-		sprintf(nombreFichero, "ATRACTOR_VISITADO_PASO_R%03d_C%05d_P%05d.dat", reglas[nr], celdas, pasos);
-		guardaPLOT(nombreFichero, visitadosPaso, pasos + 1);
+	// Los resultados parciales sólo se dan por buenos si se han escrito completos
+	bool correcto = true;
+	if (partes > 0) {
+		correcto = cerrarParcial(parcial);
+		if (correcto)
+			printf("Parte %d de %d guardada en %s\n", parte, partes, parcial.nombre);
+		else
+			printf("No se pudo completar el fichero de resultados parciales %s\n", parcial.nombre);
+	}
 
-		sprintf(nombreFichero, "ATRACTOR_ESTADO_VISITADO_R%03d_C%05d_P%05d.dat", reglas[nr], celdas, pasos);
-		guardaPLOT(nombreFichero, estadoVisitado, estadosPosibles);
+	// Terminada la ejecución, el punto de control ya no hace falta
+	if (pcontrol != NULL)
+		borrarPuntoControl(control);
 
-		// Evolución de la entropia en el tiempo aprovechando los datos ya obtenidos de 'probabilidades'
-		double* entropias = new double [pasos + 1];
-		for (int p = 0; p < pasos + 1; p++)
-			entropias[p] = entropia(probabilidades[p], celdas);
-		sprintf(nombreFichero, "ENTROPIA_R%03d_C%05d_P%05d.dat", reglas[nr], celdas, pasos);
-		guardaPLOT(nombreFichero, entropias, pasos + 1);
-		delete[] entropias;
+	// Liberamos la memoria de trabajo
+	liberarEspacioTrabajo(espacio);
 
-		// Liberamos la memoria para los datos de los atractores
-		liberarAtractores(probabilidades, visitadosPaso, estadoVisitado, pasos);
-	}
+	// Cerramos el contenedor (escribe el índice de las salidas guardadas)
+	cerrarContenedor(contenedor);
 
-	// Liberamos la memoria para la simulación del ACE
-	liberarMemoriaACE(ACE, pasos);
+	// Guardamos el informe de rendimiento
+	if (nombreInforme[0] != 0 && !guardarInformeMedidas(nombreInforme))
+		printf("No se pudo crear el informe %s\n", nombreInforme);
 
-	// Liberamos la memoria necesaria para el primer estado del ACE de 'celdas' celdas
-	delete[] base;
+	return correcto ? 0 : 1;
 }
@@ -0,0 +1,312 @@
+#include <chrono>
+#include <time.h>
+#include "libguardaimagen.h"
+#include "libACE.h"
+#include "libmotores.h"
+
+#pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
+
+#define MAX_VALORES					32		// Número máximo de valores de cada parámetro de la rejilla
+#define MIN_PASOS					1		// como mínimo 1 paso de evolución
+#define MAX_PASOS					5000	// como máximo 5000 pasos de evolución
+#define MIN_CELDAS					2		// como mínimo 2 celdas en el ACE
+#define MAX_CELDAS					10000	// como máximo 10000 celdas en el ACE
+#define MIN_CELDAS_ENTROPIA			2		// como mínimo 2^2 estados en 'entropia'
+#define MAX_CELDAS_ENTROPIA			30		// como máximo 2^30 estados en 'entropia'
+#define MAX_TIEMPO					3600	// como máximo 1 hora por medida
+
+#define REGLAS						"30,54,90,110"		// Reglas medidas por defecto
+#define CELDAS						"100,1000,10000"	// Celdas medidas por defecto
+#define PASOS						"100,1000"			// Pasos medidos por defecto
+#define CELDAS_ENTROPIA				"12,16,20"			// Celdas (2^celdas estados) para medir 'entropia' por defecto
+#define TIEMPO_MINIMO				0.2					// Segundos mínimos que se repite cada medida por defecto
+
+#define FICHERO_TEMPORAL_PGM		"BENCHMARK_temporal.pgm"	// Fichero que se escribe (y se borra) al medir guardaPGMiACE
+#define FICHERO_TEMPORAL_DAT		"BENCHMARK_temporal.dat"	// Fichero que se escribe (y se borra) al medir guardaPLOT
+
+/*
+	Resultado de una medida: se repite la operación hasta superar el tiempo mínimo y nos quedamos con la repetición más rápida.
+*/
+struct Medida {
+	int repeticiones;		// Veces que se ha repetido la operación
+	double mejor;			// Segundos de la repetición más rápida
+	double total;			// Segundos de todas las repeticiones
+};
+
+static double segundos()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void iniciarMedida(Medida& medida)
+{
+	medida.repeticiones = 0;
+	medida.mejor = 0.0;
+	medida.total = 0.0;
+}
+
+static void anotarMedida(Medida& medida, double t)
+{
+	if (medida.repeticiones == 0 || t < medida.mejor)
+		medida.mejor = t;
+	medida.total += t;
+	medida.repeticiones++;
+}
+
+static long tamanoFichero(const char* nombre)
+{
+	FILE* f = fopen(nombre, "rb");
+	if (f == NULL)
+		return 0;
+	fseek(f, 0, SEEK_END);
+	long tam = ftell(f);
+	fclose(f);
+	return tam;
+}
+
+/*
+	Escribe una línea del JSON de resultados. 'unidades' es el número de celdas actualizadas, estados, puntos o bytes
+	procesados en cada repetición y 'magnitud' su nombre en el JSON (por ejemplo "actualizaciones_por_segundo").
+*/
+static void escribirResultado(FILE* salida, bool& primero, const char* funcion, int regla, int celdas, int pasos,
+	const Medida& medida, double unidades, const char* magnitud)
+{
+	fprintf(salida, "%s\n    {\"funcion\": \"%s\", \"regla\": %d, \"celdas\": %d, \"pasos\": %d, \"repeticiones\": %d, "
+		"\"segundos_mejor\": %.9f, \"segundos_medio\": %.9f, \"%s\": %.6e}",
+		primero ? "" : ",", funcion, regla, celdas, pasos, medida.repeticiones,
+		medida.mejor, medida.total / medida.repeticiones, magnitud, medida.mejor > 0.0 ? unidades / medida.mejor : 0.0);
+	primero = false;
+	fflush(salida);
+}
+
+/*
+ * Nombre: BENCHMARK (Medida del rendimiento de las funciones de libACE y libguardaimagen)
+ * Autor: Ismael Flores Campoy
+ * Descripción: Mide el tiempo de generarACE, generarHamming, entropia, exponenteHamming, guardaPGMiACE y guardaPLOT
+ *              para todas las combinaciones de reglas, celdas y pasos indicadas (generarACE también con cada uno de los
+ *              motores de libmotores, como generarACE[<motor>]). Cada medida se repite hasta superar el tiempo
+ *              mínimo y se toma la repetición más rápida. Los resultados se escriben en formato JSON (actualizaciones
+ *              de celdas por segundo, estados por segundo, puntos por segundo o bytes por segundo) para poder
+ *              comparar distintas versiones del código.
+ * Sintaxis: BENCHMARK <opcion1>:<valor1> <opcion2>:<valor2> ...
+ *
+ * Opción					| Valores (separados por comas)		| Valor por defecto
+ * -------------------------------------------------------------------------------------------------------
+ * reglas					| [0, 255], todas					| 30,54,90,110
+ * celdas					| [2, 10000]						| 100,1000,10000
+ * pasos					| [1, 5000]							| 100,1000
+ * celdasentropia			| [2, 30]							| 12,16,20
+ * tiempo					| segundos (0, 3600]				| 0.2
+ * salida					| nombre de fichero					| (consola)
+ *
+ * Argumento					| Significado
+ * ------------------------------------------------------------------------------------------------------------
+ * reglas:30,110				| Se miden las reglas 30 y 110
+ * celdas:1000,10000			| Se miden ACEs de 1000 y 10000 celdas
+ * pasos:500					| Se miden evoluciones de 500 pasos
+ * celdasentropia:16,20			| Se mide la entropía de vectores de 2^16 y 2^20 estados
+ * tiempo:1					| Cada medida se repite durante al menos 1 segundo
+ * salida:base.json				| Los resultados se guardan en el fichero base.json
+ *
+ * Ejemplos:
+ *
+ * BENCHMARK
+ * BENCHMARK reglas:30 celdas:10000 pasos:1000 salida:antes.json
+ *
+ */
+int main(int argc, char** argv)
+{
+	int reglas[MAX_VALORES];						// Reglas a medir
+	int celdas[MAX_VALORES];						// Celdas a medir
+	int pasos[MAX_VALORES];							// Pasos a medir
+	int celdasEntropia[MAX_VALORES];				// Celdas a medir en 'entropia'
+	int nreglas, nceldas, npasos, nceldasEntropia;	// Número de valores de cada parámetro
+	double tiempoMinimo = TIEMPO_MINIMO;			// Segundos mínimos de cada medida
+	FILE* salida = stdout;							// Donde se escriben los resultados
+	bool primero = true;							// Para separar con comas los resultados en el JSON
+	Medida medida;									// Medida en curso
+	double t;										// Instante de inicio de cada repetición
+
+	nreglas = obtenerValores(reglas, MAX_VALORES, REGLAS);
+	nceldas = obtenerValores(celdas, MAX_VALORES, CELDAS, MIN_CELDAS, MAX_CELDAS);
+	npasos = obtenerValores(pasos, MAX_VALORES, PASOS, MIN_PASOS, MAX_PASOS);
+	nceldasEntropia = obtenerValores(celdasEntropia, MAX_VALORES, CELDAS_ENTROPIA, MIN_CELDAS_ENTROPIA, MAX_CELDAS_ENTROPIA);
+
+	// Procesado de los parámetros de entrada (si existen)
+	for (int a = 1; a < argc; a++) {
+		if (strstr(argv[a], "reglas:") == argv[a]) {
+			if (strstr(argv[a], ":todas") != NULL)
+				nreglas = obtenerValores(reglas, MAX_VALORES, "0-255");
+			else
+				nreglas = obtenerValores(reglas, MAX_VALORES, argv[a] + strlen("reglas:"));
+			if (nreglas == 0) {
+				nreglas = obtenerValores(reglas, MAX_VALORES, REGLAS);
+				printf("No hay ninguna regla válida... Se asumen las reglas %s\n", REGLAS);
+			}
+		}
+		else if (strstr(argv[a], "celdas:") == argv[a]) {
+			nceldas = obtenerValores(celdas, MAX_VALORES, argv[a] + strlen("celdas:"), MIN_CELDAS, MAX_CELDAS);
+			if (nceldas == 0) {
+				nceldas = obtenerValores(celdas, MAX_VALORES, CELDAS, MIN_CELDAS, MAX_CELDAS);
+				printf("No hay ningún número de celdas válido... Se asumen %s celdas\n", CELDAS);
+			}
+		}
+		else if (strstr(argv[a], "pasos:") == argv[a]) {
+			npasos = obtenerValores(pasos, MAX_VALORES, argv[a] + strlen("pasos:"), MIN_PASOS, MAX_PASOS);
+			if (npasos == 0) {
+				npasos = obtenerValores(pasos, MAX_VALORES, PASOS, MIN_PASOS, MAX_PASOS);
+				printf("No hay ningún número de pasos válido... Se asumen %s pasos\n", PASOS);
+			}
+		}
+		else if (strstr(argv[a], "celdasentropia:") == argv[a]) {
+			nceldasEntropia = obtenerValores(celdasEntropia, MAX_VALORES, argv[a] + strlen("celdasentropia:"), MIN_CELDAS_ENTROPIA, MAX_CELDAS_ENTROPIA);
+			if (nceldasEntropia == 0) {
+				nceldasEntropia = obtenerValores(celdasEntropia, MAX_VALORES, CELDAS_ENTROPIA, MIN_CELDAS_ENTROPIA, MAX_CELDAS_ENTROPIA);
+				printf("No hay ningún número de celdas de entropía válido... Se asumen %s celdas\n", CELDAS_ENTROPIA);
+			}
+		}
+		else if (strstr(argv[a], "tiempo:") == argv[a]) {
+			tiempoMinimo = atof(argv[a] + strlen("tiempo:"));
+			if (!(tiempoMinimo > 0.0 && tiempoMinimo <= MAX_TIEMPO)) {
+				tiempoMinimo = TIEMPO_MINIMO;
+				printf("Parámetro incorrecto, se esperaba un tiempo mayor que 0 y de como mucho %d segundos... Se asumen %.1f segundos\n", MAX_TIEMPO, TIEMPO_MINIMO);
+			}
+		}
+		else if (strstr(argv[a], "salida:") == argv[a]) {
+			salida = fopen(argv[a] + strlen("salida:"), "w");
+			if (salida == NULL) {
+				printf("No se pudo crear el fichero %s\n", argv[a] + strlen("salida:"));
+				return 1;
+			}
+		}
+	}
+
+	time_t ahora = time(NULL);
+	char fecha[64];
+	strftime(fecha, sizeof(fecha), "%Y-%m-%dT%H:%M:%S", localtime(&ahora));
+	fprintf(salida, "{\n  \"benchmark\": \"libACE\",\n  \"fecha\": \"%s\",\n  \"tiempo_minimo\": %.3f,\n  \"resultados\": [", fecha, tiempoMinimo);
+
+	for (int nc = 0; nc < nceldas; nc++) {
+		for (int np = 0; np < npasos; np++) {
+			int** ACE;
+			asignarMemoriaACE(&ACE, pasos[np], celdas[nc]);
+			double actualizaciones = (double)celdas[nc] * (double)pasos[np];
+
+			for (int nr = 0; nr < nreglas; nr++) {
+				// generarACE: actualizaciones de celdas por segundo
+				iniciarMedida(medida);
+				while (medida.total < tiempoMinimo || medida.repeticiones == 0) {
+					inicializarACE(ACE, celdas[nc], INICIALIZACION_SEMILLA);
+					t = segundos();
+					long* estados = generarACE(ACE, reglas[nr], pasos[np], celdas[nc]);
+					anotarMedida(medida, segundos() - t);
+					delete[] estados;
+				}
+				escribirResultado(salida, primero, "generarACE", reglas[nr], celdas[nc], pasos[np], medida, actualizaciones, "actualizaciones_por_segundo");
+
+				// Resto de motores de libmotores (los que no superan la verificación diferencial no se miden)
+				for (int motor = MOTOR_REFERENCIA + 1; motor < NUM_MOTORES; motor++) {
+					if (!verificarMotor(motor, reglas[nr], celdas[nc]))
+						continue;
+					char funcion[64];
+					sprintf(funcion, "generarACE[%s]", nombreMotor(motor));
+					iniciarMedida(medida);
+					while (medida.total < tiempoMinimo || medida.repeticiones == 0) {
+						inicializarACE(ACE, celdas[nc], INICIALIZACION_SEMILLA);
+						t = segundos();
+						long* estados = generarACEConMotor(motor, ACE, reglas[nr], pasos[np], celdas[nc]);
+						anotarMedida(medida, segundos() - t);
+						delete[] estados;
+					}
+					escribirResultado(salida, primero, funcion, reglas[nr], celdas[nc], pasos[np], medida, actualizaciones, "actualizaciones_por_segundo");
+				}
+
+				// generarHamming: simula el segundo ACE y compara ambos (actualizaciones de celdas por segundo)
+				iniciarMedida(medida);
+				while (medida.total < tiempoMinimo || medida.repeticiones == 0) {
+					t = segundos();
+					int* hamming = generarHamming(ACE, reglas[nr], pasos[np], celdas[nc]);
+					anotarMedida(medida, segundos() - t);
+					delete[] hamming;
+				}
+				escribirResultado(salida, primero, "generarHamming", reglas[nr], celdas[nc], pasos[np], medida, actualizaciones, "actualizaciones_por_segundo");
+
+				// guardaPGMiACE: bytes por segundo
+				iniciarMedida(medida);
+				while (medida.total < tiempoMinimo || medida.repeticiones == 0) {
+					t = segundos();
+					guardaPGMiACE((char*)FICHERO_TEMPORAL_PGM, pasos[np], celdas[nc], ACE, 1, 0);
+					anotarMedida(medida, segundos() - t);
+				}
+				escribirResultado(salida, primero, "guardaPGMiACE", reglas[nr], celdas[nc], pasos[np], medida, (double)tamanoFichero(FICHERO_TEMPORAL_PGM), "bytes_por_segundo");
+				remove(FICHERO_TEMPORAL_PGM);
+			}
+
+			liberarMemoriaACE(ACE, pasos[np]);
+		}
+	}
+
+	// Las funciones sobre series sólo dependen del número de puntos (pasos)
+	for (int np = 0; np < npasos; np++) {
+		// Serie sintética de distancias de Hamming crecientes (así exponenteHamming procesa todos los puntos)
+		int* distancias = new int [pasos[np] + 1];
+		double* reales = new double [pasos[np] + 1];
+		for (int i = 0; i < pasos[np] + 1; i++) {
+			distancias[i] = i + 1;
+			reales[i] = 1.0 / (i + 1);
+		}
+
+		// exponenteHamming: puntos por segundo
+		double eh;
+		iniciarMedida(medida);
+		while (medida.total < tiempoMinimo || medida.repeticiones == 0) {
+			t = segundos();
+			exponenteHamming(distancias, pasos[np] + 1, eh);
+			anotarMedida(medida, segundos() - t);
+		}
+		escribirResultado(salida, primero, "exponenteHamming", -1, 0, pasos[np], medida, pasos[np] + 1.0, "puntos_por_segundo");
+
+		// guardaPLOT (enteros y reales): bytes por segundo
+		iniciarMedida(medida);
+		while (medida.total < tiempoMinimo || medida.repeticiones == 0) {
+			t = segundos();
+			guardaPLOT((char*)FICHERO_TEMPORAL_DAT, distancias, pasos[np] + 1);
+			anotarMedida(medida, segundos() - t);
+		}
+		escribirResultado(salida, primero, "guardaPLOT(int)", -1, 0, pasos[np], medida, (double)tamanoFichero(FICHERO_TEMPORAL_DAT), "bytes_por_segundo");
+
+		iniciarMedida(medida);
+		while (medida.total < tiempoMinimo || medida.repeticiones == 0) {
+			t = segundos();
+			guardaPLOT((char*)FICHERO_TEMPORAL_DAT, reales, pasos[np] + 1);
+			anotarMedida(medida, segundos() - t);
+		}
+		escribirResultado(salida, primero, "guardaPLOT(double)", -1, 0, pasos[np], medida, (double)tamanoFichero(FICHERO_TEMPORAL_DAT), "bytes_por_segundo");
+		remove(FICHERO_TEMPORAL_DAT);
+
+		delete[] distancias;
+		delete[] reales;
+	}
+
+	// entropia: estados por segundo (vector de visitas de 2^celdas estados con aproximadamente la mitad a 0)
+	for (int nc = 0; nc < nceldasEntropia; nc++) {
+		long estadosPosibles = 1L << celdasEntropia[nc];
+		int* probabilidades = new int [estadosPosibles];
+		for (long e = 0; e < estadosPosibles; e++)
+			probabilidades[e] = (int)(((unsigned int)e * 2654435761u) >> 30);
+
+		iniciarMedida(medida);
+		while (medida.total < tiempoMinimo || medida.repeticiones == 0) {
+			t = segundos();
+			entropia(probabilidades, celdasEntropia[nc]);
+			anotarMedida(medida, segundos() - t);
+		}
+		escribirResultado(salida, primero, "entropia", -1, celdasEntropia[nc], 0, medida, (double)estadosPosibles, "estados_por_segundo");
+
+		delete[] probabilidades;
+	}
+
+	fprintf(salida, "\n  ]\n}\n");
+	if (salida != stdout)
+		fclose(salida);
+}
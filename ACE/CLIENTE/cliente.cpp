@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include "libconexion.h"
+
+#pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
+
+#define MAX_LINEA					4096	// Longitud máxima de una petición del fichero de peticiones
+#define MAX_CONEXIONES				256		// Número máximo de conexiones simultáneas
+
+static const char* rutaSocket = "ace.sock";	// Socket del servidor
+static std::vector<std::string> peticiones;	// Peticiones a enviar (en orden)
+static int repeticiones = 1;				// Veces que cada conexión envía cada petición
+static bool guardar = false;				// Guardar los ficheros devueltos en el directorio actual
+
+/*
+	Resultado de una conexión: la latencia de cada envío (en el orden de envío) y los errores.
+*/
+struct ResultadoConexion {
+	std::vector<double> latencias;			// Segundos de cada petición (peticiones · repeticiones)
+	int errores;							// Respuestas ERROR
+	bool cortada;							// Cierto si la conexión falló antes de terminar
+};
+
+static double segundos()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+	Muestra una respuesta: sus líneas de texto y, de cada fichero devuelto en ella, su nombre y su tamaño
+	(y lo guarda si se ha pedido).
+*/
+static void mostrarRespuesta(const std::vector<char>& respuesta)
+{
+	const char* p = respuesta.data();
+	const char* fin = p + respuesta.size() - 1;		// Sin el 0 que añade recibirMensaje
+
+	while (p < fin) {
+		const char* salto = (const char*)memchr(p, '\n', fin - p);
+		if (salto == NULL)
+			salto = fin;
+		std::string linea(p, salto - p);
+		p = salto + 1;
+
+		char nombre[256];
+		long long bytes;
+		if (sscanf(linea.c_str(), "DATOS %255s %lld", nombre, &bytes) == 2 && bytes >= 0 && bytes <= fin - p) {
+			printf("%s (%lld bytes recibidos)\n", linea.c_str(), bytes);
+			if (guardar) {
+				FILE* fichero = fopen(nombre, "wb");
+				if (fichero == NULL || fwrite(p, 1, (size_t)bytes, fichero) != (size_t)bytes)
+					printf("No se pudo guardar el fichero %s\n", nombre);
+				if (fichero != NULL)
+					fclose(fichero);
+			}
+			p += bytes;
+		}
+		else
+			printf("%s\n", linea.c_str());
+	}
+}
+
+/*
+	Cada conexión envía cada petición 'repeticiones' veces seguidas y espera su respuesta. La primera conexión
+	muestra la primera respuesta de cada petición.
+*/
+static void enviarPeticiones(int numero, ResultadoConexion* resultado)
+{
+	std::vector<char> respuesta;
+
+	resultado->errores = 0;
+	resultado->cortada = true;
+	long long conexion = conectar(rutaSocket);
+	if (conexion == CONEXION_INVALIDA)
+		return;
+
+	for (size_t p = 0; p < peticiones.size(); p++)
+		for (int r = 0; r < repeticiones; r++) {
+			double inicio = segundos();
+			if (!enviarMensaje(conexion, peticiones[p].c_str(), peticiones[p].size()) || !recibirMensaje(conexion, respuesta)) {
+				cerrarConexion(conexion);
+				return;
+			}
+			resultado->latencias.push_back(segundos() - inicio);
+			if (strncmp(respuesta.data(), "ERROR", 5) == 0)
+				resultado->errores++;
+			if (numero == 0 && r == 0) {
+				printf("> %s\n", peticiones[p].c_str());
+				mostrarRespuesta(respuesta);
+			}
+		}
+
+	resultado->cortada = false;
+	cerrarConexion(conexion);
+}
+
+/*
+ * Nombre: CLIENTE (Cliente de pruebas de SERVIDOR)
+ * Autor: Ismael Flores Campoy
+ * Descripción: Envía peticiones a un SERVIDOR, muestra sus respuestas (los ficheros devueltos sólo por su nombre
+ *              y tamaño, salvo que se pida guardarlos) y mide la latencia de cada petición. Con varias conexiones
+ *              las peticiones se envían a la vez desde varios hilos (cada conexión, todas las peticiones en orden);
+ *              con varias repeticiones se ve la diferencia entre la primera petición y las siguientes, que encuentran
+ *              las tablas y la memoria del servidor ya preparadas.
+ * Sintaxis: CLIENTE <opcion1>:<valor1> <opcion2>:<valor2> ...
+ *
+ * Opción					| Valores							| Valor por defecto
+ * -------------------------------------------------------------------------------------------------------
+ * socket					| ruta del socket					| ace.sock
+ * peticion					| petición (ver SERVIDOR)			| ESTADO
+ * peticiones				| nombre de fichero					| (ninguno)
+ * repeticiones				| entero >= 1						| 1
+ * conexiones				| [1, 256]							| 1
+ * guardar					| si, no							| no
+ *
+ * La opción peticion se puede repetir; su valor lleva espacios, por lo que hay que ponerla entre comillas.
+ * El fichero de peticiones tiene una petición por línea (lo que sigue a '#' es un comentario).
+ *
+ * Ejemplos:
+ *
+ * CLIENTE "peticion:ATRACTOR reglas:30 celdas:16 pasos:20" repeticiones:5
+ * CLIENTE "peticion:ACE reglas:110 respuesta:rutas" socket:/tmp/ace.sock
+ * CLIENTE peticiones:barrido.txt conexiones:8 guardar:si
+ * CLIENTE peticion:TERMINAR
+ *
+ */
+int main(int argc, char** argv)
+{
+	int nconexiones = 1;											// Conexiones simultáneas
+
+	// Procesado de los parámetros de entrada (si existen)
+	for (int a = 1; a < argc; a++) {
+		if (strstr(argv[a], "socket:") == argv[a])
+			rutaSocket = argv[a] + strlen("socket:");
+		else if (strstr(argv[a], "peticion:") == argv[a])
+			peticiones.push_back(argv[a] + strlen("peticion:"));
+		else if (strstr(argv[a], "peticiones:") == argv[a]) {
+			FILE* fichero = fopen(argv[a] + strlen("peticiones:"), "r");
+			if (fichero == NULL) {
+				printf("No se pudo abrir el fichero de peticiones %s\n", argv[a] + strlen("peticiones:"));
+				return 1;
+			}
+			char linea[MAX_LINEA];
+			while (fgets(linea, sizeof(linea), fichero) != NULL) {
+				char* comentario = strchr(linea, '#');
+				if (comentario != NULL)
+					*comentario = 0;
+				linea[strcspn(linea, "\r\n")] = 0;
+				if (linea[strspn(linea, " \t")] != 0)
+					peticiones.push_back(linea);
+			}
+			fclose(fichero);
+		}
+		else if (strstr(argv[a], "repeticiones:") == argv[a]) {
+			repeticiones = atoi(argv[a] + strlen("repeticiones:"));
+			if (repeticiones < 1) {
+				repeticiones = 1;
+				printf("Parámetro incorrecto, se esperaba un número de repeticiones mayor que 0... Se asume 1\n");
+			}
+		}
+		else if (strstr(argv[a], "conexiones:") == argv[a]) {
+			nconexiones = atoi(argv[a] + strlen("conexiones:"));
+			if (nconexiones < 1 || nconexiones > MAX_CONEXIONES) {
+				nconexiones = 1;
+				printf("Parámetro incorrecto, se esperaba un número de conexiones entre 1 y %d... Se asume 1\n", MAX_CONEXIONES);
+			}
+		}
+		else if (strstr(argv[a], "guardar:") == argv[a])
+			guardar = (strstr(argv[a], ":si") != NULL);
+	}
+	if (peticiones.empty())
+		peticiones.push_back("ESTADO");
+
+	if (!iniciarConexiones()) {
+		printf("No se pueden usar sockets\n");
+		return 1;
+	}
+
+	// Cada conexión desde su hilo (la primera desde el hilo principal, que es la que muestra las respuestas)
+	double inicio = segundos();
+	std::vector<ResultadoConexion> resultados(nconexiones);
+	std::vector<std::thread> grupo;
+	for (int c = 1; c < nconexiones; c++)
+		grupo.push_back(std::thread(enviarPeticiones, c, &resultados[c]));
+	enviarPeticiones(0, &resultados[0]);
+	for (size_t h = 0; h < grupo.size(); h++)
+		grupo[h].join();
+	double total = segundos() - inicio;
+
+	// Latencias: la primera vez que se envía cada petición y las repeticiones
+	std::vector<double> primeras, siguientes;
+	int errores = 0, cortadas = 0;
+	for (int c = 0; c < nconexiones; c++) {
+		for (size_t l = 0; l < resultados[c].latencias.size(); l++)
+			(l % repeticiones == 0 ? primeras : siguientes).push_back(resultados[c].latencias[l]);
+		errores += resultados[c].errores;
+		cortadas += resultados[c].cortada ? 1 : 0;
+	}
+	if (cortadas > 0)
+		printf("%d conexiones con %s no se pudieron completar\n", cortadas, rutaSocket);
+
+	for (int serie = 0; serie < 2; serie++) {
+		std::vector<double>& latencias = (serie == 0) ? primeras : siguientes;
+		if (latencias.empty())
+			continue;
+		std::sort(latencias.begin(), latencias.end());
+		double suma = 0.0;
+		for (size_t l = 0; l < latencias.size(); l++)
+			suma += latencias[l];
+		printf("Latencia (%s, %d peticiones): media %.3f ms, mediana %.3f ms, mínima %.3f ms, máxima %.3f ms\n",
+			serie == 0 ? "primera vez" : "repeticiones", (int)latencias.size(), 1000.0 * suma / latencias.size(),
+			1000.0 * latencias[latencias.size() / 2], 1000.0 * latencias.front(), 1000.0 * latencias.back());
+	}
+	printf("%d peticiones (%d con error) en %.3f s con %d conexiones\n", (int)(primeras.size() + siguientes.size()), errores, total, nconexiones);
+
+	return (cortadas > 0 || errores > 0) ? 1 : 0;
+}
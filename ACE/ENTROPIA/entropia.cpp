@@ -1,5 +1,13 @@
 #include "libguardaimagen.h"
 #include "libACE.h"
+#include "libcontenedor.h"
+#include "libmedidas.h"
+#include "libtrabajos.h"
+#include "libpuntocontrol.h"
+#include "libsucesores.h"
+#include "libtablas.h"
+#include "libpreimagenes.h"
+#include "libparcial.h"
 
 #pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
 
@@ -12,8 +20,7 @@
 #define MIN_PASOS					1		// como mínimo 1 paso de evolución
 #define MAX_PASOS					5000	// como máximo 5000 pasos de evolución
 
-#define N_MIN						3		// En evoluciones por número de celdas, valor mínimo
-#define N_MAX						20		// En evoluciones por número de celdas, valor máximo
+#define MAX_DISTRIBUCIONES			32		// Número máximo de distribuciones de preimágenes a calcular
 
 /*
  * Nombre: ENTROPIA (Estudio de la evolución de la entropia)
@@ -21,12 +28,31 @@
  * Descripción: Genera información a propósito de la evolución de autómatas celulares elementales
  *              según el número de celdas. Se analiza la evolución del valor estacionario de la entropía y 
  *              la evolución del porcentaje final de estados no visitados, ambas en función del número de celdas del ACE.             
+ *              Para el primer paso, el porcentaje de estados no visitados (Jardines del Edén) y la distribución del número
+ *              de preimágenes se pueden calcular también de forma exacta con matrices de transferencia (ver libpreimagenes),
+ *              sin simular, para anillos de miles de celdas.
  * Sintaxis: ACE <opcion1>:<valor1> <opcion2>:<valor2> ...
  *
  * Opción					| Valores (separados por comas)		| Valor por defecto
  * -------------------------------------------------------------------------------------------------------
  * regla					| [0, 255], todas					| REGLA (54)
  * pasos					| [1, 5000]							| PASOS (500)
+ * formato					| texto, npy, ambos					| texto
+ * contenedor				| nombre de fichero					| (ficheros independientes)
+ * informe					| nombre de fichero					| (sin informe)
+ * progreso					| segundos							| 0 (sin progreso)
+ * ciclos					| si, no							| si
+ * sucesores				| si, no							| si
+ * cachesucesores			| directorio						| (sin caché)
+ * paginasgrandes			| si, no							| si
+ * exacto					| [3, 100000]						| (sin cálculo exacto)
+ * preimagenes				| [1, 100000]						| (sin distribuciones)
+ * simulacion				| si, no							| si
+ * puntocontrol				| nombre de fichero					| (sin puntos de control)
+ * intervalocontrol			| segundos							| PUNTOCONTROL_INTERVALO (600)
+ * reanudar					| nombre de fichero					| (ejecución nueva)
+ * parte (o shard)			| i/n (0 <= i < n)					| (ejecución completa)
+ * parciales				| nombre base de fichero			| PARCIAL_ENTROPIA
  *
  * Argumento					| Significado
  * ------------------------------------------------------------------------------------------------------------
@@ -34,26 +60,74 @@
  * regla:4						| Se calcula el ACE (y se guarda en ficheros) de la regla 4
  * regla:4,90,126				| Se calcula el ACE (y se guarda en ficheros) de laS reglas 4, 90 y 126
  * pasos:300					| Se calculan 300 pasos de la evolución del ACE
+ * formato:npy					| Las series se guardan en formato binario NPY (numpy) en lugar de texto (.dat)
+ * formato:ambos				| Las series se guardan en formato texto (.dat) y en formato binario NPY (.npy)
+ * contenedor:R.acec			| Todas las salidas se guardan en el fichero contenedor R.acec (se extraen con EXTRAER)
+ * informe:R.json				| Al terminar se guarda en R.json el informe de rendimiento (tiempo de cada fase, contadores, memoria)
+ * progreso:60					| Cada 60 segundos se muestra el porcentaje realizado y el tiempo estimado que falta
+ * ciclos:no					| Se simulan todos los pasos aunque la evolución entre en un ciclo (sin copiar el ciclo detectado)
+ * sucesores:no					| Se simula cada estado inicial en lugar de seguir la tabla de sucesores (hasta 26 celdas)
+ * cachesucesores:cache			| Las tablas de sucesores se guardan en el directorio 'cache' y se reutilizan en otras ejecuciones
+ * paginasgrandes:no			| Las tablas grandes (visitas a cada estado, sucesores) se reservan con páginas normales
+ * exacto:5000					| Se guarda en NOVISITADOS_EXACTO_R... la fracción exacta de estados sin preimágenes (no visitados
+ *								| en el primer paso) de 3 a 5000 celdas, comprobada antes contra la enumeración con pocas celdas
+ * preimagenes:20,1000			| Se guarda en PREIMAGENES_R..._C... la fracción de estados de 20 y 1000 celdas con cada número
+ *								| de preimágenes
+ * simulacion:no				| No se simulan los estados (sólo se hacen los cálculos exactos)
+ * puntocontrol:R.pc			| Cada 'intervalocontrol' segundos se guarda en R.pc la posición y los resultados parciales
+ * intervalocontrol:300			| Los puntos de control se guardan cada 300 segundos
+ * reanudar:R.pc				| Se continúa la ejecución guardada en R.pc (reglas, pasos y formato se toman de él)
+ * parte:3/16					| Se calcula sólo la parte 3 de 16 de la ejecución (las reglas, celdas y estados que le tocan) y sus
+ *								| resultados se guardan en PARCIAL_ENTROPIA.3.par, en lugar de las salidas (se juntan con FUSIONAR)
+ * parciales:compartido/R		| Los resultados parciales se guardan en compartido/R.<parte>.par
  * 
  * Ejemplos:
  *
  * ENTROPIA regla:126,90
  * ENTROPIA regla:todas
  * ENTROPIA regla:4 pasos:200
+ * ENTROPIA reglas:todas puntocontrol:R.pc
+ * ENTROPIA reanudar:R.pc
+ * ENTROPIA reglas:todas pasos:200 parte:3/16 parciales:compartido/R
+ * ENTROPIA reglas:30,110 exacto:5000 preimagenes:1000 simulacion:no
  *
  */
 int main(int argc, char** argv)
 {
 	int pasos = PASOS;								// Pasos de evolución a simular (por defecto PASOS)
-	int** ACE;										// Donde guardamos el estado del autómata [PASOS + 1][CELDAS + 2]
 	int reglas[256];								// Guardamos las reglas a aplicar
 	int nreglas;									// Guardamos el número de reglas a aplicar
-	char nombreFichero[256];						// Guardamos los nombres de los ficheros a crear
-	double* noVisitados;							// Guardamos los porcentajes finales de estados no visitados
-	double* entropias;								// Guardamos los valores estacionario de las entropías
+	int formato = FORMATO_TEXTO;					// Formato de los ficheros de series (por defecto texto compatible con gnuplot)
+	char nombreContenedor[256];						// Fichero contenedor en el que guardar todas las salidas (vacío: ficheros independientes)
+	Contenedor* contenedor = NULL;					// Contenedor abierto (si se usa)
+	char nombreInforme[256];						// Fichero en el que guardar el informe de rendimiento (vacío: sin informe)
+	double intervaloProgreso = 0.0;					// Segundos entre líneas de progreso (0: sin progreso)
+	bool ciclos = true;								// Detección de ciclos en las simulaciones (por defecto activada)
+	bool sucesores = true;							// Uso de las tablas de sucesores (por defecto activado)
+	char directorioSucesores[256];					// Directorio de la caché de tablas de sucesores (vacío: sin caché)
+	bool paginasGrandes = true;						// Páginas grandes para las tablas grandes (ver libtablas, por defecto activadas)
+	int NExacto = 0;								// Celdas máximas de la fracción exacta de estados sin preimágenes (0: sin cálculo exacto)
+	int distribuciones[MAX_DISTRIBUCIONES];			// Celdas de las distribuciones de preimágenes a calcular
+	int ndistribuciones = 0;						// Número de distribuciones de preimágenes a calcular
+	bool simulacion = true;							// Simulación de todos los estados (por defecto activada)
+	char nombreControl[256];						// Fichero de punto de control (vacío: sin puntos de control)
+	char nombreReanudar[256];						// Punto de control desde el que reanudar (vacío: ejecución nueva)
+	double intervaloControl = PUNTOCONTROL_INTERVALO;	// Segundos entre puntos de control
+	PuntoControl control;							// Punto de control de la ejecución
+	PuntoControl* pcontrol = NULL;					// Punto de control en uso (NULL: sin puntos de control)
+	int nrInicial = 0;								// Posición en la lista de la primera regla a calcular (al reanudar)
+	int parte = 0, partes = 0;						// Parte de la ejecución a calcular (partes = 0: ejecución completa)
+	char baseParciales[256];						// Nombre base de los ficheros de resultados parciales
+	Parcial parcial;								// Fichero de resultados parciales de la parte
 
 	// Por defecto aplicaremos la regla REGLA si como argumento no indicamos otra cosa
 	reglas[0] = REGLA;
+	nombreContenedor[0] = 0;
+	nombreInforme[0] = 0;
+	directorioSucesores[0] = 0;
+	nombreControl[0] = 0;
+	nombreReanudar[0] = 0;
+	strcpy(baseParciales, "PARCIAL_ENTROPIA");
 	nreglas = 1;
 
 	// Procesado de los parámetros de entrada (si existen)
@@ -73,66 +147,199 @@ int main(int argc, char** argv)
 				printf("Parámetro incorrecto, se esperaba un número de pasos entre %d y %d... Se asumen %d pasos\n", MIN_PASOS, MAX_PASOS, pasos);
 			}
 		}
+		else if (strstr(argv[a], "contenedor:") == argv[a]) {
+			// Si encontramos un argumento 'contenedor:' todas las salidas se guardarán en dicho fichero
+			strncpy(nombreContenedor, argv[a] + strlen("contenedor:"), sizeof(nombreContenedor) - 1);
+			nombreContenedor[sizeof(nombreContenedor) - 1] = 0;
+		}
+		else if (strstr(argv[a], "informe:") == argv[a]) {
+			// Si encontramos un argumento 'informe:' al terminar se guardará en dicho fichero el informe de rendimiento
+			strncpy(nombreInforme, argv[a] + strlen("informe:"), sizeof(nombreInforme) - 1);
+			nombreInforme[sizeof(nombreInforme) - 1] = 0;
+		}
+		else if (strstr(argv[a], "progreso:") == argv[a]) {
+			// Si encontramos un argumento 'progreso:' analizamos que valor tiene.
+			intervaloProgreso = atof(argv[a] + strlen("progreso:"));
+		}
+		else if (strstr(argv[a], "ciclos:") == argv[a]) {
+			// Si encontramos un argumento 'ciclos:' analizamos que valor tiene.
+			ciclos = (strstr(argv[a], ":no") == NULL);
+		}
+		else if (strstr(argv[a], "sucesores:") == argv[a]) {
+			// Si encontramos un argumento 'sucesores:' analizamos que valor tiene.
+			sucesores = (strstr(argv[a], ":no") == NULL);
+		}
+		else if (strstr(argv[a], "paginasgrandes:") == argv[a]) {
+			// Si encontramos un argumento 'paginasgrandes:' analizamos que valor tiene.
+			paginasGrandes = (strstr(argv[a], ":no") == NULL);
+		}
+		else if (strstr(argv[a], "exacto:") == argv[a]) {
+			// Si encontramos un argumento 'exacto:' analizamos que valor tiene.
+			NExacto = atoi(argv[a] + strlen("exacto:"));
+			if (NExacto < ENTROPIA_N_MIN || NExacto > PREIMAGENES_MAX_CELDAS) {
+				NExacto = 0;
+				printf("Parámetro incorrecto, se esperaba un número de celdas entre %d y %d... No se hace el cálculo exacto\n", ENTROPIA_N_MIN, PREIMAGENES_MAX_CELDAS);
+			}
+		}
+		else if (strstr(argv[a], "preimagenes:") == argv[a]) {
+			// Si encontramos un argumento 'preimagenes:' analizamos que valores tiene.
+			ndistribuciones = obtenerValores(distribuciones, MAX_DISTRIBUCIONES, argv[a] + strlen("preimagenes:"), 1, PREIMAGENES_MAX_CELDAS);
+		}
+		else if (strstr(argv[a], "simulacion:") == argv[a]) {
+			// Si encontramos un argumento 'simulacion:' analizamos que valor tiene.
+			simulacion = (strstr(argv[a], ":no") == NULL);
+		}
+		else if (strstr(argv[a], "cachesucesores:") == argv[a]) {
+			// Si encontramos un argumento 'cachesucesores:' las tablas de sucesores se guardarán en dicho directorio
+			strncpy(directorioSucesores, argv[a] + strlen("cachesucesores:"), sizeof(directorioSucesores) - 1);
+			directorioSucesores[sizeof(directorioSucesores) - 1] = 0;
+		}
+		else if (strstr(argv[a], "puntocontrol:") == argv[a]) {
+			// Si encontramos un argumento 'puntocontrol:' se guardarán puntos de control en dicho fichero
+			strncpy(nombreControl, argv[a] + strlen("puntocontrol:"), sizeof(nombreControl) - 1);
+			nombreControl[sizeof(nombreControl) - 1] = 0;
+		}
+		else if (strstr(argv[a], "intervalocontrol:") == argv[a]) {
+			// Si encontramos un argumento 'intervalocontrol:' analizamos que valor tiene.
+			intervaloControl = atof(argv[a] + strlen("intervalocontrol:"));
+		}
+		else if (strstr(argv[a], "reanudar:") == argv[a]) {
+			// Si encontramos un argumento 'reanudar:' se continuará la ejecución guardada en dicho fichero
+			strncpy(nombreReanudar, argv[a] + strlen("reanudar:"), sizeof(nombreReanudar) - 1);
+			nombreReanudar[sizeof(nombreReanudar) - 1] = 0;
+		}
+		else if (strstr(argv[a], "parte:") == argv[a] || strstr(argv[a], "shard:") == argv[a]) {
+			// Si encontramos un argumento 'parte:' sólo se calculará esa parte de la ejecución
+			if (!obtenerParte(strchr(argv[a], ':') + 1, parte, partes)) {
+				printf("Parámetro incorrecto, se esperaba la parte como i/n con 0 <= i < n <= %d\n", PARCIAL_MAX_PARTES);
+				return 1;
+			}
+		}
+		else if (strstr(argv[a], "parciales:") == argv[a]) {
+			// Si encontramos un argumento 'parciales:' los resultados parciales se guardarán con dicho nombre base
+			strncpy(baseParciales, argv[a] + strlen("parciales:"), sizeof(baseParciales) - 1);
+			baseParciales[sizeof(baseParciales) - 1] = 0;
+		}
+		else if (strstr(argv[a], "formato:") == argv[a]) {
+			// Si encontramos un argumento 'formato:' analizamos que valor tiene.
+			if (strstr(argv[a], ":texto") != NULL)
+				formato = FORMATO_TEXTO;
+			else if (strstr(argv[a], ":npy") != NULL)
+				formato = FORMATO_NPY;
+			else if (strstr(argv[a], ":ambos") != NULL)
+				formato = FORMATO_AMBOS;
+		}
 	}
 
-	// Asignamos memoria para los datos de los cálculos
-	noVisitados = new double [N_MAX - N_MIN + 1];
-	entropias = new double [N_MAX - N_MIN + 1];
+	// Si se reanuda, los parámetros de la ejecución se toman del punto de control
+	if (nombreReanudar[0] != 0) {
+		if (!leerPuntoControl(control, nombreReanudar, intervaloControl) || control.cabecera.tipo != TRABAJO_ENTROPIA) {
+			printf("El fichero %s no es un punto de control de ENTROPIA\n", nombreReanudar);
+			return 1;
+		}
+		pasos = control.cabecera.pasos;
+		formato = control.cabecera.formato;
+		nreglas = control.cabecera.nreglas;
+		memcpy(reglas, control.reglas, nreglas * sizeof(int));
+		nrInicial = control.cabecera.indiceRegla;
+		printf("Se reanuda %s: regla %d (%d de %d), %d celdas, estado %d\n", nombreReanudar, reglas[nrInicial], nrInicial + 1, nreglas, control.cabecera.N, control.cabecera.estado);
+		pcontrol = &control;
+	}
+	else if (nombreControl[0] != 0) {
+		iniciarPuntoControl(control, nombreControl, intervaloControl, TRABAJO_ENTROPIA, 0, pasos, formato, reglas, nreglas);
+		pcontrol = &control;
+	}
 
-	// Hacemos los cálculos para cada regla indicada
-	for (int nr = 0; nr < nreglas; nr++) {
+	// El contenedor se escribe entero al cerrarlo, así que no se puede continuar desde un punto de control
+	if (pcontrol != NULL && nombreContenedor[0] != 0) {
+		printf("Los puntos de control no se pueden usar junto con un contenedor\n");
+		return 1;
+	}
 
-		// Para cada regla, hacemos los cáculos para ACEs con números de celdas que van de N_MIN a N_MAX
-		for (int N = N_MIN; N <= N_MAX; N++) {
+	// Una parte no guarda salidas sino resultados parciales, que se completan de una vez al terminar
+	if (partes > 0 && (pcontrol != NULL || nombreContenedor[0] != 0)) {
+		printf("Una parte de la ejecución no se puede usar junto con puntos de control ni con un contenedor\n");
+		return 1;
+	}
+	if (partes > 0 && !crearParcial(parcial, baseParciales, TRABAJO_ENTROPIA, 0, pasos, formato, reglas, nreglas, parte, partes)) {
+		printf("No se pudo crear el fichero de resultados parciales %s\n", parcial.nombre);
+		return 1;
+	}
 
-			// Estados posibles para ese tipo de ACE con ese número de celdas
-			int estadosPosibles = (int)pow(2.0, N);
+	// Medidas de rendimiento (progreso e informe)
+	iniciarMedidas("ENTROPIA", argc, argv, intervaloProgreso);
 
-			// Inicializamos las variables necesarias para los cálculos
-			int visitadosPaso = 0;
-			int* probabilidades = new int [estadosPosibles];
-			memset(probabilidades, 0, estadosPosibles * sizeof(int));
-			int* base = new int [N + 2];
-			asignarMemoriaACE(&ACE, pasos, N);
+	// Detección de ciclos en las simulaciones
+	usarDeteccionCiclos(ciclos);
 
-			// Recorremos todos los estados posibles para el número de celdas dado
-			for (int estado = 0; estado < estadosPosibles; estado++) {
-				generarEstadoInicial(base, estado, N);
-				inicializarACE(ACE, N, INICIALIZACION_FIJA, base);
+	// Tablas de sucesores (y su caché en disco)
+	usarTablasSucesores(sucesores);
+	usarCacheSucesores(directorioSucesores);
 
-				long* estados = generarACE(ACE, reglas[nr], pasos, N);
+	// Reserva de las tablas grandes (páginas grandes y prefallo en paralelo en el nodo NUMA de este hilo)
+	usarTablasGrandes(paginasGrandes);
 
-				// Actualizamos las veces que cada estado es visitado en el último paso
-				probabilidades[estados[pasos - 1]]++;
+	// Si se ha indicado un contenedor, todas las salidas se guardan en él
+	if (nombreContenedor[0] != 0) {
+		contenedor = crearContenedor(nombreContenedor);
+		if (contenedor == NULL)
+			printf("No se pudo crear el contenedor %s... Se guardan ficheros independientes\n", nombreContenedor);
+		usarContenedor(contenedor);
+	}
 
-				// Actualizamos el número de estados diferentes visitados en el último paso
-				if (probabilidades[estados[pasos - 1]] == 1)
-					visitadosPaso++;
+	// Memoria de trabajo que se reutiliza entre reglas y números de celdas
+	EspacioTrabajo espacio;
+	iniciarEspacioTrabajo(espacio);
 
-				// Eliminamos la lista de estados visitados
-				delete[] estados;
-			}
-
-			// Calculamos el porcentaje de estados no visitados y la entropía (ambos en el paso final)
-			noVisitados[N - N_MIN] = (double)(estadosPosibles - visitadosPaso) / (double)estadosPosibles;
-			entropias[N - N_MIN] = entropia(probabilidades, N);
+	// En una parte sólo se calculan los tramos de las reglas que le tocan
+	ParteTrabajo tramos[MAX_REGLAS];
+	bool calcular[MAX_REGLAS];
+	long long coste = 0;
+	for (int nr = nrInicial; nr < nreglas; nr++) {
+		long long costeRegla = costeTrabajo(TRABAJO_ENTROPIA, 0, pasos);
+		calcular[nr] = (partes == 0) || tramoReglaTrabajo(TRABAJO_ENTROPIA, 0, pasos, nreglas, nr, parte, partes, tramos[nr], costeRegla);
+		tramos[nr].parcial = &parcial;
+		if (simulacion && calcular[nr])
+			coste += costeRegla;
+	}
+	iniciarProgresoTrabajos(coste);
 
-			// Liberamos la memoria no necesaria
-			liberarMemoriaACE(ACE, pasos);
-			delete[] base;
-			delete[] probabilidades;
+	// Para cada regla, hacemos los cáculos para ACEs con números de celdas que van de ENTROPIA_N_MIN a ENTROPIA_N_MAX
+	// y guardamos los resultados
+	for (int nr = nrInicial; nr < nreglas; nr++) {
+		if (simulacion && calcular[nr]) {
+			reglaPuntoControl(pcontrol, nr);
+			trabajoEntropia(espacio, reglas[nr], pasos, formato, pcontrol, partes > 0 ? &tramos[nr] : NULL);
 		}
 
-		// Guardamos los datos calculados
-		sprintf(nombreFichero, "NOVISITADOS_R%03d_P%05d.dat", reglas[nr], pasos);
-		guardaPLOT(nombreFichero, noVisitados,  N_MAX - N_MIN + 1, N_MIN, 5);
-
-		sprintf(nombreFichero, "ENTROPIA_R%03d_P%05d.dat", reglas[nr], pasos);
-		guardaPLOT(nombreFichero, entropias, N_MAX - N_MIN + 1, N_MIN);
+		// Los cálculos exactos no dependen de la simulación (en una ejecución repartida los hace la parte 0)
+		if ((NExacto > 0 || ndistribuciones > 0) && parte == 0)
+			trabajoPreimagenes(espacio, reglas[nr], NExacto, distribuciones, ndistribuciones, formato);
+	}
 
+	// Los resultados parciales sólo se dan por buenos si se han escrito completos
+	bool correcto = true;
+	if (partes > 0) {
+		correcto = cerrarParcial(parcial);
+		if (correcto)
+			printf("Parte %d de %d guardada en %s\n", parte, partes, parcial.nombre);
+		else
+			printf("No se pudo completar el fichero de resultados parciales %s\n", parcial.nombre);
 	}
 
-	// Liberamos la memoria necesaria para guardar los datos finales
-	delete[] noVisitados;
-	delete[] entropias;
+	// Terminada la ejecución, el punto de control ya no hace falta
+	if (pcontrol != NULL)
+		borrarPuntoControl(control);
+
+	// Liberamos la memoria de trabajo
+	liberarEspacioTrabajo(espacio);
+
+	// Cerramos el contenedor (escribe el índice de las salidas guardadas)
+	cerrarContenedor(contenedor);
+
+	// Guardamos el informe de rendimiento
+	if (nombreInforme[0] != 0 && !guardarInformeMedidas(nombreInforme))
+		printf("No se pudo crear el informe %s\n", nombreInforme);
+
+	return correcto ? 0 : 1;
 }
@@ -0,0 +1,117 @@
+#include "libACE.h"
+#include "libcontenedor.h"
+
+#pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
+
+#define MAX_REGLAS					256		// Número máximo de reglas a extraer
+
+/*
+ * Nombre: EXTRAER (Extracción de las salidas guardadas en un contenedor)
+ * Autor: Ismael Flores Campoy
+ * Descripción: Recupera, como ficheros independientes, las salidas que ACE, HAMMING, ATRACTOR o ENTROPIA
+ *              guardaron en un único fichero contenedor (opción contenedor:). Los ficheros extraídos son
+ *              idénticos a los que se habrían generado sin contenedor (.pgm, .dat o .npy).
+ * Sintaxis: EXTRAER contenedor:<fichero> <opcion1>:<valor1> <opcion2>:<valor2> ...
+ *
+ * Opción					| Valores (separados por comas)		| Valor por defecto
+ * -------------------------------------------------------------------------------------------------------
+ * contenedor				| nombre de fichero					| (obligatorio)
+ * reglas					| [0, 255], todas					| todas
+ * tipo						| ACE, HAMMING, ATRACTOR, ...		| (todos)
+ * nombre					| nombre de la salida				| (todas)
+ * listar					| si, no							| no
+ *
+ * Argumento					| Significado
+ * ------------------------------------------------------------------------------------------------------------
+ * contenedor:R.acec			| Se extraen las salidas guardadas en el fichero contenedor R.acec
+ * reglas:4,90					| Sólo se extraen las salidas de las reglas 4 y 90
+ * tipo:ENTROPIA				| Sólo se extraen las salidas de tipo ENTROPIA (prefijo del nombre del fichero)
+ * nombre:ACE_R054_C01000_P00500_semilla.pgm	| Sólo se extrae la salida con ese nombre
+ * listar:si					| No se extrae nada, se muestra el índice del contenedor
+ *
+ * Ejemplos:
+ *
+ * EXTRAER contenedor:atractor.acec
+ * EXTRAER contenedor:atractor.acec listar:si
+ * EXTRAER contenedor:atractor.acec reglas:30 tipo:ENTROPIA
+ *
+ */
+int main(int argc, char** argv)
+{
+	char nombreContenedor[256];						// Fichero contenedor del que extraer las salidas
+	int reglas[MAX_REGLAS];							// Reglas cuyas salidas hay que extraer
+	int nreglas = 0;								// Número de reglas a extraer (0: todas)
+	int tipo = TIPO_DESCONOCIDO;					// Tipo de las salidas a extraer (TIPO_DESCONOCIDO: todos)
+	const char* nombre = NULL;						// Nombre de la salida a extraer (NULL: todas)
+	bool listar = false;							// Mostrar el índice en lugar de extraer
+	int extraidas = 0;								// Número de salidas extraídas
+
+	nombreContenedor[0] = 0;
+
+	// Procesado de los parámetros de entrada (si existen)
+	for (int a = 1; a < argc; a++) {
+		if (strstr(argv[a], "contenedor:") == argv[a]) {
+			strncpy(nombreContenedor, argv[a] + strlen("contenedor:"), sizeof(nombreContenedor) - 1);
+			nombreContenedor[sizeof(nombreContenedor) - 1] = 0;
+		}
+		else if (strstr(argv[a], "reglas:") == argv[a]) {
+			// Si encontramos un argumento 'reglas:' analizamos que valor tiene.
+			if (strstr(argv[a], ":todas") != NULL)
+				nreglas = 0;
+			else
+				nreglas = obtenerValores(reglas, MAX_REGLAS, argv[a] + strlen("reglas:"));
+		}
+		else if (strstr(argv[a], "tipo:") == argv[a]) {
+			// Buscamos el tipo cuyo prefijo coincide con el valor indicado
+			for (int t = TIPO_ACE; nombreTipo(t) != NULL; t++)
+				if (strcmp(nombreTipo(t), argv[a] + strlen("tipo:")) == 0)
+					tipo = t;
+			if (tipo == TIPO_DESCONOCIDO)
+				printf("Parámetro incorrecto, tipo de salida desconocido (%s)... Se extraen todos los tipos\n", argv[a] + strlen("tipo:"));
+		}
+		else if (strstr(argv[a], "nombre:") == argv[a])
+			nombre = argv[a] + strlen("nombre:");
+		else if (strstr(argv[a], "listar:") == argv[a])
+			listar = (strstr(argv[a], ":si") != NULL);
+	}
+
+	if (nombreContenedor[0] == 0) {
+		printf("Falta el parámetro contenedor:<fichero>\n");
+		return 1;
+	}
+
+	Contenedor* contenedor = abrirContenedor(nombreContenedor);
+	if (contenedor == NULL) {
+		printf("No se pudo abrir el contenedor %s\n", nombreContenedor);
+		return 1;
+	}
+
+	for (int e = 0; e < contenedor->cabecera.entradas; e++) {
+		const EntradaContenedor& entrada = contenedor->indice[e];
+
+		// Filtramos por regla, tipo y nombre
+		bool seleccionada = (nreglas == 0);
+		for (int nr = 0; nr < nreglas; nr++)
+			if (reglas[nr] == entrada.regla)
+				seleccionada = true;
+		if (tipo != TIPO_DESCONOCIDO && entrada.tipo != tipo)
+			seleccionada = false;
+		if (nombre != NULL && strcmp(nombre, entrada.nombre) != 0)
+			seleccionada = false;
+		if (!seleccionada)
+			continue;
+
+		if (listar)
+			printf("%5d R%03d %-24s %12llu %12llu %s\n", e, entrada.regla, nombreTipo(entrada.tipo) != NULL ? nombreTipo(entrada.tipo) : "?",
+				entrada.desplazamiento, entrada.longitud, entrada.nombre);
+		else if (extraerEntradaContenedor(contenedor, e))
+			extraidas++;
+		else
+			printf("No se pudo extraer %s\n", entrada.nombre);
+	}
+
+	if (!listar)
+		printf("Se han extraído %d salidas de %s\n", extraidas, nombreContenedor);
+
+	cerrarContenedor(contenedor);
+}
@@ -0,0 +1,151 @@
+#include "libguardaimagen.h"
+#include "libACE.h"
+#include "libcontenedor.h"
+#include "libtrabajos.h"
+#include "libparcial.h"
+
+#pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
+
+/*
+ * Nombre: FUSIONAR (Fusión de los resultados parciales de una ejecución repartida en partes)
+ * Autor: Ismael Flores Campoy
+ * Descripción: Junta los resultados parciales que guardaron las partes de una ejecución de ATRACTOR o ENTROPIA
+ *              (opción parte:i/n) y guarda las mismas salidas (.dat o .npy) que la ejecución completa.
+ *              Lee <base>.0.par, <base>.1.par, ... uno detrás de otro y comprueba que entre todos cubren
+ *              todos los estados de todas las reglas exactamente una vez.
+ * Sintaxis: FUSIONAR parciales:<base> <opcion1>:<valor1> <opcion2>:<valor2> ...
+ *
+ * Opción					| Valores (separados por comas)		| Valor por defecto
+ * -------------------------------------------------------------------------------------------------------
+ * parciales				| nombre base de fichero			| (obligatorio)
+ * contenedor				| nombre de fichero					| (ficheros independientes)
+ *
+ * Argumento					| Significado
+ * ------------------------------------------------------------------------------------------------------------
+ * parciales:compartido/R		| Se juntan los resultados parciales de compartido/R.0.par, compartido/R.1.par, ...
+ * contenedor:R.acec			| Todas las salidas se guardan en el fichero contenedor R.acec (se extraen con EXTRAER)
+ *
+ * Ejemplos:
+ *
+ * FUSIONAR parciales:PARCIAL_ATRACTOR
+ * FUSIONAR parciales:compartido/R contenedor:R.acec
+ *
+ */
+int main(int argc, char** argv)
+{
+	char baseParciales[256];						// Nombre base de los ficheros de resultados parciales
+	char nombreContenedor[256];						// Fichero contenedor en el que guardar todas las salidas (vacío: ficheros independientes)
+	Contenedor* contenedor = NULL;					// Contenedor abierto (si se usa)
+	Parcial parcial;								// Fichero de resultados parciales que se está leyendo
+	CabeceraParcial primera;						// Cabecera de la parte 0 (todas deben coincidir con ella)
+	int reglas[PARCIAL_MAX_REGLAS];					// Lista de reglas de la ejecución
+	int fusionadas = 0;								// Reglas cuyas salidas se han guardado
+
+	baseParciales[0] = 0;
+	nombreContenedor[0] = 0;
+
+	// Procesado de los parámetros de entrada (si existen)
+	for (int a = 1; a < argc; a++) {
+		if (strstr(argv[a], "parciales:") == argv[a]) {
+			strncpy(baseParciales, argv[a] + strlen("parciales:"), sizeof(baseParciales) - 1);
+			baseParciales[sizeof(baseParciales) - 1] = 0;
+		}
+		else if (strstr(argv[a], "contenedor:") == argv[a]) {
+			// Si encontramos un argumento 'contenedor:' todas las salidas se guardarán en dicho fichero
+			strncpy(nombreContenedor, argv[a] + strlen("contenedor:"), sizeof(nombreContenedor) - 1);
+			nombreContenedor[sizeof(nombreContenedor) - 1] = 0;
+		}
+	}
+
+	if (baseParciales[0] == 0) {
+		printf("Falta el parámetro parciales:<base>\n");
+		return 1;
+	}
+
+	// La parte 0 dice cuántas partes hay y los parámetros de la ejecución
+	if (!abrirParcial(parcial, baseParciales, 0)) {
+		printf("No se pudo leer el fichero de resultados parciales %s\n", parcial.nombre);
+		return 1;
+	}
+	primera = parcial.cabecera;
+	memcpy(reglas, parcial.reglas, primera.nreglas * sizeof(int));
+	if (primera.tipo != TRABAJO_ATRACTOR && primera.tipo != TRABAJO_ENTROPIA) {
+		printf("El fichero %s no es de ATRACTOR ni de ENTROPIA\n", parcial.nombre);
+		liberarParcial(parcial);
+		return 1;
+	}
+
+	// Si se ha indicado un contenedor, todas las salidas se guardan en él
+	if (nombreContenedor[0] != 0) {
+		contenedor = crearContenedor(nombreContenedor);
+		if (contenedor == NULL)
+			printf("No se pudo crear el contenedor %s... Se guardan ficheros independientes\n", nombreContenedor);
+		usarContenedor(contenedor);
+	}
+
+	EspacioTrabajo espacio;
+	iniciarEspacioTrabajo(espacio);
+
+	// Recorremos las piezas de todas las partes en orden: cada una debe empezar donde terminó la anterior
+	long long porRegla = estadosTrabajo(primera.tipo, primera.celdas);
+	long long esperada = 0;							// Posición del recorrido de todas las reglas en la que debe empezar la siguiente pieza
+	bool correcto = true;
+	for (int i = 0; i < primera.partes && correcto; i++) {
+		if (i > 0 && !abrirParcial(parcial, baseParciales, i)) {
+			printf("No se pudo leer el fichero de resultados parciales %s\n", parcial.nombre);
+			correcto = false;
+			break;
+		}
+
+		const CabeceraParcial& cabecera = parcial.cabecera;
+		if (cabecera.tipo != primera.tipo || cabecera.celdas != primera.celdas || cabecera.pasos != primera.pasos ||
+			cabecera.formato != primera.formato || cabecera.partes != primera.partes || cabecera.nreglas != primera.nreglas ||
+			memcmp(parcial.reglas, reglas, primera.nreglas * sizeof(int)) != 0) {
+			printf("El fichero %s no corresponde a la misma ejecución que el de la parte 0\n", parcial.nombre);
+			correcto = false;
+		}
+
+		while (correcto && parcial.hayPieza) {
+			const CabeceraPieza& pieza = parcial.pieza;
+			long long posicion = -1;
+			if (pieza.indiceRegla >= 0 && pieza.indiceRegla < primera.nreglas && pieza.regla == reglas[pieza.indiceRegla] &&
+				posicionTrabajo(primera.tipo, primera.celdas, pieza.N, pieza.hasta) >= 0 && pieza.desde < pieza.hasta)
+				posicion = pieza.indiceRegla * porRegla + posicionTrabajo(primera.tipo, primera.celdas, pieza.N, pieza.desde);
+			if (posicion != esperada) {
+				printf("Faltan o sobran estados de la regla %d en %s\n", pieza.regla, parcial.nombre);
+				correcto = false;
+				break;
+			}
+			if (!fusionarPiezaTrabajo(espacio, parcial)) {
+				printf("Los datos de la regla %d en %s no son válidos\n", pieza.regla, parcial.nombre);
+				correcto = false;
+				break;
+			}
+			esperada += pieza.hasta - pieza.desde;
+
+			// Al completar el recorrido de una regla ya se pueden guardar sus salidas
+			if (esperada % porRegla == 0) {
+				guardarFusionTrabajo(espacio, primera, pieza.regla);
+				fusionadas++;
+			}
+
+			if (!siguientePiezaParcial(parcial)) {
+				printf("El fichero de resultados parciales %s está incompleto\n", parcial.nombre);
+				correcto = false;
+			}
+		}
+		liberarParcial(parcial);
+	}
+	if (correcto && esperada != primera.nreglas * porRegla) {
+		printf("Faltan estados de la regla %d\n", reglas[esperada / porRegla]);
+		correcto = false;
+	}
+
+	liberarEspacioTrabajo(espacio);
+
+	// Cerramos el contenedor (escribe el índice de las salidas guardadas)
+	cerrarContenedor(contenedor);
+
+	printf("Se han fusionado %d de %d reglas de %d partes\n", fusionadas, primera.nreglas, primera.partes);
+	return correcto ? 0 : 1;
+}
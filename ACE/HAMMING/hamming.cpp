@@ -1,6 +1,12 @@
 #include <time.h>
 #include "libguardaimagen.h"
 #include "libACE.h"
+#include "libACEgeneral.h"
+#include "libcontenedor.h"
+#include "libmedidas.h"
+#include "libmotores.h"
+#include "libtrayectoria.h"
+#include "libaditivas.h"
 
 #pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
 
@@ -16,6 +22,7 @@
 
 #define MIN_CELDAS					2		// como mínimo 2 celdas en el ACE
 #define MAX_CELDAS					10000	// como máximo 10000 celdas en el ACE
+#define MAX_CELDAS_SALTO			100000000	// como máximo 10^8 celdas en el ACE con instantes
 
 /*
  * Nombre: HAMMING (Estudio distancia de Hamming de Autómatas Celulares Elementales)
@@ -29,19 +36,55 @@
  * Opción					| Valores (separados por comas)		| Valor por defecto
  * -------------------------------------------------------------------------------------------------------
  * inicializacion			| aleatoria, semilla				| semilla
+ * semilla					| entero >= 0						| (instante actual)
  * reglas					| [0, 255], todas					| REGLA (54)
  * pasos					| [1, 5000]							| PASOS (500)
  * celdas					| [2, 10000]						| CELDAS (1000)
+ * radio					| [1, 3]							| 1
+ * estados					| [2, 4]							| 2
+ * totalista				| si, no							| no
+ * formato					| texto, npy, ambos					| texto
+ * contenedor				| nombre de fichero					| (ficheros independientes)
+ * informe					| nombre de fichero					| (sin informe)
+ * progreso					| segundos							| 0 (sin progreso)
+ * ciclos					| si, no							| si
+ * motor					| referencia, empaquetado, tabla,	| referencia
+ *							| auto								|
+ * calibracion				| nombre de fichero					| motores.cal
+ * trayectoria				| nombre de fichero (.tra)			| (se simula el ACE)
+ * instantes				| enteros >= 0 (1e12, 2^40)			| (todos los pasos)
  *
  * Argumento					| Significado
  * ------------------------------------------------------------------------------------------------------------
  * inicializacion:aleatoria		| La primera fila del ACE contiene una sucesión aleatoria de '0' y '1'
  * inicializacion:semilla		| La primera fila del ACE contiene todo '0' menos un '1' en la posición central
+ * semilla:1234				| La inicialización aleatoria es siempre la misma para la misma semilla (resultados reproducibles)
  * reglas:todas					| Se calculan los ACEs (y se guardan en ficheros) de todas las reglas [0, 255]
  * reglas:4						| Se calcula el ACE (y se guarda en ficheros) de la regla 4
  * reglas:4,90,126				| Se calcula el ACE (y se guarda en ficheros) de laS reglas 4, 90 y 126
  * pasos:300					| Se calculan 300 pasos de la evolución del ACE
  * celdas:700					| El ACE lo conforman 700 posiciones
+ * radio:2						| La vecindad de cada celda es de radio 2 (5 celdas). Con radio mayor que 1, más de 2 estados
+ *								| o reglas totalistas, las reglas se dan por su código de Wolfram (decimal, o hexadecimal con 0x
+ *								| para 2 estados: reglas:0x6a5c33f1) y los ficheros se nombran R<código>_RADIO<radio>_E<estados>
+ * estados:3					| Cada celda tiene 3 estados (0, 1 y 2)
+ * totalista:si					| La cifra i del código de la regla es el nuevo estado cuando la vecindad suma i
+ * formato:npy					| Las series se guardan en formato binario NPY (numpy) en lugar de texto (.dat)
+ * formato:ambos				| Las series se guardan en formato texto (.dat) y en formato binario NPY (.npy)
+ * contenedor:R.acec			| Todas las salidas se guardan en el fichero contenedor R.acec (se extraen con EXTRAER)
+ * informe:R.json				| Al terminar se guarda en R.json el informe de rendimiento (tiempo de cada fase, contadores, memoria)
+ * progreso:60					| Cada 60 segundos se muestra el porcentaje realizado y el tiempo estimado que falta
+ * ciclos:no					| Se simulan todos los pasos aunque la evolución entre en un ciclo (sin copiar el ciclo detectado)
+ * motor:empaquetado			| La evolución se calcula con el motor empaquetado (ver libmotores), tras comprobar que da lo mismo
+ *								| que generarACE; si no, se usa generarACE (referencia)
+ * motor:auto					| Para cada regla y tamaño se usa el motor más rápido de los que dan lo mismo que generarACE
+ *								| (se miden con una simulación corta y la elección se guarda en el fichero de calibración)
+ * calibracion:maquina.cal		| Con motor:auto, las elecciones de cada máquina se leen y guardan en maquina.cal
+ * trayectoria:A.tra			| El ACE base no se simula, se lee del fichero de trayectoria A.tra (guardado con ACE trayectoria:si)
+ *								| La regla, las celdas y los pasos son los de la trayectoria
+ * instantes:1000,1e6,1e12		| Con reglas aditivas (0, 60, 90, 102, 150, 170, 204 y 240) sólo se calculan las distancias en esos
+ *								| instantes, saltando en el tiempo (ver libaditivas), y se guardan como parejas (instante, distancia)
+ *								| en HAMMING_SALTO_R..._C....dat. Se admiten hasta 10^8 celdas. El resto de reglas no se calcula
  * 
  * Ejemplos:
  *
@@ -49,6 +92,7 @@
  * HAMMING inicializacion:aleatoria
  * HAMMING reglas:todas celdas:500
  * HAMMING reglas:4 pasos:200 celdas:200
+ * HAMMING reglas:90,150 celdas:1000000 instantes:2^20,2^30,2^40,1e12
  *
  */
 int main(int argc, char** argv)
@@ -63,12 +107,32 @@ int main(int argc, char** argv)
 	char nombreFichero[256];						// Guardamos los nombres de los ficheros a crear
 	int* distanciasHamming;							// Vector en el que guardamos las distancias de hamming para cada paso
 	double eh;										// Guardamos el exponente de hamming calculado por el programa
+	int formato = FORMATO_TEXTO;					// Formato de los ficheros de series (por defecto texto compatible con gnuplot)
+	char nombreContenedor[256];						// Fichero contenedor en el que guardar todas las salidas (vacío: ficheros independientes)
+	Contenedor* contenedor = NULL;					// Contenedor abierto (si se usa)
+	char nombreInforme[256];						// Fichero en el que guardar el informe de rendimiento (vacío: sin informe)
+	double intervaloProgreso = 0.0;					// Segundos entre líneas de progreso (0: sin progreso)
+	bool ciclos = true;								// Detección de ciclos en las simulaciones (por defecto activada)
+	int motor = MOTOR_REFERENCIA;					// Motor de evolución (ver libmotores, por defecto generarACE)
+	char ficheroCalibracion[256];					// Fichero de calibración de motor:auto
+	int radio = 1;									// Radio de la vecindad (por defecto 1, ACE elemental)
+	int estadosCelda = 2;							// Estados de cada celda (por defecto 2)
+	bool totalista = false;							// Reglas totalistas
+	const char* textoReglas = NULL;					// Texto del parámetro 'reglas:' (se interpreta al final si las reglas son generales)
+	ReglaGeneral* reglasGenerales = NULL;			// Reglas generales (NULL: reglas elementales en 'reglas')
+	char nombreRegla[96];							// Identificación de la regla general en ficheros y mensajes
+	unsigned long long semilla = (unsigned long long)time(NULL);	// Semilla de los números aleatorios (por defecto el instante actual)
+	const char* nombreTrayectoria = NULL;			// Fichero de trayectoria del que leer el ACE base (NULL: se simula)
+	Trayectoria* trayectoria = NULL;				// Trayectoria abierta (si se usa)
+	unsigned long long instantes[ADITIVAS_MAX_INSTANTES];	// Instantes en los que calcular las distancias con reglas aditivas
+	int ninstantes = 0;								// Número de instantes (0: se calculan todos los pasos)
 
 	// Inicializamos el texto de la inicialización del ACE como "semilla" (se usará para el nombre del fichero PGM en el que se guardan los resultados)
 	strcpy(strInicializacion, "semilla");
+	nombreContenedor[0] = 0;
+	nombreInforme[0] = 0;
+	strcpy(ficheroCalibracion, MOTOR_FICHERO_CALIBRACION);
 
-	// Inicializamos la semilla de los números aleatorios
-	srand((unsigned int)time(NULL));
 
 	// Por defecto aplicaremos la regla REGLA si como argumento no indicamos otra cosa
 	reglas[0] = REGLA;
@@ -87,19 +151,45 @@ int main(int argc, char** argv)
 				inicializacion = INICIALIZACION_SEMILLA;
 			}
 		}
+		else if (strstr(argv[a], "semilla:") == argv[a]) {
+			// Si encontramos un argumento 'semilla:' la inicialización aleatoria será reproducible
+			semilla = strtoull(argv[a] + strlen("semilla:"), NULL, 10);
+		}
 		else if (strstr(argv[a], "reglas:") == argv[a]) {
 			// Si encontramos un argumento 'regla:' analizamos que valor tiene.
 			if (strstr(argv[a], ":todas") != NULL)
 				nreglas = obtenerValores(reglas, MAX_REGLAS, "0-255");
 			else
 				nreglas = obtenerValores(reglas, MAX_REGLAS, argv[a] + strlen("reglas:"));
+			textoReglas = argv[a] + strlen("reglas:");
+		}
+		else if (strstr(argv[a], "radio:") == argv[a]) {
+			// Si encontramos un argumento 'radio:' analizamos que valor tiene.
+			radio = atoi(argv[a] + strlen("radio:"));
+			if (radio < RADIO_MIN || radio > RADIO_MAX) {
+				radio = 1;
+				printf("Parámetro incorrecto, se esperaba un radio entre %d y %d... Se asume radio %d\n", RADIO_MIN, RADIO_MAX, radio);
+			}
+		}
+		else if (strstr(argv[a], "estados:") == argv[a]) {
+			// Si encontramos un argumento 'estados:' analizamos que valor tiene.
+			estadosCelda = atoi(argv[a] + strlen("estados:"));
+			if (estadosCelda < ESTADOS_MIN || estadosCelda > ESTADOS_MAX) {
+				estadosCelda = 2;
+				printf("Parámetro incorrecto, se esperaba un número de estados entre %d y %d... Se asumen %d estados\n", ESTADOS_MIN, ESTADOS_MAX, estadosCelda);
+			}
+		}
+		else if (strstr(argv[a], "totalista:") == argv[a]) {
+			// Si encontramos un argumento 'totalista:' analizamos que valor tiene.
+			totalista = (strstr(argv[a], ":si") != NULL);
 		}
 		else if (strstr(argv[a], "celdas:") == argv[a]) {
 			// Si encontramos un argumento 'celdas:' analizamos que valor tiene.
+			// (el máximo sin instantes se comprueba al final, cuando se sabe si se piden)
 			celdas = atoi(argv[a] + strlen("celdas:"));
-			if (celdas < MIN_CELDAS || celdas > MAX_CELDAS || errno != 0) {
+			if (celdas < MIN_CELDAS || celdas > MAX_CELDAS_SALTO || errno != 0) {
 				celdas = CELDAS;
-				printf("Parámetro incorrecto, se esperaba un número de celdas entre %d y %d... Se asumen %d celdas\n", MIN_CELDAS, MAX_CELDAS, celdas);
+				printf("Parámetro incorrecto, se esperaba un número de celdas entre %d y %d... Se asumen %d celdas\n", MIN_CELDAS, MAX_CELDAS_SALTO, celdas);
 			}
 		}
 		else if (strstr(argv[a], "pasos:") == argv[a]) {
@@ -110,28 +200,224 @@ int main(int argc, char** argv)
 				printf("Parámetro incorrecto, se esperaba un número de pasos entre %d y %d... Se asumen %d pasos\n", MIN_PASOS, MAX_PASOS, pasos);
 			}
 		}
+		else if (strstr(argv[a], "contenedor:") == argv[a]) {
+			// Si encontramos un argumento 'contenedor:' todas las salidas se guardarán en dicho fichero
+			strncpy(nombreContenedor, argv[a] + strlen("contenedor:"), sizeof(nombreContenedor) - 1);
+			nombreContenedor[sizeof(nombreContenedor) - 1] = 0;
+		}
+		else if (strstr(argv[a], "informe:") == argv[a]) {
+			// Si encontramos un argumento 'informe:' al terminar se guardará en dicho fichero el informe de rendimiento
+			strncpy(nombreInforme, argv[a] + strlen("informe:"), sizeof(nombreInforme) - 1);
+			nombreInforme[sizeof(nombreInforme) - 1] = 0;
+		}
+		else if (strstr(argv[a], "progreso:") == argv[a]) {
+			// Si encontramos un argumento 'progreso:' analizamos que valor tiene.
+			intervaloProgreso = atof(argv[a] + strlen("progreso:"));
+		}
+		else if (strstr(argv[a], "motor:") == argv[a]) {
+			// Si encontramos un argumento 'motor:' analizamos que valor tiene.
+			motor = obtenerMotor(argv[a] + strlen("motor:"));
+			if (motor < MOTOR_AUTOMATICO) {
+				motor = MOTOR_REFERENCIA;
+				printf("Parámetro incorrecto, se esperaba un motor (referencia, empaquetado, tabla o auto)... Se usa generarACE (referencia)\n");
+			}
+		}
+		else if (strstr(argv[a], "calibracion:") == argv[a]) {
+			// Si encontramos un argumento 'calibracion:' las elecciones de motor:auto se leen y guardan en dicho fichero
+			strncpy(ficheroCalibracion, argv[a] + strlen("calibracion:"), sizeof(ficheroCalibracion) - 1);
+			ficheroCalibracion[sizeof(ficheroCalibracion) - 1] = 0;
+		}
+		else if (strstr(argv[a], "ciclos:") == argv[a]) {
+			// Si encontramos un argumento 'ciclos:' analizamos que valor tiene.
+			ciclos = (strstr(argv[a], ":no") == NULL);
+		}
+		else if (strstr(argv[a], "trayectoria:") == argv[a]) {
+			// Si encontramos un argumento 'trayectoria:' el ACE base se leerá de dicho fichero
+			nombreTrayectoria = argv[a] + strlen("trayectoria:");
+		}
+		else if (strstr(argv[a], "instantes:") == argv[a]) {
+			// Si encontramos un argumento 'instantes:' sólo se calculan las distancias en esos instantes (reglas aditivas)
+			ninstantes = obtenerInstantes(instantes, ADITIVAS_MAX_INSTANTES, argv[a] + strlen("instantes:"));
+			if (ninstantes == 0)
+				printf("Parámetro incorrecto, se esperaba una lista de instantes (enteros, 1e12, 2^40)... Se calculan todos los pasos\n");
+		}
+		else if (strstr(argv[a], "formato:") == argv[a]) {
+			// Si encontramos un argumento 'formato:' analizamos que valor tiene.
+			if (strstr(argv[a], ":texto") != NULL)
+				formato = FORMATO_TEXTO;
+			else if (strstr(argv[a], ":npy") != NULL)
+				formato = FORMATO_NPY;
+			else if (strstr(argv[a], ":ambos") != NULL)
+				formato = FORMATO_AMBOS;
+		}
 	}
 
-	// Asignamos la memoria necesaria dinámicamente
-	asignarMemoriaACE(&ACE, pasos, celdas);
+	// El salto en el tiempo sólo existe para las reglas elementales aditivas y no necesita el ACE base
+	if (ninstantes > 0 && (radio != 1 || estadosCelda != 2 || totalista)) {
+		printf("Los instantes sólo se calculan para reglas elementales aditivas... Se calculan todos los pasos\n");
+		ninstantes = 0;
+	}
+	if (ninstantes > 0 && nombreTrayectoria != NULL) {
+		printf("Con instantes no se usa la trayectoria\n");
+		nombreTrayectoria = NULL;
+	}
 
-	// Definimos la condición inicial de nuestro ACE 
-	inicializarACE(ACE, celdas, inicializacion);
+	// Sin instantes la evolución completa se guarda en memoria
+	if (ninstantes == 0 && celdas > MAX_CELDAS) {
+		celdas = CELDAS;
+		printf("Parámetro incorrecto, se esperaba un número de celdas entre %d y %d... Se asumen %d celdas\n", MIN_CELDAS, MAX_CELDAS, celdas);
+	}
+
+	// Con radio mayor que 1, más de 2 estados o reglas totalistas se usa el motor general (libACEgeneral)
+	if (radio != 1 || estadosCelda != 2 || totalista) {
+		char reglaDefecto[16];
+		sprintf(reglaDefecto, "%d", REGLA);
+		reglasGenerales = new ReglaGeneral [MAX_REGLAS];
+		nreglas = obtenerReglasGenerales(reglasGenerales, MAX_REGLAS, textoReglas != NULL ? textoReglas : reglaDefecto, radio, estadosCelda, totalista);
+		if (nreglas == 0) {
+			printf("No hay ninguna regla válida para radio %d y %d estados\n", radio, estadosCelda);
+			delete[] reglasGenerales;
+			return 1;
+		}
+	}
+
+	// Inicializamos el generador de números aleatorios (se muestra la semilla para poder repetir la ejecución)
+	establecerSemilla(semilla);
+	if (inicializacion == INICIALIZACION_ALEATORIA)
+		printf("Semilla de los números aleatorios: %llu\n", semilla);
+
+	// Medidas de rendimiento (progreso e informe)
+	iniciarMedidas("HAMMING", argc, argv, intervaloProgreso);
+
+	// Detección de ciclos en las simulaciones
+	usarDeteccionCiclos(ciclos);
+
+	// Motor de evolución de las reglas elementales (ver libmotores)
+	usarMotor(motor, ficheroCalibracion);
+
+	// Si se ha indicado un contenedor, todas las salidas se guardan en él
+	if (nombreContenedor[0] != 0) {
+		contenedor = crearContenedor(nombreContenedor);
+		if (contenedor == NULL)
+			printf("No se pudo crear el contenedor %s... Se guardan ficheros independientes\n", nombreContenedor);
+		usarContenedor(contenedor);
+	}
+
+	// Si se ha indicado una trayectoria, la regla, las celdas y los pasos son los suyos
+	if (nombreTrayectoria != NULL && reglasGenerales != NULL) {
+		printf("Las trayectorias sólo contienen reglas de radio 1 y 2 estados\n");
+		delete[] reglasGenerales;
+		cerrarContenedor(contenedor);
+		return 1;
+	}
+	if (nombreTrayectoria != NULL) {
+		trayectoria = abrirTrayectoria(nombreTrayectoria);
+		if (trayectoria == NULL) {
+			printf("No se pudo abrir la trayectoria %s\n", nombreTrayectoria);
+			cerrarContenedor(contenedor);
+			return 1;
+		}
+		reglas[0] = trayectoria->cabecera.regla;
+		nreglas = 1;
+		celdas = trayectoria->cabecera.celdas;
+		pasos = trayectoria->cabecera.pasos;
+	}
+
+	if (trayectoria != NULL) {
+		// Cargamos la evolución del ACE base desde la trayectoria (asigna la memoria necesaria)
+		if (!cargarACETrayectoria(trayectoria, &ACE)) {
+			printf("No se pudo leer la trayectoria %s\n", nombreTrayectoria);
+			cerrarTrayectoria(trayectoria);
+			cerrarContenedor(contenedor);
+			return 1;
+		}
+	}
+	else if (ninstantes > 0) {
+		// Con instantes no se simula ningún ACE (la distancia sólo depende de la diferencia inicial)
+		asignarMemoriaACE(&ACE, 0, celdas);
+		pasos = 0;
+	}
+	else {
+		// Asignamos la memoria necesaria dinámicamente
+		asignarMemoriaACE(&ACE, pasos, celdas);
+
+		// Definimos la condición inicial de nuestro ACE (con más de 2 estados, la aleatoria usa todos los estados)
+		inicializarACE(ACE, celdas, inicializacion);
+		if (reglasGenerales != NULL && inicializacion == INICIALIZACION_ALEATORIA && estadosCelda > 2)
+			aleatorizarFilaGeneral(ACE[0], celdas, estadosCelda, generadorHilo());
+	}
 
 	// Para cada regla generamos el ACE y la información sobre la distancia de Hamming entre este y otro
 	// que únicamente se diferencia del mismo en el valor central de la primera fila (paso 0)
 	for (int nr = 0; nr < nreglas; nr++) {
 
-		// Generamos la evolución de nuestro ACE base
-		generarACE(ACE, reglas[nr], pasos, celdas);
+		// Con instantes, las distancias se calculan saltando en el tiempo (sólo reglas aditivas, tras comprobar el salto)
+		if (ninstantes > 0) {
+			if (!reglaAditiva(reglas[nr]))
+				printf("La regla %d no es aditiva, no se puede saltar en el tiempo... No se calcula\n", reglas[nr]);
+			else if (verificarSalto(reglas[nr])) {
+				distanciasHamming = generarHammingAditiva(reglas[nr], celdas, instantes, ninstantes);
+				double* x = new double [ninstantes];
+				double* y = new double [ninstantes];
+				for (int i = 0; i < ninstantes; i++) {
+					x[i] = (double)instantes[i];
+					y[i] = distanciasHamming[i];
+				}
+
+				sprintf(nombreFichero, "HAMMING_SALTO_R%03d_C%05d.dat", reglas[nr], celdas);
+				if (formato & FORMATO_TEXTO)
+					guardaParesPLOT(nombreFichero, x, y, ninstantes, 0, 0);
+				if (formato & FORMATO_NPY)
+					guardaParesNPY(cambiarExtension(nombreFichero, "npy"), x, y, ninstantes);
+
+				delete[] x;
+				delete[] y;
+				delete[] distanciasHamming;
+			}
+			MEDIR_PROGRESO(nr + 1, nreglas);
+			continue;
+		}
+
+		// Con reglas generales se usa el motor general y los mismos análisis
+		if (reglasGenerales != NULL) {
+			nombreReglaGeneral(reglasGenerales[nr], nombreRegla);
+			delete[] generarACEGeneral(ACE, reglasGenerales[nr], pasos, celdas);
+			distanciasHamming = generarHammingGeneral(ACE, reglasGenerales[nr], pasos, celdas);
+
+			sprintf(nombreFichero, "HAMMING_%s_C%05d_P%05d.dat", nombreRegla, celdas, pasos);
+			if (formato & FORMATO_TEXTO)
+				guardaPLOT(nombreFichero, distanciasHamming, pasos + 1);
+			if (formato & FORMATO_NPY)
+				guardaNPY(cambiarExtension(nombreFichero, "npy"), distanciasHamming, pasos + 1);
+
+			if (exponenteHamming(distanciasHamming, pasos + 1, eh))
+				printf("El exponente de hamming (%s,C%05d,P%05d) es %.5f\n", nombreRegla, celdas, pasos, eh);
+			else
+				printf("No se pudo calcular el exponente de hamming (%s,C%05d,P%05d)\n", nombreRegla, celdas, pasos);
+
+			delete[] distanciasHamming;
+			MEDIR_PROGRESO(nr + 1, nreglas);
+			continue;
+		}
+
+		// Generamos la evolución de nuestro ACE base (si no la hemos leído de una trayectoria)
+		CicloACE ciclo;
+		CicloACE* pciclo = NULL;
+		if (trayectoria == NULL) {
+			delete[] generarACEMotor(ACE, reglas[nr], pasos, celdas, NULL, &ciclo);
+			pciclo = &ciclo;
+		}
 
 		// Generamos la información sobre la evolución de las distancias de Hamming
 		// entre el ACE proporcionado y un ACE que difiere únicamente en el valor central del paso 0
-		distanciasHamming = generarHamming(ACE, reglas[nr], pasos, celdas);
+		distanciasHamming = generarHamming(ACE, reglas[nr], pasos, celdas, NULL, pciclo);
 
 		// Guardamos la información en un fichero
 		sprintf(nombreFichero, "HAMMING_R%03d_C%05d_P%05d.dat", reglas[nr], celdas, pasos);
-		guardaPLOT(nombreFichero, distanciasHamming, pasos + 1);
+		if (formato & FORMATO_TEXTO)
+			guardaPLOT(nombreFichero, distanciasHamming, pasos + 1);
+		if (formato & FORMATO_NPY)
+			guardaNPY(cambiarExtension(nombreFichero, "npy"), distanciasHamming, pasos + 1);
 
 		// Calculamos el exponente de Hamming mediante la regresión de los puntos de las distancias
 		// y mostramos el resultado ppor consola
@@ -142,8 +428,19 @@ int main(int argc, char** argv)
 
 		// Liberamos la memoria
 		delete[] distanciasHamming;
+
+		MEDIR_PROGRESO(nr + 1, nreglas);
 	}
 
 	// Liberamos la memoria
 	liberarMemoriaACE(ACE, pasos);
+	delete[] reglasGenerales;
+	cerrarTrayectoria(trayectoria);
+
+	// Cerramos el contenedor (escribe el índice de las salidas guardadas)
+	cerrarContenedor(contenedor);
+
+	// Guardamos el informe de rendimiento
+	if (nombreInforme[0] != 0 && !guardarInformeMedidas(nombreInforme))
+		printf("No se pudo crear el informe %s\n", nombreInforme);
 }
@@ -0,0 +1,238 @@
+#include <time.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include "libguardaimagen.h"
+#include "libACE.h"
+#include "libmedidas.h"
+#include "libmotores.h"
+#include "libtrabajos.h"
+#include "libsucesores.h"
+#include "libtablas.h"
+#include "libobservadores.h"
+
+#pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
+
+#define MAX_LINEA					4096	// Longitud máxima de una línea del fichero de trabajos
+#define MAX_AVISOS					4096	// Longitud máxima de los avisos de una línea del fichero de trabajos
+#define MAX_HILOS					256		// Número máximo de hilos
+
+/*
+	Orden de ejecución: primero los grupos más costosos (para que los hilos terminen a la vez) y, dentro de cada grupo
+	de la misma herramienta y dimensiones, por regla (así cada hilo reutiliza la memoria de trabajo del anterior).
+*/
+static bool antesTrabajo(const Trabajo& a, const Trabajo& b)
+{
+	if (a.coste != b.coste)
+		return a.coste > b.coste;
+	if (a.tipo != b.tipo)
+		return a.tipo < b.tipo;
+	if (a.celdas != b.celdas)
+		return a.celdas < b.celdas;
+	if (a.pasos != b.pasos)
+		return a.pasos < b.pasos;
+	return a.regla < b.regla;
+}
+
+/*
+	Lee el fichero de trabajos y añade a 'trabajos' un trabajo por cada combinación de regla, celdas y pasos de cada línea.
+	'semilla' es la semilla de las líneas que no indican la suya.
+	Devuelve false si no se pudo abrir el fichero.
+*/
+static bool leerTrabajos(const char* nombre, unsigned long long semilla, std::vector<Trabajo>& trabajos)
+{
+	FILE* fichero = fopen(nombre, "r");
+	if (fichero == NULL)
+		return false;
+
+	char linea[MAX_LINEA];
+	char avisos[MAX_AVISOS];
+	int numeroLinea = 0;
+	while (fgets(linea, sizeof(linea), fichero) != NULL) {
+		numeroLinea++;
+
+		// Los avisos de la línea se muestran con su número de línea
+		avisos[0] = 0;
+		interpretarLineaTrabajos(linea, semilla, trabajos, avisos, sizeof(avisos));
+		for (char* aviso = avisos; *aviso != 0; ) {
+			char* fin = strchr(aviso, '\n');
+			*fin = 0;
+			printf("Línea %d: %s\n", numeroLinea, aviso);
+			aviso = fin + 1;
+		}
+	}
+
+	fclose(fichero);
+	return true;
+}
+
+/*
+	Cada hilo va tomando el siguiente trabajo de la lista hasta que no quedan, con su propia memoria de trabajo.
+*/
+static void ejecutarTrabajos(const std::vector<Trabajo>* trabajos, std::atomic<size_t>* siguiente)
+{
+	EspacioTrabajo espacio;
+	iniciarEspacioTrabajo(espacio);
+
+	for (size_t t = (*siguiente)++; t < trabajos->size(); t = (*siguiente)++)
+		ejecutarTrabajo(espacio, (*trabajos)[t]);
+
+	liberarEspacioTrabajo(espacio);
+}
+
+/*
+ * Nombre: LOTES (Ejecución por lotes de ACE, HAMMING, ATRACTOR, ENTROPIA y ANALIZAR)
+ * Autor: Ismael Flores Campoy
+ * Descripción: Ejecuta en un único proceso todos los trabajos indicados en un fichero de trabajos, repartiéndolos
+ *              entre varios hilos. Cada hilo reutiliza su memoria de trabajo de un trabajo al siguiente y los trabajos
+ *              de la misma herramienta y dimensiones se ejecutan seguidos, de manera que en barridos de muchas
+ *              configuraciones pequeñas el tiempo no se va en crear procesos ni en asignar memoria.
+ *              Los ficheros generados son los mismos que generaría cada herramienta.
+ * Sintaxis: LOTES trabajos:<fichero> <opcion1>:<valor1> <opcion2>:<valor2> ...
+ *
+ * Opción					| Valores							| Valor por defecto
+ * -------------------------------------------------------------------------------------------------------
+ * trabajos					| nombre de fichero					| (obligatorio)
+ * hilos					| [1, 256]							| (núcleos del procesador)
+ * semilla					| entero >= 0						| (instante actual)
+ * informe					| nombre de fichero					| (sin informe)
+ * progreso					| segundos							| 0 (sin progreso)
+ * ciclos					| si, no							| si
+ * motor					| referencia, empaquetado, tabla,	| referencia
+ *							| auto								|
+ * calibracion				| nombre de fichero					| motores.cal
+ * sucesores				| si, no							| si
+ * cachesucesores			| directorio						| (sin caché)
+ * paginasgrandes			| si, no							| si
+ *
+ * Cada línea del fichero de trabajos tiene el nombre de la herramienta seguido de sus opciones, con la misma sintaxis
+ * que en la línea de comandos (reglas, celdas y pasos admiten listas y rangos). Se genera un trabajo por cada combinación.
+ * Lo que sigue a '#' es un comentario.
+ *
+ * Herramienta		| Opciones
+ * ------------------------------------------------------------------------------------------------------------
+ * ACE				| reglas, celdas, pasos, inicializacion (semilla, aleatoria), semilla, trayectoria (si, no)
+ * HAMMING			| reglas, celdas, pasos, inicializacion, semilla, formato (texto, npy, ambos)
+ * ATRACTOR			| reglas, celdas (hasta 30), pasos, formato
+ * ENTROPIA			| reglas, pasos, formato
+ * ANALIZAR			| reglas, celdas, pasos, inicializacion, semilla, formato, metricas (imagen, hamming, densidad, estados, regresion, espectro, todos)
+ *
+ * Ejemplo de fichero de trabajos:
+ *
+ * # Barrido de atractores pequeños
+ * ATRACTOR reglas:todas celdas:4-12 pasos:20
+ * HAMMING reglas:30,90,110 celdas:1000 pasos:500,1000 formato:npy
+ * ACE reglas:todas inicializacion:aleatoria
+ *
+ * Ejemplos:
+ *
+ * LOTES trabajos:barrido.txt
+ * LOTES trabajos:barrido.txt hilos:8 progreso:60 informe:barrido.json
+ * LOTES trabajos:barrido.txt semilla:1234
+ *
+ */
+int main(int argc, char** argv)
+{
+	const char* nombreTrabajos = NULL;				// Fichero de trabajos
+	int hilos = (int)std::thread::hardware_concurrency();	// Número de hilos
+	char nombreInforme[256];						// Fichero en el que guardar el informe de rendimiento (vacío: sin informe)
+	double intervaloProgreso = 0.0;					// Segundos entre líneas de progreso (0: sin progreso)
+	bool ciclos = true;								// Detección de ciclos en las simulaciones (por defecto activada)
+	int motor = MOTOR_REFERENCIA;					// Motor de evolución (ver libmotores, por defecto generarACE)
+	char ficheroCalibracion[256];					// Fichero de calibración de motor:auto
+	bool sucesores = true;							// Uso de las tablas de sucesores en ATRACTOR y ENTROPIA (por defecto activado)
+	char directorioSucesores[256];					// Directorio de la caché de tablas de sucesores (vacío: sin caché)
+	bool paginasGrandes = true;						// Páginas grandes para las tablas grandes (ver libtablas, por defecto activadas)
+	unsigned long long semilla = (unsigned long long)time(NULL);	// Semilla de las líneas que no indican la suya
+	std::vector<Trabajo> trabajos;					// Trabajos a ejecutar
+
+	nombreInforme[0] = 0;
+	directorioSucesores[0] = 0;
+	strcpy(ficheroCalibracion, MOTOR_FICHERO_CALIBRACION);
+
+	// Procesado de los parámetros de entrada (si existen)
+	for (int a = 1; a < argc; a++) {
+		if (strstr(argv[a], "trabajos:") == argv[a])
+			nombreTrabajos = argv[a] + strlen("trabajos:");
+		else if (strstr(argv[a], "hilos:") == argv[a]) {
+			hilos = atoi(argv[a] + strlen("hilos:"));
+			if (hilos < 1 || hilos > MAX_HILOS) {
+				hilos = (int)std::thread::hardware_concurrency();
+				printf("Parámetro incorrecto, se esperaba un número de hilos entre 1 y %d... Se asumen %d hilos\n", MAX_HILOS, hilos);
+			}
+		}
+		else if (strstr(argv[a], "semilla:") == argv[a])
+			semilla = strtoull(argv[a] + strlen("semilla:"), NULL, 10);
+		else if (strstr(argv[a], "informe:") == argv[a]) {
+			strncpy(nombreInforme, argv[a] + strlen("informe:"), sizeof(nombreInforme) - 1);
+			nombreInforme[sizeof(nombreInforme) - 1] = 0;
+		}
+		else if (strstr(argv[a], "progreso:") == argv[a])
+			intervaloProgreso = atof(argv[a] + strlen("progreso:"));
+		else if (strstr(argv[a], "ciclos:") == argv[a])
+			ciclos = (strstr(argv[a], ":no") == NULL);
+		else if (strstr(argv[a], "motor:") == argv[a]) {
+			motor = obtenerMotor(argv[a] + strlen("motor:"));
+			if (motor < MOTOR_AUTOMATICO) {
+				motor = MOTOR_REFERENCIA;
+				printf("Parámetro incorrecto, se esperaba un motor (referencia, empaquetado, tabla o auto)... Se usa generarACE (referencia)\n");
+			}
+		}
+		else if (strstr(argv[a], "calibracion:") == argv[a]) {
+			strncpy(ficheroCalibracion, argv[a] + strlen("calibracion:"), sizeof(ficheroCalibracion) - 1);
+			ficheroCalibracion[sizeof(ficheroCalibracion) - 1] = 0;
+		}
+		else if (strstr(argv[a], "sucesores:") == argv[a])
+			sucesores = (strstr(argv[a], ":no") == NULL);
+		else if (strstr(argv[a], "paginasgrandes:") == argv[a])
+			paginasGrandes = (strstr(argv[a], ":no") == NULL);
+		else if (strstr(argv[a], "cachesucesores:") == argv[a]) {
+			strncpy(directorioSucesores, argv[a] + strlen("cachesucesores:"), sizeof(directorioSucesores) - 1);
+			directorioSucesores[sizeof(directorioSucesores) - 1] = 0;
+		}
+	}
+	if (hilos < 1)
+		hilos = 1;
+
+	if (nombreTrabajos == NULL) {
+		printf("Falta el parámetro trabajos:<fichero>\n");
+		return 1;
+	}
+
+	iniciarMedidas("LOTES", argc, argv, intervaloProgreso);
+	usarDeteccionCiclos(ciclos);
+	usarMotor(motor, ficheroCalibracion);
+	usarTablasSucesores(sucesores);
+	usarCacheSucesores(directorioSucesores);
+	usarTablasGrandes(paginasGrandes, hilos);
+
+	if (!leerTrabajos(nombreTrabajos, semilla, trabajos)) {
+		printf("No se pudo abrir el fichero de trabajos %s\n", nombreTrabajos);
+		return 1;
+	}
+
+	// Ordenamos los trabajos y calculamos el coste total para el progreso
+	std::sort(trabajos.begin(), trabajos.end(), antesTrabajo);
+	long long total = 0;
+	for (size_t t = 0; t < trabajos.size(); t++)
+		total += trabajos[t].coste;
+	iniciarProgresoTrabajos(total);
+
+	if ((size_t)hilos > trabajos.size())
+		hilos = trabajos.size() > 0 ? (int)trabajos.size() : 1;
+	printf("Se ejecutan %d trabajos con %d hilos (semilla de los números aleatorios: %llu)\n", (int)trabajos.size(), hilos, semilla);
+
+	// Repartimos los trabajos entre los hilos (el hilo principal también trabaja)
+	std::atomic<size_t> siguiente(0);
+	std::vector<std::thread> grupo;
+	for (int h = 1; h < hilos; h++)
+		grupo.push_back(std::thread(ejecutarTrabajos, &trabajos, &siguiente));
+	ejecutarTrabajos(&trabajos, &siguiente);
+	for (size_t h = 0; h < grupo.size(); h++)
+		grupo[h].join();
+
+	// Guardamos el informe de rendimiento
+	if (nombreInforme[0] != 0 && !guardarInformeMedidas(nombreInforme))
+		printf("No se pudo crear el informe %s\n", nombreInforme);
+}
@@ -0,0 +1,463 @@
+#include <time.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <new>
+#include "libACE.h"
+#include "libmedidas.h"
+#include "libmotores.h"
+#include "libtrabajos.h"
+#include "libsucesores.h"
+#include "libtablas.h"
+#include "libcontenedor.h"
+#include "libconexion.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#define mkdir(ruta, permisos) _mkdir(ruta)
+#define rmdir _rmdir
+#define realpath(ruta, absoluta) _fullpath(absoluta, ruta, 256)
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+#pragma warning ( disable: 4996 )			// Evita los warnings del compilador de funciones obsoletas
+
+#define MAX_HILOS					256		// Número máximo de hilos
+#define MAX_AVISOS					4096	// Longitud máxima de los avisos de una petición
+#define MAX_DATOS_RESPUESTA			(256u << 20)	// Bytes máximos de los ficheros devueltos dentro de una respuesta
+#define MEMORIA_SUCESORES			1024	// Megas de tablas de sucesores retenidas por defecto
+
+#define RESPUESTA_DATOS				0		// Los ficheros generados se devuelven dentro de la respuesta (y se borran)
+#define RESPUESTA_RUTAS				1		// Se devuelven las rutas de los ficheros generados (que se conservan)
+
+static char rutaSocket[256];						// Socket en el que se escuchan las peticiones
+static char directorioSalidas[256];					// Directorio (absoluto) de las salidas de las peticiones
+static unsigned long long semilla;					// Semilla de las peticiones que no indican la suya
+static int hilos;									// Hilos que atienden las conexiones
+static long long escucha = CONEXION_INVALIDA;		// Socket de escucha
+
+static std::mutex cerrojoConexiones;				// Protege 'pendientes' y 'terminando'
+static std::condition_variable hayConexiones;		// Avisa a los hilos de una nueva conexión o del final
+static std::deque<long long> pendientes;			// Conexiones aceptadas a la espera de un hilo
+static bool terminando = false;						// Cierto tras la petición TERMINAR
+
+static std::atomic<long long> conexiones(0);		// Conexiones aceptadas
+static std::atomic<long long> peticiones(0);		// Peticiones atendidas
+static std::atomic<long long> directorios(0);		// Número del siguiente directorio de petición a probar
+static std::atomic<long long> trabajosHechos(0);	// Trabajos ejecutados
+static std::chrono::steady_clock::time_point arranque;
+
+/*
+	Añade texto con formato al final de la respuesta.
+*/
+static void anadirTexto(std::vector<char>& respuesta, const char* formato, ...)
+{
+	char texto[MAX_AVISOS + 512];
+	va_list argumentos;
+
+	va_start(argumentos, formato);
+	int n = vsnprintf(texto, sizeof(texto), formato, argumentos);
+	va_end(argumentos);
+	if (n > (int)sizeof(texto) - 1)
+		n = (int)sizeof(texto) - 1;
+	if (n > 0)
+		respuesta.insert(respuesta.end(), texto, texto + n);
+}
+
+/*
+	Quita de la línea la opción respuesta:datos|rutas (que no es de la herramienta) y devuelve el modo pedido.
+*/
+static int extraerModoRespuesta(char* linea)
+{
+	int modo = RESPUESTA_DATOS;
+
+	for (char* p = strstr(linea, "respuesta:"); p != NULL; p = strstr(p + 1, "respuesta:")) {
+		if (p != linea && p[-1] != ' ' && p[-1] != '\t')
+			continue;
+		if (strstr(p, "respuesta:rutas") == p)
+			modo = RESPUESTA_RUTAS;
+		while (*p != 0 && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+			*p++ = ' ';
+		p--;
+	}
+	return modo;
+}
+
+/*
+	Añade a la respuesta el contenido del fichero 'ruta' de 'bytes' bytes.
+*/
+static bool anadirFichero(std::vector<char>& respuesta, const char* ruta, long long bytes)
+{
+	FILE* fichero = fopen(ruta, "rb");
+	if (fichero == NULL)
+		return false;
+	size_t inicio = respuesta.size();
+	respuesta.resize(inicio + (size_t)bytes);
+	bool correcto = fread(respuesta.data() + inicio, 1, (size_t)bytes, fichero) == (size_t)bytes;
+	fclose(fichero);
+	return correcto;
+}
+
+static long long bytesFichero(const char* ruta)
+{
+	FILE* fichero = fopen(ruta, "rb");
+	if (fichero == NULL)
+		return -1;
+	fseek64(fichero, 0, SEEK_END);
+	long long bytes = ftell64(fichero);
+	fclose(fichero);
+	return bytes;
+}
+
+/*
+	Ejecuta una petición (una línea de trabajos como las de LOTES) y prepara su respuesta:
+
+	OK <trabajos> <ficheros>
+	AVISO <texto>											(uno por aviso)
+	DATOS <nombre> <bytes>\n<contenido>					(respuesta:datos, uno por fichero)
+	FICHERO <ruta>											(respuesta:rutas, uno por fichero)
+
+	o ERROR <texto>. Las salidas se crean en un directorio propio de la petición (P<número>, el primero libre) del
+	directorio de salidas.
+	Devuelve falso si la petición es TERMINAR.
+*/
+static bool atenderPeticion(EspacioTrabajo& espacio, SalidasHilo& salidas, char* linea, std::vector<char>& respuesta)
+{
+	char avisos[MAX_AVISOS];
+	std::vector<Trabajo> trabajos;
+	long long numero = peticiones++;
+
+	respuesta.clear();
+
+	// Peticiones del propio servidor
+	char orden[16];
+	if (sscanf(linea, "%15s", orden) == 1 && strcmp(orden, "TERMINAR") == 0) {
+		anadirTexto(respuesta, "OK 0 0\n");
+		return false;
+	}
+	if (sscanf(linea, "%15s", orden) == 1 && strcmp(orden, "ESTADO") == 0) {
+		double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - arranque).count();
+		anadirTexto(respuesta, "OK 0 0\n");
+		anadirTexto(respuesta, "ESTADO hilos:%d conexiones:%lld peticiones:%lld trabajos:%lld segundos:%.0f\n",
+			hilos, conexiones.load(), numero, trabajosHechos.load(), segundos);
+		return true;
+	}
+
+	int modo = extraerModoRespuesta(linea);
+	avisos[0] = 0;
+	if (interpretarLineaTrabajos(linea, semilla, trabajos, avisos, sizeof(avisos)) <= 0) {
+		// El motivo es el último aviso
+		size_t usados = strlen(avisos);
+		if (usados > 0 && avisos[usados - 1] == '\n')
+			avisos[--usados] = 0;
+		char* motivo = strrchr(avisos, '\n');
+		motivo = (motivo != NULL) ? motivo + 1 : avisos;
+		anadirTexto(respuesta, "ERROR %s\n", motivo[0] != 0 ? motivo : "petición vacía");
+		return true;
+	}
+
+	// Directorio de la petición. Los de una ejecución anterior en el mismo directorio de salidas (respuesta:rutas)
+	// siguen ahí, así que se salta al siguiente número libre
+	salidas.nsalidas = 0;
+	salidas.omitidas = 0;
+	for (;;) {
+		int longitud = snprintf(salidas.directorio, sizeof(salidas.directorio), "%s/P%06lld", directorioSalidas, directorios++);
+		if (longitud < 0 || longitud >= (int)sizeof(salidas.directorio)) {
+			anadirTexto(respuesta, "ERROR ruta de salidas demasiado larga\n");
+			return true;
+		}
+		if (mkdir(salidas.directorio, 0755) == 0)
+			break;
+		if (errno != EEXIST) {
+			anadirTexto(respuesta, "ERROR no se pudo crear el directorio %s\n", salidas.directorio);
+			return true;
+		}
+	}
+
+	// Los trabajos se ejecutan en este hilo, con su espacio de trabajo y sus salidas. Si no hay memoria para
+	// sus tablas se responde con un error en vez de terminar el servidor (y con él las demás conexiones)
+	usarSalidasHilo(&salidas);
+	try {
+		for (size_t t = 0; t < trabajos.size(); t++)
+			ejecutarTrabajo(espacio, trabajos[t]);
+	}
+	catch (const std::bad_alloc&) {
+		usarSalidasHilo(NULL);
+		anadirTexto(respuesta, "ERROR no hay memoria suficiente para la petición (salidas parciales en %s)\n", salidas.directorio);
+		return true;
+	}
+	usarSalidasHilo(NULL);
+	trabajosHechos += (long long)trabajos.size();
+
+	// Si los ficheros no caben en la respuesta se devuelven sus rutas
+	char ruta[sizeof(salidas.directorio) + CONTENEDOR_MAX_NOMBRE + 1];
+	std::vector<long long> bytes(salidas.nsalidas);
+	long long total = 0;
+	for (int s = 0; s < salidas.nsalidas; s++) {
+		sprintf(ruta, "%s/%s", salidas.directorio, salidas.nombres[s]);
+		bytes[s] = bytesFichero(ruta);
+		total += bytes[s];
+	}
+	size_t usados = strlen(avisos);
+	if (modo == RESPUESTA_DATOS && (total > (long long)MAX_DATOS_RESPUESTA || salidas.omitidas > 0)) {
+		modo = RESPUESTA_RUTAS;
+		usados += snprintf(avisos + usados, sizeof(avisos) - usados, "los ficheros no caben en la respuesta (%lld bytes)... Se devuelven sus rutas\n", total);
+	}
+	if (salidas.omitidas > 0 && usados < sizeof(avisos))
+		snprintf(avisos + usados, sizeof(avisos) - usados, "%d ficheros más en %s\n", salidas.omitidas, salidas.directorio);
+
+	anadirTexto(respuesta, "OK %d %d\n", (int)trabajos.size(), salidas.nsalidas);
+	for (char* aviso = avisos; *aviso != 0; ) {
+		char* fin = strchr(aviso, '\n');
+		if (fin != NULL)
+			*fin = 0;
+		anadirTexto(respuesta, "AVISO %s\n", aviso);
+		aviso = (fin != NULL) ? fin + 1 : aviso + strlen(aviso);
+	}
+	for (int s = 0; s < salidas.nsalidas; s++) {
+		sprintf(ruta, "%s/%s", salidas.directorio, salidas.nombres[s]);
+		if (modo == RESPUESTA_RUTAS)
+			anadirTexto(respuesta, "FICHERO %s\n", ruta);
+		else {
+			anadirTexto(respuesta, "DATOS %s %lld\n", salidas.nombres[s], bytes[s]);
+			if (!anadirFichero(respuesta, ruta, bytes[s])) {
+				respuesta.clear();
+				anadirTexto(respuesta, "ERROR no se pudo leer el fichero %s\n", ruta);
+				return true;
+			}
+			remove(ruta);
+		}
+	}
+	if (modo == RESPUESTA_DATOS)
+		rmdir(salidas.directorio);
+	return true;
+}
+
+/*
+	Cada hilo toma la siguiente conexión pendiente y atiende sus peticiones, una tras otra, hasta que el cliente la cierra.
+	El espacio de trabajo del hilo se conserva de una petición a la siguiente (y las tablas de sucesores, las elecciones
+	de motor y la calibración, entre todos los hilos), de forma que las peticiones repetidas no vuelven a reservar ni a calcular.
+*/
+static void atenderConexiones()
+{
+	EspacioTrabajo espacio;
+	SalidasHilo* salidas = new SalidasHilo;
+	std::vector<char> mensaje, respuesta;
+
+	iniciarEspacioTrabajo(espacio);
+
+	for (;;) {
+		long long conexion;
+		{
+			std::unique_lock<std::mutex> cerrojo(cerrojoConexiones);
+			hayConexiones.wait(cerrojo, [] { return terminando || !pendientes.empty(); });
+			if (pendientes.empty())
+				break;
+			conexion = pendientes.front();
+			pendientes.pop_front();
+		}
+
+		while (recibirMensaje(conexion, mensaje)) {
+			bool seguir = atenderPeticion(espacio, *salidas, mensaje.data(), respuesta);
+			bool enviado = enviarMensaje(conexion, respuesta.data(), respuesta.size());
+			if (!seguir) {
+				// TERMINAR: se deja de aceptar conexiones y los hilos acaban al vaciarse las pendientes
+				std::lock_guard<std::mutex> cerrojo(cerrojoConexiones);
+				if (!terminando) {
+					terminando = true;
+					dejarDeEscuchar(escucha, rutaSocket);
+				}
+				hayConexiones.notify_all();
+			}
+			if (!enviado)
+				break;
+		}
+		cerrarConexion(conexion);
+	}
+
+	liberarEspacioTrabajo(espacio);
+	delete salidas;
+}
+
+/*
+ * Nombre: SERVIDOR (Servidor local de simulaciones y análisis)
+ * Autor: Ismael Flores Campoy
+ * Descripción: Atiende peticiones de trabajos por un socket local (de dominio Unix) con un proceso que se mantiene
+ *              en marcha: cada hilo conserva su memoria de trabajo entre peticiones, las tablas de sucesores se
+ *              retienen en memoria (hasta 'memoriasucesores' megas) y las elecciones y verificaciones de los motores
+ *              se hacen una sola vez, de manera que una petición pequeña no paga el arranque de un proceso ni vuelve
+ *              a calcular las tablas de la petición anterior. Las conexiones se reparten entre los hilos: cada hilo
+ *              atiende las peticiones de una conexión, una tras otra, hasta que el cliente la cierra, y varias
+ *              conexiones se atienden a la vez. Ver CLIENTE para enviar peticiones.
+ * Sintaxis: SERVIDOR <opcion1>:<valor1> <opcion2>:<valor2> ...
+ *
+ * Opción					| Valores							| Valor por defecto
+ * -------------------------------------------------------------------------------------------------------
+ * socket					| ruta del socket					| ace.sock
+ * directorio				| directorio existente				| . (directorio actual)
+ * hilos					| [1, 256]							| (núcleos del procesador)
+ * memoriasucesores			| megas (0: no se retienen)			| 1024
+ * semilla					| entero >= 0						| (instante actual)
+ * informe					| nombre de fichero					| (sin informe)
+ * ciclos					| si, no							| si
+ * motor					| referencia, empaquetado, tabla,	| referencia
+ *							| auto								|
+ * calibracion				| nombre de fichero					| motores.cal
+ * sucesores				| si, no							| si
+ * cachesucesores			| directorio						| (sin caché)
+ * paginasgrandes			| si, no							| si
+ *
+ * Protocolo: cada mensaje (en los dos sentidos) va precedido de su longitud en 4 bytes, el más significativo primero
+ * (ver libconexion). Una petición es una línea de trabajos como las del fichero de trabajos de LOTES (la herramienta
+ * seguida de sus opciones, que se ejecuta en el hilo que atiende la conexión) con la opción adicional
+ * respuesta:datos (por defecto) o respuesta:rutas, o una de las órdenes ESTADO y TERMINAR. La respuesta es:
+ *
+ * OK <trabajos> <ficheros>
+ * AVISO <texto>								(opciones desconocidas... uno por línea)
+ * DATOS <nombre> <bytes>						(respuesta:datos: seguido de los bytes del fichero, uno por fichero)
+ * FICHERO <ruta>								(respuesta:rutas: uno por fichero)
+ *
+ * o ERROR <texto> si la petición no es válida. Las salidas de cada petición se crean en el directorio P<número>
+ * del directorio de salidas (el primero que no exista, también tras reiniciar el servidor); con respuesta:datos se
+ * borran una vez enviadas y con respuesta:rutas se conservan.
+ * Si los ficheros ocupan más de 256 MB se devuelven sus rutas. ESTADO responde con una línea ESTADO con las
+ * conexiones, peticiones y trabajos atendidos; TERMINAR deja de aceptar conexiones y el servidor termina cuando
+ * se cierran las abiertas. Lo que los trabajos muestran por pantalla (el exponente de Hamming...) se muestra
+ * en la consola del servidor.
+ *
+ * Ejemplos:
+ *
+ * SERVIDOR
+ * SERVIDOR socket:/tmp/ace.sock directorio:/tmp/salidas hilos:8 memoriasucesores:4096 cachesucesores:sucesores
+ *
+ */
+int main(int argc, char** argv)
+{
+	char nombreInforme[256];						// Fichero en el que guardar el informe de rendimiento (vacío: sin informe)
+	bool ciclos = true;								// Detección de ciclos en las simulaciones (por defecto activada)
+	int motor = MOTOR_REFERENCIA;					// Motor de evolución (ver libmotores, por defecto generarACE)
+	char ficheroCalibracion[256];					// Fichero de calibración de motor:auto
+	bool sucesores = true;							// Uso de las tablas de sucesores en ATRACTOR y ENTROPIA (por defecto activado)
+	char directorioSucesores[256];					// Directorio de la caché de tablas de sucesores (vacío: sin caché)
+	bool paginasGrandes = true;						// Páginas grandes para las tablas grandes (ver libtablas, por defecto activadas)
+	unsigned long long memoriaSucesores = MEMORIA_SUCESORES;	// Megas de tablas de sucesores retenidas
+	char directorio[256];							// Directorio de las salidas (tal como se indica)
+
+	hilos = (int)std::thread::hardware_concurrency();
+	semilla = (unsigned long long)time(NULL);
+	strcpy(rutaSocket, "ace.sock");
+	strcpy(directorio, ".");
+	nombreInforme[0] = 0;
+	directorioSucesores[0] = 0;
+	strcpy(ficheroCalibracion, MOTOR_FICHERO_CALIBRACION);
+
+	// Procesado de los parámetros de entrada (si existen)
+	for (int a = 1; a < argc; a++) {
+		if (strstr(argv[a], "socket:") == argv[a]) {
+			strncpy(rutaSocket, argv[a] + strlen("socket:"), sizeof(rutaSocket) - 1);
+			rutaSocket[sizeof(rutaSocket) - 1] = 0;
+		}
+		else if (strstr(argv[a], "directorio:") == argv[a]) {
+			strncpy(directorio, argv[a] + strlen("directorio:"), sizeof(directorio) - 1);
+			directorio[sizeof(directorio) - 1] = 0;
+		}
+		else if (strstr(argv[a], "hilos:") == argv[a]) {
+			hilos = atoi(argv[a] + strlen("hilos:"));
+			if (hilos < 1 || hilos > MAX_HILOS) {
+				hilos = (int)std::thread::hardware_concurrency();
+				printf("Parámetro incorrecto, se esperaba un número de hilos entre 1 y %d... Se asumen %d hilos\n", MAX_HILOS, hilos);
+			}
+		}
+		else if (strstr(argv[a], "memoriasucesores:") == argv[a])
+			memoriaSucesores = strtoull(argv[a] + strlen("memoriasucesores:"), NULL, 10);
+		else if (strstr(argv[a], "semilla:") == argv[a])
+			semilla = strtoull(argv[a] + strlen("semilla:"), NULL, 10);
+		else if (strstr(argv[a], "informe:") == argv[a]) {
+			strncpy(nombreInforme, argv[a] + strlen("informe:"), sizeof(nombreInforme) - 1);
+			nombreInforme[sizeof(nombreInforme) - 1] = 0;
+		}
+		else if (strstr(argv[a], "ciclos:") == argv[a])
+			ciclos = (strstr(argv[a], ":no") == NULL);
+		else if (strstr(argv[a], "motor:") == argv[a]) {
+			motor = obtenerMotor(argv[a] + strlen("motor:"));
+			if (motor < MOTOR_AUTOMATICO) {
+				motor = MOTOR_REFERENCIA;
+				printf("Parámetro incorrecto, se esperaba un motor (referencia, empaquetado, tabla o auto)... Se usa generarACE (referencia)\n");
+			}
+		}
+		else if (strstr(argv[a], "calibracion:") == argv[a]) {
+			strncpy(ficheroCalibracion, argv[a] + strlen("calibracion:"), sizeof(ficheroCalibracion) - 1);
+			ficheroCalibracion[sizeof(ficheroCalibracion) - 1] = 0;
+		}
+		else if (strstr(argv[a], "sucesores:") == argv[a])
+			sucesores = (strstr(argv[a], ":no") == NULL);
+		else if (strstr(argv[a], "paginasgrandes:") == argv[a])
+			paginasGrandes = (strstr(argv[a], ":no") == NULL);
+		else if (strstr(argv[a], "cachesucesores:") == argv[a]) {
+			strncpy(directorioSucesores, argv[a] + strlen("cachesucesores:"), sizeof(directorioSucesores) - 1);
+			directorioSucesores[sizeof(directorioSucesores) - 1] = 0;
+		}
+	}
+	if (hilos < 1)
+		hilos = 1;
+
+	// Las rutas de las salidas se devuelven absolutas (el cliente puede estar en otro directorio)
+	if (realpath(directorio, directorioSalidas) == NULL) {
+		printf("No existe el directorio de salidas %s\n", directorio);
+		return 1;
+	}
+
+	iniciarMedidas("SERVIDOR", argc, argv, 0.0);
+	usarDeteccionCiclos(ciclos);
+	usarMotor(motor, ficheroCalibracion);
+	usarTablasSucesores(sucesores);
+	usarCacheSucesores(directorioSucesores);
+	retenerTablasSucesores(memoriaSucesores << 20);
+	usarTablasGrandes(paginasGrandes, hilos);
+
+	if (!iniciarConexiones() || (escucha = escucharConexiones(rutaSocket)) == CONEXION_INVALIDA) {
+		printf("No se pudo escuchar en el socket %s\n", rutaSocket);
+		return 1;
+	}
+	arranque = std::chrono::steady_clock::now();
+	printf("Escuchando en %s con %d hilos (salidas en %s, semilla de los números aleatorios: %llu)\n", rutaSocket, hilos, directorioSalidas, semilla);
+	fflush(stdout);
+
+	// El hilo principal acepta las conexiones y los hilos del grupo las atienden
+	std::vector<std::thread> grupo;
+	for (int h = 0; h < hilos; h++)
+		grupo.push_back(std::thread(atenderConexiones));
+	for (;;) {
+		long long conexion = aceptarConexion(escucha);
+		std::lock_guard<std::mutex> cerrojo(cerrojoConexiones);
+		if (terminando || conexion == CONEXION_INVALIDA) {
+			cerrarConexion(conexion);
+			terminando = true;
+			hayConexiones.notify_all();
+			break;
+		}
+		conexiones++;
+		pendientes.push_back(conexion);
+		hayConexiones.notify_one();
+	}
+	for (size_t h = 0; h < grupo.size(); h++)
+		grupo[h].join();
+	printf("Se han atendido %lld peticiones en %lld conexiones\n", peticiones.load(), conexiones.load());
+
+	// Guardamos el informe de rendimiento
+	retenerTablasSucesores(0);
+	if (nombreInforme[0] != 0 && !guardarInformeMedidas(nombreInforme))
+		printf("No se pudo crear el informe %s\n", nombreInforme);
+}